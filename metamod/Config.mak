@@ -4,19 +4,23 @@ MODNAME = metamod
 EXTRA_CFLAGS += -D__METAMOD_BUILD__
 #-DMETA_PERFMON
 
-SRCFILES = api_hook.cpp api_info.cpp commands_meta.cpp conf_meta.cpp \
-	dllapi.cpp engine_api.cpp engineinfo.cpp game_support.cpp \
-	game_autodetect.cpp h_export.cpp linkgame.cpp linkplug.cpp \
-	log_meta.cpp meta_eiface.cpp metamod.cpp mlist.cpp mplayer.cpp \
-	mplugin.cpp mreg.cpp mutil.cpp osdep.cpp \
-	osdep_p.cpp reg_support.cpp sdk_util.cpp studioapi.cpp \
-	support_meta.cpp vdate.cpp
+SRCFILES = api_hook.cpp api_info.cpp api_prof.cpp api_route.cpp \
+	commands_meta.cpp conf_meta.cpp cvarquery.cpp cvarwatch.cpp \
+	diag_meta.cpp dllapi.cpp edictslot.cpp engine_api.cpp \
+	engineinfo.cpp filewatch.cpp game_autodetect.cpp \
+	game_support.cpp h_export.cpp hookprofile.cpp linkgame.cpp \
+	linkplug.cpp log_meta.cpp meta_eiface.cpp metamod.cpp \
+	mhooklist.cpp mlist.cpp mplugin.cpp mreg.cpp mutil.cpp \
+	osdep.cpp osdep_p.cpp reg_support.cpp sdk_util.cpp \
+	stageload.cpp studioapi.cpp support_meta.cpp usermsg.cpp \
+	vdate.cpp
 
 INFOFILES = info_name.h vers_meta.h
 RESFILE = res_meta.rc
 
 ifeq "$(OS)" "linux"
-	SRCFILES+=osdep_linkent_linux.cpp osdep_detect_gamedll_linux.cpp
+	SRCFILES+=osdep_linkent_linux.cpp osdep_detect_gamedll_linux.cpp \
+		osdep_elf_probe_linux.cpp osdep_modrange_linux.cpp
 	EXTRA_LINK+=
 else
 	SRCFILES+=osdep_linkent_win32.cpp osdep_detect_gamedll_win32.cpp
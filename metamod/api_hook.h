@@ -31,375 +31,568 @@
 #ifndef API_HOOK_H
 #define API_HOOK_H
 
-#include "ret_type.h"
 #include "api_info.h"
+#include "api_prof.h"		// prof_start, etc
+#include "diag_meta.h"		// diag_warning
 #include "meta_api.h"
-#include "osdep.h"		//OPEN_ARGS
+#include "mhooklist.h"		// hook_pool_t, etc
+#include "metamod.h"		// PublicMetaGlobals, Hooks, etc
+#include "log_meta.h"		// META_DEBUG, etc
+#include "osdep.h"			// likely, unlikely
 
- // Compine 4 parts for single name
-#define _COMBINE4(w,x,y,z) w##x##y##z
-#define _COMBINE2(x,y) x##y
+// Hook dispatch.
+//
+// The mm_* wrappers call a dispatcher instantiated for the api function's
+// own pointer type (FN_PRECACHEMODEL, etc), which passes the wrapper's
+// arguments unchanged to plugin functions and the original function.
+// Instances are shared by all api functions of the same signature.
+
+constexpr size_t API_TABLE_COUNT = 3;
+
+// Api tables and api_info tables, indexed by enum_api_t.
+extern const void** const api_tables[API_TABLE_COUNT] DLLHIDDEN;
+extern const void* const api_info_tables[API_TABLE_COUNT] DLLHIDDEN;
+
+// Hook call frames, for the metamod-bot-plugin bugfix.
+//  engine_api->pfnRunPlayerMove calls dllapi-functions before it returns,
+//  and plugins can call hooked engine functions from their own hooks.
+//  Plugins keep the PublicMetaGlobals pointer they got at attach, so a
+//  nested hook call saves PublicMetaGlobals in its frame and restores it
+//  when it returns.  Saving is skipped while the interrupted call is in
+//  the original function, as its plugins aren't using PublicMetaGlobals
+//  then.
+constexpr unsigned int MAX_HOOK_FRAMES = 64;
+
+typedef struct hook_frame_s {
+	meta_globals_t saved;	// PublicMetaGlobals of the interrupted plugin call
+	bool restore;			// restore saved when the call returns
+	bool exposed;			// plugins of this call may be using PublicMetaGlobals
+} hook_frame_t;
+
+// Frame 0 is never exposed; it's current when no hook call is in progress.
+extern hook_frame_t hook_frames[MAX_HOOK_FRAMES + 1] DLLHIDDEN;
+extern hook_frame_t* hook_frame DLLHIDDEN;		// current frame
+extern unsigned int hook_frames_lost DLLHIDDEN;	// calls nested past MAX_HOOK_FRAMES
+
+// get function pointer from api table by function pointer offset
+inline void* DLLINTERNAL get_api_function(const void* api_table, const unsigned int func_offset) {
+	return*(void**)((unsigned long)api_table + func_offset);
+}
+
+// get data pointer from api_info table by function offset
+inline const api_info_t* DLLINTERNAL get_api_info(const enum_api_t api, const unsigned int api_info_offset) {
+	return(const api_info_t*)((unsigned long)api_info_tables[api] + api_info_offset);
+}
+
+// get filename of plugin owning subscriber, for log messages
+const char* DLLINTERNAL get_sub_file(const hook_sub_t* sub);
+
+// log missing original function or api table
+void DLLINTERNAL orig_function_missing(enum_api_t api, const void* api_table, const api_info_t* api_info);
+
+// get original function, or NULL if gamedll/engine doesn't have it
+inline void* DLLINTERNAL get_orig_function(const enum_api_t api, const unsigned int func_offset, const api_info_t* api_info) {
+	const void* api_table = *api_tables[api];
+	if (likely(api_table)) {
+		void* pfn_routine = get_api_function(api_table, func_offset);
+		if (likely(pfn_routine))
+			return pfn_routine;
+	}
+	orig_function_missing(api, api_table, api_info);
+	return nullptr;
+}
+
+// push frame for a hook call nested too deep
+void DLLINTERNAL hook_frames_overflow();
+
+// Start of hook call: get plugin functions hooking this api function, and
+// push a frame, saving PublicMetaGlobals if an outer call is using it.
+inline const hook_subs_t* DLLINTERNAL hook_call_enter(const unsigned int hook_id, const hook_pool_t** pool) {
+	*pool = Hooks->enter();
+
+	if (likely(hook_frame < &hook_frames[MAX_HOOK_FRAMES])) {
+		const hook_frame_t* outer = hook_frame++;
+		hook_frame->restore = outer->exposed;
+		if (unlikely(hook_frame->restore))
+			hook_frame->saved = PublicMetaGlobals;
+		hook_frame->exposed = true;
+	}
+	else
+		hook_frames_overflow();
+
+	return &(*pool)->hooks[hook_id];
+}
+
+// End of hook call: pop frame, giving the outer call back its globals.
+inline void DLLINTERNAL hook_call_leave() {
+	if (likely(!hook_frames_lost)) {
+		if (unlikely(hook_frame->restore))
+			PublicMetaGlobals = hook_frame->saved;
+		hook_frame--;
+	}
+	else
+		hook_frames_lost--;
+	Hooks->leave();
+}
+
+// Original function is being called; calls nested in it needn't save
+// PublicMetaGlobals, as it's set up again for post functions.
+inline void DLLINTERNAL hook_call_original(const bool in_original) {
+	hook_frame->exposed = !in_original;
+}
+
+// Call plugin function (1-based plugin index) or original function
+// (plugin index 0), timing it if the profiler is on.
+template<typename fn_t, typename... args_t>
+inline void DLLINTERNAL call_api_function_void(void* pfn, const unsigned int hook_id, const int plugin_index, const int post, args_t... args) {
+	API_PAUSE_TSC_TRACKING();
+	const unsigned long long prof_time = prof_start();
+	reinterpret_cast<fn_t>(pfn)(args...);
+	prof_end(prof_time, hook_id, plugin_index, post);
+	API_UNPAUSE_TSC_TRACKING();
+}
+
+template<typename fn_t, typename ret_t, typename... args_t>
+inline ret_t DLLINTERNAL call_api_function(void* pfn, const unsigned int hook_id, const int plugin_index, const int post, args_t... args) {
+	API_PAUSE_TSC_TRACKING();
+	const unsigned long long prof_time = prof_start();
+	const ret_t ret = reinterpret_cast<fn_t>(pfn)(args...);
+	prof_end(prof_time, hook_id, plugin_index, post);
+	API_UNPAUSE_TSC_TRACKING();
+	return ret;
+}
+
+// Hook without subscribers: just call the original function.  Nothing
+// is exposed to plugins, so no frame is pushed.
+template<typename fn_t, typename... args_t>
+void DLLINTERNAL main_hook_function_direct_void(const unsigned int api_info_offset, const enum_api_t api, const unsigned int func_offset, args_t... args) {
+	const api_info_t* api_info = get_api_info(api, api_info_offset);
+	const unsigned int hook_id = MHookList::hook_id(api, func_offset);
+	void* pfn_routine = get_orig_function(api, func_offset, api_info);
+	if (likely(pfn_routine)) {
+		call_api_function_void<fn_t>(pfn_routine, hook_id, 0, 0, args...);
+	}
+}
+
+template<typename fn_t, typename ret_t, typename... args_t>
+ret_t DLLINTERNAL main_hook_function_direct(const ret_t ret_init, const unsigned int api_info_offset, const enum_api_t api, const unsigned int func_offset, args_t... args) {
+	const api_info_t* api_info = get_api_info(api, api_info_offset);
+	const unsigned int hook_id = MHookList::hook_id(api, func_offset);
+	void* pfn_routine = get_orig_function(api, func_offset, api_info);
+	if (unlikely(!pfn_routine))
+		return ret_init;
+	return call_api_function<fn_t, ret_t>(pfn_routine, hook_id, 0, 0, args...);
+}
+
+// Hook with one pre subscriber and no post subscribers: the plugin's
+// result only decides whether the original function is called
+// (MRES_SUPERCEDE) and which return value is used (MRES_SUPERCEDE,
+// MRES_OVERRIDE).
+template<typename fn_t, typename... args_t>
+void DLLINTERNAL main_hook_function_single_void(const unsigned int api_info_offset, const enum_api_t api, const unsigned int func_offset, args_t... args) {
+	const hook_pool_t* pool;
+
+	const api_info_t* api_info = get_api_info(api, api_info_offset);
+	const unsigned int hook_id = MHookList::hook_id(api, func_offset);
+	const hook_subs_t* hook = hook_call_enter(hook_id, &pool);
+	const hook_sub_t* sub = &pool->subs[hook->pre];
+
+#ifndef __BUILD_FAST_METAMOD__
+	const int loglevel = api_info->loglevel;
+#endif
+	META_RES status = MRES_UNSET;
+	void* pfn_routine = sub->pfn;
+
+	//Pre plugin function; NULL if plugin stopped running during this call
+	if (likely(pfn_routine)) {
+		PublicMetaGlobals.mres = MRES_UNSET;
+		PublicMetaGlobals.prev_mres = MRES_UNSET;
+		PublicMetaGlobals.status = MRES_UNSET;
+
+		META_DEBUG(loglevel, ("Calling %s:%s()", get_sub_file(sub), api_info->name));
+		call_api_function_void<fn_t>(pfn_routine, hook_id, sub->index, 0, args...);
+
+		status = PublicMetaGlobals.mres;
+		if (unlikely(status == MRES_UNSET))
+			diag_warning(DIAG_NO_MRES, sub->index, hook_id, "Plugin didn't set meta_result: %s:%s()", get_sub_file(sub), api_info->name);
+	}
+
+	hook_call_original(true);
+
+	//Api call
+	if (likely(status != MRES_SUPERCEDE)) {
+		pfn_routine = get_orig_function(api, func_offset, api_info);
+		if (likely(pfn_routine)) {
+			META_DEBUG(loglevel, ("Calling %s:%s()", (api == e_api_engine) ? "engine" : GameDLL.file, api_info->name));
+			call_api_function_void<fn_t>(pfn_routine, hook_id, 0, 0, args...);
+		}
+	}
+	else
+		META_DEBUG(loglevel, ("Skipped (supercede) %s:%s()", (api == e_api_engine) ? "engine" : GameDLL.file, api_info->name));
+
+	hook_call_leave();
+}
+
+template<typename fn_t, typename ret_t, typename... args_t>
+ret_t DLLINTERNAL main_hook_function_single(const ret_t ret_init, const unsigned int api_info_offset, const enum_api_t api, const unsigned int func_offset, args_t... args) {
+	const hook_pool_t* pool;
+
+	const api_info_t* api_info = get_api_info(api, api_info_offset);
+	const unsigned int hook_id = MHookList::hook_id(api, func_offset);
+	const hook_subs_t* hook = hook_call_enter(hook_id, &pool);
+	const hook_sub_t* sub = &pool->subs[hook->pre];
+
+	ret_t override_ret = ret_init;
+	ret_t orig_ret = ret_init;
+	ret_t pub_orig_ret = ret_init;
+	ret_t pub_override_ret = ret_init;
+
+#ifndef __BUILD_FAST_METAMOD__
+	const int loglevel = api_info->loglevel;
+#endif
+	META_RES status = MRES_UNSET;
+	void* pfn_routine = sub->pfn;
+
+	//Pre plugin function; NULL if plugin stopped running during this call
+	if (likely(pfn_routine)) {
+		PublicMetaGlobals.mres = MRES_UNSET;
+		PublicMetaGlobals.prev_mres = MRES_UNSET;
+		PublicMetaGlobals.status = MRES_UNSET;
+		PublicMetaGlobals.orig_ret = &pub_orig_ret;
+		PublicMetaGlobals.override_ret = &pub_override_ret;
+
+		META_DEBUG(loglevel, ("Calling %s:%s()", get_sub_file(sub), api_info->name));
+		override_ret = call_api_function<fn_t, ret_t>(pfn_routine, hook_id, sub->index, 0, args...);
+
+		status = PublicMetaGlobals.mres;
+		if (unlikely(status == MRES_UNSET))
+			diag_warning(DIAG_NO_MRES, sub->index, hook_id, "Plugin didn't set meta_result: %s:%s()", get_sub_file(sub), api_info->name);
+	}
+
+	hook_call_original(true);
+
+	//Api call
+	if (likely(status != MRES_SUPERCEDE)) {
+		pfn_routine = get_orig_function(api, func_offset, api_info);
+		if (likely(pfn_routine)) {
+			META_DEBUG(loglevel, ("Calling %s:%s()", (api == e_api_engine) ? "engine" : GameDLL.file, api_info->name));
+			orig_ret = call_api_function<fn_t, ret_t>(pfn_routine, hook_id, 0, 0, args...);
+		}
+		else
+			status = MRES_UNSET;
+	}
+	else {
+		META_DEBUG(loglevel, ("Skipped (supercede) %s:%s()", (api == e_api_engine) ? "engine" : GameDLL.file, api_info->name));
+		orig_ret = override_ret;
+	}
+
+	hook_call_leave();
+
+	if (likely(status != MRES_OVERRIDE))
+		return orig_ret;
+	META_DEBUG(loglevel, ("Returning (override) %s()", api_info->name));
+	return override_ret;
+}
 
 // simplified 'void' version of main hook function
-void DLLINTERNAL main_hook_function_void(unsigned int api_info_offset, enum_api_t api, unsigned int func_offset, const void* packed_args);
+template<typename fn_t, typename... args_t>
+void DLLINTERNAL main_hook_function_void(const unsigned int api_info_offset, const enum_api_t api, const unsigned int func_offset, args_t... args) {
+	const hook_pool_t* pool;
+	const hook_sub_t* sub, * end;
 
-// full return typed version of main hook function
-void* DLLINTERNAL main_hook_function(class_ret_t ret_init, unsigned int api_info_offset, enum_api_t api, unsigned int func_offset, const void* packed_args);
+	//passing offset from api wrapper function makes code faster/smaller
+	const api_info_t* api_info = get_api_info(api, api_info_offset);
+	const unsigned int hook_id = MHookList::hook_id(api, func_offset);
 
-//
-// API function args structures/classes
-//
-#define API_PACK_ARGS(type, args) \
-	_COMBINE2(pack_args_type_, type) packed_args args;
-
-#define PACK_ARGS_CLASS_HEADER(type, constructor_args) \
-	class _COMBINE2(pack_args_type_, type) : public class_metamod_new { \
-		public: inline _COMBINE2(pack_args_type_, type) constructor_args
-
-#define PACK_ARGS_END };
-
-constexpr int VOID_ARG = 0;
-
-PACK_ARGS_CLASS_HEADER(void, (int)) {}
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(i, (const int _i1)) : i1(_i1) {}
-int i1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2i, (const int _i1, const int _i2)) : i1(_i1), i2(_i2) {}
-int i1, i2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(3i, (const int _i1, const int _i2, const int _i3)) : i1(_i1), i2(_i2), i3(_i3) {}
-int i1, i2, i3;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(ui, (const unsigned int _ui1)) : ui1(_ui1) {}
-unsigned int ui1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(ul, (const unsigned long _ul1)) : ul1(_ul1) {}
-unsigned long ul1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(f, (const float _f1)) : f1(_f1) {}
-float f1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2f, (const float _f1, const float _f2)) : f1(_f1), f2(_f2) {}
-float f1, f2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(p, (const void* _p1)) : p1(_p1) {}
-const void* p1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2p, (const void* _p1, const void* _p2)) : p1(_p1), p2(_p2) {}
-const void* p1, * p2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(3p, (const void* _p1, const void* _p2, const void* _p3)) : p1(_p1), p2(_p2), p3(_p3) {}
-const void* p1, * p2, * p3;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(4p, (const void* _p1, const void* _p2, const void* _p3, const void* _p4)) : p1(_p1), p2(_p2), p3(_p3), p4(_p4) {}
-const void* p1, * p2, * p3, * p4;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2pV, (const void* _p1, const void* _p2, const void* _str)) : p1(_p1), p2(_p2), str(_str) {}
-const void* p1, * p2, * str;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(ipV, (const int _i1, const void* _p1, const void* _str)) : i1(_i1), p1(_p1), str(_str) {}
-int i1;
-const void* p1, * str;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2i2p, (const int _i1, const int _i2, const void* _p1, const void* _p2)) : i1(_i1), i2(_i2), p1(_p1), p2(_p2) {}
-int i1, i2;
-const void* p1, * p2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2p2f, (const void* _p1, const void* _p2, const float _f1, const float _f2)) : p1(_p1), p2(_p2), f1(_f1), f2(_f2) {}
-const void* p1, * p2;
-float f1, f2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2p2i2p, (const void* _p1, const void* _p2, const int _i1, const int _i2, const void* _p3, const void* _p4)) : p1(_p1), p2(_p2), i1(_i1), i2(_i2), p3(_p3), p4(_p4) {}
-const void* p1, * p2;
-int i1, i2;
-const void* p3, * p4;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2p3fus2uc, (const void* _p1, const void* _p2, const float _f1, const float _f2, const float _f3, const unsigned short _us1, const unsigned char _uc1, const unsigned char _uc2)) : p1(_p1), p2(_p2), f1(_f1), f2(_f2), f3(_f3), us1(_us1), uc1(_uc1), uc2(_uc2) {}
-const void* p1, * p2;
-float f1, f2, f3;
-unsigned short us1;
-unsigned char uc1, uc2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2pf, (const void* _p1, const void* _p2, const float _f1)) : p1(_p1), p2(_p2), f1(_f1) {}
-const void* p1, * p2;
-float f1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2pfi, (const void* _p1, const void* _p2, const float _f1, const int _i1)) : p1(_p1), p2(_p2), f1(_f1), i1(_i1) {}
-const void* p1, * p2;
-float f1;
-int i1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2pi, (const void* _p1, const void* _p2, const int _i1)) : p1(_p1), p2(_p2), i1(_i1) {}
-const void* p1, * p2;
-int i1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2pi2p, (const void* _p1, const void* _p2, const int _i1, const void* _p3, const void* _p4)) : p1(_p1), p2(_p2), i1(_i1), p3(_p3), p4(_p4) {}
-const void* p1, * p2;
-int i1;
-const void* p3, * p4;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2pif2p, (const void* _p1, const void* _p2, const int _i1, const float _f1, const void* _p3, const void* _p4)) : p1(_p1), p2(_p2), i1(_i1), f1(_f1), p3(_p3), p4(_p4) {}
-const void* p1, * p2;
-int i1;
-float f1;
-const void* p3, * p4;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(3p2f2i, (const void* _p1, const void* _p2, const void* _p3, const float _f1, const float _f2, const int _i1, const int _i2)) : p1(_p1), p2(_p2), p3(_p3), f1(_f1), f2(_f2), i1(_i1), i2(_i2) {}
-const void* p1, * p2, * p3;
-float f1, f2;
-int i1, i2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(3pi2p, (const void* _p1, const void* _p2, const void* _p3, const int _i1, const void* _p4, const void* _p5)) : p1(_p1), p2(_p2), p3(_p3), i1(_i1), p4(_p4), p5(_p5) {}
-const void* p1, * p2, * p3;
-int i1;
-const void* p4, * p5;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(i3p, (const int _i1, const void* _p1, const void* _p2, const void* _p3)) : i1(_i1), p1(_p1), p2(_p2), p3(_p3) {}
-int i1;
-const void* p1, * p2, * p3;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(ip, (const int _i1, const void* _p1)) : i1(_i1), p1(_p1) {}
-int i1;
-const void* p1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(ipusf2p2f4i, (const int _i1, const void* _p1, const unsigned short _us1, const float _f1, const void* _p2, const void* _p3, const float _f2, const float _f3, const int _i2, const int _i3, const int _i4, const int _i5)) : i1(_i1), p1(_p1), us1(_us1), f1(_f1), p2(_p2), p3(_p3), f2(_f2), f3(_f3), i2(_i2), i3(_i3), i4(_i4), i5(_i5) {}
-int i1;
-const void* p1;
-unsigned short us1;
-float f1;
-const void* p2, * p3;
-float f2, f3;
-int i2, i3, i4, i5;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(3pi, (const void* _p1, const void* _p2, const void* _p3, const int _i1)) : p1(_p1), p2(_p2), p3(_p3), i1(_i1) {}
-const void* p1, * p2, * p3;
-int i1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(4pi, (const void* _p1, const void* _p2, const void* _p3, const void* _p4, const int _i1)) : p1(_p1), p2(_p2), p3(_p3), p4(_p4), i1(_i1) {}
-const void* p1, * p2, * p3, * p4;
-int i1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(pf, (const void* _p1, const float _f1)) : p1(_p1), f1(_f1) {}
-const void* p1;
-float f1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(pfp, (const void* _p1, const float _f1, const void* _p2)) : p1(_p1), f1(_f1), p2(_p2) {}
-const void* p1;
-float f1;
-const void* p2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(pi, (const void* _p1, const int _i1)) : p1(_p1), i1(_i1) {}
-const void* p1;
-int i1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(pi2p, (const void* _p1, const int _i1, const void* _p2, const void* _p3)) : p1(_p1), i1(_i1), p2(_p2), p3(_p3) {}
-const void* p1;
-int i1;
-const void* p2, * p3;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(pip, (const void* _p1, const int _i1, const void* _p2)) : p1(_p1), i1(_i1), p2(_p2) {}
-const void* p1;
-int i1;
-const void* p2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(pip2f2i, (const void* _p1, const int _i1, const void* _p2, const float _f1, const float _f2, const int _i2, const int _i3)) : p1(_p1), i1(_i1), p2(_p2), f1(_f1), f2(_f2), i2(_i2), i3(_i3) {}
-const void* p1;
-int i1;
-const void* p2;
-float f1, f2;
-int i2, i3;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(pip2f4i2p, (const void* _p1, const int _i1, const void* _p2, const float _f1, const float _f2, const int _i2, const int _i3, const int _i4, const int _i5, const void* _p3, const void* _p4)) : p1(_p1), i1(_i1), p2(_p2), f1(_f1), f2(_f2), i2(_i2), i3(_i3), i4(_i4), i5(_i5), p3(_p3), p4(_p4) {}
-const void* p1;
-int i1;
-const void* p2;
-float f1, f2;
-int i2, i3, i4, i5;
-const void* p3, * p4;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(puc, (const void* _p1, const unsigned char _uc1)) : p1(_p1), uc1(_uc1) {}
-const void* p1;
-unsigned char uc1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2i2pi2p, (const int _i1, const int _i2, const void* _p1, const void* _p2, const int _i3, const void* _p3, const void* _p4)) : i1(_i1), i2(_i2), p1(_p1), p2(_p2), i3(_i3), p3(_p3), p4(_p4) {}
-int i1, i2;
-const void* p1, * p2;
-int i3;
-const void* p3, * p4;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2i2pi2v3, (const int _i1, const int _i2, const void *_p1, const void *_p2, const int _i3, Vector _v1, Vector _v2)) : i1(_i1), i2(_i2), p1(_p1), p2(_p2), i3(_i3), v1(_v1), v2(_v2) {}
-int i1, i2;
-const void *p1, *p2;
-int i3;
-Vector v1, v2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(2pui, (const void* _p1, const void* _p2, const unsigned int _ui1)) : p1(_p1), p2(_p2), ui1(_ui1) {}
-const void* p1, * p2;
-unsigned int ui1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(i2p, (const int _i1, const void* _p1, const void* _p2)) : i1(_i1), p1(_p1), p2(_p2) {}
-int i1;
-const void* p1, * p2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(p2f, (const void* _p1, const float _f1, const float _f2)) : p1(_p1), f1(_f1), f2(_f2) {}
-const void* p1;
-float f1, f2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(p2fi, (const void* _p1, const float _f1, const float _f2, const int _i1)) : p1(_p1), f1(_f1), f2(_f2), i1(_i1) {}
-const void* p1;
-float f1, f2;
-int i1;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(p2i, (const void* _p1, const int _i1, const int _i2)) : p1(_p1), i1(_i1), i2(_i2) {}
-const void* p1;
-int i1, i2;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(p3i, (const void* _p1, const int _i1, const int _i2, const int _i3)) : p1(_p1), i1(_i1), i2(_i2), i3(_i3) {}
-const void* p1;
-int i1, i2, i3;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(p4i, (const void* _p1, const int _i1, const int _i2, const int _i3, const int _i4)) : p1(_p1), i1(_i1), i2(_i2), i3(_i3), i4(_i4) {}
-const void* p1;
-int i1, i2, i3, i4;
-PACK_ARGS_END
-
-PACK_ARGS_CLASS_HEADER(pi2p2ip, (const void* _p1, const int _i1, const void* _p2, const void* _p3, const int _i2, const int _i3, const void* _p4)) : p1(_p1), i1(_i1), p2(_p2), p3(_p3), i2(_i2), i3(_i3), p4(_p4) {}
-const void* p1;
-int i1;
-const void* p2, * p3;
-int i2, i3;
-const void* p4;
-PACK_ARGS_END
+	//plugin functions hooking this api function
+	const hook_subs_t* hook = hook_call_enter(hook_id, &pool);
 
-//
-// API function callers.
-//
-#ifdef __METAMOD_BUILD__
-#define EXTERN_API_CALLER_FUNCTION(ret_type, args_code) \
-		void * DLLINTERNAL _COMBINE4(api_caller_, ret_type, _args_, args_code)(const void * func, const void * packed_args)
-#else
-#define EXTERN_API_CALLER_FUNCTION(ret_type, args_code) \
-		static const api_caller_func_t _COMBINE4(api_caller_, ret_type, _args_, args_code) DLLHIDDEN = (api_caller_func_t)0
+	//Setup
+#ifndef __BUILD_FAST_METAMOD__
+	const int loglevel = api_info->loglevel;
 #endif
+	META_RES mres;
+	META_RES status = MRES_UNSET;
+	void* pfn_routine;
+
+	//Pre plugin functions
+	META_RES prev_mres = MRES_UNSET;
+	for (sub = &pool->subs[hook->pre], end = sub + hook->num_pre; sub < end; sub++) {
+		pfn_routine = sub->pfn;
+		if (unlikely(!pfn_routine)) {
+			//plugin stopped running during this call
+			continue;
+		}
+
+		// initialize PublicMetaGlobals
+		PublicMetaGlobals.mres = MRES_UNSET;
+		PublicMetaGlobals.prev_mres = prev_mres;
+		PublicMetaGlobals.status = status;
+
+		// call plugin
+		META_DEBUG(loglevel, ("Calling %s:%s()", get_sub_file(sub), api_info->name));
+		call_api_function_void<fn_t>(pfn_routine, hook_id, sub->index, 0, args...);
+
+		// plugin's result code
+		mres = PublicMetaGlobals.mres;
+		if (unlikely(mres > status))
+			status = mres;
+
+		// save this for successive plugins to see
+		prev_mres = mres;
+
+		if (unlikely(mres == MRES_UNSET))
+			diag_warning(DIAG_NO_MRES, sub->index, hook_id, "Plugin didn't set meta_result: %s:%s()", get_sub_file(sub), api_info->name);
+	}
+
+	hook_call_original(true);
+
+	//Api call
+	if (likely(status != MRES_SUPERCEDE)) {
+		pfn_routine = get_orig_function(api, func_offset, api_info);
+		if (likely(pfn_routine)) {
+			META_DEBUG(loglevel, ("Calling %s:%s()", (api == e_api_engine) ? "engine" : GameDLL.file, api_info->name));
+			call_api_function_void<fn_t>(pfn_routine, hook_id, 0, 0, args...);
+		}
+		else
+			status = MRES_UNSET;
+	}
+	else
+		META_DEBUG(loglevel, ("Skipped (supercede) %s:%s()", (api == e_api_engine) ? "engine" : GameDLL.file, api_info->name));
+
+	hook_call_original(false);
+
+	//Post plugin functions
+	prev_mres = MRES_UNSET;
+	for (sub = &pool->subs[hook->post], end = sub + hook->num_post; sub < end; sub++) {
+		pfn_routine = sub->pfn;
+		if (unlikely(!pfn_routine)) {
+			//plugin stopped running during this call
+			continue;
+		}
+
+		// initialize PublicMetaGlobals
+		PublicMetaGlobals.mres = MRES_UNSET;
+		PublicMetaGlobals.prev_mres = prev_mres;
+		PublicMetaGlobals.status = status;
+
+		// call plugin
+		META_DEBUG(loglevel, ("Calling %s:%s_Post()", get_sub_file(sub), api_info->name));
+		call_api_function_void<fn_t>(pfn_routine, hook_id, sub->index, 1, args...);
+
+		// plugin's result code
+		mres = PublicMetaGlobals.mres;
+		if (unlikely(mres > status))
+			status = mres;
+
+		// save this for successive plugins to see
+		prev_mres = mres;
+
+		if (unlikely(mres == MRES_UNSET))
+			diag_warning(DIAG_NO_MRES_POST, sub->index, hook_id, "Plugin didn't set meta_result: %s:%s_Post()", get_sub_file(sub), api_info->name);
+		else if (unlikely(mres == MRES_SUPERCEDE))
+			diag_warning(DIAG_POST_SUPERCEDE, sub->index, hook_id, "MRES_SUPERCEDE not valid in Post functions: %s:%s_Post()", get_sub_file(sub), api_info->name);
+	}
+
+	hook_call_leave();
+}
 
-EXTERN_API_CALLER_FUNCTION(void, ipV);
-EXTERN_API_CALLER_FUNCTION(void, 2pV);
-EXTERN_API_CALLER_FUNCTION(void, void);
-EXTERN_API_CALLER_FUNCTION(ptr, void);
-EXTERN_API_CALLER_FUNCTION(int, void);
-EXTERN_API_CALLER_FUNCTION(float, void);
-EXTERN_API_CALLER_FUNCTION(float, 2f);
-EXTERN_API_CALLER_FUNCTION(void, 2i);
-EXTERN_API_CALLER_FUNCTION(int, 2i);
-EXTERN_API_CALLER_FUNCTION(void, 2i2p);
-EXTERN_API_CALLER_FUNCTION(void, 2i2pi2p);
-EXTERN_API_CALLER_FUNCTION(void, 2i2pi2v3);
-EXTERN_API_CALLER_FUNCTION(void, 2p);
-EXTERN_API_CALLER_FUNCTION(ptr, 2p);
-EXTERN_API_CALLER_FUNCTION(int, 2p);
-EXTERN_API_CALLER_FUNCTION(void, 2p2f);
-EXTERN_API_CALLER_FUNCTION(void, 2p2i2p);
-EXTERN_API_CALLER_FUNCTION(void, 2p3fus2uc);
-EXTERN_API_CALLER_FUNCTION(ptr, 2pf);
-EXTERN_API_CALLER_FUNCTION(void, 2pfi);
-EXTERN_API_CALLER_FUNCTION(void, 2pi);
-EXTERN_API_CALLER_FUNCTION(int, 2pi);
-EXTERN_API_CALLER_FUNCTION(void, 2pui);
-EXTERN_API_CALLER_FUNCTION(void, 2pi2p);
-EXTERN_API_CALLER_FUNCTION(void, 2pif2p);
-EXTERN_API_CALLER_FUNCTION(int, 3i);
-EXTERN_API_CALLER_FUNCTION(void, 3p);
-EXTERN_API_CALLER_FUNCTION(ptr, 3p);
-EXTERN_API_CALLER_FUNCTION(int, 3p);
-EXTERN_API_CALLER_FUNCTION(void, 3p2f2i);
-EXTERN_API_CALLER_FUNCTION(int, 3pi2p);
-EXTERN_API_CALLER_FUNCTION(void, 4p);
-EXTERN_API_CALLER_FUNCTION(int, 4p);
-EXTERN_API_CALLER_FUNCTION(void, 4pi);
-EXTERN_API_CALLER_FUNCTION(int, 4pi);
-EXTERN_API_CALLER_FUNCTION(void, f);
-EXTERN_API_CALLER_FUNCTION(void, i);
-EXTERN_API_CALLER_FUNCTION(ptr, i);
-EXTERN_API_CALLER_FUNCTION(int, i);
-EXTERN_API_CALLER_FUNCTION(ptr, ui);
-EXTERN_API_CALLER_FUNCTION(uint, ui);
-EXTERN_API_CALLER_FUNCTION(ulong, ul);
-EXTERN_API_CALLER_FUNCTION(void, i2p);
-EXTERN_API_CALLER_FUNCTION(int, i2p);
-EXTERN_API_CALLER_FUNCTION(void, i3p);
-EXTERN_API_CALLER_FUNCTION(void, ip);
-EXTERN_API_CALLER_FUNCTION(ushort, ip);
-EXTERN_API_CALLER_FUNCTION(int, ip);
-EXTERN_API_CALLER_FUNCTION(void, ipusf2p2f4i);
-EXTERN_API_CALLER_FUNCTION(void, p);
-EXTERN_API_CALLER_FUNCTION(ptr, p);
-EXTERN_API_CALLER_FUNCTION(char, p);
-EXTERN_API_CALLER_FUNCTION(int, p);
-EXTERN_API_CALLER_FUNCTION(uint, p);
-EXTERN_API_CALLER_FUNCTION(float, p);
-EXTERN_API_CALLER_FUNCTION(void, p2f);
-EXTERN_API_CALLER_FUNCTION(int, p2fi);
-EXTERN_API_CALLER_FUNCTION(void, p2i);
-EXTERN_API_CALLER_FUNCTION(void, p3i);
-EXTERN_API_CALLER_FUNCTION(void, p4i);
-EXTERN_API_CALLER_FUNCTION(void, puc);
-EXTERN_API_CALLER_FUNCTION(void, pf);
-EXTERN_API_CALLER_FUNCTION(void, pfp);
-EXTERN_API_CALLER_FUNCTION(void, pi);
-EXTERN_API_CALLER_FUNCTION(ptr, pi);
-EXTERN_API_CALLER_FUNCTION(int, pi);
-EXTERN_API_CALLER_FUNCTION(void, pi2p);
-EXTERN_API_CALLER_FUNCTION(int, pi2p2ip);
-EXTERN_API_CALLER_FUNCTION(void, pip);
-EXTERN_API_CALLER_FUNCTION(ptr, pip);
-EXTERN_API_CALLER_FUNCTION(void, pip2f2i);
-EXTERN_API_CALLER_FUNCTION(void, pip2f4i2p);
+// full return typed version of main hook function
+template<typename fn_t, typename ret_t, typename... args_t>
+ret_t DLLINTERNAL main_hook_function(const ret_t ret_init, const unsigned int api_info_offset, const enum_api_t api, const unsigned int func_offset, args_t... args) {
+	const hook_pool_t* pool;
+	const hook_sub_t* sub, * end;
+
+	//passing offset from api wrapper function makes code faster/smaller
+	const api_info_t* api_info = get_api_info(api, api_info_offset);
+	const unsigned int hook_id = MHookList::hook_id(api, func_offset);
+
+	//plugin functions hooking this api function
+	const hook_subs_t* hook = hook_call_enter(hook_id, &pool);
+
+	//Return value setup; plugins see copies through orig_ret/override_ret
+	ret_t dllret = ret_init;
+	ret_t override_ret = ret_init;
+	ret_t pub_override_ret = ret_init;
+	ret_t orig_ret = ret_init;
+	ret_t pub_orig_ret = ret_init;
+
+	//Setup
+#ifndef __BUILD_FAST_METAMOD__
+	const int loglevel = api_info->loglevel;
+#endif
+	META_RES mres;
+	META_RES status = MRES_UNSET;
+	void* pfn_routine;
+
+	//Pre plugin functions
+	META_RES prev_mres = MRES_UNSET;
+	for (sub = &pool->subs[hook->pre], end = sub + hook->num_pre; sub < end; sub++) {
+		pfn_routine = sub->pfn;
+		if (unlikely(!pfn_routine)) {
+			//plugin stopped running during this call
+			continue;
+		}
+
+		// initialize PublicMetaGlobals
+		PublicMetaGlobals.mres = MRES_UNSET;
+		PublicMetaGlobals.prev_mres = prev_mres;
+		PublicMetaGlobals.status = status;
+		pub_orig_ret = orig_ret;
+		PublicMetaGlobals.orig_ret = &pub_orig_ret;
+		pub_override_ret = override_ret;
+		PublicMetaGlobals.override_ret = &pub_override_ret;
+
+		// call plugin
+		META_DEBUG(loglevel, ("Calling %s:%s()", get_sub_file(sub), api_info->name));
+		dllret = call_api_function<fn_t, ret_t>(pfn_routine, hook_id, sub->index, 0, args...);
+
+		// plugin's result code
+		mres = PublicMetaGlobals.mres;
+		if (unlikely(mres > status))
+			status = mres;
+
+		// save this for successive plugins to see
+		prev_mres = mres;
+
+		if (unlikely(mres == MRES_SUPERCEDE || mres == MRES_OVERRIDE)) {
+			pub_override_ret = dllret;
+			override_ret = dllret;
+		}
+		else if (unlikely(mres == MRES_UNSET)) {
+			diag_warning(DIAG_NO_MRES, sub->index, hook_id, "Plugin didn't set meta_result: %s:%s()", get_sub_file(sub), api_info->name);
+		}
+	}
+
+	hook_call_original(true);
+
+	//Api call
+	if (likely(status != MRES_SUPERCEDE)) {
+		pfn_routine = get_orig_function(api, func_offset, api_info);
+		if (likely(pfn_routine)) {
+			META_DEBUG(loglevel, ("Calling %s:%s()", (api == e_api_engine) ? "engine" : GameDLL.file, api_info->name));
+			dllret = call_api_function<fn_t, ret_t>(pfn_routine, hook_id, 0, 0, args...);
+			orig_ret = dllret;
+		}
+		else
+			status = MRES_UNSET;
+	}
+	else {
+		META_DEBUG(loglevel, ("Skipped (supercede) %s:%s()", (api == e_api_engine) ? "engine" : GameDLL.file, api_info->name));
+		orig_ret = override_ret;
+		pub_orig_ret = override_ret;
+		PublicMetaGlobals.orig_ret = &pub_orig_ret;
+	}
+
+	hook_call_original(false);
+
+	//Post plugin functions
+	prev_mres = MRES_UNSET;
+	for (sub = &pool->subs[hook->post], end = sub + hook->num_post; sub < end; sub++) {
+		pfn_routine = sub->pfn;
+		if (unlikely(!pfn_routine)) {
+			//plugin stopped running during this call
+			continue;
+		}
+
+		// initialize PublicMetaGlobals
+		PublicMetaGlobals.mres = MRES_UNSET;
+		PublicMetaGlobals.prev_mres = prev_mres;
+		PublicMetaGlobals.status = status;
+		pub_orig_ret = orig_ret;
+		PublicMetaGlobals.orig_ret = &pub_orig_ret;
+		pub_override_ret = override_ret;
+		PublicMetaGlobals.override_ret = &pub_override_ret;
+
+		// call plugin
+		META_DEBUG(loglevel, ("Calling %s:%s_Post()", get_sub_file(sub), api_info->name));
+		dllret = call_api_function<fn_t, ret_t>(pfn_routine, hook_id, sub->index, 1, args...);
+
+		// plugin's result code
+		mres = PublicMetaGlobals.mres;
+		if (unlikely(mres > status))
+			status = mres;
+
+		// save this for successive plugins to see
+		prev_mres = mres;
+
+		if (unlikely(mres == MRES_OVERRIDE)) {
+			pub_override_ret = dllret;
+			override_ret = dllret;
+		}
+		else if (unlikely(mres == MRES_UNSET)) {
+			diag_warning(DIAG_NO_MRES_POST, sub->index, hook_id, "Plugin didn't set meta_result: %s:%s_Post()", get_sub_file(sub), api_info->name);
+		}
+		else if (unlikely(mres == MRES_SUPERCEDE)) {
+			diag_warning(DIAG_POST_SUPERCEDE, sub->index, hook_id, "MRES_SUPERCEDE not valid in Post functions: %s:%s_Post()", get_sub_file(sub), api_info->name);
+		}
+	}
+
+	hook_call_leave();
+
+	if (likely(status != MRES_OVERRIDE))
+		return orig_ret;
+	META_DEBUG(loglevel, ("Returning (override) %s()", api_info->name));
+	return override_ret;
+}
+
+// Dispatchers for one api function of type fn_t, called with the
+// function's own arguments:
+//
+//	api_hook_void_t<FN_TYPE>(info_offset, api, func_offset)(args);
+//	ret = api_hook_t<FN_TYPE, ret_t>(ret_init, info_offset, api, func_offset)(args);
+//
+// Only carry the constants to main_hook_function*(); inlined away.  The
+// dispatch path is picked per call from the api function's current
+// subscribers (see hook_mode_t).
+template<typename fn_t>
+class api_hook_void_t {
+public:
+	api_hook_void_t(const unsigned int _api_info_offset, const enum_api_t _api, const unsigned int _func_offset)
+		: api_info_offset(_api_info_offset), api(_api), func_offset(_func_offset) {}
+
+	template<typename... args_t>
+	void operator()(args_t... args) const {
+		switch (Hooks->mode(api, func_offset)) {
+		case HM_DIRECT:
+			main_hook_function_direct_void<fn_t>(api_info_offset, api, func_offset, args...);
+			break;
+		case HM_SINGLE:
+			main_hook_function_single_void<fn_t>(api_info_offset, api, func_offset, args...);
+			break;
+		default:
+			main_hook_function_void<fn_t>(api_info_offset, api, func_offset, args...);
+			break;
+		}
+	}
+private:
+	const unsigned int api_info_offset;
+	const enum_api_t api;
+	const unsigned int func_offset;
+};
+
+template<typename fn_t, typename ret_t>
+class api_hook_t {
+public:
+	api_hook_t(const ret_t _ret_init, const unsigned int _api_info_offset, const enum_api_t _api, const unsigned int _func_offset)
+		: ret_init(_ret_init), api_info_offset(_api_info_offset), api(_api), func_offset(_func_offset) {}
+
+	template<typename... args_t>
+	ret_t operator()(args_t... args) const {
+		switch (Hooks->mode(api, func_offset)) {
+		case HM_DIRECT:
+			return main_hook_function_direct<fn_t>(ret_init, api_info_offset, api, func_offset, args...);
+		case HM_SINGLE:
+			return main_hook_function_single<fn_t>(ret_init, api_info_offset, api, func_offset, args...);
+		default:
+			return main_hook_function<fn_t>(ret_init, api_info_offset, api, func_offset, args...);
+		}
+	}
+private:
+	const ret_t ret_init;
+	const unsigned int api_info_offset;
+	const enum_api_t api;
+	const unsigned int func_offset;
+};
 
 #endif /*API_HOOK_H*/
@@ -41,7 +41,6 @@
 
 #include "comp_dep.h"
 #include "types_meta.h"			// mBOOL
-#include "ret_type.h"
 
 #define P_PRE 0		// plugin function called before gamedll
 #define P_POST 1	// plugin function called after gamedll
@@ -53,13 +52,9 @@ typedef enum enum_api_t : std::uint8_t {
 	e_api_newapi = 2,
 } enum_api_t;
 
-// API caller function prototype
-typedef void* (DLLINTERNAL_NOVIS* api_caller_func_t)(const void* func, const void* packed_args);
-
 typedef struct api_info_s {
 	mBOOL trace;			// if true, log info about this function
 	int loglevel;			// level at which to log info about this function
-	api_caller_func_t api_caller;	// argument format/type for single-main-hook-function optimization
 	const char* name;		// string representation of function name
 } api_info_t;
 
@@ -0,0 +1,511 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cstdio>			// FILE, fopen, etc
+#include <cstdlib>			// calloc, qsort, etc
+#include <cstring>			// memset, strerror
+#include <cerrno>			// errno
+#include <ctime>			// time, strftime
+
+#include <extdll.h>			// always
+
+#include "api_prof.h"		// me
+#include "api_hook.h"		// get_api_info
+#include "metamod.h"		// Plugins, GameDLL, etc
+#include "mhooklist.h"		// NUM_*_HOOKS, MHookList::hook_id
+#include "mlist.h"			// Plugins, etc
+#include "mplugin.h"		// class MPlugin
+#include "support_meta.h"	// STRNCPY
+#include "log_meta.h"		// META_CONS, etc
+
+// Stats of one function called by the dispatcher.
+typedef struct prof_stat_s {
+	unsigned long long calls;
+	unsigned long long total_ns;
+	unsigned long long max_ns;
+	unsigned long long hist[PROF_BUCKETS];	// bucket i: 2^i to 2^(i+1)-1 ns
+} prof_stat_t;
+
+mBOOL prof_enabled = mFALSE;
+mBOOL prof_timing = mFALSE;
+
+// Stats of each api function are in slots: 0 for original function,
+// then pre and post of each plugin.
+// [slot * NUM_API_HOOKS + hook id], allocated on first enable and grown
+// as plugins with higher indexes are called; stats themselves are
+// allocated on first call.
+static prof_stat_t** prof_stats = nullptr;
+static unsigned int prof_slots = 0;
+
+static unsigned int DLLINTERNAL prof_slot(const int plugin_index, const int post) {
+	if (!plugin_index)
+		return 0;
+	return static_cast<unsigned int>(2 * plugin_index - 1 + (post ? 1 : 0));
+}
+
+// Make room for stats of given slot.
+static mBOOL DLLINTERNAL prof_grow(const unsigned int slot) {
+	unsigned int nslots = prof_slots ? prof_slots : 1 + 2 * 16;
+	while (nslots <= slot)
+		nslots *= 2;
+	prof_stat_t** nstats = static_cast<prof_stat_t**>(realloc(prof_stats, NUM_API_HOOKS * nslots * sizeof(prof_stat_t*)));
+	if (!nstats)
+		return mFALSE;
+	memset(nstats + NUM_API_HOOKS * prof_slots, 0, NUM_API_HOOKS * (nslots - prof_slots) * sizeof(prof_stat_t*));
+	prof_stats = nstats;
+	prof_slots = nslots;
+	return mTRUE;
+}
+
+static int DLLINTERNAL prof_bucket(unsigned long long ns) {
+	int b = 0;
+	while (ns > 1 && b < PROF_BUCKETS - 1) {
+		ns >>= 1;
+		b++;
+	}
+	return b;
+}
+
+// A timed hook call, kept for the frame watchdog.
+typedef struct rec_entry_s {
+	unsigned long long start;	// ns
+	unsigned int ns;			// duration, saturated
+	unsigned short hook_id;
+	int plugin_index;
+	int post;
+} rec_entry_t;
+
+static rec_entry_t* rec_ring = nullptr;		// last REC_SIZE calls
+static unsigned int rec_next = 0;			// total calls recorded
+
+static void DLLINTERNAL rec_add(const unsigned int hook_id, const int plugin_index, const int post, const unsigned long long start, const unsigned long long ns) {
+	rec_entry_t* entry = &rec_ring[rec_next++ & (REC_SIZE - 1)];
+	entry->start = start;
+	entry->ns = (ns < 0xffffffffULL) ? static_cast<unsigned int>(ns) : 0xffffffffU;
+	entry->hook_id = static_cast<unsigned short>(hook_id);
+	entry->plugin_index = plugin_index;
+	entry->post = post;
+}
+
+void DLLINTERNAL prof_record(const unsigned int hook_id, const int plugin_index, const int post, const unsigned long long start) {
+	const unsigned long long ns = get_monotonic_ns() - start;
+
+	if (rec_ring)
+		rec_add(hook_id, plugin_index, post, start, ns);
+	if (!prof_enabled || unlikely(!prof_stats || plugin_index < 0))
+		return;
+	const unsigned int slot = prof_slot(plugin_index, post);
+	if (unlikely(slot >= prof_slots) && !prof_grow(slot))
+		return;
+	prof_stat_t** pstat = &prof_stats[slot * NUM_API_HOOKS + hook_id];
+	if (unlikely(!*pstat)) {
+		*pstat = static_cast<prof_stat_t*>(calloc(1, sizeof(prof_stat_t)));
+		if (!*pstat)
+			return;
+	}
+	prof_stat_t* stat = *pstat;
+	stat->calls++;
+	stat->total_ns += ns;
+	if (ns > stat->max_ns)
+		stat->max_ns = ns;
+	stat->hist[prof_bucket(ns)]++;
+}
+
+// Turn profiler on or off; stats are kept until reset.
+mBOOL DLLINTERNAL prof_enable(const mBOOL enable) {
+	if (enable && !prof_stats) {
+		if (!prof_grow(prof_slot(Plugins ? Plugins->endlist : 0, 1))) {
+			META_ERROR("Failed to allocate hook profiler");
+			RETURN_ERRNO(mFALSE, ME_NOMEM);
+		}
+	}
+	prof_enabled = enable;
+	prof_timing = (prof_enabled || rec_ring) ? mTRUE : mFALSE;
+	return mTRUE;
+}
+
+// Clear stats.  Stats are zeroed rather than freed, as calls in progress
+// may still record into them.
+void DLLINTERNAL prof_reset() {
+	if (!prof_stats)
+		return;
+	for (unsigned int i = 0; i < NUM_API_HOOKS * prof_slots; i++) {
+		if (prof_stats[i])
+			memset(prof_stats[i], 0, sizeof(prof_stat_t));
+	}
+}
+
+// Api and function name of a hook id.
+static enum_api_t DLLINTERNAL prof_hook_api(const unsigned int hook_id, const char** name) {
+	enum_api_t api;
+	unsigned int fn = hook_id;
+
+	if (fn < NUM_ENGINE_HOOKS)
+		api = e_api_engine;
+	else if ((fn -= NUM_ENGINE_HOOKS) < NUM_DLLAPI_HOOKS)
+		api = e_api_dllapi;
+	else {
+		fn -= NUM_DLLAPI_HOOKS;
+		api = e_api_newapi;
+	}
+	*name = get_api_info(api, fn * static_cast<unsigned int>(sizeof(api_info_t)))->name;
+	if (!*name)
+		*name = "(unknown)";
+	return api;
+}
+
+// Name of plugin (1-based index) or engine/gamedll (index 0) owning a
+// function of given api.
+static const char* DLLINTERNAL prof_owner(const enum_api_t api, const int plugin_index, const mBOOL short_name) {
+	if (!plugin_index)
+		return (api == e_api_engine) ? "engine" : GameDLL.file;
+	if (plugin_index > Plugins->size)
+		return "(unloaded)";
+	const MPlugin* plug = Plugins->plist[plugin_index - 1];
+	if (plug->status < PL_VALID)
+		return "(unloaded)";
+	return short_name ? plug->desc : plug->file;
+}
+
+// Upper bound of latency below which given fraction of calls fall.
+static unsigned long long DLLINTERNAL prof_percentile(const prof_stat_t* stat, const double fraction) {
+	const double want = static_cast<double>(stat->calls) * fraction;
+	unsigned long long seen = 0;
+
+	for (int b = 0; b < PROF_BUCKETS; b++) {
+		seen += stat->hist[b];
+		if (static_cast<double>(seen) >= want)
+			return (b < PROF_BUCKETS - 1) ? (2ULL << b) : stat->max_ns;
+	}
+	return stat->max_ns;
+}
+
+static int prof_cmp_total(const void* a, const void* b) {
+	const prof_stat_t* sa = prof_stats[*static_cast<const unsigned int*>(a)];
+	const prof_stat_t* sb = prof_stats[*static_cast<const unsigned int*>(b)];
+	if (sa->total_ns == sb->total_ns)
+		return 0;
+	return (sa->total_ns < sb->total_ns) ? 1 : -1;
+}
+
+// List stats with most total time first.
+void DLLINTERNAL prof_show(const int max_lines) {
+	char bowner[18 + 1], bname[26 + 1];	// +1 for term null
+	unsigned int i, n = 0;
+
+	META_CONS("Hook profile (%s):", prof_enabled ? "running" : "stopped");
+	if (!prof_stats) {
+		META_CONS("No stats; use 'meta prof on' to start profiling");
+		return;
+	}
+
+	unsigned int* order = static_cast<unsigned int*>(malloc(NUM_API_HOOKS * prof_slots * sizeof(unsigned int)));
+	if (!order) {
+		META_CONS("Out of memory");
+		return;
+	}
+	for (i = 0; i < NUM_API_HOOKS * prof_slots; i++) {
+		if (prof_stats[i] && prof_stats[i]->calls)
+			order[n++] = i;
+	}
+	qsort(order, n, sizeof(order[0]), prof_cmp_total);
+
+	META_CONS("  %-*s  %-*s  %10s  %9s  %8s  %8s  %8s  %8s",
+		sizeof(bowner) - 1, "plugin",
+		sizeof(bname) - 1, "function",
+		"calls", "total ms", "mean us", "p50 us", "p99 us", "max us");
+	for (i = 0; i < n && i < static_cast<unsigned int>(max_lines); i++) {
+		const prof_stat_t* stat = prof_stats[order[i]];
+		const unsigned int slot = order[i] / NUM_API_HOOKS;
+		const char* name;
+		const enum_api_t api = prof_hook_api(order[i] % NUM_API_HOOKS, &name);
+
+		STRNCPY(bowner, prof_owner(api, static_cast<int>((slot + 1) / 2), mTRUE), sizeof(bowner));
+		safevoid_snprintf(bname, sizeof(bname), "%s%s", name, (slot && !(slot & 1)) ? "_Post" : "");
+		META_CONS("  %-*s  %-*s  %10llu  %9.2f  %8.2f  %8.2f  %8.2f  %8.2f",
+			sizeof(bowner) - 1, bowner,
+			sizeof(bname) - 1, bname,
+			stat->calls,
+			static_cast<double>(stat->total_ns) / 1e6,
+			static_cast<double>(stat->total_ns) / static_cast<double>(stat->calls) / 1e3,
+			static_cast<double>(prof_percentile(stat, 0.50)) / 1e3,
+			static_cast<double>(prof_percentile(stat, 0.99)) / 1e3,
+			static_cast<double>(stat->max_ns) / 1e3);
+	}
+	META_CONS("%u profiled functions, %u shown", n, (n < static_cast<unsigned int>(max_lines)) ? n : static_cast<unsigned int>(max_lines));
+	free(order);
+}
+
+// Write all stats, with full histograms, to a tab-separated file.
+// Relative paths are relative to the game directory.
+// meta_errno values:
+//  - ME_NOTFOUND	no stats, profiler never enabled
+//  - ME_NOFILE		couldn't open file
+mBOOL DLLINTERNAL prof_dump(const char* path) {
+	char fullpath[PATH_MAX];
+
+	if (!prof_stats)
+		RETURN_ERRNO(mFALSE, ME_NOTFOUND);
+	if (is_absolute_path(path))
+		STRNCPY(fullpath, path, sizeof(fullpath));
+	else
+		safevoid_snprintf(fullpath, sizeof(fullpath), "%s/%s", GameDLL.gamedir, path);
+
+	FILE* fp = fopen(fullpath, "w");
+	if (!fp) {
+		META_WARNING("Unable to open hook profile file '%s': %s", fullpath, strerror(errno));
+		RETURN_ERRNO(mFALSE, ME_NOFILE);
+	}
+	fprintf(fp, "# metamod hook profile; times in ns; hist[i] counts calls of 2^i to 2^(i+1)-1 ns\n");
+	fprintf(fp, "api\tfunction\towner\tphase\tcalls\ttotal_ns\tmax_ns\thist\n");
+	for (unsigned int i = 0; i < NUM_API_HOOKS * prof_slots; i++) {
+		const prof_stat_t* stat = prof_stats[i];
+		if (!stat || !stat->calls)
+			continue;
+		const unsigned int slot = i / NUM_API_HOOKS;
+		const char* name;
+		const enum_api_t api = prof_hook_api(i % NUM_API_HOOKS, &name);
+
+		fprintf(fp, "%s\t%s\t%s\t%s\t%llu\t%llu\t%llu\t",
+			(api == e_api_engine) ? "engine" : (api == e_api_dllapi) ? "dllapi" : "newapi",
+			name, prof_owner(api, static_cast<int>((slot + 1) / 2), mFALSE),
+			!slot ? "orig" : (slot & 1) ? "pre" : "post",
+			stat->calls, stat->total_ns, stat->max_ns);
+		for (int b = 0; b < PROF_BUCKETS; b++)
+			fprintf(fp, "%s%llu", b ? "," : "", stat->hist[b]);
+		fputc('\n', fp);
+	}
+	fclose(fp);
+	META_CONS("Wrote hook profile to %s", fullpath);
+	return mTRUE;
+}
+
+///// Frame watchdog:
+
+static unsigned long long frame_budget_ns = 0;
+static unsigned long long frame_start = 0;		// 0 if current frame isn't timed
+static unsigned long long last_hitch_dump = 0;
+static unsigned int num_hitches = 0;
+
+constexpr unsigned long long HITCH_DUMP_INTERVAL = 60ULL * 1000000000ULL;
+
+mBOOL DLLINTERNAL prof_set_frame_budget(const int ms) {
+	if (ms > 0 && !rec_ring) {
+		rec_ring = static_cast<rec_entry_t*>(calloc(REC_SIZE, sizeof(rec_entry_t)));
+		if (!rec_ring) {
+			META_ERROR("Failed to allocate frame watchdog");
+			RETURN_ERRNO(mFALSE, ME_NOMEM);
+		}
+	}
+	else if (ms <= 0 && rec_ring) {
+		free(rec_ring);
+		rec_ring = nullptr;
+	}
+	frame_budget_ns = (ms > 0) ? static_cast<unsigned long long>(ms) * 1000000ULL : 0;
+	frame_start = 0;
+	prof_timing = (prof_enabled || rec_ring) ? mTRUE : mFALSE;
+	return mTRUE;
+}
+
+void DLLINTERNAL prof_frame_reset() {
+	frame_start = 0;
+}
+
+static int DLLINTERNAL hitch_owner(const rec_entry_t* entry) {
+	if (entry->plugin_index)
+		return 1 + entry->plugin_index;
+	return (entry->hook_id < NUM_ENGINE_HOOKS) ? 0 : 1;
+}
+
+static const char* DLLINTERNAL hitch_owner_name(const int owner) {
+	if (owner < 2)
+		return owner ? GameDLL.file : "engine";
+	return prof_owner(e_api_engine, owner - 1, mTRUE);
+}
+
+static int hitch_cmp_start(const void* a, const void* b) {
+	const rec_entry_t* ea = static_cast<const rec_entry_t*>(a);
+	const rec_entry_t* eb = static_cast<const rec_entry_t*>(b);
+	if (ea->start != eb->start)
+		return (ea->start < eb->start) ? -1 : 1;
+	// outer call first
+	if (ea->ns != eb->ns)
+		return (ea->ns > eb->ns) ? -1 : 1;
+	return 0;
+}
+
+// Write hook calls of slow frame as a timeline.
+static void DLLINTERNAL hitch_dump(const rec_entry_t* calls, const int* depth, const unsigned int num, const unsigned long long* owner_ns, const int num_owners, const unsigned long long start, const unsigned long long ns, const mBOOL wrapped) {
+	char path[PATH_MAX], stamp[32];
+	const time_t now = time(nullptr);
+
+	strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+	safevoid_snprintf(path, sizeof(path), "%s/addons/metamod/hitch-%s.log", GameDLL.gamedir, stamp);
+	FILE* fp = fopen(path, "w");
+	if (!fp) {
+		META_WARNING("Unable to open slow frame log '%s': %s", path, strerror(errno));
+		return;
+	}
+	fprintf(fp, "Frame took %.3f ms (budget %.3f ms), %u hook calls%s\n\n",
+		static_cast<double>(ns) / 1e6, static_cast<double>(frame_budget_ns) / 1e6,
+		num, wrapped ? " (earliest calls lost)" : "");
+	fprintf(fp, "Time in hook calls, excluding nested calls:\n");
+	for (int i = 0; i < num_owners; i++) {
+		if (owner_ns[i])
+			fprintf(fp, "  %-32s %10.3f ms\n", hitch_owner_name(i), static_cast<double>(owner_ns[i]) / 1e6);
+	}
+	fprintf(fp, "\n      start ms     time ms  call\n");
+	for (unsigned int i = 0; i < num; i++) {
+		const char* name;
+		const enum_api_t api = prof_hook_api(calls[i].hook_id, &name);
+		fprintf(fp, "  %12.3f  %10.3f  %*s%s:%s%s\n",
+			static_cast<double>(calls[i].start - start) / 1e6,
+			static_cast<double>(calls[i].ns) / 1e6,
+			2 * depth[i], "",
+			prof_owner(api, calls[i].plugin_index, mFALSE), name,
+			calls[i].post ? "_Post" : "");
+	}
+	fclose(fp);
+	META_LOG("Wrote slow frame timeline to %s", path);
+}
+
+// Frame from start to end went over budget; find where the time went.
+static void DLLINTERNAL hitch(const unsigned long long start, const unsigned long long end) {
+	const unsigned long long ns = end - start;
+	unsigned int num = 0, i;
+
+	num_hitches++;
+
+	// calls of this frame, newest first in ring
+	const unsigned int avail = (rec_next < REC_SIZE) ? rec_next : REC_SIZE;
+	while (num < avail) {
+		const rec_entry_t* entry = &rec_ring[(rec_next - 1 - num) & (REC_SIZE - 1)];
+		if (entry->start < start)
+			break;
+		num++;
+	}
+	const mBOOL wrapped = (num == REC_SIZE) ? mTRUE : mFALSE;
+
+	rec_entry_t* calls = static_cast<rec_entry_t*>(malloc(num * sizeof(rec_entry_t) + 1));
+	int* depth = static_cast<int*>(malloc(num * sizeof(int) + 1));
+	unsigned int* stack = static_cast<unsigned int*>(malloc(num * sizeof(unsigned int) + 1));
+	if (!calls || !depth || !stack) {
+		META_LOG("Frame took %.1f ms (budget %.1f ms)", static_cast<double>(ns) / 1e6, static_cast<double>(frame_budget_ns) / 1e6);
+		free(calls);
+		free(depth);
+		free(stack);
+		return;
+	}
+	// Owners of time: engine, gamedll, then plugins.
+	int num_owners = 2;
+	for (i = 0; i < num; i++) {
+		calls[i] = rec_ring[(rec_next - num + i) & (REC_SIZE - 1)];
+		if (calls[i].plugin_index + 2 > num_owners)
+			num_owners = calls[i].plugin_index + 2;
+	}
+	qsort(calls, num, sizeof(calls[0]), hitch_cmp_start);
+
+	// Charge each call's time to its owner, minus time of calls nested in
+	// it; calls are nested if their time falls within the outer call.
+	unsigned long long* owner_ns = static_cast<unsigned long long*>(calloc(static_cast<size_t>(num_owners), sizeof(unsigned long long)));
+	if (!owner_ns) {
+		META_LOG("Frame took %.1f ms (budget %.1f ms)", static_cast<double>(ns) / 1e6, static_cast<double>(frame_budget_ns) / 1e6);
+		free(calls);
+		free(depth);
+		free(stack);
+		return;
+	}
+	unsigned long long hooked_ns = 0;
+	unsigned int top = 0;
+	for (i = 0; i < num; i++) {
+		while (top && calls[stack[top - 1]].start + calls[stack[top - 1]].ns <= calls[i].start)
+			top--;
+		if (top)
+			owner_ns[hitch_owner(&calls[stack[top - 1]])] -= calls[i].ns;
+		else
+			hooked_ns += calls[i].ns;
+		owner_ns[hitch_owner(&calls[i])] += calls[i].ns;
+		depth[i] = static_cast<int>(top);
+		stack[top++] = i;
+	}
+
+	// log the three biggest owners
+	char buf[256];
+	size_t len = 0;
+	int shown[3];
+	buf[0] = '\0';
+	for (int n = 0; n < 3; n++) {
+		int max = -1;
+		for (int o = 0; o < num_owners; o++) {
+			if (!owner_ns[o] || (n > 0 && o == shown[0]) || (n > 1 && o == shown[1]))
+				continue;
+			if (max < 0 || owner_ns[o] > owner_ns[max])
+				max = o;
+		}
+		if (max < 0)
+			break;
+		shown[n] = max;
+		safevoid_snprintf(buf + len, sizeof(buf) - len, "%s%s %.1f ms", n ? ", " : "",
+			hitch_owner_name(max), static_cast<double>(owner_ns[max]) / 1e6);
+		len = strlen(buf);
+	}
+	META_LOG("Frame took %.1f ms (budget %.1f ms): %s; outside hooks %.1f ms",
+		static_cast<double>(ns) / 1e6, static_cast<double>(frame_budget_ns) / 1e6,
+		len ? buf : "no hook calls", static_cast<double>(ns - (hooked_ns < ns ? hooked_ns : ns)) / 1e6);
+
+	if (!last_hitch_dump || end - last_hitch_dump >= HITCH_DUMP_INTERVAL) {
+		last_hitch_dump = end;
+		hitch_dump(calls, depth, num, owner_ns, num_owners, start, ns, wrapped);
+	}
+
+	free(owner_ns);
+	free(calls);
+	free(depth);
+	free(stack);
+}
+
+// Called at start of each server frame, ending the previous one.
+void DLLINTERNAL prof_frame() {
+	if (!rec_ring)
+		return;
+	const unsigned long long now = get_monotonic_ns();
+	if (frame_start && now - frame_start > frame_budget_ns)
+		hitch(frame_start, now);
+	frame_start = now;
+}
+
+void DLLINTERNAL prof_frame_show() {
+	if (!rec_ring) {
+		META_CONS("Frame watchdog is off (config.ini frame_budget)");
+		return;
+	}
+	META_CONS("Frame watchdog: budget %.1f ms, %u slow frames", static_cast<double>(frame_budget_ns) / 1e6, num_hitches);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef API_PROF_H
+#define API_PROF_H
+
+#include "types_meta.h"		// mBOOL
+#include "comp_dep.h"		// DLLINTERNAL, unlikely
+#include "osdep.h"			// get_monotonic_ns
+
+// Hook profiler.
+//
+// While enabled ("meta prof on"), the dispatcher times each call of a
+// plugin function and of the original function, keeping call counts,
+// total and max time and a histogram of latencies, bucketed by powers of
+// two nanoseconds.  Stats are kept per api function, separately for the
+// original function and for each plugin's pre and post function.  Times
+// include any hook calls nested in the timed call.
+
+//
+// Frame watchdog.
+//
+// With a frame budget set (config.ini "frame_budget"), the last
+// REC_SIZE timed hook calls are kept in a ring buffer, and each frame is
+// timed from one StartFrame to the next.  A frame over budget is logged
+// with the time spent in each plugin, and its hook calls are written as
+// a timeline to a file.
+
+constexpr int PROF_BUCKETS = 32;	// last bucket is ~2s and up
+constexpr unsigned int REC_SIZE = 4096;	// power of 2
+
+extern mBOOL prof_enabled DLLHIDDEN;	// profiler on
+extern mBOOL prof_timing DLLHIDDEN;		// profiler or frame watchdog on
+
+// Start timing a call; returns 0 if nothing needs timing.
+inline unsigned long long DLLINTERNAL prof_start() {
+	return unlikely(prof_timing) ? get_monotonic_ns() : 0;
+}
+
+// Record a timed call of a plugin function (1-based plugin index) or
+// of the original function (plugin index 0).
+void DLLINTERNAL prof_record(unsigned int hook_id, int plugin_index, int post, unsigned long long start);
+
+// End timing of a call started with prof_start().
+inline void DLLINTERNAL prof_end(const unsigned long long start, const unsigned int hook_id, const int plugin_index, const int post) {
+	if (unlikely(start))
+		prof_record(hook_id, plugin_index, post, start);
+}
+
+mBOOL DLLINTERNAL prof_enable(mBOOL enable);
+void DLLINTERNAL prof_reset();
+void DLLINTERNAL prof_show(int max_lines);
+mBOOL DLLINTERNAL prof_dump(const char* path);
+
+mBOOL DLLINTERNAL prof_set_frame_budget(int ms);	// 0 to disable
+void DLLINTERNAL prof_frame();			// start of server frame
+void DLLINTERNAL prof_frame_reset();	// don't time current frame
+void DLLINTERNAL prof_frame_show();
+
+#endif /* API_PROF_H */
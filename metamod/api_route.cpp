@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cstddef>			// offsetof
+#include <extdll.h>			// always
+
+#include "api_route.h"		// me
+#include "metamod.h"		// Config, GameDLL, Hooks, etc
+#include "engine_api.h"		// meta_engfuncs
+#include "meta_eiface.h"	// meta_enginefuncs_t, etc
+#include "mhooklist.h"		// MHookList, NUM_*_HOOKS
+#include "log_meta.h"		// META_DEBUG, etc
+#include "usermsg.h"		// umsg_num_hooks
+
+// Functions metamod itself has to see, routed whether hooked or not.
+static const unsigned int always_engine[] = {
+	offsetof(enginefuncs_t, pfnRegUserMsg),				// RegMsgs
+	offsetof(enginefuncs_t, pfnCVarSetFloat),			// meta_debug
+	offsetof(enginefuncs_t, pfnCVarSetString),
+	offsetof(enginefuncs_t, pfnCvar_DirectSet),
+	offsetof(enginefuncs_t, pfnQueryClientCvarValue),	// pointer checks
+	offsetof(enginefuncs_t, pfnQueryClientCvarValue2),
+	offsetof(enginefuncs_t, pfnEngCheckParm),
+};
+static const unsigned int always_dllapi[] = {
+	offsetof(DLL_FUNCTIONS, pfnClientConnect),			// cvarquery
+	offsetof(DLL_FUNCTIONS, pfnClientDisconnect),		// cvarquery, edictslot
+	offsetof(DLL_FUNCTIONS, pfnClientCommand),			// client_meta
+	offsetof(DLL_FUNCTIONS, pfnServerActivate),			// route_map_start, edictslot
+	offsetof(DLL_FUNCTIONS, pfnServerDeactivate),		// plugin refresh
+	offsetof(DLL_FUNCTIONS, pfnStartFrame),				// meta_debug, frame watchdog, cvarquery
+};
+static const unsigned int always_newapi[] = {
+	offsetof(NEW_DLL_FUNCTIONS, pfnCvarValue),			// cvarquery
+	offsetof(NEW_DLL_FUNCTIONS, pfnCvarValue2),
+	offsetof(NEW_DLL_FUNCTIONS, pfnOnFreeEntPrivateData),	// edictslot
+	offsetof(NEW_DLL_FUNCTIONS, pfnGameShutdown),			// log_async_stop, etc
+};
+
+// Message functions, routed while any whole message is hooked, so the
+// gamedll's messages reach usermsg.cpp.
+static const unsigned int umsg_engine[] = {
+	offsetof(enginefuncs_t, pfnMessageBegin),
+	offsetof(enginefuncs_t, pfnMessageEnd),
+	offsetof(enginefuncs_t, pfnWriteByte),
+	offsetof(enginefuncs_t, pfnWriteChar),
+	offsetof(enginefuncs_t, pfnWriteShort),
+	offsetof(enginefuncs_t, pfnWriteLong),
+	offsetof(enginefuncs_t, pfnWriteAngle),
+	offsetof(enginefuncs_t, pfnWriteCoord),
+	offsetof(enginefuncs_t, pfnWriteString),
+	offsetof(enginefuncs_t, pfnWriteEntity),
+};
+
+// Table given to gamedll with GiveFnptrsToDll.  Separate from
+// meta_engfuncs, which stays fully hooked as plugins get it from
+// GetHookTables.
+static meta_enginefuncs_t routed_engfuncs;
+static GIVE_ENGINE_FUNCTIONS_FN give_engfuncs = nullptr;
+
+// Engine's newapi table, and our routed copy of the full table; only the
+// part matching engine's version is copied to it.
+static NEW_DLL_FUNCTIONS* engine_newapi_table = nullptr;
+static meta_new_dll_functions_t routed_newapi;
+
+// Functions the current map's slowhooks profile routes, by hook id.
+static mBOOL route_all_map = mFALSE;
+static unsigned char route_map[NUM_API_HOOKS];
+
+// Should the given api function go through metamod's wrapper?
+static mBOOL DLLINTERNAL must_route(const enum_api_t api, const unsigned int func_offset, const void* orig, const unsigned int* always, const size_t num_always) {
+	// Missing original function is handled by the wrapper.
+	if (Config->slowhooks || route_all_map || !orig)
+		return mTRUE;
+	if (route_map[MHookList::hook_id(api, func_offset)])
+		return mTRUE;
+	if (Hooks->num_subs(api, func_offset))
+		return mTRUE;
+	for (size_t i = 0; i < num_always; i++) {
+		if (always[i] == func_offset)
+			return mTRUE;
+	}
+	if (api == e_api_engine && umsg_num_hooks) {
+		for (const unsigned int offset : umsg_engine) {
+			if (offset == func_offset)
+				return mTRUE;
+		}
+	}
+	return mFALSE;
+}
+
+// Point entries of a routed table either at metamod's wrapper (from
+// hooked) or at the original function.  Missing original table routes
+// everything.  With add_only, entries are only switched to the wrapper,
+// never back.  Returns number of changed entries.
+static int DLLINTERNAL route_table(void** routed, void* const* hooked, void* const* orig, const enum_api_t api, const unsigned int num_funcs, const unsigned int* always, const size_t num_always, const mBOOL add_only) {
+	int changed = 0;
+
+	for (unsigned int i = 0; i < num_funcs; i++) {
+		const unsigned int func_offset = static_cast<unsigned int>(i * sizeof(void*));
+		void* want;
+
+		if (!orig || must_route(api, func_offset, orig[i], always, num_always))
+			want = hooked[i];
+		else if (add_only)
+			continue;
+		else
+			want = orig[i];
+		if (routed[i] == want)
+			continue;
+		routed[i] = want;
+		changed++;
+	}
+	return changed;
+}
+
+static void DLLINTERNAL route_engine(const mBOOL add_only) {
+	// Not given to gamedll yet.
+	if (!give_engfuncs)
+		return;
+	const int changed = route_table((void**)&routed_engfuncs, (void* const*)&meta_engfuncs,
+		(void* const*)Engine.funcs, e_api_engine, NUM_ENGINE_HOOKS,
+		always_engine, sizeof(always_engine) / sizeof(always_engine[0]), add_only);
+	if (!changed)
+		return;
+	META_DEBUG(3, ("Rerouted %d engine functions; calling GiveFnptrsToDll", changed));
+	give_engfuncs(&routed_engfuncs, gpGlobals);
+}
+
+static void DLLINTERNAL route_dllapi() {
+	if (!g_engine_dll_funcs_table)
+		return;
+	const int changed = route_table((void**)g_engine_dll_funcs_table, (void* const*)g_pHookedDllFunctions,
+		(void* const*)GameDLL.funcs.dllapi_table, e_api_dllapi, NUM_DLLAPI_HOOKS,
+		always_dllapi, sizeof(always_dllapi) / sizeof(always_dllapi[0]), mFALSE);
+	if (changed)
+		META_DEBUG(3, ("Rerouted %d dllapi functions", changed));
+}
+
+static void DLLINTERNAL route_newapi(const mBOOL force_copy) {
+	if (!engine_newapi_table)
+		return;
+	const int changed = route_table((void**)&routed_newapi, (void* const*)g_pHookedNewDllFunctions,
+		(void* const*)GameDLL.funcs.newapi_table, e_api_newapi, NUM_NEWAPI_HOOKS,
+		always_newapi, sizeof(always_newapi) / sizeof(always_newapi[0]), mFALSE);
+	if (!changed && !force_copy)
+		return;
+	META_DEBUG(3, ("Rerouted %d newapi functions", changed));
+	routed_newapi.copy_to(engine_newapi_table);
+}
+
+// Gamedll is given the fully hooked table first; unhooked functions are
+// unrouted at first map start, by which time all plugins are loaded.
+void DLLINTERNAL route_give_engfuncs(GIVE_ENGINE_FUNCTIONS_FN pfn_give_engfuncs) {
+	give_engfuncs = pfn_give_engfuncs;
+	routed_engfuncs = meta_engfuncs;
+	give_engfuncs(&routed_engfuncs, gpGlobals);
+}
+
+void DLLINTERNAL route_set_dllapi_table(DLL_FUNCTIONS* pFunctionTable) {
+	g_engine_dll_funcs_table = pFunctionTable;
+	memcpy(g_engine_dll_funcs_table, g_pHookedDllFunctions, sizeof(DLL_FUNCTIONS));
+	route_dllapi();
+}
+
+void DLLINTERNAL route_set_newapi_table(NEW_DLL_FUNCTIONS* pNewFunctionTable) {
+	engine_newapi_table = pNewFunctionTable;
+	routed_newapi.set_from(g_pHookedNewDllFunctions);
+	route_newapi(mTRUE);
+}
+
+// The engine reads dllapi/newapi entries on every call, so those are
+// patched in place both ways.  Engine functions are only added here;
+// see route_map_start().
+void DLLINTERNAL route_update() {
+	route_dllapi();
+	route_newapi(mFALSE);
+	route_engine(mTRUE);
+}
+
+void DLLINTERNAL route_map_start(const hook_profile_t* profile) {
+	if (profile) {
+		route_all_map = profile->all;
+		memcpy(route_map, profile->route, sizeof(route_map));
+	}
+	else {
+		route_all_map = mFALSE;
+		memset(route_map, 0, sizeof(route_map));
+	}
+	route_dllapi();
+	route_newapi(mFALSE);
+	route_engine(mFALSE);
+}
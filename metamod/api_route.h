@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef API_ROUTE_H
+#define API_ROUTE_H
+
+#include <extdll.h>			// DLL_FUNCTIONS, etc
+
+#include "types_meta.h"		// mBOOL
+#include "h_export.h"		// GIVE_ENGINE_FUNCTIONS_FN
+#include "comp_dep.h"
+#include "hookprofile.h"	// hook_profile_t
+
+// Routing of api calls.
+//
+// Only the api functions that some running plugin hooks (or that metamod
+// itself needs to see) are routed through metamod's mm_* wrappers; all
+// other entries of the tables we give to the engine and the gamedll point
+// straight at the original function.  Routing is updated whenever the
+// plugin subscriber lists are rebuilt, and when the first whole-message
+// hook is added or the last one removed.
+//
+// The gamedll keeps its own copy of the engine function table, so a
+// changed engine routing has to be given to it again with
+// GiveFnptrsToDll.  To keep this rare, engine functions that are no longer
+// hooked are only unrouted at map start.
+
+// Give engine function table to gamedll, with all functions routed.
+void DLLINTERNAL route_give_engfuncs(GIVE_ENGINE_FUNCTIONS_FN pfn_give_engfuncs);
+
+// Engine's dllapi/newapi tables, as passed to GetEntityAPI2 and
+// GetNewDLLFunctions.
+void DLLINTERNAL route_set_dllapi_table(DLL_FUNCTIONS* pFunctionTable);
+void DLLINTERNAL route_set_newapi_table(NEW_DLL_FUNCTIONS* pNewFunctionTable);
+
+// Update routing after plugin subscriber lists changed.
+void DLLINTERNAL route_update();
+
+// Update routing at map start, also routing the functions named by the
+// map's slowhooks profile, if any.  Only entries that change are patched.
+void DLLINTERNAL route_map_start(const hook_profile_t* profile);
+
+#endif /* API_ROUTE_H */
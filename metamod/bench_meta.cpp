@@ -0,0 +1,538 @@
+// vi: set ts=4 sw=4 :
+// vim: set tw=75 :
+
+// bench_meta.cpp - standalone benchmark of hook dispatch and registry
+//                  lookups ("make bench")
+
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+// Not part of metamod.so.  Linked with metamod's objects into an
+// executable that plays both engine and gamedll, with synthetic plugins
+// hooking a few representative api functions:
+//
+//	metabench [calls]
+//
+// Prints one JSON object per line, with the average time per call in
+// nanoseconds, so results of two builds can be compared by script.  A few
+// checks of behaviour only this setup can reach are printed the same way;
+// it exits with 1 if any of them failed.
+
+#include <cstdio>			// printf, etc
+#include <cstdlib>			// strtol
+#include <cstring>			// memset
+#include <ctime>			// clock_gettime
+
+#include <extdll.h>			// always
+#include <entity_state.h>	// entity_state_t
+
+#include "metamod.h"		// Plugins, Hooks, GameDLL, etc
+#include "engine_api.h"		// meta_engfuncs
+#include "mhooklist.h"		// class MHookList
+#include "mlist.h"			// class MPluginList
+#include "mplugin.h"		// class MPlugin
+#include "mreg.h"			// class MRegCmdList, etc
+#include "api_prof.h"		// prof_enable
+#include "usermsg.h"		// umsg_hook
+#include "api_route.h"		// route_give_engfuncs, etc
+
+// Result pre functions of synthetic plugins return for the current case.
+static META_RES bench_mres = MRES_IGNORED;
+
+static edict_t bench_edict;
+static entity_state_t bench_state;
+static TraceResult bench_trace;
+static const float bench_vec[3] = { 0, 0, 0 };
+static char bench_model[] = "models/bench.mdl";
+
+// Plugins in the list, as with a busy server.
+constexpr int BENCH_PLUGINS = 50;
+static plugin_info_t bench_infos[BENCH_PLUGINS];
+
+///// "engine":
+
+static void eng_AlertMessage(ALERT_TYPE, const char*, ...) {}
+static void eng_ServerPrint(const char* szMsg) { fputs(szMsg, stderr); }
+static float eng_CVarGetFloat(const char*) { return 0.0f; }
+static cvar_t eng_developer = { "developer", "0", 0, 0.0f, nullptr };
+static cvar_t* eng_CVarGetPointer(const char*) { return &eng_developer; }
+static int eng_PrecacheModel(char*) { return 1; }
+static void eng_TraceLine(const float*, const float*, int, edict_t*, TraceResult*) {}
+static void eng_MessageBegin(int, int, const float*, edict_t*) {}
+static void eng_MessageEnd() {}
+static void eng_WriteByte(int) {}
+static void eng_WriteShort(int) {}
+
+///// "gamedll":
+
+static void game_PlayerPreThink(edict_t*) {}
+static int game_AddToFullPack(entity_state_t*, int, edict_t*, edict_t*, int, int, unsigned char*) { return 1; }
+
+///// synthetic plugins; all share these tables:
+
+static int plug_PrecacheModel(char*) {
+	PublicMetaGlobals.mres = bench_mres;
+	return 2;
+}
+static int plug_PrecacheModel_Post(char*) {
+	PublicMetaGlobals.mres = MRES_IGNORED;
+	return 0;
+}
+static void plug_TraceLine(const float*, const float*, int, edict_t*, TraceResult*) {
+	PublicMetaGlobals.mres = bench_mres;
+}
+static void plug_TraceLine_Post(const float*, const float*, int, edict_t*, TraceResult*) {
+	PublicMetaGlobals.mres = MRES_IGNORED;
+}
+static void plug_PlayerPreThink(edict_t*) {
+	PublicMetaGlobals.mres = bench_mres;
+}
+static void plug_PlayerPreThink_Post(edict_t*) {
+	PublicMetaGlobals.mres = MRES_IGNORED;
+}
+static int plug_AddToFullPack(entity_state_t*, int, edict_t*, edict_t*, int, int, unsigned char*) {
+	PublicMetaGlobals.mres = bench_mres;
+	return 0;
+}
+static void plug_MessageBegin(int, int, const float*, edict_t*) {
+	PublicMetaGlobals.mres = MRES_IGNORED;
+}
+static void plug_MessageEnd() {
+	PublicMetaGlobals.mres = MRES_IGNORED;
+}
+static void plug_WriteByte(int) {
+	PublicMetaGlobals.mres = MRES_IGNORED;
+}
+static void plug_WriteShort(int) {
+	PublicMetaGlobals.mres = MRES_IGNORED;
+}
+static int plug_UserMsg(usermsg_t*) {
+	return MRES_IGNORED;
+}
+static int plug_AddToFullPack_Post(entity_state_t*, int, edict_t*, edict_t*, int, int, unsigned char*) {
+	PublicMetaGlobals.mres = MRES_IGNORED;
+	return 0;
+}
+
+static enginefuncs_t bench_engine;
+static DLL_FUNCTIONS bench_dllapi;
+static enginefuncs_t plug_engine, plug_engine_post;
+static DLL_FUNCTIONS plug_dllapi, plug_dllapi_post;
+
+// Calls measured; each makes one api call through metamod.
+static void call_PrecacheModel() { meta_engfuncs.pfnPrecacheModel(bench_model); }
+static void call_TraceLine() { meta_engfuncs.pfnTraceLine(bench_vec, bench_vec, 0, &bench_edict, &bench_trace); }
+static void call_PlayerPreThink() { g_pHookedDllFunctions->pfnPlayerPreThink(&bench_edict); }
+static void call_AddToFullPack() { g_pHookedDllFunctions->pfnAddToFullPack(&bench_state, 1, &bench_edict, &bench_edict, 0, 1, nullptr); }
+
+// Same calls without metamod, for reference.
+static void orig_PrecacheModel() { bench_engine.pfnPrecacheModel(bench_model); }
+static void orig_TraceLine() { bench_engine.pfnTraceLine(bench_vec, bench_vec, 0, &bench_edict, &bench_trace); }
+static void orig_PlayerPreThink() { bench_dllapi.pfnPlayerPreThink(&bench_edict); }
+static void orig_AddToFullPack() { bench_dllapi.pfnAddToFullPack(&bench_state, 1, &bench_edict, &bench_edict, 0, 1, nullptr); }
+
+typedef void (*bench_fn_t)();
+
+typedef struct bench_hook_s {
+	const char* name;
+	bench_fn_t call;
+	bench_fn_t orig;
+	mBOOL returns;			// OVERRIDE is meaningful
+} bench_hook_t;
+
+static const bench_hook_t bench_hooks[] = {
+	{ "engine.PrecacheModel",	call_PrecacheModel,		orig_PrecacheModel,		mTRUE },
+	{ "engine.TraceLine",		call_TraceLine,			orig_TraceLine,			mFALSE },
+	{ "dllapi.PlayerPreThink",	call_PlayerPreThink,	orig_PlayerPreThink,	mFALSE },
+	{ "dllapi.AddToFullPack",	call_AddToFullPack,		orig_AddToFullPack,		mTRUE },
+};
+
+static long bench_calls = 1000000;
+
+static double now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<double>(ts.tv_sec) * 1e9 + static_cast<double>(ts.tv_nsec);
+}
+
+// Average time of one call of fn, in nanoseconds.
+static double bench_run(const bench_fn_t fn) {
+	long i;
+	for (i = 0; i < bench_calls / 10; i++)
+		fn();
+	const double start = now_ns();
+	for (i = 0; i < bench_calls; i++)
+		fn();
+	return (now_ns() - start) / static_cast<double>(bench_calls);
+}
+
+// Make the first num plugins run, with pre (and post) functions.
+static void bench_plugins(const int num, const mBOOL post) {
+	for (int i = 0; i < BENCH_PLUGINS; i++) {
+		MPlugin* iplug = Plugins->plist[i];
+		iplug->status = (i < num) ? PL_RUNNING : PL_VALID;
+		iplug->tables.engine = &plug_engine;
+		iplug->tables.dllapi = &plug_dllapi;
+		iplug->post_tables.engine = post ? &plug_engine_post : nullptr;
+		iplug->post_tables.dllapi = post ? &plug_dllapi_post : nullptr;
+	}
+	Hooks->rebuild();
+}
+
+static void bench_setup() {
+	int i;
+
+	bench_engine.pfnAlertMessage = eng_AlertMessage;
+	bench_engine.pfnServerPrint = eng_ServerPrint;
+	bench_engine.pfnCVarGetFloat = eng_CVarGetFloat;
+	bench_engine.pfnCVarGetPointer = eng_CVarGetPointer;
+	bench_engine.pfnPrecacheModel = eng_PrecacheModel;
+	bench_engine.pfnTraceLine = eng_TraceLine;
+	bench_engine.pfnMessageBegin = eng_MessageBegin;
+	bench_engine.pfnMessageEnd = eng_MessageEnd;
+	bench_engine.pfnWriteByte = eng_WriteByte;
+	bench_engine.pfnWriteShort = eng_WriteShort;
+	g_engfuncs.initialise_interface(&bench_engine);
+	Engine.funcs = &g_engfuncs;
+
+	bench_dllapi.pfnPlayerPreThink = game_PlayerPreThink;
+	bench_dllapi.pfnAddToFullPack = game_AddToFullPack;
+	GameDLL.file = "bench";
+	GameDLL.funcs.dllapi_table = &bench_dllapi;
+
+	plug_engine.pfnPrecacheModel = plug_PrecacheModel;
+	plug_engine.pfnTraceLine = plug_TraceLine;
+	plug_engine_post.pfnPrecacheModel = plug_PrecacheModel_Post;
+	plug_engine_post.pfnTraceLine = plug_TraceLine_Post;
+	plug_dllapi.pfnPlayerPreThink = plug_PlayerPreThink;
+	plug_dllapi.pfnAddToFullPack = plug_AddToFullPack;
+	plug_dllapi_post.pfnPlayerPreThink = plug_PlayerPreThink_Post;
+	plug_dllapi_post.pfnAddToFullPack = plug_AddToFullPack_Post;
+
+	Plugins = new MPluginList("");
+	Hooks = new MHookList();
+	RegCmds = new MRegCmdList();
+	RegMsgs = new MRegMsgList();
+
+	Plugins->grow(BENCH_PLUGINS);
+	for (i = 0; i < BENCH_PLUGINS; i++) {
+		MPlugin* iplug = Plugins->plist[i];
+		snprintf(iplug->filename, sizeof(iplug->filename), "dlls/bench_plugin_%d_i386.so", i + 1);
+		iplug->file = iplug->filename + 5;
+		snprintf(iplug->pathname, sizeof(iplug->pathname), "/hlds/bench/dlls/bench_plugin_%d_i386.so", i + 1);
+		snprintf(iplug->desc, sizeof(iplug->desc), "Bench plugin %d", i + 1);
+		bench_infos[i].name = iplug->desc;
+		bench_infos[i].logtag = "BENCH";
+		iplug->info = &bench_infos[i];
+		iplug->status = PL_VALID;
+	}
+	Plugins->endlist = BENCH_PLUGINS;
+}
+
+static void bench_dispatch() {
+	static const int num_subs[] = { 1, 5, 20 };
+	static const struct {
+		META_RES mres;
+		const char* name;
+	} results[] = {
+		{ MRES_IGNORED, "ignored" },
+		{ MRES_SUPERCEDE, "supercede" },
+		{ MRES_OVERRIDE, "override" },
+	};
+
+	for (const bench_hook_t& hook : bench_hooks) {
+		printf("{\"bench\":\"%s\",\"subs\":\"unrouted\",\"ns\":%.2f,\"calls\":%ld}\n",
+			hook.name, bench_run(hook.orig), bench_calls);
+
+		bench_mres = MRES_IGNORED;
+		bench_plugins(0, mFALSE);
+		printf("{\"bench\":\"%s\",\"subs\":0,\"ns\":%.2f,\"calls\":%ld}\n",
+			hook.name, bench_run(hook.call), bench_calls);
+
+		// profiler overhead
+		bench_plugins(5, mTRUE);
+		prof_enable(mTRUE);
+		printf("{\"bench\":\"%s\",\"subs\":5,\"post\":true,\"result\":\"ignored\",\"prof\":true,\"ns\":%.2f,\"calls\":%ld}\n",
+			hook.name, bench_run(hook.call), bench_calls);
+		prof_enable(mFALSE);
+
+		for (const int num : num_subs) {
+			for (int post = 0; post < 2; post++) {
+				bench_plugins(num, post ? mTRUE : mFALSE);
+				for (const auto& result : results) {
+					if (result.mres == MRES_OVERRIDE && !hook.returns)
+						continue;
+					bench_mres = result.mres;
+					printf("{\"bench\":\"%s\",\"subs\":%d,\"post\":%s,\"result\":\"%s\",\"ns\":%.2f,\"calls\":%ld}\n",
+						hook.name, num, post ? "true" : "false", result.name,
+						bench_run(hook.call), bench_calls);
+				}
+			}
+		}
+	}
+	bench_plugins(0, mFALSE);
+}
+
+// A ScoreInfo-like message: 5 writes.
+constexpr int BENCH_MSG = 85;
+static int bench_msg_type = BENCH_MSG;
+
+static void call_message() {
+	meta_engfuncs.pfnMessageBegin(MSG_ALL, bench_msg_type, nullptr, nullptr);
+	meta_engfuncs.pfnWriteByte(1);
+	meta_engfuncs.pfnWriteShort(10);
+	meta_engfuncs.pfnWriteShort(2);
+	meta_engfuncs.pfnWriteShort(0);
+	meta_engfuncs.pfnWriteShort(1);
+	meta_engfuncs.pfnMessageEnd();
+}
+
+static void bench_usermsg() {
+	printf("{\"bench\":\"usermsg\",\"hooks\":\"none\",\"ns\":%.2f,\"calls\":%ld}\n",
+		bench_run(call_message), bench_calls);
+
+	// plugin hooking message functions, each called through dispatcher
+	plug_engine.pfnMessageBegin = plug_MessageBegin;
+	plug_engine.pfnMessageEnd = plug_MessageEnd;
+	plug_engine.pfnWriteByte = plug_WriteByte;
+	plug_engine.pfnWriteShort = plug_WriteShort;
+	bench_plugins(1, mFALSE);
+	printf("{\"bench\":\"usermsg\",\"hooks\":\"write\",\"ns\":%.2f,\"calls\":%ld}\n",
+		bench_run(call_message), bench_calls);
+	plug_engine.pfnMessageBegin = nullptr;
+	plug_engine.pfnMessageEnd = nullptr;
+	plug_engine.pfnWriteByte = nullptr;
+	plug_engine.pfnWriteShort = nullptr;
+
+	// plugin hooking whole message
+	bench_plugins(1, mFALSE);
+	umsg_hook(1, BENCH_MSG, plug_UserMsg);
+	printf("{\"bench\":\"usermsg\",\"hooks\":\"whole\",\"ns\":%.2f,\"calls\":%ld}\n",
+		bench_run(call_message), bench_calls);
+	bench_msg_type = BENCH_MSG + 1;
+	printf("{\"bench\":\"usermsg\",\"hooks\":\"whole\",\"msg\":\"other\",\"ns\":%.2f,\"calls\":%ld}\n",
+		bench_run(call_message), bench_calls);
+	bench_msg_type = BENCH_MSG;
+	umsg_unhook(1, BENCH_MSG, plug_UserMsg);
+	bench_plugins(0, mFALSE);
+}
+
+// Engine table as the gamedll has it.
+static enginefuncs_t* given_engfuncs = nullptr;
+static void give_engfuncs(enginefuncs_t* pengfuncs, globalvars_t*) { given_engfuncs = pengfuncs; }
+
+static int check_msgs = 0;
+static int check_UserMsg(usermsg_t*) {
+	check_msgs++;
+	return MRES_SUPERCEDE;
+}
+
+// A whole-message hook must see the gamedll's messages even when no
+// plugin hooks the message functions themselves.  Returns number of
+// failed checks.
+static int check_usermsg_routing() {
+	int failed = 0;
+
+	bench_plugins(1, mFALSE);
+	route_give_engfuncs(give_engfuncs);
+	route_map_start(nullptr);
+	if (given_engfuncs->pfnMessageBegin != bench_engine.pfnMessageBegin)
+		failed++;
+
+	umsg_hook(1, BENCH_MSG, check_UserMsg);
+	if (given_engfuncs->pfnMessageBegin == bench_engine.pfnMessageBegin
+		|| given_engfuncs->pfnWriteShort == bench_engine.pfnWriteShort)
+		failed++;
+	given_engfuncs->pfnMessageBegin(MSG_ALL, BENCH_MSG, nullptr, nullptr);
+	given_engfuncs->pfnWriteByte(1);
+	given_engfuncs->pfnWriteShort(10);
+	given_engfuncs->pfnMessageEnd();
+	if (check_msgs != 1)
+		failed++;
+
+	umsg_unhook(1, BENCH_MSG, check_UserMsg);
+	route_map_start(nullptr);
+	if (given_engfuncs->pfnMessageBegin != bench_engine.pfnMessageBegin)
+		failed++;
+	bench_plugins(0, mFALSE);
+
+	printf("{\"check\":\"usermsg routing\",\"failed\":%d}\n", failed);
+	return failed;
+}
+
+static int check_once_calls = 0;
+static int check_count_calls = 0;
+static int check_adder_calls = 0;
+
+static int check_Count(usermsg_t*) {
+	check_count_calls++;
+	return MRES_IGNORED;
+}
+// one-shot hook
+static int check_Once(usermsg_t*) {
+	check_once_calls++;
+	umsg_unhook(1, BENCH_MSG, check_Once);
+	return MRES_IGNORED;
+}
+// hooks another plugin's hook, ahead of its own
+static int check_Adder(usermsg_t*) {
+	check_adder_calls++;
+	umsg_hook(1, BENCH_MSG, check_Count);
+	return MRES_IGNORED;
+}
+
+static void check_send() {
+	meta_engfuncs.pfnMessageBegin(MSG_ALL, BENCH_MSG, nullptr, nullptr);
+	meta_engfuncs.pfnWriteByte(1);
+	meta_engfuncs.pfnMessageEnd();
+}
+
+// Hooks unhooking themselves, or hooking, while a message is given to
+// hooks mustn't make other hooks be skipped or called twice.  Returns
+// number of failed checks.
+static int check_usermsg_hook_changes() {
+	int failed = 0;
+
+	bench_plugins(2, mFALSE);
+	umsg_hook(1, BENCH_MSG, check_Once);
+	umsg_hook(2, BENCH_MSG, check_Count);
+	check_send();
+	check_send();
+	if (check_once_calls != 1 || check_count_calls != 2)
+		failed++;
+	umsg_unhook(2, BENCH_MSG, check_Count);
+
+	check_count_calls = 0;
+	umsg_hook(2, BENCH_MSG, check_Adder);
+	check_send();
+	if (check_adder_calls != 1 || check_count_calls != 0)
+		failed++;
+	check_send();
+	if (check_adder_calls != 2 || check_count_calls != 1)
+		failed++;
+	umsg_unhook_plugin(1);
+	umsg_unhook_plugin(2);
+	if (umsg_num_hooks)
+		failed++;
+	bench_plugins(0, mFALSE);
+
+	printf("{\"check\":\"usermsg hook changes\",\"failed\":%d}\n", failed);
+	return failed;
+}
+
+static char bench_long[2 * MAX_STRBUF_LEN];
+
+static void call_alert_console() { meta_engfuncs.pfnAlertMessage(at_console, "%s: %d entities, %.2f\n", "bench", 42, 1.5); }
+static void call_alert_logged() { meta_engfuncs.pfnAlertMessage(at_logged, "%s: %d entities, %.2f\n", "bench", 42, 1.5); }
+static void call_alert_long() { meta_engfuncs.pfnAlertMessage(at_logged, "%s\n", bench_long); }
+
+// Varargs functions, which metamod formats.
+static void bench_varargs() {
+	memset(bench_long, 'x', sizeof(bench_long) - 1);
+	printf("{\"bench\":\"engine.AlertMessage\",\"type\":\"console\",\"ns\":%.2f,\"calls\":%ld}\n",
+		bench_run(call_alert_console), bench_calls);
+	printf("{\"bench\":\"engine.AlertMessage\",\"type\":\"logged\",\"ns\":%.2f,\"calls\":%ld}\n",
+		bench_run(call_alert_logged), bench_calls);
+	printf("{\"bench\":\"engine.AlertMessage\",\"type\":\"logged\",\"len\":%d,\"ns\":%.2f,\"calls\":%ld}\n",
+		static_cast<int>(sizeof(bench_long) - 1), bench_run(call_alert_long), bench_calls);
+}
+
+static const char* find_name;
+static int find_msgid;
+
+static void find_cmd() { RegCmds->find(find_name); }
+static void find_msg_name() { RegMsgs->find(find_name); }
+static void find_msg_id() { RegMsgs->find(find_msgid); }
+static void find_plugin() { Plugins->find_match(find_name); }
+static void find_plugin_path() { Plugins->find(find_name); }
+static void find_plugin_plid() { Plugins->find(static_cast<plid_t>(&bench_infos[BENCH_PLUGINS - 1])); }
+static void valid_ptr() { IS_VALID_PTR(reinterpret_cast<const void*>(find_cmd)); }
+
+static void bench_registry() {
+	static char cmd_names[100][32];
+	static char msg_names[100][32];
+	const int num_cmds = sizeof(cmd_names) / sizeof(cmd_names[0]);
+	const int num_msgs = sizeof(msg_names) / sizeof(msg_names[0]);
+	int i;
+
+	for (i = 0; i < num_cmds; i++) {
+		snprintf(cmd_names[i], sizeof(cmd_names[i]), "bench_cmd_%d", i);
+		MRegCmd* icmd = RegCmds->add(cmd_names[i]);
+		if (icmd)
+			RegCmds->enable(icmd, nullptr, 0);
+	}
+	for (i = 0; i < num_msgs; i++) {
+		snprintf(msg_names[i], sizeof(msg_names[i]), "BenchMsg%d", i);
+		RegMsgs->add(msg_names[i], 64 + i, -1);
+	}
+
+	// last entries, ie worst case of a list search
+	find_name = cmd_names[num_cmds - 1];
+	printf("{\"bench\":\"MRegCmdList::find\",\"entries\":%d,\"ns\":%.2f,\"calls\":%ld}\n",
+		num_cmds, bench_run(find_cmd), bench_calls);
+	find_name = msg_names[num_msgs - 1];
+	printf("{\"bench\":\"MRegMsgList::find(name)\",\"entries\":%d,\"ns\":%.2f,\"calls\":%ld}\n",
+		num_msgs, bench_run(find_msg_name), bench_calls);
+	find_msgid = 64 + num_msgs - 1;
+	printf("{\"bench\":\"MRegMsgList::find(msgid)\",\"entries\":%d,\"ns\":%.2f,\"calls\":%ld}\n",
+		num_msgs, bench_run(find_msg_id), bench_calls);
+	find_name = "bench_plugin_50";
+	printf("{\"bench\":\"MPluginList::find_match\",\"entries\":%d,\"ns\":%.2f,\"calls\":%ld}\n",
+		BENCH_PLUGINS, bench_run(find_plugin), bench_calls);
+	find_name = "bench_plugin_50_i386.so";
+	printf("{\"bench\":\"MPluginList::find_match\",\"type\":\"file\",\"entries\":%d,\"ns\":%.2f,\"calls\":%ld}\n",
+		BENCH_PLUGINS, bench_run(find_plugin), bench_calls);
+	find_name = Plugins->plist[BENCH_PLUGINS - 1]->pathname;
+	printf("{\"bench\":\"MPluginList::find(path)\",\"entries\":%d,\"ns\":%.2f,\"calls\":%ld}\n",
+		BENCH_PLUGINS, bench_run(find_plugin_path), bench_calls);
+	printf("{\"bench\":\"MPluginList::find(plid)\",\"entries\":%d,\"ns\":%.2f,\"calls\":%ld}\n",
+		BENCH_PLUGINS, bench_run(find_plugin_plid), bench_calls);
+	printf("{\"bench\":\"IS_VALID_PTR\",\"ns\":%.2f,\"calls\":%ld}\n",
+		bench_run(valid_ptr), bench_calls);
+}
+
+int main(int argc, char** argv) {
+	if (argc > 1) {
+		bench_calls = strtol(argv[1], nullptr, 10);
+		if (bench_calls <= 0) {
+			fprintf(stderr, "usage: %s [calls]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	bench_setup();
+	bench_dispatch();
+	bench_usermsg();
+	const int failed = check_usermsg_routing() + check_usermsg_hook_changes();
+	bench_varargs();
+	bench_registry();
+	return failed ? 1 : 0;
+}
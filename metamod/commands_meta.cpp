@@ -36,7 +36,7 @@
  *
  */
 
-#include <cstdlib>		// strtol()
+#include <cstdlib>		// strtol(), atoi()
 
 #include <extdll.h>		// always
 
@@ -45,6 +45,12 @@
 #include "log_meta.h"		// META_CONS, etc
 #include "info_name.h"		// VNAME, etc
 #include "vdate.h"			// COMPILE_TIME, COMPILE_TZONE
+#include "api_prof.h"		// prof_enable, etc
+#include "usermsg.h"		// umsg_show
+#include "diag_meta.h"		// diag_show, etc
+#include "cvarwatch.h"		// cvarwatch_show
+#include "cvarquery.h"		// cvarquery_show
+#include "filewatch.h"		// filewatch_modified, etc
 
 #ifdef META_PERFMON
 
@@ -91,12 +97,16 @@ void DLLHIDDEN svr_meta() {
 		cmd_meta_gpl();
 	else if (!strcasecmp(cmd, "refresh"))
 		cmd_meta_refresh();
+	else if (!strcasecmp(cmd, "pending"))
+		cmd_meta_pending();
 	else if (!strcasecmp(cmd, "list"))
 		cmd_meta_pluginlist();
 	else if (!strcasecmp(cmd, "cmds"))
 		cmd_meta_cmdlist();
 	else if (!strcasecmp(cmd, "cvars"))
 		cmd_meta_cvarlist();
+	else if (!strcasecmp(cmd, "hooks"))
+		cmd_meta_hooklist();
 	else if (!strcasecmp(cmd, "game"))
 		cmd_meta_game();
 	else if (!strcasecmp(cmd, "config"))
@@ -123,6 +133,11 @@ void DLLHIDDEN svr_meta() {
 	// arguments: filename, description
 	else if (!strcasecmp(cmd, "load"))
 		cmd_meta_load();
+	// arguments: subcommand
+	else if (!strcasecmp(cmd, "prof"))
+		cmd_meta_prof();
+	else if (!strcasecmp(cmd, "diag"))
+		cmd_meta_diag();
 #ifdef META_PERFMON
 	else if (!strcasecmp(cmd, "tsc"))
 		cmd_meta_tsc();
@@ -166,7 +181,11 @@ void DLLINTERNAL cmd_meta_usage() {
 	META_CONS("   list             - list plugins currently loaded");
 	META_CONS("   cmds             - list console cmds registered by plugins");
 	META_CONS("   cvars            - list cvars registered by plugins");
+	META_CONS("   hooks            - list api functions hooked by plugins");
+	META_CONS("   prof <cmd>       - profile hook calls (on, off, show, reset, dump)");
+	META_CONS("   diag [reset]     - list counts of repeated warnings");
 	META_CONS("   refresh          - load/unload any new/deleted/updated plugins");
+	META_CONS("   pending          - list plugin changes waiting for the next map");
 	META_CONS("   config           - show config info loaded from config.ini");
 	META_CONS("   load <name>      - find and load a plugin with the given name");
 	META_CONS("   unload <plugin>  - unload a loaded plugin");
@@ -284,6 +303,28 @@ void DLLINTERNAL cmd_meta_refresh() {
 	}
 }
 
+// "meta pending" console command.
+void DLLINTERNAL cmd_meta_pending() {
+	if (CMD_ARGC() != 2) {
+		META_CONS("usage: meta pending");
+		return;
+	}
+	META_CONS("Pending at next map change:");
+	int n = Plugins->show_pending();
+	if (Config->loaded_file()) {
+		char path[PATH_MAX];
+		full_gamedir_path(Config->loaded_file(), path);
+		if (filewatch_modified(path)) {
+			META_CONS("  %s changed since startup; restart to apply", Config->loaded_file());
+			n++;
+		}
+	}
+	if (filewatch_running())
+		META_CONS("%d pending changes; watching %d files", n, filewatch_num());
+	else
+		META_CONS("%d pending changes; file watcher not running", n);
+}
+
 // "meta list" console command.
 void DLLINTERNAL cmd_meta_pluginlist() {
 	if (CMD_ARGC() != 2) {
@@ -318,6 +359,74 @@ void DLLINTERNAL cmd_meta_cvarlist() {
 		return;
 	}
 	RegCvars->show();
+	cvarwatch_show();
+	cvarquery_show();
+}
+
+// "meta hooks" console command.
+void DLLINTERNAL cmd_meta_hooklist() {
+	if (CMD_ARGC() != 2) {
+		META_CONS("usage: meta hooks");
+		return;
+	}
+	Hooks->show();
+	umsg_show();
+}
+
+// "meta prof" console command.
+void DLLINTERNAL cmd_meta_prof() {
+	const char* cmd = CMD_ARGV(2);
+
+	if (CMD_ARGC() == 3 && !strcasecmp(cmd, "on")) {
+		if (prof_enable(mTRUE))
+			META_CONS("Hook profiler started");
+	}
+	else if (CMD_ARGC() == 3 && !strcasecmp(cmd, "off")) {
+		prof_enable(mFALSE);
+		META_CONS("Hook profiler stopped");
+	}
+	else if (CMD_ARGC() == 3 && !strcasecmp(cmd, "reset")) {
+		prof_reset();
+		META_CONS("Hook profile cleared");
+	}
+	else if ((CMD_ARGC() == 3 || CMD_ARGC() == 4) && !strcasecmp(cmd, "show")) {
+		int lines = 20;
+		if (CMD_ARGC() == 4)
+			lines = atoi(CMD_ARGV(3));
+		prof_show(lines > 0 ? lines : 20);
+	}
+	else if (CMD_ARGC() == 4 && !strcasecmp(cmd, "dump")) {
+		if (!prof_dump(CMD_ARGV(3)) && meta_errno == ME_NOTFOUND)
+			META_CONS("No stats; use 'meta prof on' to start profiling");
+	}
+	else if ((CMD_ARGC() == 3 || CMD_ARGC() == 4) && !strcasecmp(cmd, "frame")) {
+		if (CMD_ARGC() == 4)
+			prof_set_frame_budget(atoi(CMD_ARGV(3)));
+		prof_frame_show();
+	}
+	else {
+		META_CONS("usage: meta prof <command>");
+		META_CONS("   on               - start profiling hook calls");
+		META_CONS("   off              - stop profiling, keeping stats");
+		META_CONS("   show [<count>]   - show functions taking most time (default 20)");
+		META_CONS("   reset            - clear stats");
+		META_CONS("   dump <file>      - write all stats, with histograms, to file");
+		META_CONS("   frame [<ms>]     - show or set frame budget for slow frame logging (0 = off)");
+		META_CONS("Profiler is %s", prof_enabled ? "running" : "stopped");
+		prof_frame_show();
+	}
+}
+
+// "meta diag" console command.
+void DLLINTERNAL cmd_meta_diag() {
+	if (CMD_ARGC() == 2)
+		diag_show();
+	else if (CMD_ARGC() == 3 && !strcasecmp(CMD_ARGV(2), "reset")) {
+		diag_reset();
+		META_CONS("Warning counts cleared");
+	}
+	else
+		META_CONS("usage: meta diag [reset]");
 }
 
 // "meta config" console command.
@@ -67,11 +67,15 @@ void DLLINTERNAL cmd_meta_gpl();
 
 void DLLINTERNAL cmd_meta_game();
 void DLLINTERNAL cmd_meta_refresh();
+void DLLINTERNAL cmd_meta_pending();
 void DLLINTERNAL cmd_meta_load();
 
 void DLLINTERNAL cmd_meta_pluginlist();
 void DLLINTERNAL cmd_meta_cmdlist();
 void DLLINTERNAL cmd_meta_cvarlist();
+void DLLINTERNAL cmd_meta_hooklist();
+void DLLINTERNAL cmd_meta_prof();
+void DLLINTERNAL cmd_meta_diag();
 void DLLINTERNAL cmd_meta_config();
 
 void DLLINTERNAL cmd_doplug(PLUG_CMD pcmd);
@@ -49,7 +49,8 @@
 MConfig::MConfig()
 	: list(nullptr), filename(nullptr), debuglevel(0), gamedll(nullptr),
 	plugins_file(nullptr), exec_cfg(nullptr), autodetect(0), clientmeta(0),
-	slowhooks(0), slowhooks_whitelist(nullptr)
+	slowhooks(0), slowhooks_whitelist(nullptr), frame_budget(0), async_log(0),
+	diag_interval(0), watch_files(0), stage_reload(0)
 {
 }
 
@@ -95,13 +95,19 @@ public:
 	char* exec_cfg;		// ie metaexec.cfg, exec.cfg
 	int autodetect;		// autodetection of gamedll (Metamod-All-Support patch)
 	int clientmeta;         // control 'meta' client-command
-	int slowhooks;         // disable expensive hooks if 0 -w00tguy
+	int slowhooks;         // route all api functions, not only hooked ones
 	char* slowhooks_whitelist;	// slowhooks.ini
+	int frame_budget;		// ms; longer frames are logged, 0 to disable
+	int async_log;			// log to own files from a writer thread
+	int diag_interval;		// seconds between repeated warning summaries
+	int watch_files;		// watch plugins.ini, etc from a thread
+	int stage_reload;		// open updated plugin files before changelevel
 	// functions
 	void DLLINTERNAL init(option_t* global_options);
 	mBOOL DLLINTERNAL load(const char* filename);
 	mBOOL DLLINTERNAL set(const char* key, const char* value) const;
 	void DLLINTERNAL show() const;
+	const char* DLLINTERNAL loaded_file() const { return filename; }	// null if none
 };
 
 #endif /* CONF_META_H */
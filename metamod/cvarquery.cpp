@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#include <cstdlib>			// realloc, free
+#include <cstring>			// strlen, strdup
+
+#include <extdll.h>			// always
+
+#include "cvarquery.h"		// me
+#include "metamod.h"		// Plugins
+#include "mlist.h"			// class MPluginList
+#include "mplugin.h"		// class MPlugin
+#include "sdk_util.h"		// ENTINDEX
+#include "support_meta.h"	// strcasematch, STRNCPY
+#include "osdep.h"			// IS_VALID_PTR
+#include "log_meta.h"		// META_CONS, etc
+
+// Clients the engine allows at most.
+constexpr int CVARQUERY_MAX_CLIENTS = 32;
+// Distinct cvars tracked per client.
+constexpr int CVARQUERY_MAX_CVARS = 64;
+// Queries outstanding per client at once.
+constexpr int CVARQUERY_MAX_SENT = 4;
+// Seconds to wait for a client's answer.
+constexpr float CVARQUERY_TIMEOUT = 5.0f;
+// Request ids of our own queries; MAKE_REQUESTID gives 0x4111xxxx.
+constexpr int CVARQUERY_ID_BASE = 0x4d4d0000;
+constexpr int CVARQUERY_ID_MASK = 0xffff;
+
+typedef enum : uint8_t {
+	CQ_IDLE = 0,		// nothing to send
+	CQ_SCHEDULED,		// to be sent
+	CQ_SENT,			// waiting for answer
+} cvarquery_state_t;
+
+// A cvar of a client, with its last answer.
+typedef struct cvarquery_entry_s {
+	char name[64];
+	cvarquery_state_t state;
+	int request_id;
+	mBOOL timed_out;		// request_id's answer may still come
+	float sent_time;
+	char* value;			// nullptr if no answer
+	float answer_time;
+} cvarquery_entry_t;
+
+typedef struct cvarquery_client_s {
+	const edict_t* player;
+	cvarquery_entry_t* entries;
+	int num_entries;
+	int size_entries;
+	int num_sent;
+	mBOOL legacy_set;		// plugin's own QueryClientCvarValue
+	char legacy[64];
+} cvarquery_client_t;
+
+// A plugin's request for a cvar of a client.
+typedef struct cvarquery_waiter_s {
+	int plugin_index;
+	int client;
+	int entry;
+	CVAR_QUERY_FN pfn;		// nullptr once called, or removed during delivery
+	mBOOL ready;			// entry has the value to give
+} cvarquery_waiter_t;
+
+static cvarquery_client_t clients[CVARQUERY_MAX_CLIENTS + 1];
+static cvarquery_waiter_t* waiters = nullptr;
+static int waiter_size = 0;
+int cvarquery_num = 0;
+static int cvarquery_delivering = 0;
+static mBOOL cvarquery_removed = mFALSE;	// removed during delivery
+static int cvarquery_serial = 0;
+
+static int DLLINTERNAL client_index(const edict_t* player) {
+	if (!player)
+		return 0;
+	const int indx = ENTINDEX(player);
+	if (indx < 1 || indx > CVARQUERY_MAX_CLIENTS || indx > gpGlobals->maxClients)
+		return 0;
+	return indx;
+}
+
+// Engine didn't change version when QueryClientCvarValue2 was added, so
+// check the pointer once, as engine_api does.
+static mBOOL DLLINTERNAL engine_can_query() {
+	static mBOOL s_check = mFALSE;
+
+	if (!s_check && g_engfuncs.pfnQueryClientCvarValue2 &&
+		!IS_VALID_PTR((void*)g_engfuncs.pfnQueryClientCvarValue2)) {
+		g_engfuncs.pfnQueryClientCvarValue2 = nullptr;
+		s_check = mTRUE;
+	}
+	return g_engfuncs.pfnQueryClientCvarValue2 ? mTRUE : mFALSE;
+}
+
+// Drop requests removed while callbacks were being called.
+static void DLLINTERNAL cvarquery_compact() {
+	int n = 0;
+	for (int i = 0; i < cvarquery_num; i++) {
+		if (waiters[i].pfn)
+			waiters[n++] = waiters[i];
+	}
+	cvarquery_num = n;
+}
+
+static void DLLINTERNAL waiter_free(cvarquery_waiter_t* waiter) {
+	if (cvarquery_delivering) {
+		waiter->pfn = nullptr;
+		cvarquery_removed = mTRUE;
+		return;
+	}
+	memmove(waiter, waiter + 1, static_cast<size_t>(waiters + cvarquery_num - waiter - 1) * sizeof(cvarquery_waiter_t));
+	cvarquery_num--;
+}
+
+static void DLLINTERNAL waiters_ready(const int client, const int entry) {
+	for (int i = 0; i < cvarquery_num; i++) {
+		cvarquery_waiter_t* waiter = &waiters[i];
+		if (waiter->client == client && waiter->entry == entry)
+			waiter->ready = mTRUE;
+	}
+}
+
+static mBOOL DLLINTERNAL waiters_for(const int client, const int entry) {
+	for (int i = 0; i < cvarquery_num; i++) {
+		const cvarquery_waiter_t* waiter = &waiters[i];
+		if (waiter->pfn && waiter->client == client && waiter->entry == entry)
+			return mTRUE;
+	}
+	return mFALSE;
+}
+
+// Call the ready requests of a client, or of all clients if 0.  Requests
+// of paused plugins stay until the plugin is unpaused.
+static void DLLINTERNAL cvarquery_deliver(const int client) {
+	cvarquery_delivering++;
+	// callbacks may add requests, which are called next frame
+	const int num = cvarquery_num;
+	for (int i = 0; i < num; i++) {
+		cvarquery_waiter_t* waiter = &waiters[i];
+		if (!waiter->ready || !waiter->pfn || (client && waiter->client != client))
+			continue;
+		const MPlugin* plug = Plugins->find(waiter->plugin_index);
+		if (plug && plug->status == PL_PAUSED)
+			continue;
+		const CVAR_QUERY_FN pfn = waiter->pfn;
+		waiter->pfn = nullptr;
+		cvarquery_removed = mTRUE;
+		if (!plug || plug->status != PL_RUNNING)
+			continue;
+		const cvarquery_client_t* cl = &clients[waiter->client];
+		const cvarquery_entry_t* entry = &cl->entries[waiter->entry];
+		// callback may add cvars, moving the entry
+		char name[sizeof(entry->name)];
+		STRNCPY(name, entry->name, sizeof(name));
+		META_DEBUG(6, ("Client %d cvar '%s' is '%s'; calling plugin '%s'",
+			waiter->client, name, entry->value ? entry->value : "(none)", plug->desc));
+		pfn(cl->player, name, entry->value);
+	}
+	cvarquery_delivering--;
+	if (!cvarquery_delivering && cvarquery_removed) {
+		cvarquery_compact();
+		cvarquery_removed = mFALSE;
+	}
+}
+
+// Give up on a query; its requests get a null value.
+static void DLLINTERNAL entry_fail(const int client, const int entry) {
+	cvarquery_client_t* cl = &clients[client];
+	cvarquery_entry_t* ent = &cl->entries[entry];
+	if (ent->state == CQ_SENT)
+		cl->num_sent--;
+	ent->state = CQ_IDLE;
+	free(ent->value);
+	ent->value = nullptr;
+	waiters_ready(client, entry);
+}
+
+static void DLLINTERNAL entry_send(const int client, const int entry) {
+	cvarquery_client_t* cl = &clients[client];
+	cvarquery_entry_t* ent = &cl->entries[entry];
+	if (!engine_can_query()) {
+		entry_fail(client, entry);
+		return;
+	}
+	cvarquery_serial = (cvarquery_serial + 1) & CVARQUERY_ID_MASK;
+	const int request_id = CVARQUERY_ID_BASE | cvarquery_serial;
+	ent->state = CQ_SENT;
+	ent->request_id = request_id;
+	ent->timed_out = mFALSE;
+	ent->sent_time = gpGlobals->time;
+	cl->num_sent++;
+	// engine answers for bots right away, and the callbacks may move the
+	// entry
+	char name[sizeof(ent->name)];
+	STRNCPY(name, ent->name, sizeof(name));
+	META_DEBUG(6, ("Querying client %d cvar '%s', request id %#x", client, name, request_id));
+	(*g_engfuncs.pfnQueryClientCvarValue2)(cl->player, name, request_id);
+}
+
+// Time out unanswered queries, send one scheduled query per client, and
+// call the requests that have their value.
+void DLLINTERNAL cvarquery_run() {
+	const float now = gpGlobals->time;
+
+	for (int client = 1; client <= CVARQUERY_MAX_CLIENTS; client++) {
+		cvarquery_client_t* cl = &clients[client];
+		for (int i = 0; i < cl->num_entries; i++) {
+			cvarquery_entry_t* ent = &cl->entries[i];
+			// time going backwards means a new map
+			if (ent->state == CQ_SENT && (now - ent->sent_time > CVARQUERY_TIMEOUT || now < ent->sent_time)) {
+				META_DEBUG(5, ("Client %d didn't answer query of cvar '%s'", client, ent->name));
+				ent->timed_out = mTRUE;
+				entry_fail(client, i);
+			}
+		}
+		if (cl->num_sent >= CVARQUERY_MAX_SENT)
+			continue;
+		for (int i = 0; i < cl->num_entries; i++) {
+			cvarquery_entry_t* ent = &cl->entries[i];
+			if (ent->state != CQ_SCHEDULED)
+				continue;
+			// requests may have been cancelled
+			if (!waiters_for(client, i)) {
+				ent->state = CQ_IDLE;
+				continue;
+			}
+			entry_send(client, i);
+			break;
+		}
+	}
+	cvarquery_deliver(0);
+}
+
+static int DLLINTERNAL entry_find(const cvarquery_client_t* cl, const char* name) {
+	for (int i = 0; i < cl->num_entries; i++) {
+		if (strcasematch(cl->entries[i].name, name))
+			return i;
+	}
+	return -1;
+}
+
+// Request a client's cvar for a plugin, using an answer no older than
+// max_age seconds if there is one; returns 0 or meta_errno value.
+int DLLINTERNAL cvarquery_request(const int plugin_index, const edict_t* player, const char* name, const float max_age, const CVAR_QUERY_FN pfn) {
+	if (!name || !*name || !pfn || strlen(name) >= sizeof(cvarquery_entry_t::name))
+		return ME_ARGUMENT;
+	const int client = client_index(player);
+	if (!client)
+		return ME_NOTFOUND;
+
+	cvarquery_client_t* cl = &clients[client];
+	int entry = entry_find(cl, name);
+	if (entry >= 0) {
+		for (int i = 0; i < cvarquery_num; i++) {
+			const cvarquery_waiter_t* waiter = &waiters[i];
+			if (waiter->pfn && waiter->plugin_index == plugin_index && waiter->client == client
+				&& waiter->entry == entry && waiter->pfn == pfn)
+				return ME_ALREADY;
+		}
+	}
+	if (cvarquery_num == waiter_size) {
+		const int size = waiter_size ? waiter_size * 2 : 16;
+		cvarquery_waiter_t* temp = static_cast<cvarquery_waiter_t*>(realloc(waiters, static_cast<size_t>(size) * sizeof(cvarquery_waiter_t)));
+		if (!temp)
+			return ME_NOMEM;
+		waiters = temp;
+		waiter_size = size;
+	}
+	if (entry < 0) {
+		if (cl->num_entries == CVARQUERY_MAX_CVARS)
+			return ME_MAXREACHED;
+		if (cl->num_entries == cl->size_entries) {
+			const int size = cl->size_entries ? cl->size_entries * 2 : 4;
+			cvarquery_entry_t* temp = static_cast<cvarquery_entry_t*>(realloc(cl->entries, static_cast<size_t>(size) * sizeof(cvarquery_entry_t)));
+			if (!temp)
+				return ME_NOMEM;
+			cl->entries = temp;
+			cl->size_entries = size;
+		}
+		entry = cl->num_entries++;
+		cvarquery_entry_t* ent = &cl->entries[entry];
+		memset(ent, 0, sizeof(*ent));
+		STRNCPY(ent->name, name, sizeof(ent->name));
+		ent->state = CQ_IDLE;
+	}
+	cl->player = player;
+
+	cvarquery_entry_t* ent = &cl->entries[entry];
+	mBOOL ready = mFALSE;
+	if (ent->value && gpGlobals->time - ent->answer_time <= max_age)
+		ready = mTRUE;
+	else if (ent->state == CQ_IDLE)
+		ent->state = CQ_SCHEDULED;
+
+	cvarquery_waiter_t* waiter = &waiters[cvarquery_num++];
+	waiter->plugin_index = plugin_index;
+	waiter->client = client;
+	waiter->entry = entry;
+	waiter->pfn = pfn;
+	waiter->ready = ready;
+	return 0;
+}
+
+// Cancel a plugin's request; returns 0 or meta_errno value.
+int DLLINTERNAL cvarquery_cancel(const int plugin_index, const edict_t* player, const char* name, const CVAR_QUERY_FN pfn) {
+	const int client = client_index(player);
+	if (!client || !name)
+		return ME_NOTFOUND;
+	const int entry = entry_find(&clients[client], name);
+	for (int i = 0; entry >= 0 && i < cvarquery_num; i++) {
+		cvarquery_waiter_t* waiter = &waiters[i];
+		if (waiter->pfn && waiter->plugin_index == plugin_index && waiter->client == client
+			&& waiter->entry == entry && waiter->pfn == pfn) {
+			waiter_free(waiter);
+			return 0;
+		}
+	}
+	return ME_NOTFOUND;
+}
+
+// Answer from the engine's CvarValue2.  Returns mTRUE if it answers one
+// of our queries still waiting, or one that timed out, so the answer
+// isn't passed on to plugins or gamedll.  Anything else is passed on, as
+// plugins and gamedll may pick any request ids.
+mBOOL DLLINTERNAL cvarquery_answer(const edict_t* player, const int request_id, const char* name, const char* value) {
+	if ((request_id & ~CVARQUERY_ID_MASK) != CVARQUERY_ID_BASE)
+		return mFALSE;
+	const int client = client_index(player);
+	if (!client)
+		return mFALSE;
+
+	cvarquery_client_t* cl = &clients[client];
+	for (int i = 0; i < cl->num_entries; i++) {
+		cvarquery_entry_t* ent = &cl->entries[i];
+		if (ent->request_id != request_id || (name && !strcasematch(name, ent->name)))
+			continue;
+		if (ent->state != CQ_SENT) {
+			if (!ent->timed_out)
+				continue;
+			// too late; requests already got a null value
+			META_DEBUG(6, ("Client %d answered cvar '%s' after timeout", client, ent->name));
+			ent->timed_out = mFALSE;
+			return mTRUE;
+		}
+		META_DEBUG(6, ("Client %d answered cvar '%s' is '%s'", client, ent->name, value ? value : ""));
+		free(ent->value);
+		ent->value = strdup(value ? value : "");
+		ent->answer_time = gpGlobals->time;
+		ent->state = CQ_IDLE;
+		cl->num_sent--;
+		waiters_ready(client, i);
+		cvarquery_deliver(client);
+		return mTRUE;
+	}
+	return mFALSE;
+}
+
+// Forget a client's cvars when it connects or leaves; its pending
+// requests get a null value.
+static void DLLINTERNAL reset_client(const int client) {
+	cvarquery_client_t* cl = &clients[client];
+	cl->legacy_set = mFALSE;
+	cl->legacy[0] = '\0';
+	if (!cl->num_entries)
+		return;
+	for (int i = 0; i < cl->num_entries; i++) {
+		cvarquery_entry_t* ent = &cl->entries[i];
+		free(ent->value);
+		ent->value = nullptr;
+		ent->state = CQ_IDLE;
+		waiters_ready(client, i);
+	}
+	cvarquery_deliver(client);
+	// requests of paused plugins
+	for (int i = cvarquery_num - 1; i >= 0; i--) {
+		if (waiters[i].client == client && waiters[i].pfn)
+			waiter_free(&waiters[i]);
+	}
+	cl->num_entries = 0;
+	cl->num_sent = 0;
+}
+
+void DLLINTERNAL cvarquery_reset_client(const edict_t* player) {
+	const int client = client_index(player);
+	if (client)
+		reset_client(client);
+}
+
+void DLLINTERNAL cvarquery_reset_all() {
+	for (int client = 1; client <= CVARQUERY_MAX_CLIENTS; client++)
+		reset_client(client);
+}
+
+// Remove all requests of a plugin being unloaded.
+void DLLINTERNAL cvarquery_remove_plugin(const int plugin_index) {
+	for (int i = cvarquery_num - 1; i >= 0; i--) {
+		if (waiters[i].plugin_index == plugin_index && waiters[i].pfn)
+			waiter_free(&waiters[i]);
+	}
+}
+
+// List client cvar queries to console.
+void DLLINTERNAL cvarquery_show() {
+	static const char* const state_names[] = { "idle", "scheduled", "sent" };
+	mBOOL header = mFALSE;
+
+	for (int client = 1; client <= CVARQUERY_MAX_CLIENTS; client++) {
+		const cvarquery_client_t* cl = &clients[client];
+		for (int i = 0; i < cl->num_entries; i++) {
+			const cvarquery_entry_t* ent = &cl->entries[i];
+			int num = 0;
+			for (int j = 0; j < cvarquery_num; j++) {
+				if (waiters[j].pfn && waiters[j].client == client && waiters[j].entry == i)
+					num++;
+			}
+			if (!header) {
+				META_CONS("Client cvar queries:");
+				META_CONS("  %-6s %-20s %-9s %-7s %s", "client", "cvar", "state", "waiting", "value");
+				header = mTRUE;
+			}
+			META_CONS("  %-6d %-20s %-9s %-7d %s", client, ent->name, state_names[ent->state], num,
+				ent->value ? ent->value : "-");
+		}
+	}
+}
+
+// Mark a client as queried by a plugin's own QueryClientCvarValue.
+void DLLINTERNAL cvarquery_legacy_set(const edict_t* player, const char* name) {
+	const int client = client_index(player);
+	if (!client || !name)
+		return;
+	clients[client].legacy_set = mTRUE;
+	STRNCPY(clients[client].legacy, name, sizeof(clients[client].legacy));
+}
+
+void DLLINTERNAL cvarquery_legacy_clear(const edict_t* player) {
+	const int client = client_index(player);
+	if (client)
+		clients[client].legacy_set = mFALSE;
+}
+
+// Name of the cvar a client is queried for by QueryClientCvarValue, or
+// nullptr if none.
+// meta_errno values:
+//  - ME_NOTFOUND  invalid entity
+const char* DLLINTERNAL cvarquery_legacy(const edict_t* player) {
+	const int client = client_index(player);
+	if (!client)
+		RETURN_ERRNO(nullptr, ME_NOTFOUND);
+	return clients[client].legacy_set ? clients[client].legacy : nullptr;
+}
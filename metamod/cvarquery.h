@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef CVARQUERY_H
+#define CVARQUERY_H
+
+#include <extdll.h>			// edict_t, etc
+
+#include "types_meta.h"		// mBOOL
+#include "comp_dep.h"		// DLLINTERNAL, unlikely
+#include "mutil.h"			// CVAR_QUERY_FN
+
+// Client cvar queries.
+//
+// Plugins ask for a client's cvar with QUERY_CLIENT_CVAR instead of
+// calling QueryClientCvarValue themselves.  Requests for the same cvar of
+// the same client share one QueryClientCvarValue2, sent with a request id
+// of metamod's own; the answer is kept for later requests willing to take
+// a value of that age, and is given only to the plugins that asked for
+// it, rather than to every plugin hooking CvarValue2.  Queries are sent
+// from StartFrame, one per client a frame at most, and only a few are
+// outstanding per client at once.
+
+extern int cvarquery_num DLLHIDDEN;		// number of waiting requests
+
+void DLLINTERNAL cvarquery_run();
+
+// Called every frame.
+inline void DLLINTERNAL cvarquery_frame() {
+	if (unlikely(cvarquery_num))
+		cvarquery_run();
+}
+
+int DLLINTERNAL cvarquery_request(int plugin_index, const edict_t* player, const char* name, float max_age, CVAR_QUERY_FN pfn);
+int DLLINTERNAL cvarquery_cancel(int plugin_index, const edict_t* player, const char* name, CVAR_QUERY_FN pfn);
+mBOOL DLLINTERNAL cvarquery_answer(const edict_t* player, int request_id, const char* name, const char* value);
+void DLLINTERNAL cvarquery_reset_client(const edict_t* player);
+void DLLINTERNAL cvarquery_reset_all();
+void DLLINTERNAL cvarquery_remove_plugin(int plugin_index);
+void DLLINTERNAL cvarquery_show();
+
+// Plugins' own QueryClientCvarValue calls, for IS_QUERYING_CLIENT_CVAR.
+void DLLINTERNAL cvarquery_legacy_set(const edict_t* player, const char* name);
+void DLLINTERNAL cvarquery_legacy_clear(const edict_t* player);
+const char* DLLINTERNAL cvarquery_legacy(const edict_t* player);
+
+#endif /* CVARQUERY_H */
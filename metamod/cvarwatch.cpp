@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cstdlib>			// realloc, free
+#include <cstring>			// strcmp, strdup
+
+#include <extdll.h>			// always
+
+#include "cvarwatch.h"		// me
+#include "metamod.h"		// Plugins
+#include "mlist.h"			// class MPluginList
+#include "mplugin.h"		// class MPlugin
+#include "log_meta.h"		// META_CONS, etc
+
+// A plugin's watch of a cvar.
+typedef struct cvarwatch_s {
+	int plugin_index;
+	cvar_t* cvar;
+	CVAR_CHANGE_FN pfn;		// nullptr if removed during a check
+	float value;			// last seen value and string
+	char* string;
+} cvarwatch_t;
+
+// Watches, in plugin order.
+static cvarwatch_t* cvarwatches = nullptr;
+static int cvarwatch_size = 0;
+int cvarwatch_num = 0;
+static mBOOL cvarwatch_checking = mFALSE;
+static mBOOL cvarwatch_removed = mFALSE;	// removed during a check
+
+// Values are compared by bits, so a cvar set to "nan" doesn't look
+// changed every frame.
+static inline bool same_value(const float a, const float b) {
+	return !memcmp(&a, &b, sizeof(a));
+}
+
+// Drop watches removed while callbacks were being called.
+static void DLLINTERNAL cvarwatch_compact() {
+	int n = 0;
+	for (int i = 0; i < cvarwatch_num; i++) {
+		if (cvarwatches[i].pfn)
+			cvarwatches[n++] = cvarwatches[i];
+		else
+			free(cvarwatches[i].string);
+	}
+	cvarwatch_num = n;
+}
+
+static void DLLINTERNAL cvarwatch_free(cvarwatch_t* watch) {
+	if (cvarwatch_checking) {
+		watch->pfn = nullptr;
+		cvarwatch_removed = mTRUE;
+		return;
+	}
+	free(watch->string);
+	memmove(watch, watch + 1, static_cast<size_t>(cvarwatches + cvarwatch_num - watch - 1) * sizeof(cvarwatch_t));
+	cvarwatch_num--;
+}
+
+// Compare watched cvars to their last seen values, and call the callbacks
+// of those that changed.  Watches of paused plugins keep their last seen
+// values, so the plugin hears of the change when unpaused.
+void DLLINTERNAL cvarwatch_check() {
+	if (cvarwatch_checking)
+		return;
+	cvarwatch_checking = mTRUE;
+	// callbacks may add watches, which are checked next frame
+	const int num = cvarwatch_num;
+	for (int i = 0; i < num; i++) {
+		cvarwatch_t* watch = &cvarwatches[i];
+		const cvar_t* cvar = watch->cvar;
+		const char* string = cvar->string ? cvar->string : "";
+		if (likely(same_value(cvar->value, watch->value) && !strcmp(string, watch->string)) || !watch->pfn)
+			continue;
+		const MPlugin* plug = Plugins->find(watch->plugin_index);
+		if (!plug || plug->status != PL_RUNNING)
+			continue;
+		char* copy = strdup(string);
+		if (!copy)
+			continue;
+		char* old_string = watch->string;
+		watch->value = cvar->value;
+		watch->string = copy;
+		META_DEBUG(5, ("Cvar '%s' changed from '%s' to '%s'; calling watch of plugin '%s'",
+			cvar->name, old_string, copy, plug->desc));
+		watch->pfn(watch->cvar, old_string);
+		// callback may have added watches, moving the list
+		free(old_string);
+	}
+	cvarwatch_checking = mFALSE;
+	if (cvarwatch_removed) {
+		cvarwatch_compact();
+		cvarwatch_removed = mFALSE;
+	}
+}
+
+// Resolve a cvar by name to its engine cvar, which stays at the same
+// place for the rest of the run.
+cvar_t* DLLINTERNAL cvar_handle(const char* name) {
+	if (!name || !g_engfuncs.pfnCVarGetPointer)
+		return nullptr;
+	return CVAR_GET_POINTER(name);
+}
+
+// Engine's "developer" cvar, looked up once; nullptr if not yet
+// available.
+const cvar_t* DLLINTERNAL developer_cvar() {
+	static const cvar_t* developer = nullptr;
+
+	if (unlikely(!developer))
+		developer = cvar_handle("developer");
+	return developer;
+}
+
+// Watch a cvar for a plugin; returns 0 or meta_errno value.
+int DLLINTERNAL cvarwatch_add(const int plugin_index, cvar_t* cvar, const CVAR_CHANGE_FN pfn) {
+	if (!cvar || !pfn)
+		return ME_ARGUMENT;
+
+	int i;
+	for (i = 0; i < cvarwatch_num; i++) {
+		const cvarwatch_t* watch = &cvarwatches[i];
+		if (watch->plugin_index == plugin_index && watch->cvar == cvar && watch->pfn == pfn)
+			return ME_ALREADY;
+	}
+	if (cvarwatch_num == cvarwatch_size) {
+		const int size = cvarwatch_size ? cvarwatch_size * 2 : 16;
+		cvarwatch_t* temp = static_cast<cvarwatch_t*>(realloc(cvarwatches, static_cast<size_t>(size) * sizeof(cvarwatch_t)));
+		if (!temp)
+			return ME_NOMEM;
+		cvarwatches = temp;
+		cvarwatch_size = size;
+	}
+	char* string = strdup(cvar->string ? cvar->string : "");
+	if (!string)
+		return ME_NOMEM;
+	// after other watches of same or lower plugin index; during a check,
+	// the list can't be reordered, so just at the end
+	i = cvarwatch_num;
+	if (!cvarwatch_checking) {
+		for (; i > 0 && cvarwatches[i - 1].plugin_index > plugin_index; i--)
+			cvarwatches[i] = cvarwatches[i - 1];
+	}
+	cvarwatch_t* watch = &cvarwatches[i];
+	watch->plugin_index = plugin_index;
+	watch->cvar = cvar;
+	watch->pfn = pfn;
+	watch->value = cvar->value;
+	watch->string = string;
+	cvarwatch_num++;
+	return 0;
+}
+
+// Remove a plugin's watch of a cvar; returns 0 or meta_errno value.
+int DLLINTERNAL cvarwatch_remove(const int plugin_index, const cvar_t* cvar, const CVAR_CHANGE_FN pfn) {
+	for (int i = 0; i < cvarwatch_num; i++) {
+		cvarwatch_t* watch = &cvarwatches[i];
+		if (watch->plugin_index == plugin_index && watch->cvar == cvar && watch->pfn == pfn) {
+			cvarwatch_free(watch);
+			return 0;
+		}
+	}
+	return ME_NOTFOUND;
+}
+
+// Remove all watches of a plugin being unloaded.
+void DLLINTERNAL cvarwatch_remove_plugin(const int plugin_index) {
+	for (int i = cvarwatch_num - 1; i >= 0; i--) {
+		if (cvarwatches[i].plugin_index == plugin_index && cvarwatches[i].pfn)
+			cvarwatch_free(&cvarwatches[i]);
+	}
+}
+
+// List watched cvars to console.
+void DLLINTERNAL cvarwatch_show() {
+	if (!cvarwatch_num)
+		return;
+	META_CONS("Cvar watches:");
+	for (int i = 0; i < cvarwatch_num; i++) {
+		const cvarwatch_t* watch = &cvarwatches[i];
+		if (!watch->pfn)
+			continue;
+		const MPlugin* plug = Plugins->find(watch->plugin_index);
+		META_CONS("  %-20s %s", watch->cvar->name, plug ? plug->desc : "(unloaded)");
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef CVARWATCH_H
+#define CVARWATCH_H
+
+#include <extdll.h>			// cvar_t, etc
+
+#include "types_meta.h"		// mBOOL
+#include "comp_dep.h"		// DLLINTERNAL, unlikely
+#include "mutil.h"			// CVAR_CHANGE_FN
+
+// Cvar handles and change callbacks.
+//
+// Engine cvars never move once registered, so a plugin can resolve a cvar
+// once with GET_CVAR_HANDLE and read its value and string directly,
+// instead of having the engine search its cvar list by name on every
+// CVAR_GET_FLOAT.  A plugin may also watch a cvar with WATCH_CVAR; once a
+// frame the watched cvars are compared to their last seen values, and the
+// callbacks of any that changed are called.  Comparing, rather than
+// catching the set functions, also sees changes made from the console.
+
+extern int cvarwatch_num DLLHIDDEN;		// number of watches
+
+void DLLINTERNAL cvarwatch_check();
+
+// Called every frame.
+inline void DLLINTERNAL cvarwatch_frame() {
+	if (unlikely(cvarwatch_num))
+		cvarwatch_check();
+}
+
+cvar_t* DLLINTERNAL cvar_handle(const char* name);
+const cvar_t* DLLINTERNAL developer_cvar();
+int DLLINTERNAL cvarwatch_add(int plugin_index, cvar_t* cvar, CVAR_CHANGE_FN pfn);
+int DLLINTERNAL cvarwatch_remove(int plugin_index, const cvar_t* cvar, CVAR_CHANGE_FN pfn);
+void DLLINTERNAL cvarwatch_remove_plugin(int plugin_index);
+void DLLINTERNAL cvarwatch_show();
+
+#endif /* CVARWATCH_H */
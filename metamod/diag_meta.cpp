@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cstdarg>			// va_start, etc
+#include <cstdlib>			// realloc, calloc, free, qsort
+#include <cstring>			// strdup
+#include <ctime>			// time
+
+#include <extdll.h>			// always
+
+#include "diag_meta.h"		// me
+#include "log_meta.h"		// META_WARNING, etc
+#include "osdep.h"			// vsnprintf, etc
+
+// A counted warning.
+typedef struct diag_entry_s {
+	diag_id_t id;
+	int plugin_index;		// -1 once the plugin is unloaded
+	unsigned int where;
+	unsigned int count;		// occurrences
+	unsigned int reported;	// occurrences logged or summarized
+	char* msg;				// first occurrence, as logged
+} diag_entry_t;
+
+static diag_entry_t* diag_entries = nullptr;
+static int diag_num = 0;
+static int diag_size = 0;
+
+// Open-addressing index into diag_entries; slot holds entry index+1, or 0.
+static int* diag_slots = nullptr;
+static unsigned int diag_slot_mask = 0;
+
+static unsigned int diag_lost = 0;		// occurrences past MAX_DIAG_ENTRIES
+static int diag_interval = 300;			// seconds; 0 for no summaries
+static time_t diag_next_report = 0;
+
+unsigned int diag_pending = 0;
+
+static unsigned int DLLINTERNAL diag_hash(const diag_id_t id, const int plugin_index, const unsigned int where) {
+	unsigned int h = where * 2654435761u;
+	h ^= (static_cast<unsigned int>(plugin_index) << 8) | static_cast<unsigned int>(id);
+	h ^= h >> 15;
+	return h * 2246822519u;
+}
+
+// Rebuild index with the given number of slots (power of 2).
+static mBOOL DLLINTERNAL diag_reindex(const unsigned int nslots) {
+	int* slots = static_cast<int*>(calloc(nslots, sizeof(int)));
+	if (!slots)
+		return mFALSE;
+	free(diag_slots);
+	diag_slots = slots;
+	diag_slot_mask = nslots - 1;
+	for (int i = 0; i < diag_num; i++) {
+		const diag_entry_t* e = &diag_entries[i];
+		unsigned int s = diag_hash(e->id, e->plugin_index, e->where) & diag_slot_mask;
+		while (diag_slots[s])
+			s = (s + 1) & diag_slot_mask;
+		diag_slots[s] = i + 1;
+	}
+	return mTRUE;
+}
+
+// Find entry for the given key, adding it if missing.  Returns NULL if
+// the table is full or out of memory.
+static diag_entry_t* DLLINTERNAL diag_lookup(const diag_id_t id, const int plugin_index, const unsigned int where) {
+	if (diag_slots) {
+		unsigned int s = diag_hash(id, plugin_index, where) & diag_slot_mask;
+		for (; diag_slots[s]; s = (s + 1) & diag_slot_mask) {
+			diag_entry_t* e = &diag_entries[diag_slots[s] - 1];
+			if (e->where == where && e->plugin_index == plugin_index && e->id == id)
+				return e;
+		}
+	}
+
+	if (diag_num >= MAX_DIAG_ENTRIES)
+		return nullptr;
+	if (diag_num >= diag_size) {
+		const int size = diag_size ? diag_size * 2 : 64;
+		diag_entry_t* entries = static_cast<diag_entry_t*>(realloc(diag_entries, static_cast<size_t>(size) * sizeof(diag_entry_t)));
+		if (!entries)
+			return nullptr;
+		diag_entries = entries;
+		diag_size = size;
+	}
+	// keep index at most half full
+	if (static_cast<unsigned int>(diag_num + 1) * 2 > diag_slot_mask + 1
+		&& !diag_reindex(diag_slots ? (diag_slot_mask + 1) * 2 : 128))
+		return nullptr;
+
+	diag_entry_t* e = &diag_entries[diag_num];
+	e->id = id;
+	e->plugin_index = plugin_index;
+	e->where = where;
+	e->count = 0;
+	e->reported = 0;
+	e->msg = nullptr;
+
+	unsigned int s = diag_hash(id, plugin_index, where) & diag_slot_mask;
+	while (diag_slots[s])
+		s = (s + 1) & diag_slot_mask;
+	diag_slots[s] = ++diag_num;
+	return e;
+}
+
+void DLLINTERNAL diag_warning(const diag_id_t id, const int plugin_index, const unsigned int where, const char* fmt, ...) {
+	diag_entry_t* e = diag_lookup(id, plugin_index, where);
+	if (!e) {
+		diag_lost++;
+		return;
+	}
+
+	if (likely(e->count++)) {
+		// Repeat; summarize it later.
+		if (diag_interval > 0 && !diag_pending++) {
+			const time_t now = time(nullptr);
+			if (diag_next_report < now)
+				diag_next_report = now + diag_interval;
+		}
+		return;
+	}
+
+	char buf[MAX_LOGMSG_LEN];
+	va_list ap;
+	va_start(ap, fmt);
+	safevoid_vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	e->msg = strdup(buf);
+	e->reported = 1;
+	META_WARNING("%s", buf);
+}
+
+// Log repeats of an entry since last summary.
+static void DLLINTERNAL diag_report_entry(diag_entry_t* e) {
+	const unsigned int repeats = e->count - e->reported;
+	if (!repeats)
+		return;
+	META_WARNING("Repeated %u more time%s: %s", repeats, repeats == 1 ? "" : "s",
+		e->msg ? e->msg : "(out of memory)");
+	e->reported = e->count;
+	diag_pending -= repeats < diag_pending ? repeats : diag_pending;
+}
+
+void DLLINTERNAL diag_report_due() {
+	if (diag_interval <= 0 || time(nullptr) < diag_next_report)
+		return;
+	for (int i = 0; i < diag_num; i++)
+		diag_report_entry(&diag_entries[i]);
+	diag_pending = 0;
+	diag_next_report = 0;
+}
+
+void DLLINTERNAL diag_set_interval(const int seconds) {
+	diag_interval = seconds > 0 ? seconds : 0;
+	diag_next_report = 0;
+}
+
+// Summarize repeats of an unloaded plugin's warnings now, and stop
+// counting them under its index, which another plugin may get next.
+void DLLINTERNAL diag_plugin_unloaded(const int plugin_index) {
+	if (!diag_num)
+		return;
+	for (int i = 0; i < diag_num; i++) {
+		diag_entry_t* e = &diag_entries[i];
+		if (e->plugin_index != plugin_index)
+			continue;
+		if (diag_interval > 0)
+			diag_report_entry(e);
+		e->plugin_index = -1;
+	}
+	diag_reindex(diag_slot_mask + 1);
+}
+
+void DLLINTERNAL diag_reset() {
+	for (int i = 0; i < diag_num; i++)
+		free(diag_entries[i].msg);
+	diag_num = 0;
+	if (diag_slots)
+		memset(diag_slots, 0, (diag_slot_mask + 1) * sizeof(int));
+	diag_lost = 0;
+	diag_pending = 0;
+	diag_next_report = 0;
+}
+
+static int diag_cmp_count(const void* a, const void* b) {
+	const unsigned int ca = (*static_cast<const diag_entry_t* const*>(a))->count;
+	const unsigned int cb = (*static_cast<const diag_entry_t* const*>(b))->count;
+	return (ca < cb) - (ca > cb);
+}
+
+// List counted warnings to console, most frequent first.
+void DLLINTERNAL diag_show() {
+	if (!diag_num) {
+		META_CONS("No warnings counted");
+		return;
+	}
+	const diag_entry_t** sorted = static_cast<const diag_entry_t**>(malloc(static_cast<size_t>(diag_num) * sizeof(diag_entry_t*)));
+	if (!sorted) {
+		META_CONS("Out of memory");
+		return;
+	}
+	for (int i = 0; i < diag_num; i++)
+		sorted[i] = &diag_entries[i];
+	qsort(sorted, static_cast<size_t>(diag_num), sizeof(diag_entry_t*), diag_cmp_count);
+
+	META_CONS("Counted warnings:");
+	META_CONS("  %10s  %s", "count", "first occurrence");
+	for (int i = 0; i < diag_num; i++)
+		META_CONS("  %10u  %s", sorted[i]->count, sorted[i]->msg ? sorted[i]->msg : "(out of memory)");
+	free(sorted);
+
+	if (diag_lost)
+		META_CONS("%u more not counted; table full", diag_lost);
+	if (diag_interval > 0)
+		META_CONS("Repeats are summarized every %d seconds", diag_interval);
+	else
+		META_CONS("Repeats are not summarized");
+}
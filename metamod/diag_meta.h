@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef DIAG_META_H
+#define DIAG_META_H
+
+#include "types_meta.h"		// mBOOL
+#include "comp_dep.h"		// DLLINTERNAL, unlikely
+
+// Deduplicated warnings.
+//
+// Some warnings, like a plugin not setting meta_result, can happen on
+// every call of a hook, flooding the log many times a frame.  These are
+// counted by (plugin, where, warning), where "where" is the hook id or
+// some other number identifying the site, like a hash of a command name.
+// The first occurrence is logged as usual; repeats are only counted, and
+// a summary of the repeats is logged every diag_interval seconds
+// (config.ini "diag_interval").  "meta diag" lists the counts.
+
+// Warnings counted.
+typedef enum {
+	DIAG_NO_MRES = 0,		// plugin didn't set meta_result
+	DIAG_NO_MRES_POST,		// same, in a post function
+	DIAG_POST_SUPERCEDE,	// MRES_SUPERCEDE in a post function
+	DIAG_NO_ORIG_FN,		// original api function missing
+	DIAG_NO_GAME_ENTITY,	// CallGameEntity of unknown entity
+	DIAG_BAD_GAME_INFO,		// GetGameInfo with invalid request
+	DIAG_NO_REGCMD,			// registered command not found
+	DIAG_MAX
+} diag_id_t;
+
+constexpr int MAX_DIAG_ENTRIES = 4096;	// distinct warnings counted
+
+extern unsigned int diag_pending DLLHIDDEN;	// repeats not yet summarized
+
+// Log a warning the first time it happens for the given plugin (1-based
+// index, 0 for none) and site; afterwards just count it.
+void DLLINTERNAL diag_warning(diag_id_t id, int plugin_index, unsigned int where, const char* fmt, ...);
+
+// Log summary of repeated warnings, if due.
+void DLLINTERNAL diag_report_due();
+
+// Called every frame.
+inline void DLLINTERNAL diag_frame() {
+	if (unlikely(diag_pending))
+		diag_report_due();
+}
+
+void DLLINTERNAL diag_set_interval(int seconds);
+void DLLINTERNAL diag_plugin_unloaded(int plugin_index);
+void DLLINTERNAL diag_reset();
+void DLLINTERNAL diag_show();
+
+#endif /* DIAG_META_H */
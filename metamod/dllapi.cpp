@@ -37,6 +37,7 @@
  */
 
 #include <cstddef>			// offsetof
+#include <type_traits>		// is_same
 
 #include <extdll.h>			// always
 
@@ -47,189 +48,158 @@
 #include "log_meta.h"		// META_ERROR, etc
 #include "api_hook.h"
 #include "h_export.h"
+#include "api_route.h"		// route_map_start, etc
+#include "api_prof.h"		// prof_frame, etc
+#include "diag_meta.h"		// diag_frame
+#include "cvarwatch.h"		// cvarwatch_frame
+#include "cvarquery.h"		// cvarquery_frame, etc
+#include "edictslot.h"		// edictslot_freed, etc
+#include "filewatch.h"		// filewatch_stop
+#include "hookprofile.h"	// hookprof_find
+#include "stageload.h"		// stage_stop
 
  // Original DLL routines, functions returning "void".
-#define META_DLLAPI_HANDLE_void(FN_TYPE, pfnName, pack_args_type, pfn_args) \
+#define META_DLLAPI_HANDLE_void(FN_TYPE, pfnName, pfn_args) \
+	static_assert(std::is_same<FN_TYPE, decltype(DLL_FUNCTIONS::pfnName)>::value, "wrong FN_TYPE"); \
 	API_START_TSC_TRACKING(); \
-	API_PACK_ARGS(pack_args_type, pfn_args); \
-	main_hook_function_void(offsetof(dllapi_info_t, pfnName), e_api_dllapi, offsetof(DLL_FUNCTIONS, pfnName), &packed_args); \
+	api_hook_void_t<FN_TYPE>(offsetof(dllapi_info_t, pfnName), e_api_dllapi, offsetof(DLL_FUNCTIONS, pfnName)) pfn_args; \
 	API_END_TSC_TRACKING()
 
 // Original DLL routines, functions returning an actual value.
-#define META_DLLAPI_HANDLE(ret_t, ret_init, FN_TYPE, pfnName, pack_args_type, pfn_args) \
+#define META_DLLAPI_HANDLE(ret_t, ret_init, FN_TYPE, pfnName, pfn_args) \
+	static_assert(std::is_same<FN_TYPE, decltype(DLL_FUNCTIONS::pfnName)>::value, "wrong FN_TYPE"); \
 	API_START_TSC_TRACKING(); \
-	API_PACK_ARGS(pack_args_type, pfn_args); \
-	class_ret_t ret_val(main_hook_function(class_ret_t((ret_t)(ret_init)), offsetof(dllapi_info_t, pfnName), e_api_dllapi, offsetof(DLL_FUNCTIONS, pfnName), &packed_args)); \
+	ret_t ret_val = api_hook_t<FN_TYPE, ret_t>((ret_t)(ret_init), offsetof(dllapi_info_t, pfnName), e_api_dllapi, offsetof(DLL_FUNCTIONS, pfnName)) pfn_args; \
 	API_END_TSC_TRACKING()
 
 // The "new" api routines (just 3 right now), functions returning "void".
-#define META_NEWAPI_HANDLE_void(FN_TYPE, pfnName, pack_args_type, pfn_args) \
+#define META_NEWAPI_HANDLE_void(FN_TYPE, pfnName, pfn_args) \
+	static_assert(std::is_same<FN_TYPE, decltype(NEW_DLL_FUNCTIONS::pfnName)>::value, "wrong FN_TYPE"); \
 	API_START_TSC_TRACKING(); \
-	API_PACK_ARGS(pack_args_type, pfn_args); \
-	main_hook_function_void(offsetof(newapi_info_t, pfnName), e_api_newapi, offsetof(NEW_DLL_FUNCTIONS, pfnName), &packed_args); \
+	api_hook_void_t<FN_TYPE>(offsetof(newapi_info_t, pfnName), e_api_newapi, offsetof(NEW_DLL_FUNCTIONS, pfnName)) pfn_args; \
 	API_END_TSC_TRACKING()
 
 // The "new" api routines (just 3 right now), functions returning an actual value.
-#define META_NEWAPI_HANDLE(ret_t, ret_init, FN_TYPE, pfnName, pack_args_type, pfn_args) \
+#define META_NEWAPI_HANDLE(ret_t, ret_init, FN_TYPE, pfnName, pfn_args) \
+	static_assert(std::is_same<FN_TYPE, decltype(NEW_DLL_FUNCTIONS::pfnName)>::value, "wrong FN_TYPE"); \
 	API_START_TSC_TRACKING(); \
-	API_PACK_ARGS(pack_args_type, pfn_args); \
-	class_ret_t ret_val(main_hook_function(class_ret_t((ret_t)(ret_init)), offsetof(newapi_info_t, pfnName), e_api_newapi, offsetof(NEW_DLL_FUNCTIONS, pfnName), &packed_args)); \
+	ret_t ret_val = api_hook_t<FN_TYPE, ret_t>((ret_t)(ret_init), offsetof(newapi_info_t, pfnName), e_api_newapi, offsetof(NEW_DLL_FUNCTIONS, pfnName)) pfn_args; \
 	API_END_TSC_TRACKING()
 
 // From SDK dlls/game.cpp:
 static void mm_GameDLLInit() {
-	META_DLLAPI_HANDLE_void(FN_GAMEINIT, pfnGameInit, void, (VOID_ARG))
+	META_DLLAPI_HANDLE_void(FN_GAMEINIT, pfnGameInit, ())
 	RETURN_API_void()
 }
 
 // From SDK dlls/cbase.cpp:
 static int mm_DispatchSpawn(edict_t* pent) {
 	// 0==Success, -1==Failure ?
-	META_DLLAPI_HANDLE(int, 0, FN_DISPATCHSPAWN, pfnSpawn, p, (pent))
+	META_DLLAPI_HANDLE(int, 0, FN_DISPATCHSPAWN, pfnSpawn, (pent))
 	RETURN_API(int)
 }
 static void mm_DispatchThink(edict_t* pent) {
-	META_DLLAPI_HANDLE_void(FN_DISPATCHTHINK, pfnThink, p, (pent))
+	META_DLLAPI_HANDLE_void(FN_DISPATCHTHINK, pfnThink, (pent))
 	RETURN_API_void()
 }
 static void mm_DispatchUse(edict_t* pentUsed, edict_t* pentOther) {
-	META_DLLAPI_HANDLE_void(FN_DISPATCHUSE, pfnUse, 2p, (pentUsed, pentOther))
+	META_DLLAPI_HANDLE_void(FN_DISPATCHUSE, pfnUse, (pentUsed, pentOther))
 	RETURN_API_void()
 }
 static void mm_DispatchTouch(edict_t* pentTouched, edict_t* pentOther) {
-	META_DLLAPI_HANDLE_void(FN_DISPATCHTOUCH, pfnTouch, 2p, (pentTouched, pentOther))
+	META_DLLAPI_HANDLE_void(FN_DISPATCHTOUCH, pfnTouch, (pentTouched, pentOther))
 	RETURN_API_void()
 }
 static void mm_DispatchBlocked(edict_t* pentBlocked, edict_t* pentOther) {
-	META_DLLAPI_HANDLE_void(FN_DISPATCHBLOCKED, pfnBlocked, 2p, (pentBlocked, pentOther))
+	META_DLLAPI_HANDLE_void(FN_DISPATCHBLOCKED, pfnBlocked, (pentBlocked, pentOther))
 	RETURN_API_void()
 }
 static void mm_DispatchKeyValue(edict_t* pentKeyvalue, KeyValueData* pkvd) {
-	META_DLLAPI_HANDLE_void(FN_DISPATCHKEYVALUE, pfnKeyValue, 2p, (pentKeyvalue, pkvd))
+	META_DLLAPI_HANDLE_void(FN_DISPATCHKEYVALUE, pfnKeyValue, (pentKeyvalue, pkvd))
 	RETURN_API_void()
 }
 static void mm_DispatchSave(edict_t* pent, SAVERESTOREDATA* pSaveData) {
-	META_DLLAPI_HANDLE_void(FN_DISPATCHSAVE, pfnSave, 2p, (pent, pSaveData))
+	META_DLLAPI_HANDLE_void(FN_DISPATCHSAVE, pfnSave, (pent, pSaveData))
 	RETURN_API_void()
 }
 static int mm_DispatchRestore(edict_t* pent, SAVERESTOREDATA* pSaveData, int globalEntity) {
 	// 0==Success, -1==Failure ?
-	META_DLLAPI_HANDLE(int, 0, FN_DISPATCHRESTORE, pfnRestore, 2pi, (pent, pSaveData, globalEntity))
+	META_DLLAPI_HANDLE(int, 0, FN_DISPATCHRESTORE, pfnRestore, (pent, pSaveData, globalEntity))
 	RETURN_API(int)
 }
 static void mm_DispatchObjectCollisionBox(edict_t* pent) {
-	META_DLLAPI_HANDLE_void(FN_DISPATCHOBJECTCOLLISIONBOX, pfnSetAbsBox, p, (pent))
+	META_DLLAPI_HANDLE_void(FN_DISPATCHOBJECTCOLLISIONBOX, pfnSetAbsBox, (pent))
 	RETURN_API_void()
 }
 static void mm_SaveWriteFields(SAVERESTOREDATA* pSaveData, const char* pname, void* pBaseData, TYPEDESCRIPTION* pFields, int fieldCount) {
-	META_DLLAPI_HANDLE_void(FN_SAVEWRITEFIELDS, pfnSaveWriteFields, 4pi, (pSaveData, pname, pBaseData, pFields, fieldCount))
+	META_DLLAPI_HANDLE_void(FN_SAVEWRITEFIELDS, pfnSaveWriteFields, (pSaveData, pname, pBaseData, pFields, fieldCount))
 	RETURN_API_void()
 }
 static void mm_SaveReadFields(SAVERESTOREDATA* pSaveData, const char* pname, void* pBaseData, TYPEDESCRIPTION* pFields, int fieldCount) {
-	META_DLLAPI_HANDLE_void(FN_SAVEREADFIELDS, pfnSaveReadFields, 4pi, (pSaveData, pname, pBaseData, pFields, fieldCount))
+	META_DLLAPI_HANDLE_void(FN_SAVEREADFIELDS, pfnSaveReadFields, (pSaveData, pname, pBaseData, pFields, fieldCount))
 	RETURN_API_void()
 }
 
 // From SDK dlls/world.cpp:
 static void mm_SaveGlobalState(SAVERESTOREDATA* pSaveData) {
-	META_DLLAPI_HANDLE_void(FN_SAVEGLOBALSTATE, pfnSaveGlobalState, p, (pSaveData))
+	META_DLLAPI_HANDLE_void(FN_SAVEGLOBALSTATE, pfnSaveGlobalState, (pSaveData))
 	RETURN_API_void()
 }
 static void mm_RestoreGlobalState(SAVERESTOREDATA* pSaveData) {
-	META_DLLAPI_HANDLE_void(FN_RESTOREGLOBALSTATE, pfnRestoreGlobalState, p, (pSaveData))
+	META_DLLAPI_HANDLE_void(FN_RESTOREGLOBALSTATE, pfnRestoreGlobalState, (pSaveData))
 	RETURN_API_void()
 }
 static void mm_ResetGlobalState() {
-	META_DLLAPI_HANDLE_void(FN_RESETGLOBALSTATE, pfnResetGlobalState, void, (VOID_ARG))
+	META_DLLAPI_HANDLE_void(FN_RESETGLOBALSTATE, pfnResetGlobalState, ())
 	RETURN_API_void()
 }
 
 // From SDK dlls/client.cpp:
 static qboolean mm_ClientConnect(edict_t* pEntity, const char* pszName, const char* pszAddress, char szRejectReason[128]) {
-	g_Players.clear_player_cvar_query(pEntity);
-	META_DLLAPI_HANDLE(qboolean, TRUE, FN_CLIENTCONNECT, pfnClientConnect, 4p, (pEntity, pszName, pszAddress, szRejectReason))
+	cvarquery_reset_client(pEntity);
+	edictslot_client(pEntity);
+	META_DLLAPI_HANDLE(qboolean, TRUE, FN_CLIENTCONNECT, pfnClientConnect, (pEntity, pszName, pszAddress, szRejectReason))
 	RETURN_API(qboolean)
 }
 static void mm_ClientDisconnect(edict_t* pEntity) {
-	g_Players.clear_player_cvar_query(pEntity);
-	META_DLLAPI_HANDLE_void(FN_CLIENTDISCONNECT, pfnClientDisconnect, p, (pEntity))
+	cvarquery_reset_client(pEntity);
+	META_DLLAPI_HANDLE_void(FN_CLIENTDISCONNECT, pfnClientDisconnect, (pEntity))
+	// after plugins and gamedll are done with the client
+	edictslot_client(pEntity);
 	RETURN_API_void()
 }
 static void mm_ClientKill(edict_t* pEntity) {
-	META_DLLAPI_HANDLE_void(FN_CLIENTKILL, pfnClientKill, p, (pEntity))
+	META_DLLAPI_HANDLE_void(FN_CLIENTKILL, pfnClientKill, (pEntity))
 	RETURN_API_void()
 }
 static void mm_ClientPutInServer(edict_t* pEntity) {
-	META_DLLAPI_HANDLE_void(FN_CLIENTPUTINSERVER, pfnClientPutInServer, p, (pEntity))
+	META_DLLAPI_HANDLE_void(FN_CLIENTPUTINSERVER, pfnClientPutInServer, (pEntity))
 	RETURN_API_void()
 }
 static void mm_ClientCommand(edict_t* pEntity) {
 	if (Config->clientmeta && strmatch(CMD_ARGV(0), "meta")) {
 		client_meta(pEntity);
 	}
-	META_DLLAPI_HANDLE_void(FN_CLIENTCOMMAND, pfnClientCommand, p, (pEntity))
+	META_DLLAPI_HANDLE_void(FN_CLIENTCOMMAND, pfnClientCommand, (pEntity))
 	RETURN_API_void()
 }
 static void mm_ClientUserInfoChanged(edict_t* pEntity, char* infobuffer) {
-	META_DLLAPI_HANDLE_void(FN_CLIENTUSERINFOCHANGED, pfnClientUserInfoChanged, 2p, (pEntity, infobuffer))
+	META_DLLAPI_HANDLE_void(FN_CLIENTUSERINFOCHANGED, pfnClientUserInfoChanged, (pEntity, infobuffer))
 	RETURN_API_void()
 }
-bool shouldExpensiveHooksBeEnabled(const char* gameMap) {
-	char loadfile[PATH_MAX];
-	char line[MAX_MAPNAME_LENGTH];
-
-	// Make full pathname (from gamedir if relative, collapse "..", backslashes, etc).
-	full_gamedir_path(Config->slowhooks_whitelist, loadfile);
-
-	FILE* fp = fopen(loadfile, "r");
-	if (!fp) {
-		META_WARNING("unable to open slowhook whitelist file '%s': %s", loadfile, strerror(errno));
-		return false;
-	}
-
-	bool shouldEnable = false;
-
-	META_DEBUG(2, ("Loading from slowhooks whitelist: %s", loadfile));
-	for (int ln = 1; !feof(fp) && fgets(line, sizeof(line), fp); ln++) {
-		if (line[0] == '#')
-			continue;
-		if (line[0] == ';')
-			continue;
-		if (strnmatch(line, "//", 2))
-			continue;
-		const char* fileMap = strtok(line, " \t\r\n");
-
-		if (!strcasematch(fileMap, gameMap)) {
-			shouldEnable = true;
-			break;
-		}
-	}
-	fclose(fp);
-
-	return shouldEnable;
-}
 static void mm_ServerActivate(edict_t* pEdictList, int edictCount, int clientMax) {
+	// Map load isn't a slow frame.
+	prof_frame_reset();
 
-	if (!Config->slowhooks) {
-		const GIVE_ENGINE_FUNCTIONS_FN pfn_give_engfuncs = GIVE_ENGINE_FUNCTIONS_FN(DLSYM(GameDLL.handle, "GiveFnptrsToDll"));
-
-		if (shouldExpensiveHooksBeEnabled(STRING(gpGlobals->mapname))) {
-			META_DEBUG(3, ("Expensive metamod hooks enabled."));
-			pfn_give_engfuncs(&g_slow_hooks_table_engine, gpGlobals);
-			memcpy(g_engine_dll_funcs_table, &g_slow_hooks_table_dll, sizeof(DLL_FUNCTIONS));
-		}
-		else {
-			META_DEBUG(3, ("Expensive metamod hooks disabled."));
-			pfn_give_engfuncs(&g_fast_hooks_table_engine, gpGlobals);
-			memcpy(g_engine_dll_funcs_table, &g_fast_hooks_table_dll, sizeof(DLL_FUNCTIONS));
-		}
-	}
+	// Route hooked functions, plus any the map's slowhooks profile names.
+	route_map_start(Config->slowhooks ? nullptr : hookprof_find(STRING(gpGlobals->mapname)));
+	edictslot_map_start(pEdictList);
 
-	META_DLLAPI_HANDLE_void(FN_SERVERACTIVATE, pfnServerActivate, p2i, (pEdictList, edictCount, clientMax))
+	META_DLLAPI_HANDLE_void(FN_SERVERACTIVATE, pfnServerActivate, (pEdictList, edictCount, clientMax))
 	RETURN_API_void()
 }
 static void mm_ServerDeactivate() {
-	META_DLLAPI_HANDLE_void(FN_SERVERDEACTIVATE, pfnServerDeactivate, void, (VOID_ARG))
+	META_DLLAPI_HANDLE_void(FN_SERVERDEACTIVATE, pfnServerDeactivate, ())
 	// Update loaded plugins.  Look for new plugins in inifile, as well as
 	// any plugins waiting for a changelevel to load.
 	//
@@ -246,149 +216,163 @@ static void mm_ServerDeactivate() {
 	Plugins->refresh(PT_CHANGELEVEL);
 	Plugins->unpause_all();
 	// Plugins->retry_all(PT_CHANGELEVEL);
-	g_Players.clear_all_cvar_queries();
+	cvarquery_reset_all();
+	edictslot_map_end();
 	requestid_counter = 0;
+	// Make sure the previous map's log is on disk.
+	log_async_flush();
 	RETURN_API_void()
 }
 static void mm_PlayerPreThink(edict_t* pEntity) {
-	META_DLLAPI_HANDLE_void(FN_PLAYERPRETHINK, pfnPlayerPreThink, p, (pEntity))
+	META_DLLAPI_HANDLE_void(FN_PLAYERPRETHINK, pfnPlayerPreThink, (pEntity))
 	RETURN_API_void()
 }
 static void mm_PlayerPostThink(edict_t* pEntity) {
-	META_DLLAPI_HANDLE_void(FN_PLAYERPOSTTHINK, pfnPlayerPostThink, p, (pEntity))
+	META_DLLAPI_HANDLE_void(FN_PLAYERPOSTTHINK, pfnPlayerPostThink, (pEntity))
 	RETURN_API_void()
 }
 static void mm_StartFrame() {
+	prof_frame();
+	diag_frame();
+	cvarwatch_frame();
+	cvarquery_frame();
 	meta_debug_value = static_cast<int>(meta_debug.value);
 
-	META_DLLAPI_HANDLE_void(FN_STARTFRAME, pfnStartFrame, void, (VOID_ARG))
+	META_DLLAPI_HANDLE_void(FN_STARTFRAME, pfnStartFrame, ())
 	RETURN_API_void()
 }
 static void mm_ParmsNewLevel() {
-	META_DLLAPI_HANDLE_void(FN_PARMSNEWLEVEL, pfnParmsNewLevel, void, (VOID_ARG))
+	META_DLLAPI_HANDLE_void(FN_PARMSNEWLEVEL, pfnParmsNewLevel, ())
 	RETURN_API_void()
 }
 static void mm_ParmsChangeLevel() {
-	META_DLLAPI_HANDLE_void(FN_PARMSCHANGELEVEL, pfnParmsChangeLevel, void, (VOID_ARG))
+	META_DLLAPI_HANDLE_void(FN_PARMSCHANGELEVEL, pfnParmsChangeLevel, ())
 	RETURN_API_void()
 }
 static const char* mm_GetGameDescription() {
-	META_DLLAPI_HANDLE(const char*, NULL, FN_GETGAMEDESCRIPTION, pfnGetGameDescription, void, (VOID_ARG))
+	META_DLLAPI_HANDLE(const char*, NULL, FN_GETGAMEDESCRIPTION, pfnGetGameDescription, ())
 	RETURN_API(const char*)
 }
 static void mm_PlayerCustomization(edict_t* pEntity, customization_t* pCust) {
-	META_DLLAPI_HANDLE_void(FN_PLAYERCUSTOMIZATION, pfnPlayerCustomization, 2p, (pEntity, pCust))
+	META_DLLAPI_HANDLE_void(FN_PLAYERCUSTOMIZATION, pfnPlayerCustomization, (pEntity, pCust))
 	RETURN_API_void()
 }
 static void mm_SpectatorConnect(edict_t* pEntity) {
-	META_DLLAPI_HANDLE_void(FN_SPECTATORCONNECT, pfnSpectatorConnect, p, (pEntity))
+	META_DLLAPI_HANDLE_void(FN_SPECTATORCONNECT, pfnSpectatorConnect, (pEntity))
 	RETURN_API_void()
 }
 static void mm_SpectatorDisconnect(edict_t* pEntity) {
-	META_DLLAPI_HANDLE_void(FN_SPECTATORDISCONNECT, pfnSpectatorDisconnect, p, (pEntity))
+	META_DLLAPI_HANDLE_void(FN_SPECTATORDISCONNECT, pfnSpectatorDisconnect, (pEntity))
 	RETURN_API_void()
 }
 static void mm_SpectatorThink(edict_t* pEntity) {
-	META_DLLAPI_HANDLE_void(FN_SPECTATORTHINK, pfnSpectatorThink, p, (pEntity))
+	META_DLLAPI_HANDLE_void(FN_SPECTATORTHINK, pfnSpectatorThink, (pEntity))
 	RETURN_API_void()
 }
 static void mm_Sys_Error(const char* error_string) {
-	META_DLLAPI_HANDLE_void(FN_SYS_ERROR, pfnSys_Error, p, (error_string))
+	META_DLLAPI_HANDLE_void(FN_SYS_ERROR, pfnSys_Error, (error_string))
 	RETURN_API_void()
 }
 
 // From SDK pm_shared/pm_shared.c:
 static void mm_PM_Move(playermove_s* ppmove, int server) {
-	META_DLLAPI_HANDLE_void(FN_PM_MOVE, pfnPM_Move, pi, (ppmove, server))
+	META_DLLAPI_HANDLE_void(FN_PM_MOVE, pfnPM_Move, (ppmove, server))
 	RETURN_API_void()
 }
 static void mm_PM_Init(playermove_s* ppmove) {
-	META_DLLAPI_HANDLE_void(FN_PM_INIT, pfnPM_Init, p, (ppmove))
+	META_DLLAPI_HANDLE_void(FN_PM_INIT, pfnPM_Init, (ppmove))
 	RETURN_API_void()
 }
 static char mm_PM_FindTextureType(char* name) {
-	META_DLLAPI_HANDLE(char, '\0', FN_PM_FINDTEXTURETYPE, pfnPM_FindTextureType, p, (name))
+	META_DLLAPI_HANDLE(char, '\0', FN_PM_FINDTEXTURETYPE, pfnPM_FindTextureType, (name))
 	RETURN_API(char)
 }
 
 // From SDK dlls/client.cpp:
 static void mm_SetupVisibility(edict_t* pViewEntity, edict_t* pClient, unsigned char** pvs, unsigned char** pas) {
-	META_DLLAPI_HANDLE_void(FN_SETUPVISIBILITY, pfnSetupVisibility, 4p, (pViewEntity, pClient, pvs, pas))
+	META_DLLAPI_HANDLE_void(FN_SETUPVISIBILITY, pfnSetupVisibility, (pViewEntity, pClient, pvs, pas))
 	RETURN_API_void()
 }
 static void mm_UpdateClientData(const edict_s* ent, int sendweapons, clientdata_s* cd) {
-	META_DLLAPI_HANDLE_void(FN_UPDATECLIENTDATA, pfnUpdateClientData, pip, (ent, sendweapons, cd))
+	META_DLLAPI_HANDLE_void(FN_UPDATECLIENTDATA, pfnUpdateClientData, (ent, sendweapons, cd))
 	RETURN_API_void()
 }
 static int mm_AddToFullPack(entity_state_s* state, int e, edict_t* ent, edict_t* host, int hostflags, int player, unsigned char* pSet) {
-	META_DLLAPI_HANDLE(int, 0, FN_ADDTOFULLPACK, pfnAddToFullPack, pi2p2ip, (state, e, ent, host, hostflags, player, pSet))
+	META_DLLAPI_HANDLE(int, 0, FN_ADDTOFULLPACK, pfnAddToFullPack, (state, e, ent, host, hostflags, player, pSet))
 	RETURN_API(int)
 }
 static void mm_CreateBaseline(int player, int eindex, entity_state_s *baseline, edict_s *entity, int playermodelindex, const Vector& player_mins, const Vector& player_maxs) {
-	META_DLLAPI_HANDLE_void(FN_CREATEBASELINE, pfnCreateBaseline, 2i2pi2v3, (player, eindex, baseline, entity, playermodelindex, player_mins, player_maxs))
+	META_DLLAPI_HANDLE_void(FN_CREATEBASELINE, pfnCreateBaseline, (player, eindex, baseline, entity, playermodelindex, player_mins, player_maxs))
 		RETURN_API_void()
 }
 static void mm_RegisterEncoders() {
-	META_DLLAPI_HANDLE_void(FN_REGISTERENCODERS, pfnRegisterEncoders, void, (VOID_ARG))
+	META_DLLAPI_HANDLE_void(FN_REGISTERENCODERS, pfnRegisterEncoders, ())
 	RETURN_API_void()
 }
 static int mm_GetWeaponData(edict_s* player, weapon_data_s* info) {
-	META_DLLAPI_HANDLE(int, 0, FN_GETWEAPONDATA, pfnGetWeaponData, 2p, (player, info))
+	META_DLLAPI_HANDLE(int, 0, FN_GETWEAPONDATA, pfnGetWeaponData, (player, info))
 	RETURN_API(int)
 }
 static void mm_CmdStart(const edict_t* player, const usercmd_s* cmd, unsigned int random_seed) {
-	META_DLLAPI_HANDLE_void(FN_CMDSTART, pfnCmdStart, 2pui, (player, cmd, random_seed))
+	META_DLLAPI_HANDLE_void(FN_CMDSTART, pfnCmdStart, (player, cmd, random_seed))
 	RETURN_API_void()
 }
 static void mm_CmdEnd(const edict_t* player) {
-	META_DLLAPI_HANDLE_void(FN_CMDEND, pfnCmdEnd, p, (player))
+	META_DLLAPI_HANDLE_void(FN_CMDEND, pfnCmdEnd, (player))
 	RETURN_API_void()
 }
 static int mm_ConnectionlessPacket(const netadr_s* net_from, const char* args, char* response_buffer, int* response_buffer_size) {
-	META_DLLAPI_HANDLE(int, 0, FN_CONNECTIONLESSPACKET, pfnConnectionlessPacket, 4p, (net_from, args, response_buffer, response_buffer_size))
+	META_DLLAPI_HANDLE(int, 0, FN_CONNECTIONLESSPACKET, pfnConnectionlessPacket, (net_from, args, response_buffer, response_buffer_size))
 	RETURN_API(int)
 }
 static int mm_GetHullBounds(int hullnumber, float* mins, float* maxs) {
-	META_DLLAPI_HANDLE(int, 0, FN_GETHULLBOUNDS, pfnGetHullBounds, i2p, (hullnumber, mins, maxs))
+	META_DLLAPI_HANDLE(int, 0, FN_GETHULLBOUNDS, pfnGetHullBounds, (hullnumber, mins, maxs))
 	RETURN_API(int)
 }
 static void mm_CreateInstancedBaselines() {
-	META_DLLAPI_HANDLE_void(FN_CREATEINSTANCEDBASELINES, pfnCreateInstancedBaselines, void, (VOID_ARG))
+	META_DLLAPI_HANDLE_void(FN_CREATEINSTANCEDBASELINES, pfnCreateInstancedBaselines, ())
 	RETURN_API_void()
 }
 static int mm_InconsistentFile(const edict_t* player, const char* filename, char* disconnect_message) {
-	META_DLLAPI_HANDLE(int, 0, FN_INCONSISTENTFILE, pfnInconsistentFile, 3p, (player, filename, disconnect_message))
+	META_DLLAPI_HANDLE(int, 0, FN_INCONSISTENTFILE, pfnInconsistentFile, (player, filename, disconnect_message))
 	RETURN_API(int)
 }
 static int mm_AllowLagCompensation() {
-	META_DLLAPI_HANDLE(int, 0, FN_ALLOWLAGCOMPENSATION, pfnAllowLagCompensation, void, (VOID_ARG))
+	META_DLLAPI_HANDLE(int, 0, FN_ALLOWLAGCOMPENSATION, pfnAllowLagCompensation, ())
 	RETURN_API(int)
 }
 
 // New API functions
 // From SDK ?
 static void mm_OnFreeEntPrivateData(edict_t* pEnt) {
-	META_NEWAPI_HANDLE_void(FN_ONFREEENTPRIVATEDATA, pfnOnFreeEntPrivateData, p, (pEnt))
+	META_NEWAPI_HANDLE_void(FN_ONFREEENTPRIVATEDATA, pfnOnFreeEntPrivateData, (pEnt))
+	edictslot_freed(pEnt);
 	RETURN_API_void()
 }
 static void mm_GameShutdown() {
-	META_NEWAPI_HANDLE_void(FN_GAMESHUTDOWN, pfnGameShutdown, void, (VOID_ARG))
+	META_NEWAPI_HANDLE_void(FN_GAMESHUTDOWN, pfnGameShutdown, ())
+	filewatch_stop();
+	stage_stop();
+	log_async_stop();
 	RETURN_API_void()
 }
 static int mm_ShouldCollide(edict_t* pentTouched, edict_t* pentOther) {
-	META_NEWAPI_HANDLE(int, 1, FN_SHOULDCOLLIDE, pfnShouldCollide, 2p, (pentTouched, pentOther))
+	META_NEWAPI_HANDLE(int, 1, FN_SHOULDCOLLIDE, pfnShouldCollide, (pentTouched, pentOther))
 	RETURN_API(int)
 }
 // Added 2005/08/11 (no SDK update):
 static void mm_CvarValue(const edict_t* pEnt, const char* value) {
-	g_Players.clear_player_cvar_query(pEnt);
-	META_NEWAPI_HANDLE_void(FN_CVARVALUE, pfnCvarValue, 2p, (pEnt, value))
+	cvarquery_legacy_clear(pEnt);
+	META_NEWAPI_HANDLE_void(FN_CVARVALUE, pfnCvarValue, (pEnt, value))
 
 	RETURN_API_void()
 }
 // Added 2005/11/21 (no SDK update):
 static void mm_CvarValue2(const edict_t* pEnt, int requestID, const char* cvarName, const char* value) {
-	META_NEWAPI_HANDLE_void(FN_CVARVALUE2, pfnCvarValue2, pi2p, (pEnt, requestID, cvarName, value))
+	// Answers to metamod's own queries go only to the plugins that asked.
+	if (cvarquery_answer(pEnt, requestID, cvarName, value))
+		return;
+	META_NEWAPI_HANDLE_void(FN_CVARVALUE2, pfnCvarValue2, (pEnt, requestID, cvarName, value))
 
 	RETURN_API_void()
 }
@@ -506,43 +490,7 @@ C_DLLEXPORT int GetEntityAPI2(DLL_FUNCTIONS* pFunctionTable, int* interfaceVersi
 		return FALSE;
 	}
 
-	if (!Config->slowhooks) {
-		memcpy(&g_slow_hooks_table_dll, &gFunctionTable, sizeof(DLL_FUNCTIONS));
-
-		// disabling expensive hooks to improve linux performance 
-		// AddToFullPack is by far the most expensive (>40% of all hook calls)
-		gFunctionTable.pfnAddToFullPack = GameDLL.funcs.dllapi_table->pfnAddToFullPack;
-		gFunctionTable.pfnThink = GameDLL.funcs.dllapi_table->pfnThink;
-		gFunctionTable.pfnSetAbsBox = GameDLL.funcs.dllapi_table->pfnSetAbsBox;
-		gFunctionTable.pfnTouch = GameDLL.funcs.dllapi_table->pfnTouch;
-
-		// disabling more hooks that seem totally useless, for a minor performance improvement
-		gFunctionTable.pfnSave = GameDLL.funcs.dllapi_table->pfnSave;
-		gFunctionTable.pfnRestore = GameDLL.funcs.dllapi_table->pfnRestore;
-		gFunctionTable.pfnSaveWriteFields = GameDLL.funcs.dllapi_table->pfnSaveWriteFields;
-		gFunctionTable.pfnSaveReadFields = GameDLL.funcs.dllapi_table->pfnSaveReadFields;
-		gFunctionTable.pfnSaveGlobalState = GameDLL.funcs.dllapi_table->pfnSaveGlobalState;
-		gFunctionTable.pfnRestoreGlobalState = GameDLL.funcs.dllapi_table->pfnRestoreGlobalState;
-		gFunctionTable.pfnResetGlobalState = GameDLL.funcs.dllapi_table->pfnResetGlobalState;
-		gFunctionTable.pfnParmsNewLevel = GameDLL.funcs.dllapi_table->pfnParmsNewLevel; // just use ChangeLeve or ServerActivate/Deactivate
-		gFunctionTable.pfnPlayerCustomization = GameDLL.funcs.dllapi_table->pfnPlayerCustomization;
-		gFunctionTable.pfnPM_FindTextureType = GameDLL.funcs.dllapi_table->pfnPM_FindTextureType;
-		gFunctionTable.pfnSetupVisibility = GameDLL.funcs.dllapi_table->pfnSetupVisibility;
-		gFunctionTable.pfnUpdateClientData = GameDLL.funcs.dllapi_table->pfnUpdateClientData;
-		gFunctionTable.pfnCreateBaseline = GameDLL.funcs.dllapi_table->pfnCreateBaseline;
-		gFunctionTable.pfnRegisterEncoders = GameDLL.funcs.dllapi_table->pfnRegisterEncoders;
-		gFunctionTable.pfnGetWeaponData = GameDLL.funcs.dllapi_table->pfnGetWeaponData;
-		gFunctionTable.pfnConnectionlessPacket = GameDLL.funcs.dllapi_table->pfnConnectionlessPacket;
-		gFunctionTable.pfnGetHullBounds = GameDLL.funcs.dllapi_table->pfnGetHullBounds;
-		gFunctionTable.pfnCreateInstancedBaselines = GameDLL.funcs.dllapi_table->pfnCreateInstancedBaselines;
-		gFunctionTable.pfnInconsistentFile = GameDLL.funcs.dllapi_table->pfnInconsistentFile;
-		gFunctionTable.pfnAllowLagCompensation = GameDLL.funcs.dllapi_table->pfnAllowLagCompensation;
-
-		memcpy(&g_fast_hooks_table_dll, &gFunctionTable, sizeof(DLL_FUNCTIONS));
-	}
-
-	g_engine_dll_funcs_table = pFunctionTable;
-	memcpy(g_engine_dll_funcs_table, &gFunctionTable, sizeof(DLL_FUNCTIONS));
+	route_set_dllapi_table(pFunctionTable);
 	return TRUE;
 }
 
@@ -591,17 +539,6 @@ C_DLLEXPORT int GetNewDLLFunctions(NEW_DLL_FUNCTIONS* pNewFunctionTable, int* in
 		return FALSE;
 	}
 
-	// disabling hooks for improved linux performance
-	if (!Config->slowhooks) {
-		if (GameDLL.funcs.newapi_table) {
-			sNewFunctionTable.copy_to(&g_slow_hooks_table_newdll);
-			if (GameDLL.funcs.newapi_table) {
-				sNewFunctionTable.pfnShouldCollide = GameDLL.funcs.newapi_table->pfnShouldCollide;
-				sNewFunctionTable.pfnOnFreeEntPrivateData = GameDLL.funcs.newapi_table->pfnOnFreeEntPrivateData;
-			}
-			sNewFunctionTable.copy_to(&g_fast_hooks_table_newdll);
-		}
-		sNewFunctionTable.copy_to(pNewFunctionTable);
-	}
+	route_set_newapi_table(pNewFunctionTable);
 	return TRUE;
 }
\ No newline at end of file
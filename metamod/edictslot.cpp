@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#include <cstdlib>			// realloc, calloc, free
+#include <cstring>			// memset
+
+#include <extdll.h>			// always
+
+#include "edictslot.h"		// me
+#include "metamod.h"		// gpGlobals
+#include "log_meta.h"		// META_DEBUG, etc
+
+// Storage per edict is rounded up to this, so slots can hold pointers
+// and doubles.
+constexpr size_t EDICTSLOT_ALIGN = 8;
+// Largest storage per edict.
+constexpr size_t EDICTSLOT_MAX_SIZE = 4096;
+
+// A plugin's slot: one array of stride bytes per edict.
+typedef struct edictslot_s {
+	int plugin_index;		// 0 if free
+	size_t size;			// size asked for, zeroed on clear
+	size_t stride;
+	unsigned char* data;	// nullptr until engine's limit is known
+} edictslot_t;
+
+static edictslot_t* edictslots = nullptr;
+static int edictslot_num = 0;
+static int edictslot_size = 0;
+int edictslot_used = 0;
+static int edictslot_capacity = 0;			// edicts each slot holds
+static const edict_t* edict_base = nullptr;	// edict 0 of current map
+
+// Engine's entity limit; 0 until the first map is set up.
+static int DLLINTERNAL edict_limit() {
+	return gpGlobals ? gpGlobals->maxEntities : 0;
+}
+
+// Edict 0, found from the engine if the map started before we knew.
+static const edict_t* DLLINTERNAL find_base() {
+	if (!edict_base && g_engfuncs.pfnPEntityOfEntIndex)
+		edict_base = INDEXENT(0);
+	return edict_base;
+}
+
+// Grow all slots to hold capacity edicts, zeroing the new part.
+static mBOOL DLLINTERNAL edictslot_grow(const int capacity) {
+	if (capacity <= edictslot_capacity)
+		return mTRUE;
+	for (int i = 0; i < edictslot_num; i++) {
+		edictslot_t* es = &edictslots[i];
+		if (!es->plugin_index)
+			continue;
+		unsigned char* temp = static_cast<unsigned char*>(realloc(es->data, static_cast<size_t>(capacity) * es->stride));
+		if (!temp) {
+			META_ERROR("Couldn't grow edict slot %d to %d edicts", i + 1, capacity);
+			return mFALSE;
+		}
+		memset(temp + static_cast<size_t>(edictslot_capacity) * es->stride, 0,
+			static_cast<size_t>(capacity - edictslot_capacity) * es->stride);
+		es->data = temp;
+	}
+	META_DEBUG(3, ("Edict slots grown from %d to %d edicts", edictslot_capacity, capacity));
+	edictslot_capacity = capacity;
+	return mTRUE;
+}
+
+// Allocate a slot of size bytes per edict for a plugin; returns the slot
+// (1 or more), or 0 with meta_errno set.
+int DLLINTERNAL edictslot_alloc(const int plugin_index, const size_t size) {
+	if (!size)
+		RETURN_ERRNO(0, ME_ARGUMENT);
+	if (size > EDICTSLOT_MAX_SIZE)
+		RETURN_ERRNO(0, ME_MAXREACHED);
+	// fresh slots come at the current capacity
+	if (!edictslot_grow(edict_limit()))
+		RETURN_ERRNO(0, ME_NOMEM);
+
+	int i;
+	for (i = 0; i < edictslot_num && edictslots[i].plugin_index; i++)
+		;
+	if (i == edictslot_size) {
+		const int num = edictslot_size ? edictslot_size * 2 : 8;
+		edictslot_t* temp = static_cast<edictslot_t*>(realloc(edictslots, static_cast<size_t>(num) * sizeof(edictslot_t)));
+		if (!temp)
+			RETURN_ERRNO(0, ME_NOMEM);
+		edictslots = temp;
+		edictslot_size = num;
+	}
+	const size_t stride = (size + EDICTSLOT_ALIGN - 1) & ~(EDICTSLOT_ALIGN - 1);
+	unsigned char* data = nullptr;
+	if (edictslot_capacity) {
+		data = static_cast<unsigned char*>(calloc(static_cast<size_t>(edictslot_capacity), stride));
+		if (!data)
+			RETURN_ERRNO(0, ME_NOMEM);
+	}
+	edictslot_t* es = &edictslots[i];
+	es->plugin_index = plugin_index;
+	es->size = size;
+	es->stride = stride;
+	es->data = data;
+	if (i == edictslot_num)
+		edictslot_num++;
+	edictslot_used++;
+	return i + 1;
+}
+
+// Storage of a slot for an entity index, or nullptr.
+void* DLLINTERNAL edictslot_get_index(const int slot, const int index) {
+	if (unlikely(slot < 1 || slot > edictslot_num))
+		return nullptr;
+	const edictslot_t* es = &edictslots[slot - 1];
+	if (unlikely(!es->plugin_index))
+		return nullptr;
+	// limit can grow on a new map, or wasn't known at alloc
+	if (unlikely(index < 0 || index >= edictslot_capacity)) {
+		if (index < 0 || index >= edict_limit() || !edictslot_grow(edict_limit()))
+			return nullptr;
+	}
+	return es->data + static_cast<size_t>(index) * es->stride;
+}
+
+// Storage of a slot for an edict, or nullptr.
+void* DLLINTERNAL edictslot_get(const int slot, const edict_t* ed) {
+	const edict_t* base = edict_base ? edict_base : find_base();
+	if (unlikely(!ed || !base))
+		return nullptr;
+	return edictslot_get_index(slot, static_cast<int>(ed - base));
+}
+
+static void DLLINTERNAL zero_index(const int index) {
+	for (int i = 0; i < edictslot_num; i++) {
+		const edictslot_t* es = &edictslots[i];
+		if (es->plugin_index)
+			memset(es->data + static_cast<size_t>(index) * es->stride, 0, es->size);
+	}
+}
+
+// Zero an entity's storage in all slots.  Clients' storage is zeroed only
+// when they connect or disconnect, not when the gamedll frees their
+// entity at changelevel.
+void DLLINTERNAL edictslot_zero(const edict_t* ed, const mBOOL client) {
+	const edict_t* base = edict_base ? edict_base : find_base();
+	if (!ed || !base)
+		return;
+	const int index = static_cast<int>(ed - base);
+	if (index < 0 || index >= edictslot_capacity)
+		return;
+	const mBOOL is_client = (index >= 1 && index <= gpGlobals->maxClients) ? mTRUE : mFALSE;
+	if (is_client != client)
+		return;
+	zero_index(index);
+}
+
+// New map's edicts; engine's limit may have grown.
+void DLLINTERNAL edictslot_map_start(const edict_t* edict_list) {
+	edict_base = edict_list;
+	if (edictslot_used)
+		edictslot_grow(edict_limit());
+}
+
+// Map is ending; the next map's edicts may be elsewhere, and no entity
+// but the clients lasts into it.
+void DLLINTERNAL edictslot_map_end() {
+	edict_base = nullptr;
+	if (!edictslot_used)
+		return;
+	const int first = gpGlobals->maxClients + 1;
+	for (int i = 0; i < edictslot_num; i++) {
+		const edictslot_t* es = &edictslots[i];
+		if (!es->plugin_index || !es->data)
+			continue;
+		memset(es->data, 0, es->stride);
+		if (first < edictslot_capacity)
+			memset(es->data + static_cast<size_t>(first) * es->stride, 0,
+				static_cast<size_t>(edictslot_capacity - first) * es->stride);
+	}
+}
+
+// Free the slots of a plugin being unloaded.
+void DLLINTERNAL edictslot_remove_plugin(const int plugin_index) {
+	for (int i = 0; i < edictslot_num; i++) {
+		edictslot_t* es = &edictslots[i];
+		if (es->plugin_index != plugin_index)
+			continue;
+		free(es->data);
+		es->data = nullptr;
+		es->plugin_index = 0;
+		edictslot_used--;
+	}
+	while (edictslot_num && !edictslots[edictslot_num - 1].plugin_index)
+		edictslot_num--;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef EDICTSLOT_H
+#define EDICTSLOT_H
+
+#include <cstddef>			// size_t
+
+#include <extdll.h>			// edict_t, etc
+
+#include "types_meta.h"		// mBOOL
+#include "comp_dep.h"		// DLLINTERNAL
+
+// Per-edict plugin storage.
+//
+// A plugin allocates a slot of some size with ALLOC_EDICT_SLOT, usually
+// in Meta_Attach, and gets the slot's storage for an entity with
+// GET_EDICT_SLOT or GET_INDEX_SLOT.  A slot is one array, indexed by
+// entity index, with the size rounded up for alignment.  Metamod zeroes
+// an entity's storage after the gamedll frees it (OnFreeEntPrivateData),
+// and a client's when it connects and after it disconnects, so a
+// client's storage lasts over changelevels.  Plugins don't need to hook
+// those functions just to clear their own arrays.
+//
+// The arrays are sized to the engine's entity limit, which can grow on a
+// new map; pointers into a slot are good until then.
+
+extern int edictslot_used DLLHIDDEN;		// slots allocated
+
+void DLLINTERNAL edictslot_zero(const edict_t* ed, mBOOL client);
+
+// Entity's private data was freed.
+inline void DLLINTERNAL edictslot_freed(const edict_t* ed) {
+	if (edictslot_used)
+		edictslot_zero(ed, mFALSE);
+}
+
+// Client connected or disconnected.
+inline void DLLINTERNAL edictslot_client(const edict_t* ed) {
+	if (edictslot_used)
+		edictslot_zero(ed, mTRUE);
+}
+
+int DLLINTERNAL edictslot_alloc(int plugin_index, size_t size);
+void* DLLINTERNAL edictslot_get(int slot, const edict_t* ed);
+void* DLLINTERNAL edictslot_get_index(int slot, int index);
+void DLLINTERNAL edictslot_map_start(const edict_t* edict_list);
+void DLLINTERNAL edictslot_map_end();
+void DLLINTERNAL edictslot_remove_plugin(int plugin_index);
+
+#endif /* EDICTSLOT_H */
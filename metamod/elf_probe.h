@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef ELF_PROBE_H
+#define ELF_PROBE_H
+
+#include "comp_dep.h"		// DLLINTERNAL
+
+// Bounded ELF export prober.
+//
+// Finds which of a few known functions an ELF shared library exports,
+// reading with pread() only the ELF header, the section or program
+// headers, and the symbol and string tables.  Every offset and size read
+// from the file is checked against the file size, so truncated or
+// corrupt files just fail.  Handles 32- and 64-bit files, whatever the
+// host.  Depends on nothing else in metamod, so it can be built and
+// tried on its own.
+
+// Exports looked for.
+constexpr unsigned int ELF_EXPORT_GIVEFNPTRSTODLL = 1 << 0;	// GiveFnptrsToDll
+constexpr unsigned int ELF_EXPORT_GETENTITYAPI2 = 1 << 1;	// GetEntityAPI2
+constexpr unsigned int ELF_EXPORT_GETENTITYAPI = 1 << 2;	// GetEntityAPI
+constexpr unsigned int ELF_EXPORT_META = 1 << 3;			// Meta_Init, Meta_Query, etc
+
+typedef enum {
+	ELF_PROBE_OK = 0,
+	ELF_PROBE_OPEN,			// couldn't open or stat file
+	ELF_PROBE_READ,			// read error
+	ELF_PROBE_NOT_ELF,		// no ELF magic
+	ELF_PROBE_TARGET,		// not a shared library for wanted class/machine
+	ELF_PROBE_BAD_ELF,		// offset or size outside file, etc
+	ELF_PROBE_NO_SYMTAB,	// no symbol table found
+	ELF_PROBE_NOMEM,
+} elf_probe_err_t;
+
+typedef struct elf_probe_s {
+	int elf_class;			// ELFCLASS32, ELFCLASS64
+	int type;				// ET_DYN, etc
+	int machine;			// EM_386, EM_X86_64, etc
+	unsigned int exports;	// ELF_EXPORT_* found
+	char meta_export[16];	// first Meta_* export found
+} elf_probe_t;
+
+// Probe file for exports.  If the file isn't a shared library of the
+// given class and machine, returns ELF_PROBE_TARGET after reading just
+// the ELF header; class, type and machine are filled in either way.
+elf_probe_err_t DLLINTERNAL elf_probe(const char* filename, int want_class, int want_machine, elf_probe_t* probe);
+
+const char* DLLINTERNAL elf_probe_strerror(elf_probe_err_t err);
+
+#endif /* ELF_PROBE_H */
@@ -0,0 +1,89 @@
+// vi: set ts=4 sw=4 :
+// vim: set tw=75 :
+
+// elftest_meta.cpp - checks elf_probe() against the fixtures in
+//                    testdata/elf_probe ("make elftest")
+
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+// Not part of metamod.so.  Linked only with osdep_elf_probe_linux.o,
+// which depends on nothing else in metamod.  Prints a JSON line with the
+// number of failed checks, and exits non-zero if any failed.
+
+#include <elf.h>			// ELFCLASS32, EM_386, etc
+#include <stdio.h>			// printf, snprintf
+#include <string.h>			// memset
+
+#include "elf_probe.h"		// elf_probe, etc
+
+static const char *fixture_dir = "testdata/elf_probe";
+static int failed = 0;
+
+static void check(const char *fixture, int want_class, int want_machine,
+		elf_probe_err_t want_err, unsigned int want_exports)
+{
+	char path[512];
+	elf_probe_t probe;
+	elf_probe_err_t err;
+
+	snprintf(path, sizeof(path), "%s/%s", fixture_dir, fixture);
+	memset(&probe, 0, sizeof(probe));
+	err = elf_probe(path, want_class, want_machine, &probe);
+	if(err != want_err || (err == ELF_PROBE_OK && probe.exports != want_exports)) {
+		printf("FAIL %s: got '%s' exports 0x%x, wanted '%s' exports 0x%x\n",
+				fixture, elf_probe_strerror(err), probe.exports,
+				elf_probe_strerror(want_err), want_exports);
+		failed++;
+	}
+	else
+		printf("ok   %s: %s\n", fixture, elf_probe_strerror(err));
+}
+
+int main(int argc, char *argv[]) {
+	const unsigned int gamedll = ELF_EXPORT_GIVEFNPTRSTODLL | ELF_EXPORT_GETENTITYAPI2;
+
+	if(argc > 1)
+		fixture_dir = argv[1];
+
+	check("gamedll_i386.so", ELFCLASS32, EM_386, ELF_PROBE_OK, gamedll);
+	check("gamedll_amd64.so", ELFCLASS64, EM_X86_64, ELF_PROBE_OK, gamedll);
+	check("noexport_amd64.so", ELFCLASS64, EM_X86_64, ELF_PROBE_OK, 0);
+	check("truncated_amd64.so", ELFCLASS64, EM_X86_64, ELF_PROBE_BAD_ELF, 0);
+	// wrong target for this host's metamod
+	check("gamedll_i386.so", ELFCLASS64, EM_X86_64, ELF_PROBE_TARGET, 0);
+	check("gamedll_amd64.so", ELFCLASS32, EM_386, ELF_PROBE_TARGET, 0);
+	check("gamedll.c", ELFCLASS64, EM_X86_64, ELF_PROBE_NOT_ELF, 0);
+	check("missing.so", ELFCLASS64, EM_X86_64, ELF_PROBE_OPEN, 0);
+
+	printf("{\"check\":\"elf_probe\",\"failed\":%d}\n", failed);
+	return(failed ? 1 : 0);
+}
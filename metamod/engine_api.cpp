@@ -40,6 +40,7 @@
 #include <cstdio>			// vsnprintf, etc
 #include <cstdarg>			// va_start, etc
 #include <malloc.h>			// alloca, etc
+#include <type_traits>		// is_same
 
 #include <extdll.h>			// always
 
@@ -49,23 +50,70 @@
 #include "log_meta.h"		// META_ERROR, etc
 #include "osdep.h"		// win32 vsnprintf, etc
 #include "api_hook.h"
+#include "usermsg.h"		// umsg_begin, etc
+#include "cvarwatch.h"		// developer_cvar
 
  // Engine routines, functions returning "void".
-#define META_ENGINE_HANDLE_void(FN_TYPE, pfnName, pack_args_type, pfn_args) \
+#define META_ENGINE_HANDLE_void(FN_TYPE, pfnName, pfn_args) \
+	static_assert(std::is_same<FN_TYPE, decltype(enginefuncs_t::pfnName)>::value, "wrong FN_TYPE"); \
 	API_START_TSC_TRACKING(); \
-	API_PACK_ARGS(pack_args_type, pfn_args); \
-	main_hook_function_void(offsetof(engine_info_t, pfnName), e_api_engine, offsetof(enginefuncs_t, pfnName), &packed_args); \
+	api_hook_void_t<FN_TYPE>(offsetof(engine_info_t, pfnName), e_api_engine, offsetof(enginefuncs_t, pfnName)) pfn_args; \
 	API_END_TSC_TRACKING()
 
 // Engine routines, functions returning an actual value.
-#define META_ENGINE_HANDLE(ret_t, ret_init, FN_TYPE, pfnName, pack_args_type, pfn_args) \
+#define META_ENGINE_HANDLE(ret_t, ret_init, FN_TYPE, pfnName, pfn_args) \
+	static_assert(std::is_same<FN_TYPE, decltype(enginefuncs_t::pfnName)>::value, "wrong FN_TYPE"); \
 	API_START_TSC_TRACKING(); \
-	API_PACK_ARGS(pack_args_type, pfn_args); \
-	class_ret_t ret_val(main_hook_function(class_ret_t((ret_t)(ret_init)), offsetof(engine_info_t, pfnName), e_api_engine, offsetof(enginefuncs_t, pfnName), &packed_args)); \
+	ret_t ret_val = api_hook_t<FN_TYPE, ret_t>((ret_t)(ret_init), offsetof(engine_info_t, pfnName), e_api_engine, offsetof(enginefuncs_t, pfnName)) pfn_args; \
 	API_END_TSC_TRACKING()
 
-// For varargs functions
+// For varargs functions.  The engine has no va_list versions of these,
+// so the string is formatted once and passed on with "%s".  Strings too
+// long for the stack buffer go to a per-thread buffer, kept for reuse
+// and freed when the thread exits.
 #ifndef DO_NOT_FIX_VARARG_ENGINE_API_WARPERS
+struct long_fmt_t {
+	char* buf = nullptr;
+	size_t size = 0;
+	mBOOL busy = mFALSE;	// hook called us again
+
+	~long_fmt_t() { free(buf); }
+};
+static thread_local long_fmt_t long_fmt;
+
+// Format a string that didn't fit the stack buffer, of given size, into
+// the per-thread buffer, or a malloc'd one when that's in use (a hook
+// called us again).  Release with release_format().
+static char* DLLINTERNAL long_format(char* strbuf, const size_t size, const char* szFmt, va_list ap) {
+	char* buf;
+	if (!long_fmt.busy && size <= long_fmt.size)
+		buf = long_fmt.buf;
+	else if (!long_fmt.busy) {
+		buf = static_cast<char*>(realloc(long_fmt.buf, size));
+		if (buf) {
+			long_fmt.buf = buf;
+			long_fmt.size = size;
+		}
+	}
+	else
+		buf = static_cast<char*>(malloc(size));
+	if (!buf)
+		return strbuf;		// truncated string, as formatted
+	if (buf == long_fmt.buf)
+		long_fmt.busy = mTRUE;
+	safevoid_vsnprintf(buf, size, szFmt, ap);
+	return buf;
+}
+
+static void DLLINTERNAL release_format(char* buf, const char* strbuf) {
+	if (likely(buf == strbuf))
+		return;
+	if (buf == long_fmt.buf)
+		long_fmt.busy = mFALSE;
+	else
+		free(buf);
+}
+
 #define MAKE_FORMATED_STRING(szFmt) \
 		char strbuf[MAX_STRBUF_LEN]; \
 		char * buf=strbuf; \
@@ -75,20 +123,14 @@
 			va_start(vargs, szFmt); \
 			len = safe_vsnprintf(strbuf, sizeof(strbuf), szFmt, vargs); \
 			va_end(vargs); \
-			if(len >= 0 && (unsigned)len >= sizeof(strbuf)) { \
-				buf = (char *)malloc((size_t)len + 1); \
-				if(buf) { \
-					va_start(vargs, szFmt); \
-					safevoid_vsnprintf(buf, (size_t)len + 1, szFmt, vargs); \
-					va_end(vargs); \
-				} else { \
-					buf=strbuf; \
-				} \
+			if(unlikely(len >= 0 && (unsigned)len >= sizeof(strbuf))) { \
+				va_start(vargs, szFmt); \
+				buf = long_format(strbuf, (size_t)len + 1, szFmt, vargs); \
+				va_end(vargs); \
 			} \
 		}
 #define CLEAN_FORMATED_STRING() \
-		if(buf != strbuf) \
-			free(buf);
+		release_format(buf, strbuf);
 #else
 #define MAKE_FORMATED_STRING(szFmt) \
 		char buf[MAX_STRBUF_LEN]; \
@@ -101,292 +143,347 @@
 #endif
 
 // Engine routines, printf-style functions returning "void".
-#define META_ENGINE_HANDLE_void_varargs(FN_TYPE, pfnName, pack_args_type, pfn_arg, fmt_arg) \
+#define META_ENGINE_HANDLE_void_varargs(FN_TYPE, pfnName, pfn_arg, fmt_arg) \
 	MAKE_FORMATED_STRING(fmt_arg); \
+	static_assert(std::is_same<FN_TYPE, decltype(enginefuncs_t::pfnName)>::value, "wrong FN_TYPE"); \
 	API_START_TSC_TRACKING(); \
 	META_DEBUG(engine_info.pfnName.loglevel, ("In %s: fmt=%s", engine_info.pfnName.name, fmt_arg)); \
-	API_PACK_ARGS(pack_args_type, (pfn_arg, "%s", buf)); \
-	main_hook_function_void(offsetof(engine_info_t, pfnName), e_api_engine, offsetof(enginefuncs_t, pfnName), &packed_args); \
+	api_hook_void_t<FN_TYPE>(offsetof(engine_info_t, pfnName), e_api_engine, offsetof(enginefuncs_t, pfnName))(pfn_arg, const_cast<char*>("%s"), buf); \
 	API_END_TSC_TRACKING() \
 	CLEAN_FORMATED_STRING()
 
 // Engine routines, printf-style functions returning an actual value.
-#define META_ENGINE_HANDLE_varargs(ret_t, ret_init, FN_TYPE, pfnName, pack_args_type, pfn_arg, fmt_arg) \
+#define META_ENGINE_HANDLE_varargs(ret_t, ret_init, FN_TYPE, pfnName, pfn_arg, fmt_arg) \
 	MAKE_FORMATED_STRING(fmt_arg); \
+	static_assert(std::is_same<FN_TYPE, decltype(enginefuncs_t::pfnName)>::value, "wrong FN_TYPE"); \
 	API_START_TSC_TRACKING(); \
 	META_DEBUG(engine_info.pfnName.loglevel, ("In %s: fmt=%s", engine_info.pfnName.name, fmt_arg)); \
-	API_PACK_ARGS(pack_args_type, (pfn_arg, "%s", buf)); \
-	class_ret_t ret_val(main_hook_function(class_ret_t((ret_t)(ret_init)), offsetof(engine_info_t, pfnName), e_api_engine, offsetof(enginefuncs_t, pfnName), &packed_args)); \
+	ret_t ret_val = api_hook_t<FN_TYPE, ret_t>((ret_t)(ret_init), offsetof(engine_info_t, pfnName), e_api_engine, offsetof(enginefuncs_t, pfnName))(pfn_arg, const_cast<char*>("%s"), buf); \
 	API_END_TSC_TRACKING() \
 	CLEAN_FORMATED_STRING()
 
 static int mm_PrecacheModel(char* s) {
-	META_ENGINE_HANDLE(int, 0, FN_PRECACHEMODEL, pfnPrecacheModel, p, (s))
+	META_ENGINE_HANDLE(int, 0, FN_PRECACHEMODEL, pfnPrecacheModel, (s))
 	RETURN_API(int)
 }
 static int mm_PrecacheSound(char* s) {
-	META_ENGINE_HANDLE(int, 0, FN_PRECACHESOUND, pfnPrecacheSound, p, (s))
+	META_ENGINE_HANDLE(int, 0, FN_PRECACHESOUND, pfnPrecacheSound, (s))
 	RETURN_API(int)
 }
 static void mm_SetModel(edict_t* e, const char* m) {
-	META_ENGINE_HANDLE_void(FN_SETMODEL, pfnSetModel, 2p, (e, m))
+	META_ENGINE_HANDLE_void(FN_SETMODEL, pfnSetModel, (e, m))
 	RETURN_API_void()
 }
 static int mm_ModelIndex(const char* m) {
-	META_ENGINE_HANDLE(int, 0, FN_MODELINDEX, pfnModelIndex, p, (m))
+	META_ENGINE_HANDLE(int, 0, FN_MODELINDEX, pfnModelIndex, (m))
 	RETURN_API(int)
 }
 static int mm_ModelFrames(int modelIndex) {
-	META_ENGINE_HANDLE(int, 0, FN_MODELFRAMES, pfnModelFrames, i, (modelIndex))
+	META_ENGINE_HANDLE(int, 0, FN_MODELFRAMES, pfnModelFrames, (modelIndex))
 	RETURN_API(int)
 }
 
 static void mm_SetSize(edict_t* e, const float* rgflMin, const float* rgflMax) {
-	META_ENGINE_HANDLE_void(FN_SETSIZE, pfnSetSize, 3p, (e, rgflMin, rgflMax))
+	META_ENGINE_HANDLE_void(FN_SETSIZE, pfnSetSize, (e, rgflMin, rgflMax))
 	RETURN_API_void()
 }
 static void mm_ChangeLevel(char* s1, char* s2) {
-	META_ENGINE_HANDLE_void(FN_CHANGELEVEL, pfnChangeLevel, 2p, (s1, s2))
+	META_ENGINE_HANDLE_void(FN_CHANGELEVEL, pfnChangeLevel, (s1, s2))
 	RETURN_API_void()
 }
 static void mm_GetSpawnParms(edict_t* ent) {
-	META_ENGINE_HANDLE_void(FN_GETSPAWNPARMS, pfnGetSpawnParms, p, (ent))
+	META_ENGINE_HANDLE_void(FN_GETSPAWNPARMS, pfnGetSpawnParms, (ent))
 	RETURN_API_void()
 }
 static void mm_SaveSpawnParms(edict_t* ent) {
-	META_ENGINE_HANDLE_void(FN_SAVESPAWNPARMS, pfnSaveSpawnParms, p, (ent))
+	META_ENGINE_HANDLE_void(FN_SAVESPAWNPARMS, pfnSaveSpawnParms, (ent))
 	RETURN_API_void()
 }
 
 static float mm_VecToYaw(const float* rgflVector) {
-	META_ENGINE_HANDLE(float, 0.0, FN_VECTOYAW, pfnVecToYaw, p, (rgflVector))
+	META_ENGINE_HANDLE(float, 0.0, FN_VECTOYAW, pfnVecToYaw, (rgflVector))
 	RETURN_API(float)
 }
 static void mm_VecToAngles(const float* rgflVectorIn, float* rgflVectorOut) {
-	META_ENGINE_HANDLE_void(FN_VECTOANGLES, pfnVecToAngles, 2p, (rgflVectorIn, rgflVectorOut))
+	META_ENGINE_HANDLE_void(FN_VECTOANGLES, pfnVecToAngles, (rgflVectorIn, rgflVectorOut))
 	RETURN_API_void()
 }
 static void mm_MoveToOrigin(edict_t* ent, const float* pflGoal, float dist, int iMoveType) {
-	META_ENGINE_HANDLE_void(FN_MOVETOORIGIN, pfnMoveToOrigin, 2pfi, (ent, pflGoal, dist, iMoveType))
+	META_ENGINE_HANDLE_void(FN_MOVETOORIGIN, pfnMoveToOrigin, (ent, pflGoal, dist, iMoveType))
 	RETURN_API_void()
 }
 static void mm_ChangeYaw(edict_t* ent) {
-	META_ENGINE_HANDLE_void(FN_CHANGEYAW, pfnChangeYaw, p, (ent))
+	META_ENGINE_HANDLE_void(FN_CHANGEYAW, pfnChangeYaw, (ent))
 	RETURN_API_void()
 }
 static void mm_ChangePitch(edict_t* ent) {
-	META_ENGINE_HANDLE_void(FN_CHANGEPITCH, pfnChangePitch, p, (ent))
+	META_ENGINE_HANDLE_void(FN_CHANGEPITCH, pfnChangePitch, (ent))
 	RETURN_API_void()
 }
 
 static edict_t* mm_FindEntityByString(edict_t* pEdictStartSearchAfter, const char* pszField, const char* pszValue) {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_FINDENTITYBYSTRING, pfnFindEntityByString, 3p, (pEdictStartSearchAfter, pszField, pszValue))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_FINDENTITYBYSTRING, pfnFindEntityByString, (pEdictStartSearchAfter, pszField, pszValue))
 	RETURN_API(edict_t*)
 }
 static int mm_GetEntityIllum(edict_t* pEnt) {
-	META_ENGINE_HANDLE(int, 0, FN_GETENTITYILLUM, pfnGetEntityIllum, p, (pEnt))
+	META_ENGINE_HANDLE(int, 0, FN_GETENTITYILLUM, pfnGetEntityIllum, (pEnt))
 	RETURN_API(int)
 }
 static edict_t* mm_FindEntityInSphere(edict_t* pEdictStartSearchAfter, const float* org, float rad) {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_FINDENTITYINSPHERE, pfnFindEntityInSphere, 2pf, (pEdictStartSearchAfter, org, rad))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_FINDENTITYINSPHERE, pfnFindEntityInSphere, (pEdictStartSearchAfter, org, rad))
 	RETURN_API(edict_t*)
 }
 static edict_t* mm_FindClientInPVS(edict_t* pEdict) {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_FINDCLIENTINPVS, pfnFindClientInPVS, p, (pEdict))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_FINDCLIENTINPVS, pfnFindClientInPVS, (pEdict))
 	RETURN_API(edict_t*)
 }
 static edict_t* mm_EntitiesInPVS(edict_t* pplayer) {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_ENTITIESINPVS, pfnEntitiesInPVS, p, (pplayer))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_ENTITIESINPVS, pfnEntitiesInPVS, (pplayer))
 	RETURN_API(edict_t*)
 }
 
 static void mm_MakeVectors(const float* rgflVector) {
-	META_ENGINE_HANDLE_void(FN_MAKEVECTORS, pfnMakeVectors, p, (rgflVector))
+	META_ENGINE_HANDLE_void(FN_MAKEVECTORS, pfnMakeVectors, (rgflVector))
 	RETURN_API_void()
 }
 static void mm_AngleVectors(const float* rgflVector, float* forward, float* right, float* up) {
-	META_ENGINE_HANDLE_void(FN_ANGLEVECTORS, pfnAngleVectors, 4p, (rgflVector, forward, right, up))
+	META_ENGINE_HANDLE_void(FN_ANGLEVECTORS, pfnAngleVectors, (rgflVector, forward, right, up))
 	RETURN_API_void()
 }
 
 static edict_t* mm_CreateEntity() {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_CREATEENTITY, pfnCreateEntity, void, (VOID_ARG))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_CREATEENTITY, pfnCreateEntity, ())
 	RETURN_API(edict_t*)
 }
 static void mm_RemoveEntity(edict_t* e) {
-	META_ENGINE_HANDLE_void(FN_REMOVEENTITY, pfnRemoveEntity, p, (e))
+	META_ENGINE_HANDLE_void(FN_REMOVEENTITY, pfnRemoveEntity, (e))
 	RETURN_API_void()
 }
 static edict_t* mm_CreateNamedEntity(int className) {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_CREATENAMEDENTITY, pfnCreateNamedEntity, i, (className))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_CREATENAMEDENTITY, pfnCreateNamedEntity, (className))
 	RETURN_API(edict_t*)
 }
 
 static void mm_MakeStatic(edict_t* ent) {
-	META_ENGINE_HANDLE_void(FN_MAKESTATIC, pfnMakeStatic, p, (ent))
+	META_ENGINE_HANDLE_void(FN_MAKESTATIC, pfnMakeStatic, (ent))
 	RETURN_API_void()
 }
 static int mm_EntIsOnFloor(edict_t* e) {
-	META_ENGINE_HANDLE(int, 0, FN_ENTISONFLOOR, pfnEntIsOnFloor, p, (e))
+	META_ENGINE_HANDLE(int, 0, FN_ENTISONFLOOR, pfnEntIsOnFloor, (e))
 	RETURN_API(int)
 }
 static int mm_DropToFloor(edict_t* e) {
-	META_ENGINE_HANDLE(int, 0, FN_DROPTOFLOOR, pfnDropToFloor, p, (e))
+	META_ENGINE_HANDLE(int, 0, FN_DROPTOFLOOR, pfnDropToFloor, (e))
 	RETURN_API(int)
 }
 
 static int mm_WalkMove(edict_t* ent, float yaw, float dist, int iMode) {
-	META_ENGINE_HANDLE(int, 0, FN_WALKMOVE, pfnWalkMove, p2fi, (ent, yaw, dist, iMode))
+	META_ENGINE_HANDLE(int, 0, FN_WALKMOVE, pfnWalkMove, (ent, yaw, dist, iMode))
 	RETURN_API(int)
 }
 static void mm_SetOrigin(edict_t* e, const float* rgflOrigin) {
-	META_ENGINE_HANDLE_void(FN_SETORIGIN, pfnSetOrigin, 2p, (e, rgflOrigin))
+	META_ENGINE_HANDLE_void(FN_SETORIGIN, pfnSetOrigin, (e, rgflOrigin))
 	RETURN_API_void()
 }
 
 static void mm_EmitSound(edict_t* entity, int channel, const char* sample, float volume, float attenuation, int fFlags, int pitch) {
-	META_ENGINE_HANDLE_void(FN_EMITSOUND, pfnEmitSound, pip2f2i, (entity, channel, sample, volume, attenuation, fFlags, pitch))
+	META_ENGINE_HANDLE_void(FN_EMITSOUND, pfnEmitSound, (entity, channel, sample, volume, attenuation, fFlags, pitch))
 	RETURN_API_void()
 }
 static void mm_EmitAmbientSound(edict_t* entity, float* pos, const char* samp, float vol, float attenuation, int fFlags, int pitch) {
-	META_ENGINE_HANDLE_void(FN_EMITAMBIENTSOUND, pfnEmitAmbientSound, 3p2f2i, (entity, pos, samp, vol, attenuation, fFlags, pitch))
+	META_ENGINE_HANDLE_void(FN_EMITAMBIENTSOUND, pfnEmitAmbientSound, (entity, pos, samp, vol, attenuation, fFlags, pitch))
 	RETURN_API_void()
 }
 
 static void mm_TraceLine(const float* v1, const float* v2, int fNoMonsters, edict_t* pentToSkip, TraceResult* ptr) {
-	META_ENGINE_HANDLE_void(FN_TRACELINE, pfnTraceLine, 2pi2p, (v1, v2, fNoMonsters, pentToSkip, ptr))
+	META_ENGINE_HANDLE_void(FN_TRACELINE, pfnTraceLine, (v1, v2, fNoMonsters, pentToSkip, ptr))
 	RETURN_API_void()
 }
 static void mm_TraceToss(edict_t* pent, edict_t* pentToIgnore, TraceResult* ptr) {
-	META_ENGINE_HANDLE_void(FN_TRACETOSS, pfnTraceToss, 3p, (pent, pentToIgnore, ptr))
+	META_ENGINE_HANDLE_void(FN_TRACETOSS, pfnTraceToss, (pent, pentToIgnore, ptr))
 	RETURN_API_void()
 }
 static int mm_TraceMonsterHull(edict_t* pEdict, const float* v1, const float* v2, int fNoMonsters, edict_t* pentToSkip, TraceResult* ptr) {
-	META_ENGINE_HANDLE(int, 0, FN_TRACEMONSTERHULL, pfnTraceMonsterHull, 3pi2p, (pEdict, v1, v2, fNoMonsters, pentToSkip, ptr))
+	META_ENGINE_HANDLE(int, 0, FN_TRACEMONSTERHULL, pfnTraceMonsterHull, (pEdict, v1, v2, fNoMonsters, pentToSkip, ptr))
 	RETURN_API(int)
 }
 static void mm_TraceHull(const float* v1, const float* v2, int fNoMonsters, int hullNumber, edict_t* pentToSkip, TraceResult* ptr) {
-	META_ENGINE_HANDLE_void(FN_TRACEHULL, pfnTraceHull, 2p2i2p, (v1, v2, fNoMonsters, hullNumber, pentToSkip, ptr))
+	META_ENGINE_HANDLE_void(FN_TRACEHULL, pfnTraceHull, (v1, v2, fNoMonsters, hullNumber, pentToSkip, ptr))
 	RETURN_API_void()
 }
 static void mm_TraceModel(const float* v1, const float* v2, int hullNumber, edict_t* pent, TraceResult* ptr) {
-	META_ENGINE_HANDLE_void(FN_TRACEMODEL, pfnTraceModel, 2pi2p, (v1, v2, hullNumber, pent, ptr))
+	META_ENGINE_HANDLE_void(FN_TRACEMODEL, pfnTraceModel, (v1, v2, hullNumber, pent, ptr))
 	RETURN_API_void()
 }
 static const char* mm_TraceTexture(edict_t* pTextureEntity, const float* v1, const float* v2) {
-	META_ENGINE_HANDLE(const char*, NULL, FN_TRACETEXTURE, pfnTraceTexture, 3p, (pTextureEntity, v1, v2))
+	META_ENGINE_HANDLE(const char*, NULL, FN_TRACETEXTURE, pfnTraceTexture, (pTextureEntity, v1, v2))
 	RETURN_API(const char*)
 }
 static void mm_TraceSphere(const float* v1, const float* v2, int fNoMonsters, float radius, edict_t* pentToSkip, TraceResult* ptr) {
-	META_ENGINE_HANDLE_void(FN_TRACESPHERE, pfnTraceSphere, 2pif2p, (v1, v2, fNoMonsters, radius, pentToSkip, ptr))
+	META_ENGINE_HANDLE_void(FN_TRACESPHERE, pfnTraceSphere, (v1, v2, fNoMonsters, radius, pentToSkip, ptr))
 	RETURN_API_void()
 }
 static void mm_GetAimVector(edict_t* ent, float speed, float* rgflReturn) {
-	META_ENGINE_HANDLE_void(FN_GETAIMVECTOR, pfnGetAimVector, pfp, (ent, speed, rgflReturn))
+	META_ENGINE_HANDLE_void(FN_GETAIMVECTOR, pfnGetAimVector, (ent, speed, rgflReturn))
 	RETURN_API_void()
 }
 
 static void mm_ServerCommand(char* str) {
-	META_ENGINE_HANDLE_void(FN_SERVERCOMMAND, pfnServerCommand, p, (str))
+	META_ENGINE_HANDLE_void(FN_SERVERCOMMAND, pfnServerCommand, (str))
 	RETURN_API_void()
 }
 static void mm_ServerExecute() {
-	META_ENGINE_HANDLE_void(FN_SERVEREXECUTE, pfnServerExecute, void, (VOID_ARG))
+	META_ENGINE_HANDLE_void(FN_SERVEREXECUTE, pfnServerExecute, ())
 	RETURN_API_void()
 }
 static void mm_engClientCommand(edict_t* pEdict, char* szFmt, ...) {
-	META_ENGINE_HANDLE_void_varargs(FN_CLIENTCOMMAND_ENG, pfnClientCommand, 2pV, pEdict, szFmt)
+	META_ENGINE_HANDLE_void_varargs(FN_CLIENTCOMMAND_ENG, pfnClientCommand, pEdict, szFmt)
 	RETURN_API_void()
 }
 
 static void mm_ParticleEffect(const float* org, const float* dir, float color, float count) {
-	META_ENGINE_HANDLE_void(FN_PARTICLEEFFECT, pfnParticleEffect, 2p2f, (org, dir, color, count))
+	META_ENGINE_HANDLE_void(FN_PARTICLEEFFECT, pfnParticleEffect, (org, dir, color, count))
 	RETURN_API_void()
 }
 static void mm_LightStyle(int style, char* val) {
-	META_ENGINE_HANDLE_void(FN_LIGHTSTYLE, pfnLightStyle, ip, (style, val))
+	META_ENGINE_HANDLE_void(FN_LIGHTSTYLE, pfnLightStyle, (style, val))
 	RETURN_API_void()
 }
 static int mm_DecalIndex(const char* name) {
-	META_ENGINE_HANDLE(int, 0, FN_DECALINDEX, pfnDecalIndex, p, (name))
+	META_ENGINE_HANDLE(int, 0, FN_DECALINDEX, pfnDecalIndex, (name))
 	RETURN_API(int)
 }
 static int mm_PointContents(const float* rgflVector) {
-	META_ENGINE_HANDLE(int, 0, FN_POINTCONTENTS, pfnPointContents, p, (rgflVector))
+	META_ENGINE_HANDLE(int, 0, FN_POINTCONTENTS, pfnPointContents, (rgflVector))
 	RETURN_API(int)
 }
 
+// Messages of types hooked with HOOK_USER_MSG are kept whole until
+// MessageEnd; see usermsg.h.
 static void mm_MessageBegin(int msg_dest, int msg_type, const float* pOrigin, edict_t* ed) {
-	META_ENGINE_HANDLE_void(FN_MESSAGEBEGIN, pfnMessageBegin, 2i2p, (msg_dest, msg_type, pOrigin, ed))
+	if (umsg_begin(msg_dest, msg_type, pOrigin, ed))
+		return;
+	META_ENGINE_HANDLE_void(FN_MESSAGEBEGIN, pfnMessageBegin, (msg_dest, msg_type, pOrigin, ed))
 	RETURN_API_void()
 }
 static void mm_MessageEnd() {
-	META_ENGINE_HANDLE_void(FN_MESSAGEEND, pfnMessageEnd, void, (VOID_ARG))
+	if (unlikely(umsg_capturing)) {
+		umsg_end();
+		return;
+	}
+	META_ENGINE_HANDLE_void(FN_MESSAGEEND, pfnMessageEnd, ())
 	RETURN_API_void()
 }
 
 static void mm_WriteByte(int iValue) {
-	META_ENGINE_HANDLE_void(FN_WRITEBYTE, pfnWriteByte, i, (iValue))
+	if (unlikely(umsg_capturing)) {
+		umsg_write(UMSG_BYTE, iValue);
+		return;
+	}
+	META_ENGINE_HANDLE_void(FN_WRITEBYTE, pfnWriteByte, (iValue))
 	RETURN_API_void()
 }
 static void mm_WriteChar(int iValue) {
-	META_ENGINE_HANDLE_void(FN_WRITECHAR, pfnWriteChar, i, (iValue))
+	if (unlikely(umsg_capturing)) {
+		umsg_write(UMSG_CHAR, iValue);
+		return;
+	}
+	META_ENGINE_HANDLE_void(FN_WRITECHAR, pfnWriteChar, (iValue))
 	RETURN_API_void()
 }
 static void mm_WriteShort(int iValue) {
-	META_ENGINE_HANDLE_void(FN_WRITESHORT, pfnWriteShort, i, (iValue))
+	if (unlikely(umsg_capturing)) {
+		umsg_write(UMSG_SHORT, iValue);
+		return;
+	}
+	META_ENGINE_HANDLE_void(FN_WRITESHORT, pfnWriteShort, (iValue))
 	RETURN_API_void()
 }
 static void mm_WriteLong(int iValue) {
-	META_ENGINE_HANDLE_void(FN_WRITELONG, pfnWriteLong, i, (iValue))
+	if (unlikely(umsg_capturing)) {
+		umsg_write(UMSG_LONG, iValue);
+		return;
+	}
+	META_ENGINE_HANDLE_void(FN_WRITELONG, pfnWriteLong, (iValue))
 	RETURN_API_void()
 }
 static void mm_WriteAngle(float flValue) {
-	META_ENGINE_HANDLE_void(FN_WRITEANGLE, pfnWriteAngle, f, (flValue))
+	if (unlikely(umsg_capturing)) {
+		umsg_write(UMSG_ANGLE, flValue);
+		return;
+	}
+	META_ENGINE_HANDLE_void(FN_WRITEANGLE, pfnWriteAngle, (flValue))
 	RETURN_API_void()
 }
 static void mm_WriteCoord(float flValue) {
-	META_ENGINE_HANDLE_void(FN_WRITECOORD, pfnWriteCoord, f, (flValue))
+	if (unlikely(umsg_capturing)) {
+		umsg_write(UMSG_COORD, flValue);
+		return;
+	}
+	META_ENGINE_HANDLE_void(FN_WRITECOORD, pfnWriteCoord, (flValue))
 	RETURN_API_void()
 }
 static void mm_WriteString(const char* sz) {
-	META_ENGINE_HANDLE_void(FN_WRITESTRING, pfnWriteString, p, (sz))
+	if (unlikely(umsg_capturing)) {
+		umsg_write(sz);
+		return;
+	}
+	META_ENGINE_HANDLE_void(FN_WRITESTRING, pfnWriteString, (sz))
 	RETURN_API_void()
 }
 static void mm_WriteEntity(int iValue) {
-	META_ENGINE_HANDLE_void(FN_WRITEENTITY, pfnWriteEntity, i, (iValue))
+	if (unlikely(umsg_capturing)) {
+		umsg_write(UMSG_ENTITY, iValue);
+		return;
+	}
+	META_ENGINE_HANDLE_void(FN_WRITEENTITY, pfnWriteEntity, (iValue))
 	RETURN_API_void()
 }
 
 static void mm_CVarRegister(cvar_t* pCvar) {
-	META_ENGINE_HANDLE_void(FN_CVARREGISTER, pfnCVarRegister, p, (pCvar))
+	META_ENGINE_HANDLE_void(FN_CVARREGISTER, pfnCVarRegister, (pCvar))
 	RETURN_API_void()
 }
 static float mm_CVarGetFloat(const char* szVarName) {
-	META_ENGINE_HANDLE(float, 0.0f, FN_CVARGETFLOAT, pfnCVarGetFloat, p, (szVarName))
+	META_ENGINE_HANDLE(float, 0.0f, FN_CVARGETFLOAT, pfnCVarGetFloat, (szVarName))
 	RETURN_API(float)
 }
 static const char* mm_CVarGetString(const char* szVarName) {
-	META_ENGINE_HANDLE(const char*, NULL, FN_CVARGETSTRING, pfnCVarGetString, p, (szVarName))
+	META_ENGINE_HANDLE(const char*, NULL, FN_CVARGETSTRING, pfnCVarGetString, (szVarName))
 	RETURN_API(const char*)
 }
 static void mm_CVarSetFloat(const char* szVarName, float flValue) {
-	META_ENGINE_HANDLE_void(FN_CVARSETFLOAT, pfnCVarSetFloat, pf, (szVarName, flValue))
+	META_ENGINE_HANDLE_void(FN_CVARSETFLOAT, pfnCVarSetFloat, (szVarName, flValue))
 
 	meta_debug_value = static_cast<int>(meta_debug.value);
 
 	RETURN_API_void()
 }
 static void mm_CVarSetString(const char* szVarName, const char* szValue) {
-	META_ENGINE_HANDLE_void(FN_CVARSETSTRING, pfnCVarSetString, 2p, (szVarName, szValue))
+	META_ENGINE_HANDLE_void(FN_CVARSETSTRING, pfnCVarSetString, (szVarName, szValue))
 
 	meta_debug_value = static_cast<int>(meta_debug.value);
 
 	RETURN_API_void()
 }
 
+// Whether the engine would print an alert of this type.  It drops all
+// but at_logged when "developer" is 0, and at_aiconsole when it's below 2.
+static bool DLLINTERNAL alert_printed(const ALERT_TYPE atype) {
+	if (atype == at_logged)
+		return true;
+	const cvar_t* developer = developer_cvar();
+	if (unlikely(!developer))
+		return true;
+	return developer->value >= ((atype == at_aiconsole) ? 2.0f : 1.0f);
+}
+
 static void mm_AlertMessage(ALERT_TYPE atype, const char* szFmt, ...) {
-	META_ENGINE_HANDLE_void_varargs(FN_ALERTMESSAGE, pfnAlertMessage, ipV, atype, szFmt)
+	// With no plugin hooking it, don't format an alert the engine would
+	// drop anyway; some games send thousands of them per map.
+	if (Hooks->mode(e_api_engine, offsetof(enginefuncs_t, pfnAlertMessage)) == HM_DIRECT && !alert_printed(atype))
+		return;
+	META_ENGINE_HANDLE_void_varargs(FN_ALERTMESSAGE, pfnAlertMessage, atype, szFmt)
 	RETURN_API_void()
 }
 #ifdef HLSDK_3_2_OLD_EIFACE
@@ -394,7 +491,7 @@ static void mm_EngineFprintf(FILE* pfile, char* szFmt, ...) {
 #else
 static void mm_EngineFprintf(void* pfile, char* szFmt, ...) {
 #endif
-	META_ENGINE_HANDLE_void_varargs(FN_ENGINEFPRINTF, pfnEngineFprintf, 2pV, pfile, szFmt)
+	META_ENGINE_HANDLE_void_varargs(FN_ENGINEFPRINTF, pfnEngineFprintf, pfile, szFmt)
 	RETURN_API_void()
 }
 
@@ -403,66 +500,66 @@ static void* mm_PvAllocEntPrivateData(edict_t * pEdict, long cb) {
 #else
 static void* mm_PvAllocEntPrivateData(edict_t * pEdict, int32 cb) {
 #endif
-	META_ENGINE_HANDLE(void*, NULL, FN_PVALLOCENTPRIVATEDATA, pfnPvAllocEntPrivateData, pi, (pEdict, cb))
+	META_ENGINE_HANDLE(void*, NULL, FN_PVALLOCENTPRIVATEDATA, pfnPvAllocEntPrivateData, (pEdict, cb))
 	RETURN_API(void*)
 }
 static void* mm_PvEntPrivateData(edict_t * pEdict) {
-	META_ENGINE_HANDLE(void*, NULL, FN_PVENTPRIVATEDATA, pfnPvEntPrivateData, p, (pEdict))
+	META_ENGINE_HANDLE(void*, NULL, FN_PVENTPRIVATEDATA, pfnPvEntPrivateData, (pEdict))
 	RETURN_API(void*)
 }
 static void mm_FreeEntPrivateData(edict_t * pEdict) {
-	META_ENGINE_HANDLE_void(FN_FREEENTPRIVATEDATA, pfnFreeEntPrivateData, p, (pEdict))
+	META_ENGINE_HANDLE_void(FN_FREEENTPRIVATEDATA, pfnFreeEntPrivateData, (pEdict))
 	RETURN_API_void()
 }
 
 static const char* mm_SzFromIndex(int iString) {
-	META_ENGINE_HANDLE(const char*, NULL, FN_SZFROMINDEX, pfnSzFromIndex, i, (iString))
+	META_ENGINE_HANDLE(const char*, NULL, FN_SZFROMINDEX, pfnSzFromIndex, (iString))
 	RETURN_API(const char*)
 }
 static int mm_AllocString(const char* szValue) {
-	META_ENGINE_HANDLE(int, 0, FN_ALLOCSTRING, pfnAllocString, p, (szValue))
+	META_ENGINE_HANDLE(int, 0, FN_ALLOCSTRING, pfnAllocString, (szValue))
 	RETURN_API(int)
 }
 
 static entvars_s* mm_GetVarsOfEnt(edict_t * pEdict) {
-	META_ENGINE_HANDLE(struct entvars_s*, NULL, FN_GETVARSOFENT, pfnGetVarsOfEnt, p, (pEdict))
+	META_ENGINE_HANDLE(struct entvars_s*, NULL, FN_GETVARSOFENT, pfnGetVarsOfEnt, (pEdict))
 	RETURN_API(entvars_s*)
 }
 static edict_t* mm_PEntityOfEntOffset(int iEntOffset) {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_PENTITYOFENTOFFSET, pfnPEntityOfEntOffset, i, (iEntOffset))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_PENTITYOFENTOFFSET, pfnPEntityOfEntOffset, (iEntOffset))
 	RETURN_API(edict_t*)
 }
 static int mm_EntOffsetOfPEntity(const edict_t * pEdict) {
-	META_ENGINE_HANDLE(int, 0, FN_ENTOFFSETOFPENTITY, pfnEntOffsetOfPEntity, p, (pEdict))
+	META_ENGINE_HANDLE(int, 0, FN_ENTOFFSETOFPENTITY, pfnEntOffsetOfPEntity, (pEdict))
 	RETURN_API(int)
 }
 static int mm_IndexOfEdict(const edict_t * pEdict) {
-	META_ENGINE_HANDLE(int, 0, FN_INDEXOFEDICT, pfnIndexOfEdict, p, (pEdict))
+	META_ENGINE_HANDLE(int, 0, FN_INDEXOFEDICT, pfnIndexOfEdict, (pEdict))
 	RETURN_API(int)
 }
 static edict_t* mm_PEntityOfEntIndex(int iEntIndex) {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_PENTITYOFENTINDEX, pfnPEntityOfEntIndex, i, (iEntIndex))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_PENTITYOFENTINDEX, pfnPEntityOfEntIndex, (iEntIndex))
 	RETURN_API(edict_t*)
 }
 static edict_t* mm_FindEntityByVars(entvars_s* pvars) {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_FINDENTITYBYVARS, pfnFindEntityByVars, p, (pvars))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_FINDENTITYBYVARS, pfnFindEntityByVars, (pvars))
 	RETURN_API(edict_t*)
 }
 static void* mm_GetModelPtr(edict_t * pEdict) {
-	META_ENGINE_HANDLE(void*, NULL, FN_GETMODELPTR, pfnGetModelPtr, p, (pEdict))
+	META_ENGINE_HANDLE(void*, NULL, FN_GETMODELPTR, pfnGetModelPtr, (pEdict))
 	RETURN_API(void*)
 }
 
 static int mm_RegUserMsg(const char* pszName, int iSize) {
-	META_ENGINE_HANDLE(int, 0, FN_REGUSERMSG, pfnRegUserMsg, pi, (pszName, iSize))
+	META_ENGINE_HANDLE(int, 0, FN_REGUSERMSG, pfnRegUserMsg, (pszName, iSize))
 	// Expand the macro, since we need to do extra work.
 	/// RETURN_API(int)
-	const int imsgid = GET_RET_CLASS(ret_val, int);
+	const int imsgid = ret_val;
 
 	// Add the msgid, name, and size to our saved list, if we haven't
 	// already.
 	MRegMsg* nmsg = RegMsgs->find(imsgid);
-	if (nmsg) {
+	if (nmsg && !nmsg->is_builtin()) {
 		if (nmsg->name && nmsg->name[0] && FStrEq(pszName, nmsg->name))
 			// This name/msgid pair was already registered.
 			META_DEBUG(3, ("user message registered again: name=%s, msgid=%d", pszName, imsgid));
@@ -471,8 +568,7 @@ static int mm_RegUserMsg(const char* pszName, int iSize) {
 			// the actual name.  This is normal for some mods (e.g. DoD)
 			// that register message IDs before assigning names.
 			META_DEBUG(3, ("user message id updated with name: msgid=%d, name=%s", imsgid, pszName));
-			nmsg->name = pszName;
-			nmsg->size = iSize;
+			RegMsgs->rename(nmsg, pszName, iSize);
 		}
 		else
 			// This msgid was previously used by a different message name.
@@ -484,22 +580,22 @@ static int mm_RegUserMsg(const char* pszName, int iSize) {
 }
 
 static void mm_AnimationAutomove(const edict_t * pEdict, float flTime) {
-	META_ENGINE_HANDLE_void(FN_ANIMATIONAUTOMOVE, pfnAnimationAutomove, pf, (pEdict, flTime))
+	META_ENGINE_HANDLE_void(FN_ANIMATIONAUTOMOVE, pfnAnimationAutomove, (pEdict, flTime))
 	RETURN_API_void()
 }
 static void mm_GetBonePosition(const edict_t * pEdict, int iBone, float* rgflOrigin, float* rgflAngles) {
-	META_ENGINE_HANDLE_void(FN_GETBONEPOSITION, pfnGetBonePosition, pi2p, (pEdict, iBone, rgflOrigin, rgflAngles))
+	META_ENGINE_HANDLE_void(FN_GETBONEPOSITION, pfnGetBonePosition, (pEdict, iBone, rgflOrigin, rgflAngles))
 	RETURN_API_void()
 }
 
 #ifdef HLSDK_3_2_OLD_EIFACE
 static unsigned long mm_FunctionFromName(const char* pName) {
-	META_ENGINE_HANDLE(unsigned long, 0, FN_FUNCTIONFROMNAME, pfnFunctionFromName, p, (pName));
+	META_ENGINE_HANDLE(unsigned long, 0, FN_FUNCTIONFROMNAME, pfnFunctionFromName, (pName));
 	RETURN_API(unsigned long)
 }
 #else
 static uint32 mm_FunctionFromName(const char* pName) {
-	META_ENGINE_HANDLE(uint32, 0, FN_FUNCTIONFROMNAME, pfnFunctionFromName, p, (pName))
+	META_ENGINE_HANDLE(uint32, 0, FN_FUNCTIONFROMNAME, pfnFunctionFromName, (pName))
 	RETURN_API(uint32)
 }
 #endif
@@ -508,272 +604,272 @@ static const char* mm_NameForFunction(unsigned long function) {
 #else
 static const char* mm_NameForFunction(uint32 function) {
 #endif
-	META_ENGINE_HANDLE(const char*, NULL, FN_NAMEFORFUNCTION, pfnNameForFunction, ui, (function))
+	META_ENGINE_HANDLE(const char*, NULL, FN_NAMEFORFUNCTION, pfnNameForFunction, (function))
 	RETURN_API(const char*)
 }
 
 //! JOHN: engine callbacks so game DLL can print messages to individual clients
 static void mm_ClientPrintf(edict_t * pEdict, PRINT_TYPE ptype, const char* szMsg) {
-	META_ENGINE_HANDLE_void(FN_CLIENTPRINTF, pfnClientPrintf, pip, (pEdict, ptype, szMsg))
+	META_ENGINE_HANDLE_void(FN_CLIENTPRINTF, pfnClientPrintf, (pEdict, ptype, szMsg))
 	RETURN_API_void()
 }
 static void mm_ServerPrint(const char* szMsg) {
-	META_ENGINE_HANDLE_void(FN_SERVERPRINT, pfnServerPrint, p, (szMsg))
+	META_ENGINE_HANDLE_void(FN_SERVERPRINT, pfnServerPrint, (szMsg))
 	RETURN_API_void()
 }
 
 //! these 3 added so game DLL can easily access client 'cmd' strings
 static const char* mm_Cmd_Args() {
-	META_ENGINE_HANDLE(const char*, NULL, FN_CMD_ARGS, pfnCmd_Args, void, (VOID_ARG))
+	META_ENGINE_HANDLE(const char*, NULL, FN_CMD_ARGS, pfnCmd_Args, ())
 	RETURN_API(const char*)
 }
 static const char* mm_Cmd_Argv(int argc) {
-	META_ENGINE_HANDLE(const char*, NULL, FN_CMD_ARGV, pfnCmd_Argv, i, (argc))
+	META_ENGINE_HANDLE(const char*, NULL, FN_CMD_ARGV, pfnCmd_Argv, (argc))
 	RETURN_API(const char*)
 }
 static int mm_Cmd_Argc() {
-	META_ENGINE_HANDLE(int, 0, FN_CMD_ARGC, pfnCmd_Argc, void, (VOID_ARG))
+	META_ENGINE_HANDLE(int, 0, FN_CMD_ARGC, pfnCmd_Argc, ())
 	RETURN_API(int)
 }
 
 static void mm_GetAttachment(const edict_t * pEdict, int iAttachment, float* rgflOrigin, float* rgflAngles) {
-	META_ENGINE_HANDLE_void(FN_GETATTACHMENT, pfnGetAttachment, pi2p, (pEdict, iAttachment, rgflOrigin, rgflAngles))
+	META_ENGINE_HANDLE_void(FN_GETATTACHMENT, pfnGetAttachment, (pEdict, iAttachment, rgflOrigin, rgflAngles))
 	RETURN_API_void()
 }
 
 static void mm_CRC32_Init(CRC32_t * pulCRC) {
-	META_ENGINE_HANDLE_void(FN_CRC32_INIT, pfnCRC32_Init, p, (pulCRC))
+	META_ENGINE_HANDLE_void(FN_CRC32_INIT, pfnCRC32_Init, (pulCRC))
 	RETURN_API_void()
 }
 static void mm_CRC32_ProcessBuffer(CRC32_t * pulCRC, void* p, int len) {
-	META_ENGINE_HANDLE_void(FN_CRC32_PROCESSBUFFER, pfnCRC32_ProcessBuffer, 2pi, (pulCRC, p, len))
+	META_ENGINE_HANDLE_void(FN_CRC32_PROCESSBUFFER, pfnCRC32_ProcessBuffer, (pulCRC, p, len))
 	RETURN_API_void()
 }
 static void mm_CRC32_ProcessByte(CRC32_t * pulCRC, unsigned char ch) {
-	META_ENGINE_HANDLE_void(FN_CRC32_PROCESSBYTE, pfnCRC32_ProcessByte, puc, (pulCRC, ch))
+	META_ENGINE_HANDLE_void(FN_CRC32_PROCESSBYTE, pfnCRC32_ProcessByte, (pulCRC, ch))
 	RETURN_API_void()
 }
 static CRC32_t mm_CRC32_Final(CRC32_t pulCRC) {
-	META_ENGINE_HANDLE(CRC32_t, 0, FN_CRC32_FINAL, pfnCRC32_Final, ul, (pulCRC))
+	META_ENGINE_HANDLE(CRC32_t, 0, FN_CRC32_FINAL, pfnCRC32_Final, (pulCRC))
 	RETURN_API(CRC32_t)
 }
 
 #ifdef HLSDK_3_2_OLD_EIFACE
 static long mm_RandomLong(long lLow, long lHigh) {
-	META_ENGINE_HANDLE(long, 0, FN_RANDOMLONG, pfnRandomLong, 2i, (lLow, lHigh));
+	META_ENGINE_HANDLE(long, 0, FN_RANDOMLONG, pfnRandomLong, (lLow, lHigh));
 	RETURN_API(long)
 }
 #else
 static int32 mm_RandomLong(int32 lLow, int32 lHigh) {
-	META_ENGINE_HANDLE(int32, 0, FN_RANDOMLONG, pfnRandomLong, 2i, (lLow, lHigh))
+	META_ENGINE_HANDLE(int32, 0, FN_RANDOMLONG, pfnRandomLong, (lLow, lHigh))
 	RETURN_API(int32)
 }
 #endif
 static float mm_RandomFloat(float flLow, float flHigh) {
-	META_ENGINE_HANDLE(float, 0.0, FN_RANDOMFLOAT, pfnRandomFloat, 2f, (flLow, flHigh))
+	META_ENGINE_HANDLE(float, 0.0, FN_RANDOMFLOAT, pfnRandomFloat, (flLow, flHigh))
 	RETURN_API(float)
 }
 
 static void mm_SetView(const edict_t * pClient, const edict_t * pViewent) {
-	META_ENGINE_HANDLE_void(FN_SETVIEW, pfnSetView, 2p, (pClient, pViewent))
+	META_ENGINE_HANDLE_void(FN_SETVIEW, pfnSetView, (pClient, pViewent))
 	RETURN_API_void()
 }
 static float mm_Time() {
-	META_ENGINE_HANDLE(float, 0.0, FN_TIME, pfnTime, void, (VOID_ARG))
+	META_ENGINE_HANDLE(float, 0.0, FN_TIME, pfnTime, ())
 	RETURN_API(float)
 }
 static void mm_CrosshairAngle(const edict_t * pClient, float pitch, float yaw) {
-	META_ENGINE_HANDLE_void(FN_CROSSHAIRANGLE, pfnCrosshairAngle, p2f, (pClient, pitch, yaw))
+	META_ENGINE_HANDLE_void(FN_CROSSHAIRANGLE, pfnCrosshairAngle, (pClient, pitch, yaw))
 	RETURN_API_void()
 }
 
 static byte* mm_LoadFileForMe(char* filename, int* pLength) {
-	META_ENGINE_HANDLE(byte*, NULL, FN_LOADFILEFORME, pfnLoadFileForMe, 2p, (filename, pLength))
+	META_ENGINE_HANDLE(byte*, NULL, FN_LOADFILEFORME, pfnLoadFileForMe, (filename, pLength))
 	RETURN_API(byte*)
 }
 static void mm_FreeFile(void* buffer) {
-	META_ENGINE_HANDLE_void(FN_FREEFILE, pfnFreeFile, p, (buffer))
+	META_ENGINE_HANDLE_void(FN_FREEFILE, pfnFreeFile, (buffer))
 	RETURN_API_void()
 }
 
 //! trigger_endsection
 static void mm_EndSection(const char* pszSectionName) {
-	META_ENGINE_HANDLE_void(FN_ENDSECTION, pfnEndSection, p, (pszSectionName))
+	META_ENGINE_HANDLE_void(FN_ENDSECTION, pfnEndSection, (pszSectionName))
 	RETURN_API_void()
 }
 static int mm_CompareFileTime(char* filename1, char* filename2, int* iCompare) {
-	META_ENGINE_HANDLE(int, 0, FN_COMPAREFILETIME, pfnCompareFileTime, 3p, (filename1, filename2, iCompare))
+	META_ENGINE_HANDLE(int, 0, FN_COMPAREFILETIME, pfnCompareFileTime, (filename1, filename2, iCompare))
 	RETURN_API(int)
 }
 static void mm_GetGameDir(char* szGetGameDir) {
-	META_ENGINE_HANDLE_void(FN_GETGAMEDIR, pfnGetGameDir, p, (szGetGameDir))
+	META_ENGINE_HANDLE_void(FN_GETGAMEDIR, pfnGetGameDir, (szGetGameDir))
 	RETURN_API_void()
 }
 static void mm_Cvar_RegisterVariable(cvar_t * variable) {
-	META_ENGINE_HANDLE_void(FN_CVAR_REGISTERVARIABLE, pfnCvar_RegisterVariable, p, (variable))
+	META_ENGINE_HANDLE_void(FN_CVAR_REGISTERVARIABLE, pfnCvar_RegisterVariable, (variable))
 	RETURN_API_void()
 }
 static void mm_FadeClientVolume(const edict_t * pEdict, int fadePercent, int fadeOutSeconds, int holdTime, int fadeInSeconds) {
-	META_ENGINE_HANDLE_void(FN_FADECLIENTVOLUME, pfnFadeClientVolume, p4i, (pEdict, fadePercent, fadeOutSeconds, holdTime, fadeInSeconds))
+	META_ENGINE_HANDLE_void(FN_FADECLIENTVOLUME, pfnFadeClientVolume, (pEdict, fadePercent, fadeOutSeconds, holdTime, fadeInSeconds))
 	RETURN_API_void()
 }
 static void mm_SetClientMaxspeed(const edict_t * pEdict, float fNewMaxspeed) {
-	META_ENGINE_HANDLE_void(FN_SETCLIENTMAXSPEED, pfnSetClientMaxspeed, pf, (pEdict, fNewMaxspeed))
+	META_ENGINE_HANDLE_void(FN_SETCLIENTMAXSPEED, pfnSetClientMaxspeed, (pEdict, fNewMaxspeed))
 	RETURN_API_void()
 }
 //! returns NULL if fake client can't be created
 static edict_t* mm_CreateFakeClient(const char* netname) {
-	META_ENGINE_HANDLE(edict_t*, NULL, FN_CREATEFAKECLIENT, pfnCreateFakeClient, p, (netname))
+	META_ENGINE_HANDLE(edict_t*, NULL, FN_CREATEFAKECLIENT, pfnCreateFakeClient, (netname))
 	RETURN_API(edict_t*)
 }
 static void mm_RunPlayerMove(edict_t * fakeclient, const float* viewangles, float forwardmove, float sidemove, float upmove, unsigned short buttons, byte impulse, byte msec) {
-	META_ENGINE_HANDLE_void(FN_RUNPLAYERMOVE, pfnRunPlayerMove, 2p3fus2uc, (fakeclient, viewangles, forwardmove, sidemove, upmove, buttons, impulse, msec))
+	META_ENGINE_HANDLE_void(FN_RUNPLAYERMOVE, pfnRunPlayerMove, (fakeclient, viewangles, forwardmove, sidemove, upmove, buttons, impulse, msec))
 	RETURN_API_void()
 }
 static int mm_NumberOfEntities() {
-	META_ENGINE_HANDLE(int, 0, FN_NUMBEROFENTITIES, pfnNumberOfEntities, void, (VOID_ARG))
+	META_ENGINE_HANDLE(int, 0, FN_NUMBEROFENTITIES, pfnNumberOfEntities, ())
 	RETURN_API(int)
 }
 
 //! passing in NULL gets the serverinfo
 static char* mm_GetInfoKeyBuffer(edict_t * e) {
-	META_ENGINE_HANDLE(char*, NULL, FN_GETINFOKEYBUFFER, pfnGetInfoKeyBuffer, p, (e))
+	META_ENGINE_HANDLE(char*, NULL, FN_GETINFOKEYBUFFER, pfnGetInfoKeyBuffer, (e))
 	RETURN_API(char*)
 }
 static char* mm_InfoKeyValue(char* infobuffer, char* key) {
-	META_ENGINE_HANDLE(char*, NULL, FN_INFOKEYVALUE, pfnInfoKeyValue, 2p, (infobuffer, key))
+	META_ENGINE_HANDLE(char*, NULL, FN_INFOKEYVALUE, pfnInfoKeyValue, (infobuffer, key))
 	RETURN_API(char*)
 }
 static void mm_SetKeyValue(char* infobuffer, char* key, char* value) {
-	META_ENGINE_HANDLE_void(FN_SETKEYVALUE, pfnSetKeyValue, 3p, (infobuffer, key, value))
+	META_ENGINE_HANDLE_void(FN_SETKEYVALUE, pfnSetKeyValue, (infobuffer, key, value))
 	RETURN_API_void()
 }
 static void mm_SetClientKeyValue(int clientIndex, char* infobuffer, char* key, char* value) {
-	META_ENGINE_HANDLE_void(FN_SETCLIENTKEYVALUE, pfnSetClientKeyValue, i3p, (clientIndex, infobuffer, key, value))
+	META_ENGINE_HANDLE_void(FN_SETCLIENTKEYVALUE, pfnSetClientKeyValue, (clientIndex, infobuffer, key, value))
 	RETURN_API_void()
 }
 
 static int mm_IsMapValid(char* filename) {
-	META_ENGINE_HANDLE(int, 0, FN_ISMAPVALID, pfnIsMapValid, p, (filename))
+	META_ENGINE_HANDLE(int, 0, FN_ISMAPVALID, pfnIsMapValid, (filename))
 	RETURN_API(int)
 }
 static void mm_StaticDecal(const float* origin, int decalIndex, int entityIndex, int modelIndex) {
-	META_ENGINE_HANDLE_void(FN_STATICDECAL, pfnStaticDecal, p3i, (origin, decalIndex, entityIndex, modelIndex))
+	META_ENGINE_HANDLE_void(FN_STATICDECAL, pfnStaticDecal, (origin, decalIndex, entityIndex, modelIndex))
 	RETURN_API_void()
 }
 static int mm_PrecacheGeneric(char* s) {
-	META_ENGINE_HANDLE(int, 0, FN_PRECACHEGENERIC, pfnPrecacheGeneric, p, (s))
+	META_ENGINE_HANDLE(int, 0, FN_PRECACHEGENERIC, pfnPrecacheGeneric, (s))
 	RETURN_API(int)
 }
 //! returns the server assigned userid for this player. useful for logging frags, etc. returns -1 if the edict couldn't be found in the list of clients
 static int mm_GetPlayerUserId(edict_t * e) {
-	META_ENGINE_HANDLE(int, 0, FN_GETPLAYERUSERID, pfnGetPlayerUserId, p, (e))
+	META_ENGINE_HANDLE(int, 0, FN_GETPLAYERUSERID, pfnGetPlayerUserId, (e))
 	RETURN_API(int)
 }
 static void mm_BuildSoundMsg(edict_t * entity, int channel, const char* sample, float volume, float attenuation, int fFlags, int pitch, int msg_dest, int msg_type, const float* pOrigin, edict_t * ed)
 {
-	META_ENGINE_HANDLE_void(FN_BUILDSOUNDMSG, pfnBuildSoundMsg, pip2f4i2p, (entity, channel, sample, volume, attenuation, fFlags, pitch, msg_dest, msg_type, pOrigin, ed))
+	META_ENGINE_HANDLE_void(FN_BUILDSOUNDMSG, pfnBuildSoundMsg, (entity, channel, sample, volume, attenuation, fFlags, pitch, msg_dest, msg_type, pOrigin, ed))
 	RETURN_API_void()
 }
 //! is this a dedicated server?
 static int mm_IsDedicatedServer() {
-	META_ENGINE_HANDLE(int, 0, FN_ISDEDICATEDSERVER, pfnIsDedicatedServer, void, (VOID_ARG))
+	META_ENGINE_HANDLE(int, 0, FN_ISDEDICATEDSERVER, pfnIsDedicatedServer, ())
 	RETURN_API(int)
 }
 static cvar_t* mm_CVarGetPointer(const char* szVarName) {
-	META_ENGINE_HANDLE(cvar_t*, NULL, FN_CVARGETPOINTER, pfnCVarGetPointer, p, (szVarName))
+	META_ENGINE_HANDLE(cvar_t*, NULL, FN_CVARGETPOINTER, pfnCVarGetPointer, (szVarName))
 	RETURN_API(cvar_t*)
 }
 //! returns the server assigned WONid for this player. useful for logging frags, etc. returns -1 if the edict couldn't be found in the list of clients
 static unsigned int mm_GetPlayerWONId(edict_t * e) {
-	META_ENGINE_HANDLE(unsigned int, 0, FN_GETPLAYERWONID, pfnGetPlayerWONId, p, (e))
+	META_ENGINE_HANDLE(unsigned int, 0, FN_GETPLAYERWONID, pfnGetPlayerWONId, (e))
 	RETURN_API(unsigned int)
 }
 
 //! YWB 8/1/99 TFF Physics additions
 static void mm_Info_RemoveKey(char* s, const char* key) {
-	META_ENGINE_HANDLE_void(FN_INFO_REMOVEKEY, pfnInfo_RemoveKey, 2p, (s, key))
+	META_ENGINE_HANDLE_void(FN_INFO_REMOVEKEY, pfnInfo_RemoveKey, (s, key))
 	RETURN_API_void()
 }
 static const char* mm_GetPhysicsKeyValue(const edict_t * pClient, const char* key) {
-	META_ENGINE_HANDLE(const char*, NULL, FN_GETPHYSICSKEYVALUE, pfnGetPhysicsKeyValue, 2p, (pClient, key))
+	META_ENGINE_HANDLE(const char*, NULL, FN_GETPHYSICSKEYVALUE, pfnGetPhysicsKeyValue, (pClient, key))
 	RETURN_API(const char*)
 }
 static void mm_SetPhysicsKeyValue(const edict_t * pClient, const char* key, const char* value) {
-	META_ENGINE_HANDLE_void(FN_SETPHYSICSKEYVALUE, pfnSetPhysicsKeyValue, 3p, (pClient, key, value))
+	META_ENGINE_HANDLE_void(FN_SETPHYSICSKEYVALUE, pfnSetPhysicsKeyValue, (pClient, key, value))
 	RETURN_API_void()
 }
 static const char* mm_GetPhysicsInfoString(const edict_t * pClient) {
-	META_ENGINE_HANDLE(const char*, NULL, FN_GETPHYSICSINFOSTRING, pfnGetPhysicsInfoString, p, (pClient))
+	META_ENGINE_HANDLE(const char*, NULL, FN_GETPHYSICSINFOSTRING, pfnGetPhysicsInfoString, (pClient))
 	RETURN_API(const char*)
 }
 static unsigned short mm_PrecacheEvent(int type, const char* psz) {
-	META_ENGINE_HANDLE(unsigned short, 0, FN_PRECACHEEVENT, pfnPrecacheEvent, ip, (type, psz))
+	META_ENGINE_HANDLE(unsigned short, 0, FN_PRECACHEEVENT, pfnPrecacheEvent, (type, psz))
 	RETURN_API(unsigned short)
 }
 static void mm_PlaybackEvent(int flags, const edict_t * pInvoker, unsigned short eventindex, float delay, float* origin, float* angles, float fparam1, float fparam2, int iparam1, int iparam2, int bparam1, int bparam2) {
-	META_ENGINE_HANDLE_void(FN_PLAYBACKEVENT, pfnPlaybackEvent, ipusf2p2f4i, (flags, pInvoker, eventindex, delay, origin, angles, fparam1, fparam2, iparam1, iparam2, bparam1, bparam2))
+	META_ENGINE_HANDLE_void(FN_PLAYBACKEVENT, pfnPlaybackEvent, (flags, pInvoker, eventindex, delay, origin, angles, fparam1, fparam2, iparam1, iparam2, bparam1, bparam2))
 	RETURN_API_void()
 }
 
 static unsigned char* mm_SetFatPVS(float* org) {
-	META_ENGINE_HANDLE(unsigned char*, nullptr, FN_SETFATPVS, pfnSetFatPVS, p, (org))
+	META_ENGINE_HANDLE(unsigned char*, nullptr, FN_SETFATPVS, pfnSetFatPVS, (org))
 	RETURN_API(unsigned char*)
 }
 static unsigned char* mm_SetFatPAS(float* org) {
-	META_ENGINE_HANDLE(unsigned char*, nullptr, FN_SETFATPAS, pfnSetFatPAS, p, (org))
+	META_ENGINE_HANDLE(unsigned char*, nullptr, FN_SETFATPAS, pfnSetFatPAS, (org))
 	RETURN_API(unsigned char*)
 }
 
 static int mm_CheckVisibility(const edict_t * entity, unsigned char* pset) {
-	META_ENGINE_HANDLE(int, 0, FN_CHECKVISIBILITY, pfnCheckVisibility, 2p, (entity, pset))
+	META_ENGINE_HANDLE(int, 0, FN_CHECKVISIBILITY, pfnCheckVisibility, (entity, pset))
 	RETURN_API(int)
 }
 
 static void mm_DeltaSetField(delta_s* pFields, const char* fieldname) {
-	META_ENGINE_HANDLE_void(FN_DELTASETFIELD, pfnDeltaSetField, 2p, (pFields, fieldname))
+	META_ENGINE_HANDLE_void(FN_DELTASETFIELD, pfnDeltaSetField, (pFields, fieldname))
 	RETURN_API_void()
 }
 static void mm_DeltaUnsetField(delta_s* pFields, const char* fieldname) {
-	META_ENGINE_HANDLE_void(FN_DELTAUNSETFIELD, pfnDeltaUnsetField, 2p, (pFields, fieldname))
+	META_ENGINE_HANDLE_void(FN_DELTAUNSETFIELD, pfnDeltaUnsetField, (pFields, fieldname))
 	RETURN_API_void()
 }
 static void mm_DeltaAddEncoder(char* name, void (*conditionalencode)(delta_s* pFields, const unsigned char* from, const unsigned char* to)) {
-	META_ENGINE_HANDLE_void(FN_DELTAADDENCODER, pfnDeltaAddEncoder, 2p, (name, (void*)conditionalencode))
+	META_ENGINE_HANDLE_void(FN_DELTAADDENCODER, pfnDeltaAddEncoder, (name, conditionalencode))
 	RETURN_API_void()
 }
 static int mm_GetCurrentPlayer() {
-	META_ENGINE_HANDLE(int, 0, FN_GETCURRENTPLAYER, pfnGetCurrentPlayer, void, (VOID_ARG))
+	META_ENGINE_HANDLE(int, 0, FN_GETCURRENTPLAYER, pfnGetCurrentPlayer, ())
 	RETURN_API(int)
 }
 static int mm_CanSkipPlayer(const edict_t * player) {
-	META_ENGINE_HANDLE(int, 0, FN_CANSKIPPLAYER, pfnCanSkipPlayer, p, (player))
+	META_ENGINE_HANDLE(int, 0, FN_CANSKIPPLAYER, pfnCanSkipPlayer, (player))
 	RETURN_API(int)
 }
 static int mm_DeltaFindField(delta_s* pFields, const char* fieldname) {
-	META_ENGINE_HANDLE(int, 0, FN_DELTAFINDFIELD, pfnDeltaFindField, 2p, (pFields, fieldname))
+	META_ENGINE_HANDLE(int, 0, FN_DELTAFINDFIELD, pfnDeltaFindField, (pFields, fieldname))
 	RETURN_API(int)
 }
 static void mm_DeltaSetFieldByIndex(delta_s* pFields, int fieldNumber) {
-	META_ENGINE_HANDLE_void(FN_DELTASETFIELDBYINDEX, pfnDeltaSetFieldByIndex, pi, (pFields, fieldNumber))
+	META_ENGINE_HANDLE_void(FN_DELTASETFIELDBYINDEX, pfnDeltaSetFieldByIndex, (pFields, fieldNumber))
 	RETURN_API_void()
 }
 static void mm_DeltaUnsetFieldByIndex(delta_s* pFields, int fieldNumber) {
-	META_ENGINE_HANDLE_void(FN_DELTAUNSETFIELDBYINDEX, pfnDeltaUnsetFieldByIndex, pi, (pFields, fieldNumber))
+	META_ENGINE_HANDLE_void(FN_DELTAUNSETFIELDBYINDEX, pfnDeltaUnsetFieldByIndex, (pFields, fieldNumber))
 	RETURN_API_void()
 }
 
 static void mm_SetGroupMask(int mask, int op) {
-	META_ENGINE_HANDLE_void(FN_SETGROUPMASK, pfnSetGroupMask, 2i, (mask, op))
+	META_ENGINE_HANDLE_void(FN_SETGROUPMASK, pfnSetGroupMask, (mask, op))
 	RETURN_API_void()
 }
 
 static int mm_engCreateInstancedBaseline(int classname, entity_state_s* baseline) {
-	META_ENGINE_HANDLE(int, 0, FN_CREATEINSTANCEDBASELINE, pfnCreateInstancedBaseline, ip, (classname, baseline))
+	META_ENGINE_HANDLE(int, 0, FN_CREATEINSTANCEDBASELINE, pfnCreateInstancedBaseline, (classname, baseline))
 	RETURN_API(int)
 }
 static void mm_Cvar_DirectSet(cvar_s* var, char* value) {
-	META_ENGINE_HANDLE_void(FN_CVAR_DIRECTSET, pfnCvar_DirectSet, 2p, (var, value))
+	META_ENGINE_HANDLE_void(FN_CVAR_DIRECTSET, pfnCvar_DirectSet, (var, value))
 
 	meta_debug_value = static_cast<int>(meta_debug.value);
 
@@ -784,17 +880,17 @@ static void mm_Cvar_DirectSet(cvar_s* var, char* value) {
 //!( e.g., a player model ).
 //! Calling this has no effect in single player
 static void mm_ForceUnmodified(FORCE_TYPE type, float* mins, float* maxs, const char* filename) {
-	META_ENGINE_HANDLE_void(FN_FORCEUNMODIFIED, pfnForceUnmodified, i3p, (type, mins, maxs, filename))
+	META_ENGINE_HANDLE_void(FN_FORCEUNMODIFIED, pfnForceUnmodified, (type, mins, maxs, filename))
 	RETURN_API_void()
 }
 
 static void mm_GetPlayerStats(const edict_t * pClient, int* ping, int* packet_loss) {
-	META_ENGINE_HANDLE_void(FN_GETPLAYERSTATS, pfnGetPlayerStats, 3p, (pClient, ping, packet_loss))
+	META_ENGINE_HANDLE_void(FN_GETPLAYERSTATS, pfnGetPlayerStats, (pClient, ping, packet_loss))
 	RETURN_API_void()
 }
 
 static void mm_AddServerCommand(char* cmd_name, void (*function) ()) {
-	META_ENGINE_HANDLE_void(FN_ADDSERVERCOMMAND, pfnAddServerCommand, 2p, (cmd_name, (void*)function))
+	META_ENGINE_HANDLE_void(FN_ADDSERVERCOMMAND, pfnAddServerCommand, (cmd_name, function))
 	RETURN_API_void()
 }
 
@@ -803,75 +899,75 @@ static void mm_AddServerCommand(char* cmd_name, void (*function) ()) {
 //! For voice communications, set which clients hear eachother.
 //! NOTE: these functions take player entity indices (starting at 1).
 static qboolean mm_Voice_GetClientListening(int iReceiver, int iSender) {
-	META_ENGINE_HANDLE(qboolean, false, FN_VOICE_GETCLIENTLISTENING, pfnVoice_GetClientListening, 2i, (iReceiver, iSender))
+	META_ENGINE_HANDLE(qboolean, false, FN_VOICE_GETCLIENTLISTENING, pfnVoice_GetClientListening, (iReceiver, iSender))
 	RETURN_API(qboolean)
 }
 static qboolean mm_Voice_SetClientListening(int iReceiver, int iSender, qboolean bListen) {
-	META_ENGINE_HANDLE(qboolean, false, FN_VOICE_SETCLIENTLISTENING, pfnVoice_SetClientListening, 3i, (iReceiver, iSender, bListen))
+	META_ENGINE_HANDLE(qboolean, false, FN_VOICE_SETCLIENTLISTENING, pfnVoice_SetClientListening, (iReceiver, iSender, bListen))
 	RETURN_API(qboolean)
 }
 
 // Added for HL 1109 (no SDK update):
 
 static const char* mm_GetPlayerAuthId(edict_t * e) {
-	META_ENGINE_HANDLE(const char*, NULL, FN_GETPLAYERAUTHID, pfnGetPlayerAuthId, p, (e))
+	META_ENGINE_HANDLE(const char*, NULL, FN_GETPLAYERAUTHID, pfnGetPlayerAuthId, (e))
 	RETURN_API(const char*)
 }
 
 // Added 2003/11/10 (no SDK update):
 
 static sequenceEntry_s* mm_SequenceGet(const char* fileName, const char* entryName) {
-	META_ENGINE_HANDLE(sequenceEntry_s*, NULL, FN_SEQUENCEGET, pfnSequenceGet, 2p, (fileName, entryName))
+	META_ENGINE_HANDLE(sequenceEntry_s*, NULL, FN_SEQUENCEGET, pfnSequenceGet, (fileName, entryName))
 	RETURN_API(sequenceEntry_s*)
 }
 
 static sentenceEntry_s* mm_SequencePickSentence(const char* groupName, int pickMethod, int* picked) {
-	META_ENGINE_HANDLE(sentenceEntry_s*, NULL, FN_SEQUENCEPICKSENTENCE, pfnSequencePickSentence, pip, (groupName, pickMethod, picked))
+	META_ENGINE_HANDLE(sentenceEntry_s*, NULL, FN_SEQUENCEPICKSENTENCE, pfnSequencePickSentence, (groupName, pickMethod, picked))
 	RETURN_API(sentenceEntry_s*)
 }
 
 static int mm_GetFileSize(char* filename) {
-	META_ENGINE_HANDLE(int, 0, FN_GETFILESIZE, pfnGetFileSize, p, (filename))
+	META_ENGINE_HANDLE(int, 0, FN_GETFILESIZE, pfnGetFileSize, (filename))
 	RETURN_API(int)
 }
 
 static unsigned int mm_GetApproxWavePlayLen(const char* filepath) {
-	META_ENGINE_HANDLE(unsigned int, 0, FN_GETAPPROXWAVEPLAYLEN, pfnGetApproxWavePlayLen, p, (filepath))
+	META_ENGINE_HANDLE(unsigned int, 0, FN_GETAPPROXWAVEPLAYLEN, pfnGetApproxWavePlayLen, (filepath))
 	RETURN_API(unsigned int)
 }
 
 static int mm_IsCareerMatch() {
-	META_ENGINE_HANDLE(int, 0, FN_ISCAREERMATCH, pfnIsCareerMatch, void, (VOID_ARG))
+	META_ENGINE_HANDLE(int, 0, FN_ISCAREERMATCH, pfnIsCareerMatch, ())
 	RETURN_API(int)
 }
 
 static int mm_GetLocalizedStringLength(const char* label) {
-	META_ENGINE_HANDLE(int, 0, FN_GETLOCALIZEDSTRINGLENGTH, pfnGetLocalizedStringLength, p, (label))
+	META_ENGINE_HANDLE(int, 0, FN_GETLOCALIZEDSTRINGLENGTH, pfnGetLocalizedStringLength, (label))
 	RETURN_API(int)
 }
 
 static void mm_RegisterTutorMessageShown(int mid) {
-	META_ENGINE_HANDLE_void(FN_REGISTERTUTORMESSAGESHOWN, pfnRegisterTutorMessageShown, i, (mid))
+	META_ENGINE_HANDLE_void(FN_REGISTERTUTORMESSAGESHOWN, pfnRegisterTutorMessageShown, (mid))
 	RETURN_API_void()
 }
 
 static int mm_GetTimesTutorMessageShown(int mid) {
-	META_ENGINE_HANDLE(int, 0, FN_GETTIMESTUTORMESSAGESHOWN, pfnGetTimesTutorMessageShown, i, (mid))
+	META_ENGINE_HANDLE(int, 0, FN_GETTIMESTUTORMESSAGESHOWN, pfnGetTimesTutorMessageShown, (mid))
 	RETURN_API(int)
 }
 
 static void mm_ProcessTutorMessageDecayBuffer(int* buffer, int bufferLength) {
-	META_ENGINE_HANDLE_void(FN_PROCESSTUTORMESSAGEDECAYBUFFER, pfnProcessTutorMessageDecayBuffer, pi, (buffer, bufferLength))
+	META_ENGINE_HANDLE_void(FN_PROCESSTUTORMESSAGEDECAYBUFFER, pfnProcessTutorMessageDecayBuffer, (buffer, bufferLength))
 	RETURN_API_void()
 }
 
 static void mm_ConstructTutorMessageDecayBuffer(int* buffer, int bufferLength) {
-	META_ENGINE_HANDLE_void(FN_CONSTRUCTTUTORMESSAGEDECAYBUFFER, pfnConstructTutorMessageDecayBuffer, pi, (buffer, bufferLength))
+	META_ENGINE_HANDLE_void(FN_CONSTRUCTTUTORMESSAGEDECAYBUFFER, pfnConstructTutorMessageDecayBuffer, (buffer, bufferLength))
 	RETURN_API_void()
 }
 
 static void mm_ResetTutorMessageDecayData() {
-	META_ENGINE_HANDLE_void(FN_RESETTUTORMESSAGEDECAYDATA, pfnResetTutorMessageDecayData, void, (VOID_ARG))
+	META_ENGINE_HANDLE_void(FN_RESETTUTORMESSAGEDECAYDATA, pfnResetTutorMessageDecayData, ())
 	RETURN_API_void()
 }
 
@@ -886,7 +982,7 @@ static void mm_QueryClientCvarValue(const edict_t * player, const char* cvarName
 		s_check = mTRUE;
 	}
 
-	META_ENGINE_HANDLE_void(FN_QUERYCLIENTCVARVALUE, pfnQueryClientCvarValue, 2p, (player, cvarName))
+	META_ENGINE_HANDLE_void(FN_QUERYCLIENTCVARVALUE, pfnQueryClientCvarValue, (player, cvarName))
 	RETURN_API_void()
 }
 
@@ -901,7 +997,7 @@ static void mm_QueryClientCvarValue2(const edict_t * player, const char* cvarNam
 		s_check = mTRUE;
 	}
 
-	META_ENGINE_HANDLE_void(FN_QUERYCLIENTCVARVALUE2, pfnQueryClientCvarValue2, 2pi, (player, cvarName, requestID))
+	META_ENGINE_HANDLE_void(FN_QUERYCLIENTCVARVALUE2, pfnQueryClientCvarValue2, (player, cvarName, requestID))
 	RETURN_API_void()
 }
 
@@ -916,7 +1012,7 @@ static int mm_EngCheckParm(const char* pchCmdLineToken, char** pchNextVal) {
 		s_check = mTRUE;
 	}
 
-	META_ENGINE_HANDLE(int, 0, FN_ENGCHECKPARM, pfnEngCheckParm, 2p, (pchCmdLineToken, pchNextVal))
+	META_ENGINE_HANDLE(int, 0, FN_ENGCHECKPARM, pfnEngCheckParm, (pchCmdLineToken, pchNextVal))
 	RETURN_API(int)
 }
 
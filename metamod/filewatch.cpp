@@ -0,0 +1,518 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cerrno>			// errno, etc
+#include <cstdio>			// fopen, fread, etc
+#include <cstdlib>			// malloc, realloc, free
+#include <cstring>			// strcmp, strdup, etc
+#include <sys/stat.h>		// stat
+
+#include <extdll.h>			// always
+
+#include "filewatch.h"		// me
+#include "osdep.h"			// THREAD_T, os_thread_start, etc
+#include "log_meta.h"		// META_DEBUG, etc
+#include "support_meta.h"	// STRNCPY, etc
+
+#ifdef __linux__
+#include <fcntl.h>			// O_NONBLOCK, etc
+#include <poll.h>			// poll
+#include <sys/inotify.h>	// inotify_init1, etc
+#include <unistd.h>			// pipe, read, write, close
+
+// A watched file.  Path, name and contents_wanted are set when added;
+// the thread's view of the file (ready and on) is guarded by
+// watch_mutex.
+typedef struct watch_file_s {
+	char path[PATH_MAX];	// full pathname
+	const char* name;		// file part of path
+	mBOOL contents_wanted;
+	int wd;					// inotify watch of directory; thread only
+	mBOOL dirty;			// to be stat'd and read again
+	mBOOL ready;			// stat'd at least once
+	mBOOL exists;
+	time_t time;			// newer of mtime and ctime, 0 if missing
+	filewatch_id_t id;		// zero if missing
+	mBOOL started;
+	filewatch_id_t start_id;	// id when first stat'd
+	char* contents;			// if wanted and file exists
+} watch_file_t;
+
+// Changes in a directory that may change a watched file in it.
+constexpr unsigned int WATCH_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB;
+
+static watch_file_t** watch_files = nullptr;
+static int watch_num = 0;
+static int watch_size = 0;
+static pthread_mutex_t watch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int watch_fd = -1;				// inotify
+static int watch_wake[2] = { -1, -1 };	// pipe to wake thread
+static THREAD_T watch_thread;
+static mBOOL watch_running = mFALSE;
+static mBOOL watch_stopping = mFALSE;	// guarded by watch_mutex
+static FILEWATCH_FN watch_notify = nullptr;	// guarded by watch_mutex
+
+// Read a whole file; nullptr if it couldn't be read.
+static char* DLLINTERNAL read_file(const char* path);
+static void DLLINTERNAL stat_id(const struct stat* st, filewatch_id_t* id);
+
+// Stat (and read) a file again, and update its entry.
+static void DLLINTERNAL watch_refresh(watch_file_t* wf) {
+	struct stat st;
+	char* contents = nullptr;
+
+	if (wf->wd < 0) {
+		char dir[PATH_MAX];
+		STRNCPY(dir, wf->path, sizeof(dir));
+		dir[wf->name - wf->path] = '\0';
+		// watches of the same directory share a descriptor
+		wf->wd = inotify_add_watch(watch_fd, dir[0] ? dir : ".", WATCH_EVENTS);
+	}
+	const mBOOL exists = (stat(wf->path, &st) == 0) ? mTRUE : mFALSE;
+	if (exists && wf->contents_wanted)
+		contents = read_file(wf->path);
+
+	const time_t when = exists ? ((st.st_ctime > st.st_mtime) ? st.st_ctime : st.st_mtime) : 0;
+	filewatch_id_t id;
+	memset(&id, 0, sizeof(id));
+	if (exists)
+		stat_id(&st, &id);
+	pthread_mutex_lock(&watch_mutex);
+	// by identity, so a file replaced twice in a second is seen twice
+	const FILEWATCH_FN notify = (wf->started && exists && !filewatch_same_id(&id, &wf->id)) ? watch_notify : nullptr;
+	// Without a watch, changes wouldn't be seen; leave it to callers to
+	// read the disk.
+	wf->ready = (wf->wd >= 0) ? mTRUE : mFALSE;
+	wf->exists = exists;
+	wf->time = when;
+	wf->id = id;
+	if (!wf->started) {
+		wf->started = mTRUE;
+		wf->start_id = id;
+	}
+	char* old = wf->contents;
+	wf->contents = contents;
+	pthread_mutex_unlock(&watch_mutex);
+	free(old);
+	// entries live until the thread is stopped, so path stays valid
+	if (notify)
+		notify(wf->path, &id);
+}
+
+// Refresh files marked dirty.  The list may grow meanwhile, so it's only
+// indexed with the mutex held.
+static void DLLINTERNAL watch_refresh_dirty() {
+	for (int i = 0; ; i++) {
+		pthread_mutex_lock(&watch_mutex);
+		if (i >= watch_num) {
+			pthread_mutex_unlock(&watch_mutex);
+			break;
+		}
+		watch_file_t* wf = watch_files[i];
+		const mBOOL dirty = wf->dirty;
+		wf->dirty = mFALSE;
+		pthread_mutex_unlock(&watch_mutex);
+		if (dirty)
+			watch_refresh(wf);
+	}
+}
+
+// Mark files changed by an inotify event.
+static void DLLINTERNAL watch_event(const struct inotify_event* ev) {
+	pthread_mutex_lock(&watch_mutex);
+	for (int i = 0; i < watch_num; i++) {
+		watch_file_t* wf = watch_files[i];
+		if (ev->mask & IN_Q_OVERFLOW)
+			wf->dirty = mTRUE;
+		else if (wf->wd == ev->wd) {
+			// directory itself gone; try to watch it again
+			if (ev->mask & IN_IGNORED) {
+				wf->wd = -1;
+				wf->dirty = mTRUE;
+			}
+			else if (ev->len && !strcmp(wf->name, ev->name))
+				wf->dirty = mTRUE;
+		}
+	}
+	pthread_mutex_unlock(&watch_mutex);
+}
+
+static void watch_main(void* /*arg*/) {
+	alignas(struct inotify_event) char buf[4096];
+	struct pollfd fds[2];
+
+	fds[0].fd = watch_fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = watch_wake[0];
+	fds[1].events = POLLIN;
+	for (;;) {
+		watch_refresh_dirty();
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (fds[1].revents) {
+			// drain wakeups; files to add are already marked dirty
+			while (read(watch_wake[0], buf, sizeof(buf)) > 0)
+				;
+			pthread_mutex_lock(&watch_mutex);
+			const mBOOL stopping = watch_stopping;
+			pthread_mutex_unlock(&watch_mutex);
+			if (stopping)
+				break;
+		}
+		if (fds[0].revents) {
+			ssize_t len;
+			while ((len = read(watch_fd, buf, sizeof(buf))) > 0) {
+				for (char* ptr = buf; ptr < buf + len; ) {
+					const struct inotify_event* ev = reinterpret_cast<const struct inotify_event*>(ptr);
+					watch_event(ev);
+					ptr += sizeof(struct inotify_event) + ev->len;
+				}
+			}
+		}
+	}
+}
+
+static void DLLINTERNAL watch_wakeup() {
+	const char c = 0;
+	if (write(watch_wake[1], &c, 1) < 0) {
+		// pipe full; thread is awake anyway
+	}
+}
+
+// Start the watcher thread.
+// meta_errno values:
+//  - ME_ALREADY	already running
+//  - ME_OSNOTSUP	couldn't create inotify instance or pipe
+//  - errno's from os_thread_start()
+mBOOL DLLINTERNAL filewatch_start() {
+	if (watch_running)
+		RETURN_ERRNO(mFALSE, ME_ALREADY);
+	if ((watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0) {
+		META_WARNING("Couldn't start file watcher: inotify_init1: %s", strerror(errno));
+		RETURN_ERRNO(mFALSE, ME_OSNOTSUP);
+	}
+	if (pipe2(watch_wake, O_NONBLOCK | O_CLOEXEC) != 0) {
+		META_WARNING("Couldn't start file watcher: pipe: %s", strerror(errno));
+		close(watch_fd);
+		watch_fd = -1;
+		RETURN_ERRNO(mFALSE, ME_OSNOTSUP);
+	}
+	watch_stopping = mFALSE;
+	if (!os_thread_start(&watch_thread, watch_main, nullptr)) {
+		META_WARNING("Couldn't start file watcher thread");
+		close(watch_fd);
+		close(watch_wake[0]);
+		close(watch_wake[1]);
+		watch_fd = watch_wake[0] = watch_wake[1] = -1;
+		// meta_errno should be already set in os_thread_start()
+		return mFALSE;
+	}
+	watch_running = mTRUE;
+	META_DEBUG(2, ("Started file watcher"));
+	return mTRUE;
+}
+
+// Stop the watcher thread and forget all files.
+void DLLINTERNAL filewatch_stop() {
+	if (!watch_running)
+		return;
+	pthread_mutex_lock(&watch_mutex);
+	watch_stopping = mTRUE;
+	pthread_mutex_unlock(&watch_mutex);
+	watch_wakeup();
+	os_thread_join(watch_thread);
+	watch_running = mFALSE;
+
+	close(watch_fd);
+	close(watch_wake[0]);
+	close(watch_wake[1]);
+	watch_fd = watch_wake[0] = watch_wake[1] = -1;
+	for (int i = 0; i < watch_num; i++) {
+		free(watch_files[i]->contents);
+		free(watch_files[i]);
+	}
+	free(watch_files);
+	watch_files = nullptr;
+	watch_num = watch_size = 0;
+}
+
+mBOOL DLLINTERNAL filewatch_running() {
+	return watch_running;
+}
+
+int DLLINTERNAL filewatch_num() {
+	return watch_num;
+}
+
+// Set the function called when a watched file changes; null for none.
+void DLLINTERNAL filewatch_notify(const FILEWATCH_FN fn) {
+	pthread_mutex_lock(&watch_mutex);
+	watch_notify = fn;
+	pthread_mutex_unlock(&watch_mutex);
+}
+
+// Find a watched file; mutex must be held.
+static watch_file_t* DLLINTERNAL watch_find(const char* path) {
+	for (int i = 0; i < watch_num; i++) {
+		if (!strcmp(watch_files[i]->path, path))
+			return watch_files[i];
+	}
+	return nullptr;
+}
+
+// Watch a file, keeping its contents in memory if wanted.  Its first
+// stat is done by the thread, so until then it's read from disk.
+// meta_errno values:
+//  - ME_NOTFOUND	watcher isn't running
+//  - ME_NOMEM		couldn't allocate
+mBOOL DLLINTERNAL filewatch_add(const char* path, const mBOOL contents) {
+	if (!watch_running)
+		RETURN_ERRNO(mFALSE, ME_NOTFOUND);
+
+	pthread_mutex_lock(&watch_mutex);
+	watch_file_t* wf = watch_find(path);
+	if (wf) {
+		if (contents && !wf->contents_wanted) {
+			wf->contents_wanted = mTRUE;
+			wf->ready = mFALSE;
+			wf->dirty = mTRUE;
+		}
+	}
+	else {
+		if (watch_num == watch_size) {
+			const int nsize = watch_size ? watch_size * 2 : 16;
+			watch_file_t** nfiles = static_cast<watch_file_t**>(realloc(watch_files, static_cast<size_t>(nsize) * sizeof(watch_file_t*)));
+			if (!nfiles) {
+				pthread_mutex_unlock(&watch_mutex);
+				RETURN_ERRNO(mFALSE, ME_NOMEM);
+			}
+			watch_files = nfiles;
+			watch_size = nsize;
+		}
+		if (!((wf = static_cast<watch_file_t*>(calloc(1, sizeof(watch_file_t)))))) {
+			pthread_mutex_unlock(&watch_mutex);
+			RETURN_ERRNO(mFALSE, ME_NOMEM);
+		}
+		STRNCPY(wf->path, path, sizeof(wf->path));
+		const char* cp = strrchr(wf->path, '/');
+		wf->name = cp ? cp + 1 : wf->path;
+		wf->contents_wanted = contents;
+		wf->wd = -1;
+		wf->dirty = mTRUE;
+		watch_files[watch_num++] = wf;
+		META_DEBUG(4, ("Watching file: %s", path));
+	}
+	pthread_mutex_unlock(&watch_mutex);
+	watch_wakeup();
+	return mTRUE;
+}
+
+// Copy what the thread last saw of a file; false if the file isn't
+// watched or not yet seen.
+static mBOOL DLLINTERNAL watch_get(const char* path, mBOOL* exists, time_t* when, filewatch_id_t* id, filewatch_id_t* start_id, char** contents) {
+	mBOOL ready = mFALSE;
+
+	if (!watch_running)
+		return mFALSE;
+	pthread_mutex_lock(&watch_mutex);
+	const watch_file_t* wf = watch_find(path);
+	if (wf && wf->ready && (!contents || wf->contents_wanted)) {
+		ready = mTRUE;
+		*exists = wf->exists;
+		if (when)
+			*when = wf->time;
+		if (id)
+			*id = wf->id;
+		if (start_id)
+			*start_id = wf->start_id;
+		if (contents)
+			*contents = (wf->exists && wf->contents) ? strdup(wf->contents) : nullptr;
+	}
+	pthread_mutex_unlock(&watch_mutex);
+	return ready;
+}
+
+#else /* _WIN32 */
+
+mBOOL DLLINTERNAL filewatch_start() {
+	RETURN_ERRNO(mFALSE, ME_OSNOTSUP);
+}
+
+void DLLINTERNAL filewatch_stop() {
+}
+
+mBOOL DLLINTERNAL filewatch_running() {
+	return mFALSE;
+}
+
+int DLLINTERNAL filewatch_num() {
+	return 0;
+}
+
+mBOOL DLLINTERNAL filewatch_add(const char* /*path*/, const mBOOL /*contents*/) {
+	RETURN_ERRNO(mFALSE, ME_NOTFOUND);
+}
+
+void DLLINTERNAL filewatch_notify(const FILEWATCH_FN /*fn*/) {
+}
+
+static mBOOL DLLINTERNAL watch_get(const char* /*path*/, mBOOL* /*exists*/, time_t* /*when*/, filewatch_id_t* /*id*/, filewatch_id_t* /*start_id*/, char** /*contents*/) {
+	return mFALSE;
+}
+
+#endif /* _WIN32 */
+
+// Read a whole file; nullptr if it couldn't be read.
+static char* DLLINTERNAL read_file(const char* path) {
+	FILE* fp = fopen(path, "rb");
+	if (!fp)
+		return nullptr;
+
+	size_t len = 0, size = 4096;
+	char* buf = static_cast<char*>(malloc(size));
+	while (buf) {
+		len += fread(buf + len, 1, size - 1 - len, fp);
+		if (len < size - 1)
+			break;
+		char* nbuf = static_cast<char*>(realloc(buf, size *= 2));
+		if (!nbuf)
+			free(buf);
+		buf = nbuf;
+	}
+	const int err = buf ? (ferror(fp) ? EIO : 0) : ENOMEM;
+	fclose(fp);
+	if (err) {
+		free(buf);
+		errno = err;
+		return nullptr;
+	}
+	buf[len] = '\0';
+	return buf;
+}
+
+// Contents of a text file, null-terminated, from memory if watched;
+// caller frees.
+// meta_errno values:
+//  - ME_NOFILE		couldn't read file; errno says why
+char* DLLINTERNAL filewatch_read(const char* path) {
+	mBOOL exists;
+	char* contents;
+
+	if (watch_get(path, &exists, nullptr, nullptr, nullptr, &contents)) {
+		if (contents)
+			return contents;
+		errno = exists ? ENOMEM : ENOENT;
+		RETURN_ERRNO(NULL, ME_NOFILE);
+	}
+	if (!((contents = read_file(path))))
+		RETURN_ERRNO(NULL, ME_NOFILE);
+	return contents;
+}
+
+// Newer of modify and change time of a file, from memory if watched.
+// Files not watched are stat'd, and watched from then on.
+// meta_errno values:
+//  - ME_NOFILE		couldn't stat file; errno says why
+mBOOL DLLINTERNAL filewatch_time(const char* path, time_t* when) {
+	struct stat st;
+	mBOOL exists;
+
+	if (watch_get(path, &exists, when, nullptr, nullptr, nullptr)) {
+		if (exists)
+			return mTRUE;
+		errno = ENOENT;
+		RETURN_ERRNO(mFALSE, ME_NOFILE);
+	}
+	if (filewatch_running())
+		filewatch_add(path, mFALSE);
+	if (stat(path, &st) != 0)
+		RETURN_ERRNO(mFALSE, ME_NOFILE);
+	*when = (st.st_ctime > st.st_mtime) ? st.st_ctime : st.st_mtime;
+	return mTRUE;
+}
+
+// Whether a watched file changed (or was removed or created) since the
+// watch started; false if not watched.
+mBOOL DLLINTERNAL filewatch_modified(const char* path) {
+	mBOOL exists;
+	filewatch_id_t id, start_id;
+
+	if (!watch_get(path, &exists, nullptr, &id, &start_id, nullptr))
+		return mFALSE;
+	return filewatch_same_id(&id, &start_id) ? mFALSE : mTRUE;
+}
+
+static void DLLINTERNAL stat_id(const struct stat* st, filewatch_id_t* id) {
+#ifdef __linux__
+	id->mtime = static_cast<long long>(st->st_mtim.tv_sec) * 1000000000LL + st->st_mtim.tv_nsec;
+	id->ctime = static_cast<long long>(st->st_ctim.tv_sec) * 1000000000LL + st->st_ctim.tv_nsec;
+#else
+	id->mtime = static_cast<long long>(st->st_mtime);
+	id->ctime = static_cast<long long>(st->st_ctime);
+#endif
+	id->size = static_cast<unsigned long long>(st->st_size);
+	id->inode = static_cast<unsigned long long>(st->st_ino);
+}
+
+// Identity of a file as on disk now; false if it couldn't be stat'd, with
+// errno saying why.  Doesn't watch the file, log or set meta_errno, so it
+// may be called on any thread.
+mBOOL DLLINTERNAL filewatch_stat_id(const char* path, filewatch_id_t* id) {
+	struct stat st;
+
+	if (stat(path, &st) != 0)
+		return mFALSE;
+	stat_id(&st, id);
+	return mTRUE;
+}
+
+// Identity of a file, from memory if watched.  Files not watched are
+// stat'd, and watched from then on.
+// meta_errno values:
+//  - ME_NOFILE		couldn't stat file; errno says why
+mBOOL DLLINTERNAL filewatch_id(const char* path, filewatch_id_t* id) {
+	mBOOL exists;
+
+	if (watch_get(path, &exists, nullptr, id, nullptr, nullptr)) {
+		if (exists)
+			return mTRUE;
+		errno = ENOENT;
+		RETURN_ERRNO(mFALSE, ME_NOFILE);
+	}
+	if (filewatch_running())
+		filewatch_add(path, mFALSE);
+	if (!filewatch_stat_id(path, id))
+		RETURN_ERRNO(mFALSE, ME_NOFILE);
+	return mTRUE;
+}
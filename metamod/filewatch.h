@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef FILEWATCH_H
+#define FILEWATCH_H
+
+#include <ctime>			// time_t
+
+#include "types_meta.h"		// mBOOL
+#include "comp_dep.h"		// DLLINTERNAL
+
+// Watcher of plugins.ini, config.ini, the slowhooks whitelist and plugin
+// files.
+//
+// Refreshing plugins at changelevel re-reads plugins.ini and stats every
+// plugin file, and map start re-reads the slowhooks whitelist, just when
+// the server is busiest.  On linux, a background thread instead waits on
+// inotify for changes to watched files, and keeps the contents of text
+// files and the times of others in memory, so reading them at changelevel
+// touches no disk.  Files that aren't watched, or everything if the
+// thread isn't running, are read from disk as before.
+
+mBOOL DLLINTERNAL filewatch_start();
+void DLLINTERNAL filewatch_stop();
+mBOOL DLLINTERNAL filewatch_running();
+int DLLINTERNAL filewatch_num();
+mBOOL DLLINTERNAL filewatch_add(const char* path, mBOOL contents);
+
+// Identity of a version of a file: modify and change times to the
+// nanosecond (where the platform has them), size and inode.  A file
+// rewritten or replaced within the same second still gets a new one.
+typedef struct filewatch_id_s {
+	long long mtime;
+	long long ctime;
+	unsigned long long size;
+	unsigned long long inode;
+} filewatch_id_t;
+
+inline mBOOL DLLINTERNAL filewatch_same_id(const filewatch_id_t* a, const filewatch_id_t* b) {
+	return (a->mtime == b->mtime && a->ctime == b->ctime
+		&& a->size == b->size && a->inode == b->inode) ? mTRUE : mFALSE;
+}
+
+// Contents of a text file, null-terminated; caller frees.
+char* DLLINTERNAL filewatch_read(const char* path);
+// Newer of modify and change time of a file.
+mBOOL DLLINTERNAL filewatch_time(const char* path, time_t* when);
+// Identity of a file, from memory if watched.
+mBOOL DLLINTERNAL filewatch_id(const char* path, filewatch_id_t* id);
+// Identity of a file as on disk now; may be called on any thread.
+mBOOL DLLINTERNAL filewatch_stat_id(const char* path, filewatch_id_t* id);
+// Whether a watched file changed since the watch started.
+mBOOL DLLINTERNAL filewatch_modified(const char* path);
+
+// Called on the watcher thread when a watched file's identity changes
+// after it was first seen; it must not log or touch the plugin list.
+typedef void (*FILEWATCH_FN)(const char* path, const filewatch_id_t* id);
+void DLLINTERNAL filewatch_notify(FILEWATCH_FN fn);
+
+#endif /* FILEWATCH_H */
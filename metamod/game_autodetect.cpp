@@ -36,18 +36,245 @@
  *
  */
 
+#include <atomic>				// std::atomic
+#include <cstdio>				// fopen, fgets, etc
+#include <cstdlib>				// malloc, free
+
 #include <extdll.h>				// always
-#include "osdep_p.h"				// is_gamedll, ...
+#include "osdep_p.h"				// check_gamedll, ...
 #include "game_autodetect.h"			// me
 #include "support_meta.h"			// full_gamedir_path,
+#include "log_meta.h"				// META_DEBUG, etc
+
+#ifdef _WIN32
+#include <process.h>			// _getpid
+#define getpid _getpid
+#endif
+
+// Results of checking dlls are cached in this file, keyed by path, inode,
+// size and mtime, so unchanged files aren't read again on later starts.
+// Servers sharing a game dir share the file; it's replaced with rename, so
+// a server reading it sees one whole version or the other.
+#define AUTODETECT_CACHE_DIR "addons/metamod"
+#define AUTODETECT_CACHE_FILE "autodetect.cache"
+#define AUTODETECT_CACHE_HEADER "# metamod gamedll autodetect cache v2 " PLATFORM_SPC
+
+constexpr int MAX_AUTODETECT_FILES = 256;	// dlls checked, and cached
+constexpr int MAX_PROBE_THREADS = 4;		// threads reading dlls
+
+// A dll, and what we know about it.
+typedef struct autodetect_file_s {
+	char path[PATH_MAX];
+	unsigned long long inode;
+	unsigned long long size;
+	long long mtime;	// nanoseconds where the platform has them
+	mBOOL checked;		// from cache or check_gamedll
+	mBOOL cached;
+	mBOOL is_gamedll;
+	int loglevel;		// for why
+	char why[128];
+} autodetect_file_t;
+
+// Candidates being checked by probe threads.
+typedef struct probe_work_s {
+	autodetect_file_t* files;
+	int num;
+	std::atomic<int> next;
+} probe_work_t;
+
+// Fill in identity of file from stat().
+static mBOOL DLLINTERNAL get_file_identity(autodetect_file_t* file) {
+	struct stat st;
+	if (stat(file->path, &st) != 0)
+		return mFALSE;
+	file->inode = static_cast<unsigned long long>(st.st_ino);
+	file->size = static_cast<unsigned long long>(st.st_size);
+#ifdef __linux__
+	// Full resolution, so a dll rewritten within the same second as the
+	// cached one, at the same size, isn't taken as unchanged.
+	file->mtime = static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+	file->mtime = static_cast<long long>(st.st_mtime);
+#endif
+	return mTRUE;
+}
+
+// Read cache file into a new array; returns number of entries.
+static int DLLINTERNAL load_cache(const char* cachepath, autodetect_file_t** entries) {
+	*entries = nullptr;
+	FILE* fp = fopen(cachepath, "r");
+	if (!fp)
+		return 0;
+
+	char line[PATH_MAX + 128];
+	if (!fgets(line, sizeof(line), fp) || strncmp(line, AUTODETECT_CACHE_HEADER, strlen(AUTODETECT_CACHE_HEADER)) != 0) {
+		META_DEBUG(3, ("autodetect: Ignoring cache '%s' from another version or platform", cachepath));
+		fclose(fp);
+		return 0;
+	}
+
+	*entries = static_cast<autodetect_file_t*>(calloc(MAX_AUTODETECT_FILES, sizeof(autodetect_file_t)));
+	if (!*entries) {
+		fclose(fp);
+		return 0;
+	}
+
+	int num = 0;
+	while (num < MAX_AUTODETECT_FILES && fgets(line, sizeof(line), fp)) {
+		autodetect_file_t* entry = &(*entries)[num];
+		int is_gamedll, pos = 0;
+		if (sscanf(line, "%d %llu %llu %lld %n", &is_gamedll, &entry->inode, &entry->size, &entry->mtime, &pos) < 4 || !pos)
+			continue;
+		// path is the rest of the line
+		char* path = line + pos;
+		path[strcspn(path, "\r\n")] = '\0';
+		if (!*path)
+			continue;
+		STRNCPY(entry->path, path, sizeof(entry->path));
+		entry->is_gamedll = is_gamedll ? mTRUE : mFALSE;
+		num++;
+	}
+
+	fclose(fp);
+	return num;
+}
+
+// Write checked files to cache, replacing it.
+static void DLLINTERNAL save_cache(const char* cachepath, const autodetect_file_t* files, const int num) {
+	char tmppath[PATH_MAX];
+	safevoid_snprintf(tmppath, sizeof(tmppath), "%s.%d", cachepath, static_cast<int>(getpid()));
+
+	FILE* fp = fopen(tmppath, "w");
+	if (!fp) {
+		META_DEBUG(3, ("autodetect: Couldn't write cache '%s': %s", tmppath, strerror(errno)));
+		return;
+	}
+	fprintf(fp, "%s\n", AUTODETECT_CACHE_HEADER);
+	for (int i = 0; i < num; i++) {
+		if (files[i].checked)
+			fprintf(fp, "%d %llu %llu %lld %s\n", files[i].is_gamedll ? 1 : 0, files[i].inode, files[i].size, files[i].mtime, files[i].path);
+	}
+	const int failed = ferror(fp) | fclose(fp);
+
+#ifdef _WIN32
+	if (failed || !MoveFileExA(tmppath, cachepath, MOVEFILE_REPLACE_EXISTING)) {
+#else
+	if (failed || rename(tmppath, cachepath) != 0) {
+#endif
+		META_DEBUG(3, ("autodetect: Couldn't replace cache '%s'", cachepath));
+		remove(tmppath);
+	}
+}
+
+// Take result for file from cache, if its identity is unchanged.
+static void DLLINTERNAL lookup_cache(autodetect_file_t* file, const autodetect_file_t* cache, const int ncache) {
+	for (int i = 0; i < ncache; i++) {
+		if (cache[i].inode == file->inode && cache[i].size == file->size && cache[i].mtime == file->mtime
+			&& !strcmp(cache[i].path, file->path)) {
+			file->is_gamedll = cache[i].is_gamedll;
+			file->checked = mTRUE;
+			file->cached = mTRUE;
+			return;
+		}
+	}
+}
+
+// Check files until none are left; runs on probe threads, and on the
+// server thread alongside them.
+static void probe_worker(void* arg) {
+	probe_work_t* work = static_cast<probe_work_t*>(arg);
+	int i;
+	while ((i = work->next++) < work->num) {
+		autodetect_file_t* file = &work->files[i];
+		if (!file->checked) {
+			file->is_gamedll = check_gamedll(file->path, file->why, sizeof(file->why), &file->loglevel);
+			file->checked = mTRUE;
+		}
+	}
+}
+
+// Check files not found in cache, reading them in parallel.
+static void DLLINTERNAL probe_files(autodetect_file_t* files, const int num) {
+	int unchecked = 0;
+	for (int i = 0; i < num; i++) {
+		if (!files[i].checked)
+			unchecked++;
+	}
+	if (!unchecked)
+		return;
+
+	probe_work_t work;
+	work.files = files;
+	work.num = num;
+	work.next = 0;
+
+	THREAD_T threads[MAX_PROBE_THREADS - 1];
+	int nthreads = 0;
+	while (nthreads < MAX_PROBE_THREADS - 1 && nthreads < unchecked - 1) {
+		if (!os_thread_start(&threads[nthreads], probe_worker, &work))
+			break;
+		nthreads++;
+	}
+	probe_worker(&work);
+	for (int i = 0; i < nthreads; i++)
+		os_thread_join(threads[i]);
+
+	META_DEBUG(5, ("autodetect: Checked %d dlls with %d threads", unchecked, nthreads + 1));
+}
+
+// Log result of checking file.
+static void DLLINTERNAL log_check(const autodetect_file_t* file) {
+	if (file->cached)
+		META_DEBUG(5, ("is_gamedll(%s): Cached, %s.", file->path, file->is_gamedll ? "GameDLL" : "not GameDLL"));
+	else
+		META_DEBUG(file->loglevel, ("is_gamedll(%s): %s", file->path, file->why));
+}
+
+// Check if file is a dll we don't want to load as gamedll.
+static mBOOL DLLINTERNAL is_excluded(const char* name) {
+	const size_t dlext_len = strlen(PLATFORM_DLEXT);
+	const size_t metamod_len = strlen("metamod");
+	const size_t fn_len = strlen(name);
+	char buf[NAME_MAX];
+
+	if (fn_len <= dlext_len) {
+		// Filename is too short
+		return mTRUE;
+	}
+
+	// Compare end of filename with PLATFORM_DLEXT
+	if (!strcasematch(&name[fn_len - dlext_len], PLATFORM_DLEXT)) {
+		// File isn't dll
+		return mTRUE;
+	}
+
+	// Exclude all metamods
+	if (strncasematch(name, "metamod", metamod_len)) {
+		return mTRUE;
+	}
+
+	// Exclude all bots
+	STRNCPY(buf, name, sizeof(buf));
+	strlwr(buf);
+	if (strstr(buf, "bot.")) {
+		return mTRUE;
+	}
+#ifdef __linux__
+	//bot_iX86.so, bot_amd64.so, bot_x86_64.so
+	if (strstr(buf, "bot_i") || strstr(buf, "bot_amd64.so") || strstr(buf, "bot_x86")) {
+		return mTRUE;
+	}
+#endif
+
+	return mFALSE;
+}
 
  // Search gamedir/dlls/*.dll for gamedlls
- //TODO: add META_DEBUG
 const char* DLLINTERNAL autodetect_gamedll(const gamedll_t* gamedll, const char* knownfn)
 {
 	static char buf[256];
-	char dllpath[256];
-	char fnpath[256];
+	char dllpath[PATH_MAX];
+	char cachepath[PATH_MAX];
 	DIR* dir;
 	dirent* ent;
 
@@ -59,73 +286,88 @@ const char* DLLINTERNAL autodetect_gamedll(const gamedll_t* gamedll, const char*
 		return nullptr;
 	}
 
-	// Generate knownfn path
-	safevoid_snprintf(fnpath, sizeof(fnpath), "%s/%s", dllpath, knownfn);
+	// Files to check: knownfn first, then dlls in directory order
+	autodetect_file_t* files = static_cast<autodetect_file_t*>(calloc(MAX_AUTODETECT_FILES, sizeof(autodetect_file_t)));
+	if (!files) {
+		META_WARNING("GameDLL-Autodetection: Out of memory.");
+		return nullptr;
+	}
+	int num = 0;
+
+	// No cache if its directory doesn't resolve (full_gamedir_path then
+	// hands back the relative name); every dll is read instead.
+	autodetect_file_t* cache = nullptr;
+	int ncache = 0;
+	const mBOOL use_cache = is_absolute_path(full_gamedir_path(AUTODETECT_CACHE_DIR, cachepath));
+	if (use_cache) {
+		const size_t dirlen = strlen(cachepath);
+		safevoid_snprintf(cachepath + dirlen, sizeof(cachepath) - dirlen, "/%s", AUTODETECT_CACHE_FILE);
+		ncache = load_cache(cachepath, &cache);
+	}
+	else
+		META_DEBUG(3, ("autodetect: Cache directory '%s' doesn't resolve; not caching", AUTODETECT_CACHE_DIR));
 
 	// Check if knownfn exists and is valid gamedll
-	if (is_gamedll(fnpath)) {
-		// knownfn exists and is loadable gamedll, return 0.
-		return nullptr;
+	safevoid_snprintf(files[0].path, sizeof(files[0].path), "%s/%s", dllpath, knownfn);
+	if (get_file_identity(&files[0])) {
+		lookup_cache(&files[0], cache, ncache);
+		probe_files(&files[0], 1);
+		log_check(&files[0]);
+		num = 1;
 	}
 
-	// Open directory
-	if (!((dir = opendir(dllpath)))) {
+	const char* result = nullptr;
+	if (num && files[0].is_gamedll) {
+		// knownfn exists and is loadable gamedll, return 0.
+	}
+	else if (!((dir = opendir(dllpath)))) {
 		//whine & return
 		META_WARNING("GameDLL-Autodetection: Couldn't open directory '%s'.", dllpath);
-		return nullptr;
 	}
-
-	const size_t dlext_len = strlen(PLATFORM_DLEXT);
-	const size_t metamod_len = strlen("metamod");
-
-	while ((ent = readdir(dir)) != nullptr) {
-		const size_t fn_len = strlen(ent->d_name);
-		if (fn_len <= dlext_len) {
-			// Filename is too short
-			continue;
-		}
-
-		// Compare end of filename with PLATFORM_DLEXT
-		if (!strcasematch(&ent->d_name[fn_len - dlext_len], PLATFORM_DLEXT)) {
-			// File isn't dll
-			continue;
+	else {
+		const int first = num;
+		while ((ent = readdir(dir)) != nullptr && num < MAX_AUTODETECT_FILES) {
+			if (is_excluded(ent->d_name))
+				continue;
+			autodetect_file_t* file = &files[num];
+			safevoid_snprintf(file->path, sizeof(file->path), "%s/%s", dllpath, ent->d_name);
+			if (num && !strcmp(file->path, files[0].path))
+				continue;	// knownfn, checked above
+			if (!get_file_identity(file))
+				continue;
+			lookup_cache(file, cache, ncache);
+			num++;
 		}
+		closedir(dir);
 
-		// Exclude all metamods
-		if (strncasematch(ent->d_name, "metamod", metamod_len)) {
-			continue;
-		}
+		probe_files(&files[first], num - first);
 
-		// Exclude all bots
-		STRNCPY(buf, ent->d_name, sizeof(buf));
-		strlwr(buf);
-		if (strstr(buf, "bot.")) {
-			continue;
-		}
-#ifdef __linux__
-		//bot_iX86.so, bot_amd64.so, bot_x86_64.so
-		if (strstr(buf, "bot_i") || strstr(buf, "bot_amd64.so") || strstr(buf, "bot_x86")) {
-			continue;
+		for (int i = first; i < num; i++) {
+			log_check(&files[i]);
+			if (files[i].is_gamedll) {
+				//gamedll detected
+				const char* name = strrchr(files[i].path, '/');
+				STRNCPY(buf, name ? name + 1 : files[i].path, sizeof(buf));
+				result = buf;
+				break;
+			}
 		}
-#endif
-
-		// Generate full path
-		safevoid_snprintf(fnpath, sizeof(fnpath), "%s/%s", dllpath, ent->d_name);
-
-		// Check if dll is gamedll
-		if (is_gamedll(fnpath)) {
-			META_DEBUG(8, ("is_gamedll(%s): ok.", fnpath));
-			//gamedll detected
-			STRNCPY(buf, ent->d_name, sizeof(buf));
-			closedir(dir);
-			return buf;
+		if (!result) {
+			//not found
+			META_WARNING("GameDLL-Autodetection: Couldn't find gamedll in '%s'.", dllpath);
 		}
-		META_DEBUG(8, ("is_gamedll(%s): failed.", fnpath));
 	}
 
-	//not found
-	META_WARNING("GameDLL-Autodetection: Couldn't find gamedll in '%s'.", dllpath);
-	closedir(dir);
+	// Update cache if anything was read from dlls, or went away
+	int probed = 0;
+	for (int i = 0; i < num; i++) {
+		if (!files[i].cached)
+			probed++;
+	}
+	if (use_cache && (probed || num != ncache))
+		save_cache(cachepath, files, num);
 
-	return nullptr;
-}
\ No newline at end of file
+	free(cache);
+	free(files);
+	return result;
+}
@@ -181,10 +181,41 @@ const game_modlist_t known_games = {
 	{nullptr, nullptr, nullptr, nullptr}
 };
 
+// Index of known_games by name: chains of entries with the same name
+// hash, in list order.  Built on first lookup.
+constexpr int GAME_HASH_SIZE = 256;	// power of 2
+constexpr int GAME_HASH_MAX = 1024;	// max entries indexed
+static short game_hash_head[GAME_HASH_SIZE];
+static short game_hash_next[GAME_HASH_MAX];
+static mBOOL game_hash_built = mFALSE;
+
+static void DLLINTERNAL build_game_hash() {
+	int num = 0;
+	while (known_games[num].name)
+		num++;
+	if (num > GAME_HASH_MAX) {
+		META_ERROR("Too many known games (%d) to index; max %d", num, GAME_HASH_MAX);
+		num = GAME_HASH_MAX;
+	}
+
+	// Entries are 1-based in the index, so 0 ends a chain.  Pushing
+	// from the end keeps chains in list order.
+	memset(game_hash_head, 0, sizeof(game_hash_head));
+	for (int i = num - 1; i >= 0; i--) {
+		const unsigned int h = mm_strcasehash(known_games[i].name) & (GAME_HASH_SIZE - 1);
+		game_hash_next[i] = game_hash_head[h];
+		game_hash_head[h] = static_cast<short>(i + 1);
+	}
+	game_hash_built = mTRUE;
+}
+
 // Find a modinfo corresponding to the given game name.
 const game_modinfo_t* DLLINTERNAL lookup_game(const char* name) {
-	for (int i = 0; known_games[i].name; i++) {
-		const game_modinfo_t* imod = &known_games[i];
+	if (!game_hash_built)
+		build_game_hash();
+
+	for (int i = game_hash_head[mm_strcasehash(name) & (GAME_HASH_SIZE - 1)]; i; i = game_hash_next[i - 1]) {
+		const game_modinfo_t* imod = &known_games[i - 1];
 		// If there are 2 or more same names check next dll file if doesn't exist
 		if (strcasematch(imod->name, name)) {
 			char check_path[NAME_MAX];
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cctype>			// tolower
+#include <cerrno>			// errno
+#include <cstdlib>			// calloc, free
+#include <cstring>			// strchr, strerror, etc
+#include <ctime>			// time_t
+
+#include <extdll.h>			// always
+
+#include "hookprofile.h"	// me
+#include "api_hook.h"		// get_api_info
+#include "conf_meta.h"		// MConfig
+#include "filewatch.h"		// filewatch_read, filewatch_time
+#include "metamod.h"		// Config
+#include "support_meta.h"	// full_gamedir_path, strcasematch, etc
+#include "log_meta.h"		// META_DEBUG, etc
+#include "osdep.h"			// strcasecmp, etc
+
+// Compiled whitelist, and the file it was compiled from.
+static hook_profile_t* profiles = nullptr;
+static int num_profiles = 0;
+static char profiles_path[PATH_MAX] = "";
+static time_t profiles_time = 0;		// 0 if file missing
+
+static const char* const api_prefix[3] = { "engine", "dllapi", "newapi" };
+static const unsigned int api_num_hooks[3] = { NUM_ENGINE_HOOKS, NUM_DLLAPI_HOOKS, NUM_NEWAPI_HOOKS };
+// Functions with a name; the info tables can be shorter than the api
+// tables (not counting END).
+static const unsigned int api_num_named[3] = {
+	static_cast<unsigned int>(sizeof(engine_info_t) / sizeof(api_info_t) - 1),
+	static_cast<unsigned int>(sizeof(dllapi_info_t) / sizeof(api_info_t) - 1),
+	static_cast<unsigned int>(sizeof(newapi_info_t) / sizeof(api_info_t) - 1),
+};
+
+// Match a name against a pattern with '*' and '?', ignoring case.
+static mBOOL DLLINTERNAL pattern_match(const char* pattern, const char* name) {
+	const char* star = nullptr;
+	const char* resume = nullptr;
+
+	while (*name) {
+		if (*pattern == '*') {
+			star = pattern++;
+			resume = name;
+		}
+		else if (*pattern == '?' || (*pattern && tolower(*pattern) == tolower(*name))) {
+			pattern++;
+			name++;
+		}
+		else if (star) {
+			// let the last '*' take one more character
+			pattern = star + 1;
+			name = ++resume;
+		}
+		else
+			return mFALSE;
+	}
+	while (*pattern == '*')
+		pattern++;
+	return *pattern ? mFALSE : mTRUE;
+}
+
+// Route a function, or a whole table, named in a profile; false if
+// nothing by that name.
+static mBOOL DLLINTERNAL profile_add(hook_profile_t* prof, const char* token) {
+	int want_api = -1;
+	mBOOL found = mFALSE;
+
+	for (int api = 0; api < 3; api++) {
+		const size_t len = strlen(api_prefix[api]);
+		if (!strncasecmp(token, api_prefix[api], len)) {
+			if (!token[len]) {
+				for (unsigned int fn = 0; fn < api_num_hooks[api]; fn++) {
+					const unsigned int id = MHookList::hook_id(static_cast<enum_api_t>(api), static_cast<unsigned int>(fn * sizeof(void*)));
+					prof->route[id] = 1;
+				}
+				return mTRUE;
+			}
+			if (token[len] == ':') {
+				want_api = api;
+				token += len + 1;
+				break;
+			}
+		}
+	}
+	for (int api = 0; api < 3; api++) {
+		if (want_api >= 0 && api != want_api)
+			continue;
+		for (unsigned int fn = 0; fn < api_num_named[api] && fn < api_num_hooks[api]; fn++) {
+			const api_info_t* info = get_api_info(static_cast<enum_api_t>(api), static_cast<unsigned int>(fn * sizeof(api_info_t)));
+			if (info->name && strcasematch(info->name, token)) {
+				prof->route[MHookList::hook_id(static_cast<enum_api_t>(api), static_cast<unsigned int>(fn * sizeof(void*)))] = 1;
+				found = mTRUE;
+			}
+		}
+	}
+	return found;
+}
+
+static void DLLINTERNAL profiles_free() {
+	for (int i = 0; i < num_profiles; i++)
+		free(profiles[i].pattern);
+	free(profiles);
+	profiles = nullptr;
+	num_profiles = 0;
+}
+
+// Compile the whitelist file into profiles.
+static void DLLINTERNAL profiles_compile(const char* path) {
+	char* ptr_line;
+	int nlines = 1, ln = 0;
+
+	profiles_free();
+	char* contents = filewatch_read(path);
+	if (!contents) {
+		// whitelist is optional
+		META_DEBUG(2, ("unable to open slowhooks whitelist file '%s': %s", path, strerror(errno)));
+		return;
+	}
+	for (const char* cp = contents; ((cp = strchr(cp, '\n'))); cp++)
+		nlines++;
+	if (!((profiles = static_cast<hook_profile_t*>(calloc(static_cast<size_t>(nlines), sizeof(hook_profile_t)))))) {
+		META_WARNING("Couldn't allocate slowhooks profiles for '%s'", path);
+		free(contents);
+		return;
+	}
+
+	META_DEBUG(2, ("Loading from slowhooks whitelist: %s", path));
+	for (char* line = contents; line; ) {
+		char* next = strchr(line, '\n');
+		if (next)
+			*next++ = '\0';
+		ln++;
+		char* token = strtok_r(line, " \t\r", &ptr_line);
+		if (token && token[0] != '#' && token[0] != ';' && !strnmatch(token, "//", 2)) {
+			hook_profile_t* prof = &profiles[num_profiles];
+			prof->pattern = strdup(token);
+			prof->line = ln;
+			token = strtok_r(nullptr, " \t\r", &ptr_line);
+			// a map name alone routes everything
+			prof->all = token ? mFALSE : mTRUE;
+			for (; token; token = strtok_r(nullptr, " \t\r", &ptr_line)) {
+				if (!strcasecmp(token, "*") || !strcasecmp(token, "all"))
+					prof->all = mTRUE;
+				else if (!profile_add(prof, token))
+					META_WARNING("slowhooks whitelist '%s' line %d: unknown function '%s'", path, ln, token);
+			}
+			for (unsigned int id = 0; id < NUM_API_HOOKS; id++)
+				prof->num_routed += prof->route[id];
+			if (prof->all)
+				prof->num_routed = NUM_API_HOOKS;
+			if (prof->pattern)
+				num_profiles++;
+		}
+		line = next;
+	}
+	free(contents);
+	META_DEBUG(2, ("Compiled %d slowhooks profiles from %s", num_profiles, path));
+}
+
+// Find the profile for a map, compiling the whitelist again first if it
+// changed.
+const hook_profile_t* DLLINTERNAL hookprof_find(const char* mapname) {
+	char path[PATH_MAX];
+	time_t file_time;
+
+	// Make full pathname (from gamedir if relative, collapse "..", backslashes, etc).
+	full_gamedir_path(Config->slowhooks_whitelist, path);
+	if (!filewatch_time(path, &file_time))
+		file_time = 0;
+	if (file_time != profiles_time || strcmp(path, profiles_path) != 0) {
+		profiles_compile(path);
+		STRNCPY(profiles_path, path, sizeof(profiles_path));
+		profiles_time = file_time;
+	}
+
+	for (int i = 0; i < num_profiles; i++) {
+		if (pattern_match(profiles[i].pattern, mapname)) {
+			META_DEBUG(3, ("Map '%s' matches slowhooks pattern '%s' (line %d); routing %u functions",
+				mapname, profiles[i].pattern, profiles[i].line, profiles[i].num_routed));
+			return &profiles[i];
+		}
+	}
+	return nullptr;
+}
@@ -28,42 +28,37 @@
  *    version.
  *
  */
-#ifndef RET_TYPE_H
-#define RET_TYPE_H
 
-#include "new_baseclass.h"
+#ifndef HOOKPROFILE_H
+#define HOOKPROFILE_H
 
-class class_ret_t : public class_metamod_new {
-public:
-	// Construction
-	class_ret_t() = default;
-	class_ret_t(const float f) { data.f = f; }
-	class_ret_t(void* p) { data.p = p; }
-	class_ret_t(const char* pc) { data.pc = pc; }
-	class_ret_t(const int i) { data.i = i; }
-	class_ret_t(const short s) { data.i = s; }
-	class_ret_t(const char c) { data.i = c; }
-	class_ret_t(const unsigned int ui) { data.ui = ui; }
-	class_ret_t(const unsigned long ui) { data.ui = ui; }
-	class_ret_t(const unsigned short us) { data.ui = us; }
-	class_ret_t(const unsigned char uc) { data.ui = uc; }
+#include "types_meta.h"		// mBOOL
+#include "comp_dep.h"		// DLLINTERNAL
+#include "mhooklist.h"		// NUM_API_HOOKS
 
-	// Reading/Writing
-	void* getptr() { return&data; }
+// Per-map routing profiles, from the slowhooks whitelist.
+//
+// Each line of the whitelist is a map name pattern, where '*' matches any
+// characters and '?' any one character, optionally followed by the api
+// functions to route through Metamod on matching maps whether hooked or
+// not.  A pattern alone routes every function, as a plain map name always
+// did.  Functions are named as in "meta hooks" (ie "PlayerPreThink"),
+// optionally prefixed by "engine:", "dllapi:" or "newapi:"; the names
+// "engine", "dllapi" and "newapi" alone stand for the whole table.  The
+// first matching line applies.
+//
+// The file used to be read and parsed again at every map start; it's now
+// compiled once, and again only when its time changes.
 
-#define SET_RET_CLASS(ret,type,x) \
-		*(type*)((ret).getptr()) = (type)(x)
-#define GET_RET_CLASS(ret,type) \
-		(*(type*)((ret).getptr()))
-private:
-	//Data (select data size of largest type) (x86: 32bit, x86_64: 64bit)
-	union {
-		void* p;
-		const char* pc;
-		float f;
-		long i;
-		unsigned long ui;
-	} data;
-};
+typedef struct hook_profile_s {
+	char* pattern;
+	int line;						// in whitelist file
+	mBOOL all;						// route every function
+	unsigned int num_routed;		// functions set in route
+	unsigned char route[NUM_API_HOOKS];	// by hook id
+} hook_profile_t;
 
-#endif /*RET_TYPE_H*/
+// Profile for a map; null if no line matches.  Valid until the next call.
+const hook_profile_t* DLLINTERNAL hookprof_find(const char* mapname);
+
+#endif /* HOOKPROFILE_H */
@@ -38,6 +38,9 @@
 
 #include <cstdio>		// vsnprintf, etc
 #include <cstdarg>		// va_start, etc
+#include <cstdlib>		// calloc, free
+#include <ctime>		// time, localtime, etc
+#include <atomic>		// std::atomic
 
 #include <extdll.h>				// always
 #include "enginecallbacks.h"		// ALERT, etc
@@ -46,6 +49,7 @@
 #include "log_meta.h"			// me
 #include "osdep.h"				// win32 vsnprintf, etc
 #include "support_meta.h"		// MAX
+#include "cvarwatch.h"			// developer_cvar
 
 cvar_t meta_debug = { "meta_debug", "0", FCVAR_EXTDLL, 0, nullptr };
 
@@ -58,7 +62,7 @@ enum MLOG_SERVICE {
 	mlsCLIENT
 };
 
-static void buffered_ALERT(MLOG_SERVICE service, ALERT_TYPE atype, const char* prefix, const char* fmt, va_list ap);
+static void buffered_ALERT(MLOG_SERVICE service, ALERT_TYPE atype, const char* prefix, mBOOL to_engine, const char* fmt, va_list ap);
 
 // Print to console.
 void DLLINTERNAL META_CONS(const char* fmt, ...) {
@@ -84,13 +88,12 @@ static const char* const prefixDEV = "[META] dev:";
 void DLLINTERNAL META_DEV(const char* fmt, ...) {
 	va_list ap;
 
-	if (nullptr != g_engfuncs.pfnCVarGetFloat) {
-		const int dev = static_cast<int>(CVAR_GET_FLOAT("developer"));
-		if (dev == 0) return;
-	}
+	const cvar_t* developer = developer_cvar();
+	if (developer && static_cast<int>(developer->value) == 0)
+		return;
 
 	va_start(ap, fmt);
-	buffered_ALERT(mlsDEV, at_logged, prefixDEV, fmt, ap);
+	buffered_ALERT(mlsDEV, at_logged, prefixDEV, mFALSE, fmt, ap);
 	va_end(ap);
 }
 
@@ -100,7 +103,7 @@ void DLLINTERNAL META_INFO(const char* fmt, ...) {
 	va_list ap;
 
 	va_start(ap, fmt);
-	buffered_ALERT(mlsIWEL, at_logged, prefixINFO, fmt, ap);
+	buffered_ALERT(mlsIWEL, at_logged, prefixINFO, mFALSE, fmt, ap);
 	va_end(ap);
 }
 
@@ -110,7 +113,7 @@ void DLLINTERNAL META_WARNING(const char* fmt, ...) {
 	va_list ap;
 
 	va_start(ap, fmt);
-	buffered_ALERT(mlsIWEL, at_logged, prefixWARNING, fmt, ap);
+	buffered_ALERT(mlsIWEL, at_logged, prefixWARNING, mTRUE, fmt, ap);
 	va_end(ap);
 }
 
@@ -120,7 +123,7 @@ void DLLINTERNAL META_ERROR(const char* fmt, ...) {
 	va_list ap;
 
 	va_start(ap, fmt);
-	buffered_ALERT(mlsIWEL, at_logged, prefixERROR, fmt, ap);
+	buffered_ALERT(mlsIWEL, at_logged, prefixERROR, mTRUE, fmt, ap);
 	va_end(ap);
 }
 
@@ -130,7 +133,7 @@ void DLLINTERNAL META_LOG(const char* fmt, ...) {
 	va_list ap;
 
 	va_start(ap, fmt);
-	buffered_ALERT(mlsIWEL, at_logged, prefixLOG, fmt, ap);
+	buffered_ALERT(mlsIWEL, at_logged, prefixLOG, mFALSE, fmt, ap);
 	va_end(ap);
 }
 
@@ -169,11 +172,27 @@ void DLLINTERNAL META_DO_DEBUG(const char* fmt, ...) {
 	safevoid_vsnprintf(meta_debug_str, sizeof(meta_debug_str), fmt, ap);
 	va_end(ap);
 
-	ALERT(at_logged, "[META] (debug:%d) %s\n", debug_level, meta_debug_str);
+	char line[MAX_LOGMSG_LEN];
+	safevoid_snprintf(line, sizeof(line), "[META] (debug:%d) %s\n", debug_level, meta_debug_str);
+	log_write(at_logged, line, mFALSE);
 }
 
 #endif /*!__BUILD_FAST_METAMOD__*/
 
+// Format a log line, as "<prefix> <message>\n", in one pass.
+void DLLINTERNAL log_vformat(char* buf, const size_t size, const char* prefix, const char* fmt, va_list ap) {
+	size_t len = strlen(prefix);
+	if (len > size - 3)
+		len = size - 3;
+	memcpy(buf, prefix, len);
+	buf[len++] = ' ';
+	// -1 null, -1 for newline
+	safevoid_vsnprintf(buf + len, size - len - 1, fmt, ap);
+	len += strlen(buf + len);
+	buf[len] = '\n';
+	buf[len + 1] = '\0';
+}
+
 class BufferedMessage : public class_metamod_new {
 public:
 	MLOG_SERVICE service;
@@ -186,12 +205,12 @@ public:
 static BufferedMessage* messageQueueStart = nullptr;
 static BufferedMessage* messageQueueEnd = nullptr;
 
-static void buffered_ALERT(const MLOG_SERVICE service, const ALERT_TYPE atype, const char* prefix, const char* fmt, va_list ap) {
+static void buffered_ALERT(const MLOG_SERVICE service, const ALERT_TYPE atype, const char* prefix, const mBOOL to_engine, const char* fmt, va_list ap) {
 	char buf[MAX_LOGMSG_LEN];
 
 	if (nullptr != g_engfuncs.pfnAlertMessage) {
-		vsnprintf(buf, sizeof(buf), fmt, ap);
-		ALERT(atype, "%s %s\n", prefix, buf);
+		log_vformat(buf, sizeof(buf), prefix, fmt, ap);
+		log_write(atype, buf, to_engine);
 		return;
 	}
 
@@ -221,7 +240,8 @@ static void buffered_ALERT(const MLOG_SERVICE service, const ALERT_TYPE atype, c
 // jumptable is set. Don't call it if it isn't set.
 void DLLINTERNAL flush_ALERT_buffer() {
 	BufferedMessage* msg = messageQueueStart;
-	const int dev = static_cast<int>(CVAR_GET_FLOAT("developer"));
+	const cvar_t* developer = developer_cvar();
+	const int dev = developer ? static_cast<int>(developer->value) : 0;
 
 	while (nullptr != msg) {
 		if (msg->service == mlsDEV && dev == 0) {
@@ -235,4 +255,210 @@ void DLLINTERNAL flush_ALERT_buffer() {
 	}
 
 	messageQueueStart = messageQueueEnd = nullptr;
-}
\ No newline at end of file
+}
+///// Async log:
+//
+// With async_log set in config.ini, log lines are written to metamod's
+// own log files, in addons/metamod/logs, by a writer thread, rather than
+// passed to the engine's log.  Producers (the server thread, or any
+// plugin thread) copy pre-formatted lines into a bounded lock-free ring;
+// if it's full, the line is dropped and counted, so logging never waits
+// on the disk.  Warnings and errors are passed to the engine as well, so
+// they still show on the console.
+
+constexpr unsigned int LOG_RING_SIZE = 1024;		// power of 2
+constexpr int LOG_WRITER_SLEEP_MS = 20;		// poll interval of writer when idle
+constexpr int LOG_FLUSH_TIMEOUT_MS = 2000;
+
+// A ring entry.  Sequence is the position it may be written at, or, once
+// written, that position + 1 (Vyukov's bounded queue).
+typedef struct log_rec_s {
+	std::atomic<unsigned int> seq;
+	time_t time;
+	char text[MAX_LOGMSG_LEN];
+} log_rec_t;
+
+// Ring lines are pushed to; nullptr when async log isn't running.  The
+// memory stays allocated after stop, as a plugin thread may still be
+// pushing to it.
+static std::atomic<log_rec_t*> log_ring(nullptr);
+static log_rec_t* log_ring_mem = nullptr;
+static std::atomic<unsigned int> log_tail(0);		// next position to write
+static std::atomic<unsigned int> log_head(0);		// next position to read
+static std::atomic<unsigned int> log_dropped(0);
+static std::atomic<bool> log_stopping(false);
+static THREAD_T log_thread;
+static char log_dir[PATH_MAX];
+
+// Put line in ring; false if full.
+static mBOOL DLLINTERNAL log_push(log_rec_t* ring, const char* line) {
+	unsigned int pos = log_tail.load(std::memory_order_relaxed);
+	log_rec_t* rec;
+
+	for (;;) {
+		rec = &ring[pos & (LOG_RING_SIZE - 1)];
+		const int diff = static_cast<int>(rec->seq.load(std::memory_order_acquire) - pos);
+		if (diff == 0) {
+			if (log_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+			return mFALSE;
+		else
+			pos = log_tail.load(std::memory_order_relaxed);
+	}
+	rec->time = time(nullptr);
+	STRNCPY(rec->text, line, sizeof(rec->text));
+	rec->seq.store(pos + 1, std::memory_order_release);
+	return mTRUE;
+}
+
+// Write a log line (ending in newline) to the async log, or to the
+// engine's log if async log isn't running.  Lines that must also reach
+// the engine (console) are passed with to_engine.
+void DLLINTERNAL log_write(const ALERT_TYPE atype, const char* line, const mBOOL to_engine) {
+	log_rec_t* ring = log_ring.load(std::memory_order_acquire);
+	if (ring) {
+		if (!log_push(ring, line))
+			log_dropped.fetch_add(1, std::memory_order_relaxed);
+		if (!to_engine)
+			return;
+	}
+	ALERT(atype, "%s", line);
+}
+
+// Open log file for the day of given time, if not already open.
+static FILE* DLLINTERNAL log_open(FILE* fp, int* day, const time_t when) {
+	struct tm tm_when;
+	char path[PATH_MAX];
+
+#ifdef _WIN32
+	localtime_s(&tm_when, &when);
+#else
+	localtime_r(&when, &tm_when);
+#endif
+	if (fp && *day == tm_when.tm_yday)
+		return fp;
+	if (fp)
+		fclose(fp);
+	*day = tm_when.tm_yday;
+	safevoid_snprintf(path, sizeof(path), "%s/metamod_%04d%02d%02d.log", log_dir,
+		tm_when.tm_year + 1900, tm_when.tm_mon + 1, tm_when.tm_mday);
+	return fopen(path, "a");
+}
+
+static void DLLINTERNAL log_print(FILE* fp, const time_t when, const char* text) {
+	struct tm tm_when;
+
+#ifdef _WIN32
+	localtime_s(&tm_when, &when);
+#else
+	localtime_r(&when, &tm_when);
+#endif
+	fprintf(fp, "L %02d/%02d/%04d - %02d:%02d:%02d: %s",
+		tm_when.tm_mon + 1, tm_when.tm_mday, tm_when.tm_year + 1900,
+		tm_when.tm_hour, tm_when.tm_min, tm_when.tm_sec, text);
+}
+
+// Writer thread; runs until stopped and ring is empty.
+static void log_writer(void* arg) {
+	log_rec_t* ring = static_cast<log_rec_t*>(arg);
+	FILE* fp = nullptr;
+	int day = -1;
+
+	for (;;) {
+		const bool stopping = log_stopping.load(std::memory_order_acquire);
+		unsigned int head = log_head.load(std::memory_order_relaxed);
+		int count = 0;
+
+		for (;; count++) {
+			log_rec_t* rec = &ring[head & (LOG_RING_SIZE - 1)];
+			if (rec->seq.load(std::memory_order_acquire) != head + 1)
+				break;
+			fp = log_open(fp, &day, rec->time);
+			if (fp)
+				log_print(fp, rec->time, rec->text);
+			rec->seq.store(head + LOG_RING_SIZE, std::memory_order_release);
+			log_head.store(++head, std::memory_order_release);
+		}
+		const unsigned int dropped = log_dropped.exchange(0, std::memory_order_relaxed);
+		if (dropped) {
+			const time_t now = time(nullptr);
+			fp = log_open(fp, &day, now);
+			if (fp) {
+				char line[128];
+				safevoid_snprintf(line, sizeof(line), "[META] WARNING: Log full; %u lines dropped\n", dropped);
+				log_print(fp, now, line);
+			}
+		}
+		if (fp && (count || dropped))
+			fflush(fp);
+		if (!count) {
+			if (stopping)
+				break;
+			os_sleep_ms(LOG_WRITER_SLEEP_MS);
+		}
+	}
+	if (fp)
+		fclose(fp);
+}
+
+// Start async log, writing files in given directory.
+// meta_errno values:
+//  - ME_ALREADY	already running
+//  - ME_NOMEM		couldn't allocate ring
+//  - errno's from os_thread_start()
+mBOOL DLLINTERNAL log_async_start(const char* dir) {
+	if (log_ring.load())
+		RETURN_ERRNO(mFALSE, ME_ALREADY);
+
+	STRNCPY(log_dir, dir, sizeof(log_dir));
+#ifdef _WIN32
+	_mkdir(log_dir);
+#else
+	mkdir(log_dir, 0755);
+#endif
+	if (!log_ring_mem)
+		log_ring_mem = static_cast<log_rec_t*>(calloc(LOG_RING_SIZE, sizeof(log_rec_t)));
+	log_rec_t* ring = log_ring_mem;
+	if (!ring) {
+		META_ERROR("Failed to allocate async log");
+		RETURN_ERRNO(mFALSE, ME_NOMEM);
+	}
+	for (unsigned int i = 0; i < LOG_RING_SIZE; i++)
+		ring[i].seq.store(i, std::memory_order_relaxed);
+	log_tail.store(0);
+	log_head.store(0);
+	log_stopping.store(false);
+	log_ring.store(ring, std::memory_order_release);
+	if (!os_thread_start(&log_thread, log_writer, ring)) {
+		log_ring.store(nullptr);
+		META_ERROR("Failed to start async log thread; logging to engine");
+		return mFALSE;
+	}
+	META_LOG("Logging to %s", log_dir);
+	return mTRUE;
+}
+
+// Wait until lines logged so far are written; at changelevel.
+void DLLINTERNAL log_async_flush() {
+	if (!log_ring.load(std::memory_order_acquire))
+		return;
+	const unsigned int target = log_tail.load(std::memory_order_acquire);
+	for (int waited = 0; waited < LOG_FLUSH_TIMEOUT_MS; waited++) {
+		if (static_cast<int>(log_head.load(std::memory_order_acquire) - target) >= 0)
+			return;
+		os_sleep_ms(1);
+	}
+}
+
+// Write remaining lines and stop writer thread; at shutdown.
+void DLLINTERNAL log_async_stop() {
+	// lines logged from now go to engine
+	if (!log_ring.exchange(nullptr, std::memory_order_acq_rel))
+		return;
+	log_stopping.store(true, std::memory_order_release);
+	os_thread_join(log_thread);
+	// Ring isn't freed; a thread that loaded the pointer just before may
+	// still be pushing a line, which is then lost.
+}
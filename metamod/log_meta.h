@@ -37,6 +37,8 @@
 #ifndef LOG_META_H
 #define LOG_META_H
 
+#include <cstdarg>		// va_list
+
 #include "comp_dep.h"
 #include "osdep.h"	//unlikely, OPEN_ARGS
 
@@ -113,4 +115,10 @@ void DLLINTERNAL META_DO_DEBUG(const char* fmt, ...);
 
 void DLLINTERNAL flush_ALERT_buffer();
 
+void DLLINTERNAL log_vformat(char* buf, size_t size, const char* prefix, const char* fmt, va_list ap);
+void DLLINTERNAL log_write(ALERT_TYPE atype, const char* line, mBOOL to_engine);
+mBOOL DLLINTERNAL log_async_start(const char* dir);
+void DLLINTERNAL log_async_flush();
+void DLLINTERNAL log_async_stop();
+
 #endif /* LOG_META_H */
@@ -63,7 +63,12 @@
  // Version 5:11 added plugin loading and unloading API [v1.18]
  // Version 5:12 added IS_QUERYING_CLIENT_CVAR to mutils [v1.18]
  // Version 5:13 added MAKE_REQUESTID and GET_HOOK_TABLES to mutils [v1.19]
-#define META_INTERFACE_VERSION "5:13"
+ // Version 5:14 added HOOK_USER_MSG and UNHOOK_USER_MSG to mutils
+ // Version 5:15 added GET_USER_MSG_GENERATION to mutils
+ // Version 5:16 added GET_CVAR_HANDLE, WATCH_CVAR and UNWATCH_CVAR to mutils
+ // Version 5:17 added QUERY_CLIENT_CVAR and CANCEL_CLIENT_CVAR_QUERY to mutils
+ // Version 5:18 added ALLOC_EDICT_SLOT, GET_EDICT_SLOT and GET_INDEX_SLOT to mutils
+#define META_INTERFACE_VERSION "5:18"
 
 // Flags returned by a plugin's api function.
 // NOTE: order is crucial, as greater/less comparisons are made.
@@ -40,11 +40,11 @@
 #include "comp_dep.h"
 #include "meta_api.h"			// META_RES, etc
 #include "mlist.h"				// MPluginList, etc
+#include "mhooklist.h"			// MHookList
 #include "mreg.h"				// MRegCmdList, etc
 #include "conf_meta.h"			// MConfig
 #include "osdep.h"				// NAME_MAX, etc
 #include "types_meta.h"			// mBOOL
-#include "mplayer.h"                    // MPlayerList
 #include "meta_eiface.h"        // HL_enginefuncs_t, meta_enginefuncs_t
 #include "engine_t.h"           // engine_t, Engine
 
@@ -97,6 +97,9 @@ extern MConfig* Config DLLHIDDEN;
 // List of plugins loaded/opened/running.
 extern MPluginList* Plugins DLLHIDDEN;
 
+// Plugin functions hooking each api function, from running plugins.
+extern MHookList* Hooks DLLHIDDEN;
+
 // List of command functions registered by plugins.
 extern MRegCmdList* RegCmds DLLHIDDEN;
 
@@ -118,22 +121,8 @@ extern NEW_DLL_FUNCTIONS* g_pHookedNewDllFunctions DLLHIDDEN;
 
 extern int metamod_not_loaded DLLHIDDEN;
 
-// function tables that have all hooks enabled
-extern meta_enginefuncs_t g_slow_hooks_table_engine;
-extern DLL_FUNCTIONS g_slow_hooks_table_dll;
-extern NEW_DLL_FUNCTIONS g_slow_hooks_table_newdll;
-
-// function tables which have expensive hooks disabled
-extern meta_enginefuncs_t g_fast_hooks_table_engine;
-extern DLL_FUNCTIONS g_fast_hooks_table_dll;
-extern NEW_DLL_FUNCTIONS g_fast_hooks_table_newdll;
-
-// pointer to the engine's dll function table. For enabling/disabling hooks without a restart.
-extern DLL_FUNCTIONS* g_engine_dll_funcs_table;
-
-// Holds cached player info, right now only things for querying cvars
-// Max players is always 32, small enough that we can use a static array
-extern MPlayerList g_Players DLLHIDDEN;
+// pointer to the engine's dll function table, patched by api routing.
+extern DLL_FUNCTIONS* g_engine_dll_funcs_table DLLHIDDEN;
 
 extern int requestid_counter DLLHIDDEN;
 
@@ -207,7 +196,7 @@ mBOOL DLLINTERNAL meta_load_gamedll();
 
 // return a value
 #define RETURN_API(ret_t) \
-	{return(GET_RET_CLASS(ret_val, ret_t));}
+	{return(ret_val);}
 
 // ===== end macros ===========================================================
 
@@ -0,0 +1,226 @@
+// vi: set ts=4 sw=4 :
+// vim: set tw=75 :
+
+// mhooklist.cpp - precompiled lists of plugin functions hooking each api
+//                 function (class MHookList)
+
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cstddef>			// offsetof
+#include <cstdlib>			// calloc, free
+
+#include <extdll.h>			// always
+
+#include "mhooklist.h"		// me
+#include "api_hook.h"		// get_api_info
+#include "api_route.h"		// route_update
+#include "metamod.h"		// Plugins
+#include "mlist.h"			// class MPluginList
+#include "mplugin.h"		// class MPlugin
+#include "log_meta.h"		// META_DEBUG, etc
+
+// Number of hooks and first hook id for each api, indexed by enum_api_t.
+static const unsigned int api_num_hooks[3] = { NUM_ENGINE_HOOKS, NUM_DLLAPI_HOOKS, NUM_NEWAPI_HOOKS };
+static const unsigned int api_first_hook[3] = { 0, NUM_ENGINE_HOOKS, NUM_ENGINE_HOOKS + NUM_DLLAPI_HOOKS };
+
+// Get plugin's function for given api function, or NULL if plugin is not
+// running or doesn't hook it.
+static void* DLLINTERNAL get_plugin_hook(MPlugin* plug, const enum_api_t api, const unsigned int fn, const int post) {
+	if (plug->status != PL_RUNNING)
+		return nullptr;
+	void** table = static_cast<void**>(post ? plug->get_api_post_table(api) : plug->get_api_table(api));
+	if (!table)
+		return nullptr;
+	return table[fn];
+}
+
+///// class MHookList:
+
+// Constructor
+MHookList::MHookList()
+	: pool(nullptr), retired(nullptr), busy(0)
+{
+	// start with empty lists, so callers never see a NULL pool
+	pool = static_cast<hook_pool_t*>(calloc(1, sizeof(hook_pool_t)));
+	if (!pool)
+		META_ERROR("Failed to allocate MHookList");
+}
+
+// Destructor
+MHookList::~MHookList() {
+	busy = 0;
+	collect();
+	free(pool);
+}
+
+// Rebuild subscriber lists from the tables of all running plugins.  Must
+// be called whenever a plugin starts or stops running (load, unload,
+// pause, unpause); also updates api routing.  Hook calls already in progress keep iterating the
+// previous pool, in which functions of stopped plugins are disabled.
+void DLLINTERNAL MHookList::rebuild() {
+	unsigned int api, fn, num = 0;
+	int i, post;
+
+	// count subscribers, to allocate the pool in one piece
+	for (i = 0; i < Plugins->endlist; i++) {
+		MPlugin* iplug = Plugins->plist[i];
+		if (iplug->status != PL_RUNNING)
+			continue;
+		for (api = 0; api < 3; api++) {
+			for (post = 0; post < 2; post++) {
+				void** table = static_cast<void**>(post ? iplug->get_api_post_table(static_cast<enum_api_t>(api)) : iplug->get_api_table(static_cast<enum_api_t>(api)));
+				if (!table)
+					continue;
+				for (fn = 0; fn < api_num_hooks[api]; fn++) {
+					if (table[fn])
+						num++;
+				}
+			}
+		}
+	}
+
+	hook_pool_t* npool = static_cast<hook_pool_t*>(calloc(1, offsetof(hook_pool_t, subs) + (num + 1) * sizeof(hook_sub_t)));
+	if (!npool) {
+		META_ERROR("Failed to allocate hook lists for %u plugin functions", num);
+		// keep old lists, but make sure they don't reference stopped plugins
+		revalidate(pool);
+		return;
+	}
+
+	// fill lists hook by hook, so each hook's subscribers are contiguous
+	num = 0;
+	for (api = 0; api < 3; api++) {
+		for (fn = 0; fn < api_num_hooks[api]; fn++) {
+			hook_subs_t* hook = &npool->hooks[api_first_hook[api] + fn];
+			for (post = 0; post < 2; post++) {
+				const unsigned int first = num;
+				for (i = 0; i < Plugins->endlist; i++) {
+					MPlugin* iplug = Plugins->plist[i];
+					void* pfn = get_plugin_hook(iplug, static_cast<enum_api_t>(api), fn, post);
+					if (!pfn)
+						continue;
+					npool->subs[num].pfn = pfn;
+					npool->subs[num].index = iplug->index;
+					num++;
+				}
+				if (post) {
+					hook->post = first;
+					hook->num_post = num - first;
+				}
+				else {
+					hook->pre = first;
+					hook->num_pre = num - first;
+				}
+			}
+			if (!hook->num_pre && !hook->num_post)
+				hook->mode = HM_DIRECT;
+			else if (hook->num_pre == 1 && !hook->num_post)
+				hook->mode = HM_SINGLE;
+			else
+				hook->mode = HM_GENERAL;
+		}
+	}
+
+	// retire old pool; hook calls in progress may still be using it
+	if (pool) {
+		pool->next = retired;
+		retired = pool;
+	}
+	pool = npool;
+
+	if (busy)
+		revalidate(retired);
+	else
+		collect();
+
+	META_DEBUG(5, ("Rebuilt hook lists: %u plugin functions", num));
+
+	// send newly hooked functions through metamod
+	route_update();
+}
+
+// List api functions hooked by running plugins, with the dispatch path
+// used for each.
+void DLLINTERNAL MHookList::show() const {
+	static const char* const api_names[3] = { "engine", "dllapi", "newapi" };
+	static const char* const mode_names[3] = { "direct", "single", "general" };
+	int n = 0, single = 0;
+
+	META_CONS("Hooked api functions:");
+	META_CONS("  %-6s  %-30s  %4s  %4s  %s", "api", "function", "pre", "post", "dispatch");
+
+	for (unsigned int api = 0; api < 3; api++) {
+		for (unsigned int fn = 0; fn < api_num_hooks[api]; fn++) {
+			const hook_subs_t* hook = &pool->hooks[api_first_hook[api] + fn];
+			if (hook->mode == HM_DIRECT)
+				continue;
+			const api_info_t* info = get_api_info(static_cast<enum_api_t>(api), fn * static_cast<unsigned int>(sizeof(api_info_t)));
+			META_CONS("  %-6s  %-30s  %4u  %4u  %s",
+				api_names[api], info->name ? info->name : "(unknown)",
+				hook->num_pre, hook->num_post, mode_names[hook->mode]);
+			if (hook->mode == HM_SINGLE)
+				single++;
+			n++;
+		}
+	}
+
+	META_CONS("%d hooked functions, %d single, %d general; others direct", n, single, n - single);
+}
+
+// Disable functions of plugins that have stopped running (or have been
+// replaced) in the given pool and all pools retired before it.
+void DLLINTERNAL MHookList::revalidate(hook_pool_t* rpool) const {
+	for (; rpool; rpool = rpool->next) {
+		for (unsigned int api = 0; api < 3; api++) {
+			for (unsigned int fn = 0; fn < api_num_hooks[api]; fn++) {
+				const hook_subs_t* hook = &rpool->hooks[api_first_hook[api] + fn];
+				for (int post = 0; post < 2; post++) {
+					hook_sub_t* sub = &rpool->subs[post ? hook->post : hook->pre];
+					const hook_sub_t* end = sub + (post ? hook->num_post : hook->num_pre);
+					for (; sub < end; sub++) {
+						if (sub->pfn && get_plugin_hook(Plugins->plist[sub->index - 1], static_cast<enum_api_t>(api), fn, post) != sub->pfn)
+							sub->pfn = nullptr;
+					}
+				}
+			}
+		}
+	}
+}
+
+// Free retired pools; only safe when no hook call is in progress.
+void DLLINTERNAL MHookList::collect() {
+	while (retired) {
+		hook_pool_t* next = retired->next;
+		free(retired);
+		retired = next;
+	}
+}
@@ -0,0 +1,142 @@
+// vi: set ts=4 sw=4 :
+// vim: set tw=75 :
+
+// mhooklist.h - precompiled lists of plugin functions hooking each api
+//               function (class MHookList)
+
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef MHOOKLIST_H
+#define MHOOKLIST_H
+
+#include <extdll.h>			// enginefuncs_t, DLL_FUNCTIONS, etc
+
+#include "api_info.h"		// enum_api_t
+#include "comp_dep.h"		// DLLINTERNAL
+#include "new_baseclass.h"
+
+ // Number of hookable functions in each api table.
+constexpr unsigned int NUM_ENGINE_HOOKS = sizeof(enginefuncs_t) / sizeof(void*);
+constexpr unsigned int NUM_DLLAPI_HOOKS = sizeof(DLL_FUNCTIONS) / sizeof(void*);
+constexpr unsigned int NUM_NEWAPI_HOOKS = sizeof(NEW_DLL_FUNCTIONS) / sizeof(void*);
+constexpr unsigned int NUM_API_HOOKS = NUM_ENGINE_HOOKS + NUM_DLLAPI_HOOKS + NUM_NEWAPI_HOOKS;
+
+// A plugin function hooking an api function.
+typedef struct hook_sub_s {
+	void* pfn;				// plugin function; NULL once plugin stops running
+	int index;				// index of owning plugin (1-based)
+} hook_sub_t;
+
+// How the dispatcher calls an api function, chosen by its subscribers.
+typedef enum {
+	HM_DIRECT = 0,			// no subscribers; call original function only
+	HM_SINGLE,				// one pre subscriber and no post subscribers
+	HM_GENERAL,				// anything else
+} hook_mode_t;
+
+// Location of the pre and post subscribers of one api function in
+// hook_pool_t::subs.  Subscribers are kept in plugin list order.
+typedef struct hook_subs_s {
+	unsigned int pre;		// first pre subscriber
+	unsigned int num_pre;
+	unsigned int post;		// first post subscriber
+	unsigned int num_post;
+	hook_mode_t mode;		// dispatch path for this api function
+} hook_subs_t;
+
+// One generation of subscriber lists, built from the running plugins.
+// A pool is never modified after it's built, except to disable entries of
+// plugins that stop running while the pool is still in use by a nested
+// hook call.
+typedef struct hook_pool_s {
+	struct hook_pool_s* next;			// next retired pool
+	hook_subs_t hooks[NUM_API_HOOKS];	// indexed by hook id
+	hook_sub_t subs[1];					// actually variable length
+} hook_pool_t;
+
+// Subscriber lists for all api functions.
+class MHookList : public class_metamod_new {
+public:
+	~MHookList() DLLINTERNAL;
+private:
+	// data:
+	hook_pool_t* pool;		// current subscriber lists
+	hook_pool_t* retired;	// old pools, possibly still used by callers
+	int busy;				// number of hook calls in progress
+	// Private; to satisfy -Weffc++ "has pointer data members but does
+	// not override" copy/assignment constructor.
+	void operator=(const MHookList& src) = delete;
+	MHookList(const MHookList& src) = delete;
+
+	// functions:
+	void DLLINTERNAL revalidate(hook_pool_t* rpool) const;
+	void DLLINTERNAL collect();
+
+public:
+	// constructor:
+	MHookList() DLLINTERNAL;
+
+	// functions:
+	void DLLINTERNAL rebuild();			// re-read tables of running plugins
+	void DLLINTERNAL show() const;		// list hooked api functions
+
+	// Hook id of an api function; ids of all apis share one range.
+	static unsigned int DLLINTERNAL hook_id(const enum_api_t api, const unsigned int func_offset) {
+		static constexpr unsigned int api_base[3] = { 0, NUM_ENGINE_HOOKS, NUM_ENGINE_HOOKS + NUM_DLLAPI_HOOKS };
+		return api_base[api] + static_cast<unsigned int>(func_offset / sizeof(void*));
+	}
+
+	// Number of plugin functions hooking an api function.
+	unsigned int DLLINTERNAL num_subs(const enum_api_t api, const unsigned int func_offset) const {
+		const hook_subs_t* hook = &pool->hooks[hook_id(api, func_offset)];
+		return hook->num_pre + hook->num_post;
+	}
+
+	// Dispatch path for an api function.
+	hook_mode_t DLLINTERNAL mode(const enum_api_t api, const unsigned int func_offset) const {
+		return pool->hooks[hook_id(api, func_offset)].mode;
+	}
+
+	// Start using subscriber lists for a hook call.  The returned pool
+	// stays valid until the matching leave().
+	const hook_pool_t* DLLINTERNAL enter() {
+		busy++;
+		return pool;
+	}
+
+	// Done with hook call; free old pools once no call uses them.
+	void DLLINTERNAL leave() {
+		if (--busy == 0 && retired)
+			collect();
+	}
+};
+
+#endif /* MHOOKLIST_H */
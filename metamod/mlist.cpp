@@ -50,34 +50,171 @@
 #include "log_meta.h"			// META_LOG, etc
 #include "osdep.h"				// win32 snprintf, normalize_pathname,
 #include "osdep_p.h"
+#include "support_meta.h"		// mm_strhash, etc
+#include "filewatch.h"			// filewatch_read, etc
+#include "stageload.h"			// stage_ready
+
+// Initial entries of plist.
+constexpr int PLIST_INIT_SIZE = 16;
+
+// Hash indexes kept by the list, in order in indexes.
+enum {
+	PLI_PLID = 0,
+	PLI_HANDLE,
+	PLI_PATH,
+	PLI_FILE,
+	PLI_NUM
+};
+
+static unsigned int DLLINTERNAL ptr_hash(const void* ptr) {
+	return static_cast<unsigned int>((static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(ptr)) * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static int DLLINTERNAL match_plid(const MPlugin* plug, const void* key) {
+	return plug->info == key;
+}
+
+static int DLLINTERNAL match_handle(const MPlugin* plug, const void* key) {
+	return plug->handle == key;
+}
+
+static int DLLINTERNAL match_path(const MPlugin* plug, const void* key) {
+	return strmatch(plug->pathname, static_cast<const char*>(key));
+}
+
+static int DLLINTERNAL match_file(const MPlugin* plug, const void* key) {
+	return plug->file && strcasematch(plug->file, static_cast<const char*>(key));
+}
 
  // Constructor
 MPluginList::MPluginList(const char* ifile)
-	: size(MAX_PLUGINS), endlist(0)
+	: plist(nullptr), size(0), endlist(0), indexes(nullptr), index_size(0), index_stale(mTRUE)
 {
 	// store filename of ini file
 	STRNCPY(inifile, ifile, sizeof(inifile));
 	// initialize array
-	for (int i = 0; i < size; i++) {
-		//reset to empty
-		plist[i].index = i + 1;
-		reset_plugin(&plist[i]);
+	grow(PLIST_INIT_SIZE);
+}
+
+// Make sure list has at least 'want' entries, allocating new (empty)
+// plugins as needed.
+// meta_errno values:
+//  - ME_NOMEM		couldn't allocate
+mBOOL DLLINTERNAL MPluginList::grow(const int want) {
+	if (want <= size)
+		return mTRUE;
+
+	int nsize = size ? size : PLIST_INIT_SIZE;
+	while (nsize < want)
+		nsize *= 2;
+	MPlugin** nlist = static_cast<MPlugin**>(realloc(plist, static_cast<size_t>(nsize) * sizeof(MPlugin*)));
+	if (!nlist) {
+		META_ERROR("Failed to grow plugin list to %d plugins", nsize);
+		RETURN_ERRNO(mFALSE, ME_NOMEM);
 	}
-	endlist = 0;
+	plist = nlist;
+	for (; size < nsize; size++) {
+		if (!((plist[size] = new MPlugin()))) {
+			META_ERROR("Failed to allocate plugin %d", size + 1);
+			RETURN_ERRNO(mFALSE, ME_NOMEM);
+		}
+		plist[size]->index = size + 1;     // 1-based
+	}
+	return mTRUE;
 }
 
 // Resets plugin to empty
-void DLLINTERNAL MPluginList::reset_plugin(MPlugin* pl_find) const
+void DLLINTERNAL MPluginList::reset_plugin(MPlugin* pl_find)
 {
-	//calculate index
-	const int i = pl_find - &plist[0];
+	const int i = pl_find->index;
 
 	//free any pointers first
 	pl_find->free_api_pointers();
 
 	//set zero
 	*pl_find = MPlugin();
-	pl_find->index = i + 1;     // 1-based
+	pl_find->index = i;
+	index_stale = mTRUE;
+}
+
+// Rebuild hash indexes from the list, sized for twice the used entries.
+// meta_errno values:
+//  - ME_NOMEM		couldn't allocate
+mBOOL DLLINTERNAL MPluginList::reindex() {
+	unsigned int nsize = 16;
+	while (nsize < 2 * static_cast<unsigned int>(endlist))
+		nsize *= 2;
+	if (nsize != index_size) {
+		int* nindexes = static_cast<int*>(realloc(indexes, PLI_NUM * nsize * sizeof(int)));
+		if (!nindexes) {
+			META_ERROR("Failed to allocate plugin indexes");
+			index_stale = mTRUE;
+			RETURN_ERRNO(mFALSE, ME_NOMEM);
+		}
+		indexes = nindexes;
+		index_size = nsize;
+	}
+	memset(indexes, 0, PLI_NUM * index_size * sizeof(int));
+
+	const unsigned int mask = index_size - 1;
+	for (int i = 0; i < endlist; i++) {
+		const MPlugin* iplug = plist[i];
+		unsigned int hash[PLI_NUM];
+		int have[PLI_NUM];
+		if (iplug->status < PL_VALID)
+			continue;
+		have[PLI_PLID] = iplug->info != nullptr;
+		hash[PLI_PLID] = ptr_hash(iplug->info);
+		have[PLI_HANDLE] = iplug->handle != nullptr;
+		hash[PLI_HANDLE] = ptr_hash(iplug->handle);
+		have[PLI_PATH] = iplug->pathname[0] != '\0';
+		hash[PLI_PATH] = mm_strhash(iplug->pathname);
+		have[PLI_FILE] = iplug->file && iplug->file[0];
+		hash[PLI_FILE] = have[PLI_FILE] ? mm_strcasehash(iplug->file) : 0;
+		for (int which = 0; which < PLI_NUM; which++) {
+			if (!have[which])
+				continue;
+			int* index = indexes + static_cast<unsigned int>(which) * index_size;
+			unsigned int h = hash[which] & mask;
+			while (index[h])
+				h = (h + 1) & mask;
+			index[h] = iplug->index;
+		}
+	}
+	index_stale = mFALSE;
+	return mTRUE;
+}
+
+// Look up key in given index, without rebuilding it; skip is a plugin to
+// pass over, to find a second match.
+MPlugin* DLLINTERNAL MPluginList::probe(const int which, const unsigned int hash, const void* key, int (*match)(const MPlugin*, const void*), const MPlugin* skip) const
+{
+	const int* index = indexes + static_cast<unsigned int>(which) * index_size;
+	const unsigned int mask = index_size - 1;
+	for (unsigned int h = hash & mask; index[h]; h = (h + 1) & mask) {
+		MPlugin* iplug = plist[index[h] - 1];
+		if (iplug != skip && iplug->status >= PL_VALID && match(iplug, key))
+			return iplug;
+	}
+	return nullptr;
+}
+
+// Look up key in given index, rebuilding the index if it's stale.
+// Pathnames and files only change through the list, and plid and handle
+// through MPlugin's load and reload, all of which mark the indexes stale,
+// so a miss on a fresh index is a miss.  Falls back to scanning the list
+// if the index can't be allocated.
+MPlugin* DLLINTERNAL MPluginList::find_indexed(const int which, const unsigned int hash, const void* key, int (*match)(const MPlugin*, const void*)) {
+	if (!index_stale)
+		return probe(which, hash, key, match, nullptr);
+	if (reindex())
+		return probe(which, hash, key, match, nullptr);
+
+	for (int i = 0; i < endlist; i++) {
+		if (plist[i]->status >= PL_VALID && match(plist[i], key))
+			return plist[i];
+	}
+	return nullptr;
 }
 
 // Find a plugin based on the plugin index #.
@@ -85,9 +222,9 @@ void DLLINTERNAL MPluginList::reset_plugin(MPlugin* pl_find) const
 //  - ME_ARGUMENT	invalid pindex
 //  - ME_NOTFOUND	couldn't find a matching plugin
 MPlugin* DLLINTERNAL MPluginList::find(const int pindex) {
-	if (pindex <= 0)
+	if (pindex <= 0 || pindex > size)
 		RETURN_ERRNO(NULL, ME_ARGUMENT);
-	MPlugin* pfound = &plist[pindex - 1];
+	MPlugin* pfound = plist[pindex - 1];
 	if (pfound->status < PL_VALID)
 		RETURN_ERRNO(NULL, ME_NOTFOUND);
 	return pfound;
@@ -100,13 +237,10 @@ MPlugin* DLLINTERNAL MPluginList::find(const int pindex) {
 MPlugin* DLLINTERNAL MPluginList::find(const DLHANDLE handle) {
 	if (!handle)
 		RETURN_ERRNO(NULL, ME_ARGUMENT);
-	for (int i = 0; i < endlist; i++) {
-		if (plist[i].status < PL_VALID)
-			continue;
-		if (plist[i].handle == handle)
-			return&plist[i];
-	}
-	RETURN_ERRNO(NULL, ME_NOTFOUND);
+	MPlugin* pfound = find_indexed(PLI_HANDLE, ptr_hash(handle), handle, match_handle);
+	if (!pfound)
+		RETURN_ERRNO(NULL, ME_NOTFOUND);
+	return pfound;
 }
 
 // Clear source_plugin_index on all matching plugins
@@ -115,10 +249,10 @@ void DLLINTERNAL MPluginList::clear_source_plugin_index(const int source_index)
 		return;
 
 	for (int i = 0; i < endlist; i++) {
-		if (plist[i].status < PL_VALID)
+		if (plist[i]->status < PL_VALID)
 			continue;
-		if (plist[i].source_plugin_index == source_index)
-			plist[i].source_plugin_index = -1;
+		if (plist[i]->source_plugin_index == source_index)
+			plist[i]->source_plugin_index = -1;
 	}
 }
 
@@ -129,9 +263,9 @@ mBOOL DLLINTERNAL MPluginList::found_child_plugins(const int source_index) const
 		return mFALSE;
 
 	for (int i = 0; i < endlist; i++) {
-		if (plist[i].status < PL_VALID)
+		if (plist[i]->status < PL_VALID)
 			continue;
-		if (plist[i].source_plugin_index == source_index)
+		if (plist[i]->source_plugin_index == source_index)
 			return mTRUE;
 	}
 
@@ -146,7 +280,7 @@ void DLLINTERNAL MPluginList::trim_list() {
 		return;
 
 	for (i = 0, n = 0; i < endlist; i++) {
-		if (plist[i].status == PL_EMPTY)
+		if (plist[i]->status == PL_EMPTY)
 			continue;
 		n = i + 1;
 	}
@@ -161,13 +295,10 @@ void DLLINTERNAL MPluginList::trim_list() {
 MPlugin* DLLINTERNAL MPluginList::find(const plid_t id) {
 	if (!id)
 		RETURN_ERRNO(NULL, ME_ARGUMENT);
-	for (int i = 0; i < endlist; i++) {
-		if (plist[i].status < PL_VALID)
-			continue;
-		if (plist[i].info == id)
-			return&plist[i];
-	}
-	RETURN_ERRNO(NULL, ME_NOTFOUND);
+	MPlugin* pfound = find_indexed(PLI_PLID, ptr_hash(id), id, match_plid);
+	if (!pfound)
+		RETURN_ERRNO(NULL, ME_NOTFOUND);
+	return pfound;
 }
 
 // Find a plugin with the given pathname.
@@ -178,14 +309,10 @@ MPlugin* DLLINTERNAL MPluginList::find(const char* findpath) {
 	if (!findpath)
 		RETURN_ERRNO(NULL, ME_ARGUMENT);
 	META_DEBUG(8, ("Looking for loaded plugin with dlfnamepath: %s", findpath));
-	for (int i = 0; i < endlist; i++) {
-		META_DEBUG(9, ("Looking at: plugin %s loadedpath: %s", plist[i].file, plist[i].pathname));
-		if (plist[i].status < PL_VALID)
-			continue;
-		if (strmatch(plist[i].pathname, findpath)) {
-			META_DEBUG(8, ("Found loaded plugin %s", plist[i].file));
-			return&plist[i];
-		}
+	MPlugin* pfound = find_indexed(PLI_PATH, mm_strhash(findpath), findpath, match_path);
+	if (pfound) {
+		META_DEBUG(8, ("Found loaded plugin %s", pfound->file));
+		return pfound;
 	}
 	META_DEBUG(8, ("No loaded plugin found with path: %s", findpath));
 	RETURN_ERRNO(NULL, ME_NOTFOUND);
@@ -195,20 +322,18 @@ MPlugin* DLLINTERNAL MPluginList::find(const char* findpath) {
 // meta_errno values:
 //  - ME_ARGUMENT	null memptr
 //  - ME_NOTFOUND	couldn't find a matching plugin
-//  - errno's from DLFNAME()
 MPlugin* DLLINTERNAL MPluginList::find_memloc(void* memptr) {
 #ifdef __linux__
-	const char* dlfile;
-
 	if (!memptr)
 		RETURN_ERRNO(NULL, ME_ARGUMENT);
-	if (!(dlfile = DLFNAME(memptr))) {
-		META_DEBUG(8, ("DLFNAME failed to find memloc %d", memptr));
-		// meta_errno should be already set in DLFNAME
+	const int pindex = os_memloc_plugin(memptr);
+	if (!pindex) {
+		META_DEBUG(8, ("No loaded plugin found with memloc %p", memptr));
+		// meta_errno should be already set in os_memloc_plugin
 		return nullptr;
 	}
 
-	return(find(dlfile));
+	return find(pindex);
 #else
 	DLHANDLE dlhandle;
 
@@ -224,7 +349,8 @@ MPlugin* DLLINTERNAL MPluginList::find_memloc(void* memptr) {
 }
 
 // Find a plugin with non-ambiguous prefix string matching desc, file,
-// name, or logtag.
+// name, or logtag.  A plugin whose file is exactly the given string is
+// found directly, if no other plugin has that file.
 // meta_errno values:
 //  - ME_ARGUMENT	null prefix
 //  - ME_NOTFOUND	couldn't find a matching plugin
@@ -234,13 +360,18 @@ MPlugin* DLLINTERNAL MPluginList::find_match(const char* prefix) {
 
 	if (!prefix)
 		RETURN_ERRNO(NULL, ME_ARGUMENT);
-	MPlugin* pfound = nullptr;
+	const unsigned int hash = mm_strcasehash(prefix);
+	MPlugin* pfound = find_indexed(PLI_FILE, hash, prefix, match_file);
+	if (pfound && !index_stale && !probe(PLI_FILE, hash, prefix, match_file, pfound))
+		return pfound;
+
+	pfound = nullptr;
 	const size_t len = strlen(prefix);
 	safevoid_snprintf(buf, sizeof(buf), "mm_%s", prefix);
 	const size_t buf_len = strlen(buf);
 
 	for (int i = 0; i < endlist; i++) {
-		MPlugin* iplug = &plist[i];
+		MPlugin* iplug = plist[i];
 		if (iplug->status < PL_VALID)
 			continue;
 		if (iplug->info && strncasecmp(iplug->info->name, prefix, len) == 0) {
@@ -293,7 +424,7 @@ MPlugin* DLLINTERNAL MPluginList::find_match(const MPlugin* pmatch) {
 		RETURN_ERRNO(NULL, ME_ARGUMENT);
 	MPlugin* pfound = nullptr;
 	for (int i = 0; i < endlist; i++) {
-		MPlugin* iplug = &plist[i];
+		MPlugin* iplug = plist[i];
 		if (pmatch->platform_match(iplug)) {
 			pfound = iplug;
 			break;
@@ -308,26 +439,27 @@ MPlugin* DLLINTERNAL MPluginList::find_match(const MPlugin* pmatch) {
 
 // Add a plugin to the list.
 // meta_errno values:
-//  - ME_MAXREACHED		reached max plugins
+//  - ME_NOMEM		couldn't grow list
 MPlugin* DLLINTERNAL MPluginList::add(const MPlugin* padd) {
 	int i;
 
 	// Find either:
 	//  - a slot in the list that's not being used
 	//  - the end of the list
-	for (i = 0; i < endlist && plist[i].status != PL_EMPTY; i++);
+	for (i = 0; i < endlist && plist[i]->status != PL_EMPTY; i++);
 
-	// couldn't find a slot to use
-	if (i == size) {
-		META_WARNING("Couldn't add plugin '%s' to list; reached max plugins (%d)",
-			padd->file, i);
-		RETURN_ERRNO(NULL, ME_MAXREACHED);
+	// list is full
+	if (i == size && !grow(size + 1)) {
+		META_WARNING("Couldn't add plugin '%s' to list; out of memory",
+			padd->file);
+		// meta_errno should be already set in grow()
+		return nullptr;
 	}
 
 	// if we found the end of the list, advance end marker
 	if (i == endlist)
 		endlist++;
-	MPlugin* iplug = &plist[i];
+	MPlugin* iplug = plist[i];
 
 	// copy filename into this free slot
 	STRNCPY(iplug->filename, padd->filename, sizeof(iplug->filename));
@@ -345,6 +477,7 @@ MPlugin* DLLINTERNAL MPluginList::add(const MPlugin* padd) {
 	iplug->source_plugin_index = padd->source_plugin_index;
 	// copy status
 	iplug->status = padd->status;
+	index_stale = mTRUE;
 
 	return iplug;
 }
@@ -371,7 +504,12 @@ mBOOL DLLINTERNAL MPluginList::ini_startup() {
 	}
 
 	META_LOG("ini: Begin reading plugins list: %s", inifile);
-	for (n = 0, ln = 1; !feof(fp) && fgets(line, sizeof(line), fp) && n < size; ln++) {
+	for (n = 0, ln = 1; !feof(fp) && fgets(line, sizeof(line), fp); ln++) {
+		// Make room for next entry.
+		if (!grow(n + 1)) {
+			META_WARNING("ini: Out of memory; skipping rest of %s", inifile);
+			break;
+		}
 		// Remove line terminations.
 		char* cp;
 		if ((cp = strrchr(line, '\r')))
@@ -379,36 +517,37 @@ mBOOL DLLINTERNAL MPluginList::ini_startup() {
 		if ((cp = strrchr(line, '\n')))
 			*cp = '\0';
 		// Parse directly into next entry in array
-		if (!plist[n].ini_parseline(line)) {
+		if (!plist[n]->ini_parseline(line)) {
 			if (meta_errno == ME_FORMAT)
 				META_WARNING("ini: Skipping malformed line %d of %s", ln,
 					inifile);
 			continue;
 		}
 		// Check for a duplicate - an existing entry with this pathname.
-		if (find(plist[n].pathname)) {
+		if (find(plist[n]->pathname)) {
 			// Should we check platform specific level here?
 			META_INFO("ini: Skipping duplicate plugin, line %d of %s: %s",
-				ln, inifile, plist[n].pathname);
+				ln, inifile, plist[n]->pathname);
 			continue;
 		}
 		// Check for a matching platform with different platform specifics
 		// level.
-		if (nullptr != (pmatch = find_match(&plist[n]))) {
-			if (pmatch->pfspecific >= plist[n].pfspecific) {
+		if (nullptr != (pmatch = find_match(plist[n]))) {
+			if (pmatch->pfspecific >= plist[n]->pfspecific) {
 				META_DEBUG(1, ("ini: Skipping plugin, line %d of %s: plugin with higher platform specific level already exists. (%d >= %d)",
-					ln, inifile, pmatch->pfspecific, plist[n].pfspecific));
+					ln, inifile, pmatch->pfspecific, plist[n]->pfspecific));
 				continue;
 			}
 			META_DEBUG(1, ("ini: Plugin in line %d overrides existing plugin with lower platform specific level %d, ours %d",
-				ln, pmatch->pfspecific, plist[n].pfspecific));
+				ln, pmatch->pfspecific, plist[n]->pfspecific));
 			//reset to empty
 			reset_plugin(pmatch);
 		}
-		plist[n].action = PA_LOAD;
-		META_LOG("ini: Read plugin config for: %s", plist[n].desc);
+		plist[n]->action = PA_LOAD;
+		META_LOG("ini: Read plugin config for: %s", plist[n]->desc);
 		n++;
 		endlist = n;		// mark end of list
+		index_stale = mTRUE;
 	}
 	META_LOG("ini: Finished reading plugins list: %s; Found %d plugins to load",
 		inifile, n);
@@ -420,31 +559,35 @@ mBOOL DLLINTERNAL MPluginList::ini_startup() {
 	return mTRUE;
 }
 
-// Re-read plugins.ini looking for added/deleted/changed plugins.
+// Re-read plugins.ini looking for added/deleted/changed plugins.  The
+// file comes from memory if it's watched, so at changelevel this needn't
+// touch the disk unless plugins changed.
 // meta_errno values:
 //  - ME_NOFILE		ini file missing or empty
 mBOOL DLLINTERNAL MPluginList::ini_refresh() {
-	char line[MAX_STRBUF_LEN];
+	char* line, * next;
 	int n, ln;
 	MPlugin pl_temp = MPlugin(); // value-initialization
 	MPlugin* pl_found, * pl_added;
 
-	FILE* fp = fopen(inifile, "r");
-	if (!fp) {
+	char* contents = filewatch_read(inifile);
+	if (!contents) {
 		META_WARNING("ini: Unable to open plugins file '%s': %s", inifile,
 			strerror(errno));
 		RETURN_ERRNO(mFALSE, ME_NOFILE);
 	}
 
 	META_DEBUG(3, ("ini: Begin re-reading plugins list: %s", inifile));
-	for (n = 0, ln = 1; !feof(fp) && fgets(line, sizeof(line), fp) && n < size; ln++)
+	for (n = 0, ln = 1, line = contents; line; line = next, ln++)
 	{
-		// Remove line terminations.
+		// Split off line, and remove line terminations.
 		char* cp;
+		if ((next = strchr(line, '\n')))
+			*next++ = '\0';
+		else if (!line[0])
+			break;
 		if ((cp = strrchr(line, '\r')))
 			*cp = '\0';
-		if ((cp = strrchr(line, '\n')))
-			*cp = '\0';
 
 		// No need for memset now
 		//memset(&pl_temp, 0, sizeof(pl_temp));
@@ -526,7 +669,7 @@ mBOOL DLLINTERNAL MPluginList::ini_refresh() {
 	}
 	META_DEBUG(3, ("ini: Finished reading plugins list: %s; Found %d plugins", inifile, n));
 
-	fclose(fp);
+	free(contents);
 	if (!n) {
 		META_WARNING("ini: Warning; no plugins found to load?");
 	}
@@ -692,13 +835,13 @@ mBOOL DLLINTERNAL MPluginList::load() {
 
 	META_LOG("dll: Loading plugins...");
 	for (i = 0, n = 0; i < endlist; i++) {
-		if (plist[i].status < PL_VALID)
+		if (plist[i]->status < PL_VALID)
 			continue;
-		if (plist[i].load(PT_STARTUP) == mTRUE)
+		if (plist[i]->load(PT_STARTUP) == mTRUE)
 			n++;
 		else
 			// all plugins should be loadable at startup...
-			META_WARNING("dll: Failed to load plugin '%s'", plist[i].file);
+			META_WARNING("dll: Failed to load plugin '%s'", plist[i]->file);
 	}
 	META_LOG("dll: Finished loading %d plugins", n);
 	return mTRUE;
@@ -718,7 +861,7 @@ mBOOL DLLINTERNAL MPluginList::refresh(const PLUG_LOADTIME now) {
 
 	META_DEBUG(3, ("dll: Updating plugins..."));
 	for (int i = 0; i < endlist; i++) {
-		MPlugin* iplug = &plist[i];
+		MPlugin* iplug = plist[i];
 		if (iplug->status < PL_VALID)
 			continue;
 		switch (iplug->action) {
@@ -787,7 +930,7 @@ mBOOL DLLINTERNAL MPluginList::refresh(const PLUG_LOADTIME now) {
 //  - none
 void DLLINTERNAL MPluginList::unpause_all() {
 	for (int i = 0; i < endlist; i++) {
-		MPlugin* iplug = &plist[i];
+		MPlugin* iplug = plist[i];
 		if (iplug->status == PL_PAUSED)
 			iplug->unpause();
 	}
@@ -799,7 +942,7 @@ void DLLINTERNAL MPluginList::unpause_all() {
 //  - none
 void DLLINTERNAL MPluginList::retry_all(const PLUG_LOADTIME now) {
 	for (int i = 0; i < endlist; i++) {
-		MPlugin* iplug = &plist[i];
+		MPlugin* iplug = plist[i];
 		if (iplug->action != PA_NONE)
 			iplug->retry(now, PNL_DELAYED);
 	}
@@ -827,7 +970,7 @@ void DLLINTERNAL MPluginList::show(const int source_index) const
 		"load ", "unlod");
 
 	for (int i = 0; i < endlist; i++) {
-		const MPlugin* pl = &plist[i];
+		const MPlugin* pl = plist[i];
 		if (pl->status < PL_VALID)
 			continue;
 		if (source_index > 0 && pl->source_plugin_index != source_index)
@@ -853,6 +996,69 @@ void DLLINTERNAL MPluginList::show(const int source_index) const
 	META_CONS("%d plugins, %d running", n, r);
 }
 
+// List what the next refresh (at changelevel) would do, without doing it:
+// plugins added to or removed from the inifile, plugins with newer files,
+// and plugin actions still waiting.  Returns number of changes.
+// meta_errno values:
+//  - none
+int DLLINTERNAL MPluginList::show_pending() {
+	char* line, * next;
+	int n = 0;
+	MPlugin pl_temp = MPlugin(); // value-initialization
+	MPlugin* pl_found;
+
+	char* seen = static_cast<char*>(calloc(static_cast<size_t>(endlist) + 1, 1));
+	char* contents = filewatch_read(inifile);
+	const mBOOL have_ini = contents ? mTRUE : mFALSE;
+	if (!contents)
+		META_CONS("  Unable to read plugins file '%s': %s", inifile, strerror(errno));
+	for (line = contents; line; line = next) {
+		char* cp;
+		if ((next = strchr(line, '\n')))
+			*next++ = '\0';
+		else if (!line[0])
+			break;
+		if ((cp = strrchr(line, '\r')))
+			*cp = '\0';
+		if (!pl_temp.ini_parseline(line))
+			continue;
+		if ((pl_found = find(pl_temp.pathname))) {
+			if (seen)
+				seen[pl_found->index - 1] = 1;
+			// waiting actions are listed below
+			if (pl_found->action == PA_NONE && pl_found->status >= PL_OPENED && pl_found->newer_file()) {
+				META_CONS("  reload  %-20s (newer file on disk%s)", pl_found->desc,
+					stage_ready(pl_found->pathname) ? ", staged" : "");
+				n++;
+			}
+			continue;
+		}
+		// same plugin for another platform specific level
+		if ((pl_found = find_match(&pl_temp)) && pl_found->pfspecific >= pl_temp.pfspecific)
+			continue;
+		META_CONS("  load    %-20s (%s)", pl_temp.desc, pl_temp.file);
+		n++;
+	}
+	free(contents);
+
+	for (int i = 0; i < endlist; i++) {
+		const MPlugin* iplug = plist[i];
+		if (iplug->status < PL_VALID)
+			continue;
+		if (iplug->action != PA_NONE && iplug->action != PA_KEEP) {
+			META_CONS("  %-7s %-20s (waiting)", iplug->str_action(), iplug->desc);
+			n++;
+		}
+		// If the inifile couldn't be read, refresh won't unload anything.
+		else if (have_ini && seen && !seen[i] && iplug->source == PS_INI && iplug->status >= PL_RUNNING) {
+			META_CONS("  unload  %-20s (removed from %s)", iplug->desc, inifile);
+			n++;
+		}
+	}
+	free(seen);
+	return n;
+}
+
 // List plugins and information to Player/client entity.  Differs from the
 // "meta list" console command in that:
 //  - Shows only "running" plugins, skipping any failed or paused plugins.
@@ -865,7 +1071,7 @@ void DLLINTERNAL MPluginList::show_client(edict_t* pEntity) const
 	int n = 0;
 	META_CLIENT(pEntity, "Currently running plugins:");
 	for (int i = 0; i < endlist; i++) {
-		const MPlugin* pl = &plist[i];
+		const MPlugin* pl = plist[i];
 		if (pl->status != PL_RUNNING || !pl->info)
 			continue;
 		n++;
@@ -42,19 +42,24 @@
 #include "plinfo.h"			// plid_t, etc
 #include "new_baseclass.h"
 
- // Max number of plugins we can manage.  This is an arbitrary, fixed number,
- // for convenience.  It would probably be better to dynamically grow the
- // list as needed, but we do this for now.
-constexpr int MAX_PLUGINS = 50;
-// Width required to printf above MAX, for show() functions.
+ // Width required to printf plugin indexes, for show() functions.  The
+ // list grows as needed, so wider indexes just push the columns over.
 constexpr int WIDTH_MAX_PLUGINS = 2;
 
 // A list of plugins.
+//
+// Plugins are allocated one at a time and never moved or freed, so a
+// plugin's index (1-based position in the list) and pointer stay valid
+// for the life of the list; only the array of pointers grows.  Lookups by
+// plid, handle, pathname and file name go through hash indexes, rebuilt
+// from the list on the next lookup after add, reset_plugin or mark_stale
+// (which MPlugin calls when its own load sets plid or handle).  A miss on
+// an index that's up to date is a miss.
 class MPluginList : public class_metamod_new {
 public:
 	// data:
-	MPlugin plist[MAX_PLUGINS];			// array of plugins
-	int size;					// size of list, ie MAX_PLUGINS
+	MPlugin** plist;				// array of plugins
+	int size;					// allocated entries of plist
 	int endlist;					// index of last used entry
 	char inifile[PATH_MAX];				// full pathname
 
@@ -62,7 +67,7 @@ public:
 	MPluginList(const char* ifile) DLLINTERNAL;
 
 	// functions:
-	void DLLINTERNAL reset_plugin(MPlugin* pl_find) const;
+	void DLLINTERNAL reset_plugin(MPlugin* pl_find);
 	MPlugin* DLLINTERNAL find(int pindex);			// find by index
 	MPlugin* DLLINTERNAL find(const char* findpath); 	// find by pathname
 	MPlugin* DLLINTERNAL find(plid_t id);			// find by plid_t
@@ -71,10 +76,14 @@ public:
 	MPlugin* DLLINTERNAL find_match(const char* prefix);	// find by partial prefix match
 	MPlugin* DLLINTERNAL find_match(const MPlugin* pmatch);	// find by platform_match()
 	MPlugin* DLLINTERNAL add(const MPlugin* padd);
+	mBOOL DLLINTERNAL grow(int want);			// allocate entries up to want
 
 	mBOOL DLLINTERNAL found_child_plugins(int source_index) const;
 	void DLLINTERNAL clear_source_plugin_index(int source_index);
 	void DLLINTERNAL trim_list();
+	// A plugin's plid or handle changed (set by its own load, not through
+	// the list), so the indexes need rebuilding before the next lookup.
+	void DLLINTERNAL mark_stale() { index_stale = mTRUE; }
 
 	mBOOL DLLINTERNAL ini_startup();			// read inifile at startup
 	mBOOL DLLINTERNAL ini_refresh();			// re-read inifile
@@ -88,6 +97,20 @@ public:
 	void DLLINTERNAL show(int source_index) const;		// list plugins to console
 	void DLLINTERNAL show() const { show(-1); } // list plugins to console
 	void DLLINTERNAL show_client(edict_t* pEntity) const;		// list plugins to player client
+	int DLLINTERNAL show_pending();			// list changes of next refresh
+
+private:
+	// Open addressed hash indexes by plid, handle, pathname and file,
+	// index_size entries each; entries are 1-based plugin indexes, 0 if
+	// empty.  Hits are checked against the plugin, so entries left by
+	// plugins since unloaded or changed are harmless.
+	int* indexes;
+	unsigned int index_size;			// power of 2
+	mBOOL index_stale;				// plugin added/changed; see mark_stale
+
+	mBOOL DLLINTERNAL reindex();
+	MPlugin* DLLINTERNAL probe(int which, unsigned int hash, const void* key, int (*match)(const MPlugin*, const void*), const MPlugin* skip) const;
+	MPlugin* DLLINTERNAL find_indexed(int which, unsigned int hash, const void* key, int (*match)(const MPlugin*, const void*));
 };
 
 #endif /* MLIST_H */
@@ -53,6 +53,13 @@
 #include "log_meta.h"			// logging functions, etc
 #include "osdep.h"				// win32 snprintf, is_absolute_path,
 #include "mm_pextensions.h"
+#include "usermsg.h"				// umsg_unhook_plugin
+#include "diag_meta.h"			// diag_plugin_unloaded
+#include "cvarwatch.h"			// cvarwatch_remove_plugin
+#include "cvarquery.h"			// cvarquery_remove_plugin
+#include "edictslot.h"			// edictslot_remove_plugin
+#include "filewatch.h"			// filewatch_time, filewatch_id
+#include "stageload.h"			// stage_take, etc
 
  // Parse a line from plugins.ini into a plugin.
  // meta_errno values:
@@ -555,7 +562,7 @@ mBOOL DLLINTERNAL MPlugin::load(const PLUG_LOADTIME now) {
 
 	if (status <= PL_OPENED) {
 		// query plugin; open file and get info about it
-		if (!query()) {
+		if (!query(nullptr)) {
 			META_WARNING("dll: Skipping plugin '%s'; couldn't query", desc);
 			if (meta_errno != ME_DLOPEN) {
 				if (DLCLOSE(handle) != 0) {
@@ -603,6 +610,8 @@ mBOOL DLLINTERNAL MPlugin::load(const PLUG_LOADTIME now) {
 
 	status = PL_RUNNING;
 	action = PA_NONE;
+	Hooks->rebuild();
+	stage_track(pathname);
 
 	// If not loading at server startup, then need to call plugin's
 	// GameInit, since we've passed that.
@@ -623,7 +632,7 @@ mBOOL DLLINTERNAL MPlugin::load(const PLUG_LOADTIME now) {
 }
 
 // Query a plugin:
-//  - dlopen() the file, store the handle
+//  - dlopen() the file, store the handle, or use the one given
 //  - dlsym() and call:
 //	    Meta_Init (if present) - tell dll it'll be used as a metamod plugin
 //	    GiveFnptrsToDll - give engine function ptrs
@@ -633,12 +642,12 @@ mBOOL DLLINTERNAL MPlugin::load(const PLUG_LOADTIME now) {
 //  - ME_DLMISSING	couldn't find a query() or giveFuncs() in plugin
 //  - ME_DLERROR	plugin query() returned error
 //  - ME_NULLDATA	info struct from query() was null
-mBOOL DLLINTERNAL MPlugin::query() {
+mBOOL DLLINTERNAL MPlugin::query(DLHANDLE opened) {
 	META_GIVE_PEXT_FUNCTIONS_FN pfn_give_pext_funcs;
 	GIVE_ENGINE_FUNCTIONS_FN pfn_give_engfuncs;
 
-	// open the plugin DLL
-	if (!((handle = DLOPEN(pathname)))) {
+	// open the plugin DLL, unless a staged copy was opened already
+	if (!((handle = opened ? opened : DLOPEN(pathname)))) {
 		META_WARNING("dll: Failed query plugin '%s'; Couldn't open file '%s': %s",
 			desc, pathname, DLERROR());
 		RETURN_ERRNO(mFALSE, ME_DLOPEN);
@@ -709,7 +718,10 @@ mBOOL DLLINTERNAL MPlugin::query() {
 	// same reason.
 	memcpy(&mutil_funcs, &MetaUtilFunctions, sizeof(mutil_funcs));
 
-	if (pfn_query(META_INTERFACE_VERSION, &info, &mutil_funcs) != TRUE) {
+	const int queried = pfn_query(META_INTERFACE_VERSION, &info, &mutil_funcs);
+	// new handle and plid, for lookups from here on
+	Plugins->mark_stale();
+	if (queried != TRUE) {
 		META_WARNING("dll: Failed query plugin '%s'; Meta_Query returned error",
 			desc);
 		meta_errno = ME_DLERROR;
@@ -1058,14 +1070,8 @@ mBOOL DLLINTERNAL MPlugin::unload(const PLUG_LOADTIME now, const PL_UNLOAD_REASO
 	}
 
 	// successful detach, or forced unload
-
-	// clear source_plugin_index for all plugins that this plugin has loaded
-	Plugins->clear_source_plugin_index(index);
-
-	// Unmark registered commands for this plugin (by index number).
-	RegCmds->disable(index);
-	// Unmark registered cvars for this plugin (by index number).
-	RegCvars->disable(index);
+	unregister();
+	stage_untrack(pathname);
 
 	// Close the file.  Note: after this, attempts to reference any memory
 	// locations in the file will produce a segfault.
@@ -1085,6 +1091,7 @@ mBOOL DLLINTERNAL MPlugin::unload(const PLUG_LOADTIME now, const PL_UNLOAD_REASO
 		action = PA_LOAD;
 		clear();
 	}
+	Hooks->rebuild();
 	META_LOG("dll: Unloaded plugin '%s' for reason '%s'", desc, str_reason(reason, real_reason));
 	return mTRUE;
 }
@@ -1118,6 +1125,27 @@ mBOOL DLLINTERNAL MPlugin::detach(const PLUG_LOADTIME now, const PL_UNLOAD_REASO
 	return mTRUE;
 }
 
+// Forget what a detached plugin registered with us.
+void DLLINTERNAL MPlugin::unregister() const {
+	// clear source_plugin_index for all plugins that this plugin has loaded
+	Plugins->clear_source_plugin_index(index);
+
+	// Unmark registered commands for this plugin (by index number).
+	RegCmds->disable(index);
+	// Unmark registered cvars for this plugin (by index number).
+	RegCvars->disable(index);
+	// Remove user message hooks of this plugin.
+	umsg_unhook_plugin(index);
+	// Remove cvar watches of this plugin.
+	cvarwatch_remove_plugin(index);
+	// Drop client cvar requests of this plugin.
+	cvarquery_remove_plugin(index);
+	// Free per-edict storage of this plugin.
+	edictslot_remove_plugin(index);
+	// Summarize and forget warnings counted for this plugin.
+	diag_plugin_unloaded(index);
+}
+
 // Reload a plugin; unload and load again.
 // meta_errno values:
 //  - ME_NOTALLOWED	plugin not loadable after startup
@@ -1145,6 +1173,15 @@ mBOOL DLLINTERNAL MPlugin::reload(const PLUG_LOADTIME now, PL_UNLOAD_REASON reas
 		RETURN_ERRNO(mFALSE, ME_NOTALLOWED);
 	}
 
+	// If the updated file was already opened mid-map, swap to it, unless
+	// unload would be delayed or refused now.
+	if (status >= PL_RUNNING && (!info || info->unloadable >= now || reason == PNL_CMD_FORCED)) {
+		filewatch_id_t file_id;
+		DLHANDLE staged;
+		if (filewatch_id(pathname, &file_id) && ((staged = stage_take(pathname, &file_id))))
+			return reload_staged(now, reason, staged);
+	}
+
 	//this is to fix unloading
 	if (status < PL_RUNNING) {
 		META_WARNING("dll: Plugin '%s' isn't running; Forcing unload plugin for reloading", desc);
@@ -1163,6 +1200,89 @@ mBOOL DLLINTERNAL MPlugin::reload(const PLUG_LOADTIME now, PL_UNLOAD_REASON reas
 	return mTRUE;
 }
 
+// Reload a running plugin from a copy of its file opened beforehand (see
+// stageload.h).  The copy is queried while the old one still runs, and
+// the old one is only closed once the copy is attached; if the copy
+// fails, the old one is kept, or attached again.
+// meta_errno values:
+//  - ME_DELAYED	new version can't attach now; old one kept
+//  - ME_NOTALLOWED	new version not loadable after startup; old one kept
+//  - errno's from query()
+//  - errno's from attach()
+//  - errno's from detach()
+mBOOL DLLINTERNAL MPlugin::reload_staged(const PLUG_LOADTIME now, const PL_UNLOAD_REASON reason, DLHANDLE staged) {
+	DLHANDLE old_handle = handle;
+	plugin_info_t* old_info = info;
+
+	const mBOOL queried = query(staged);
+	if (!queried || info->loadable < now) {
+		const META_ERRNO err = !queried ? meta_errno
+			: (info->loadable > PT_STARTUP) ? ME_DELAYED : ME_NOTALLOWED;
+		META_WARNING("dll: Not reloading plugin '%s' from staged copy; keeping loaded version", desc);
+		if (DLCLOSE(staged) != 0)
+			META_WARNING("dll: Couldn't close staged copy of plugin file '%s': %s", file, DLERROR());
+		handle = old_handle;
+		info = old_info;
+		Plugins->mark_stale();
+		action = PA_NONE;
+		RETURN_ERRNO(mFALSE, err);
+	}
+	plugin_info_t* new_info = info;
+
+	handle = old_handle;
+	info = old_info;
+	Plugins->mark_stale();
+	if (!detach(now, reason) && reason != PNL_CMD_FORCED) {
+		META_WARNING("dll: Failed to detach plugin '%s' for reloading; keeping loaded version", desc);
+		const META_ERRNO err = meta_errno;
+		if (DLCLOSE(staged) != 0)
+			META_WARNING("dll: Couldn't close staged copy of plugin file '%s': %s", file, DLERROR());
+		action = PA_NONE;
+		RETURN_ERRNO(mFALSE, err);
+	}
+	unregister();
+
+	handle = staged;
+	info = new_info;
+	Plugins->mark_stale();
+	if (!attach(now)) {
+		const META_ERRNO err = meta_errno;
+		// Like a failed load, the copy stays open; it may have handed
+		// out pointers into itself before failing.
+		unregister();
+		handle = old_handle;
+		info = old_info;
+		Plugins->mark_stale();
+		META_WARNING("dll: Failed to attach staged copy of plugin '%s'; reattaching loaded version", desc);
+		if (!attach(now)) {
+			META_WARNING("dll: Failed to reattach plugin '%s'", desc);
+			status = PL_FAILED;
+			Hooks->rebuild();
+			RETURN_ERRNO(mFALSE, err);
+		}
+		action = PA_NONE;
+		Hooks->rebuild();
+		RETURN_ERRNO(mFALSE, err);
+	}
+
+	if (DLCLOSE(old_handle) != 0)
+		META_WARNING("dll: Couldn't dlclose plugin file '%s': %s", file, DLERROR());
+	status = PL_RUNNING;
+	action = PA_NONE;
+	Hooks->rebuild();
+
+	// As in load().
+	if (now != PT_STARTUP) {
+		FN_GAMEINIT pfn_gameinit;
+		if (tables.dllapi && ((pfn_gameinit = tables.dllapi->pfnGameInit)))
+			pfn_gameinit();
+	}
+
+	META_LOG("dll: Reloaded plugin '%s' from staged copy for reason '%s': %s v%s %s, %s", desc,
+		str_reason(reason, reason), info->name, info->version, info->date, info->author);
+	return mTRUE;
+}
+
 // Pause a plugin; temporarily disabled for API routines.
 // meta_errno values:
 //  - ME_ALREADY	this plugin already paused
@@ -1186,6 +1306,7 @@ mBOOL MPlugin::pause() {
 	}
 
 	status = PL_PAUSED;
+	Hooks->rebuild();
 	META_LOG("Paused plugin '%s'", desc);
 	return mTRUE;
 }
@@ -1199,6 +1320,7 @@ mBOOL DLLINTERNAL MPlugin::unpause() {
 		RETURN_ERRNO(mFALSE, ME_BADREQ);
 	}
 	status = PL_RUNNING;
+	Hooks->rebuild();
 	META_LOG("Unpaused plugin '%s'", desc);
 	return mTRUE;
 }
@@ -1370,13 +1492,13 @@ void DLLINTERNAL MPlugin::show() const {
 //  - ME_NOERROR	no error; false indicates file not newer
 mBOOL DLLINTERNAL MPlugin::newer_file() const
 {
-	struct stat st;
+	time_t file_time;
 
-	if (stat(pathname, &st) != 0)
+	// newer of mtime and ctime, from memory if the file is watched
+	if (!filewatch_time(pathname, &file_time))
 		RETURN_ERRNO(mFALSE, ME_NOFILE);
-	const time_t file_time = st.st_ctime > st.st_mtime ? st.st_ctime : st.st_mtime;
-	META_DEBUG(5, ("newer_file? file=%s; load=%d, file=%d; ctime=%d, mtime=%d",
-		file, time_loaded, file_time, st.st_ctime, st.st_mtime));
+	META_DEBUG(5, ("newer_file? file=%s; load=%d, file=%d",
+		file, time_loaded, file_time));
 	if (file_time > time_loaded)
 		return mTRUE;
 	RETURN_ERRNO(mFALSE, ME_NOERROR);
@@ -207,9 +207,11 @@ public:
 	}
 
 private:
-	mBOOL DLLINTERNAL query();
+	mBOOL DLLINTERNAL query(DLHANDLE opened);
 	mBOOL DLLINTERNAL attach(PLUG_LOADTIME now);
 	mBOOL DLLINTERNAL detach(PLUG_LOADTIME now, PL_UNLOAD_REASON reason) const;
+	void DLLINTERNAL unregister() const;
+	mBOOL DLLINTERNAL reload_staged(PLUG_LOADTIME now, PL_UNLOAD_REASON reason, DLHANDLE staged);
 
 	gamedll_funcs_t gamedll_funcs = {};
 	mutil_funcs_t mutil_funcs = {};
@@ -55,6 +55,137 @@
 #include "types_meta.h"		// mBOOL
 #include "log_meta.h"		// META_LOG, etc
 #include "osdep.h"			// os_safe_call, etc
+#include "sdk_util.h"		// SVC_TEMPENTITY, etc
+#include "support_meta.h"	// mm_strhash, etc
+
+// Smallest power of 2 hash size that keeps the given number of entries at
+// most half full.
+static unsigned int reg_hash_size(const int entries) {
+	unsigned int n = 16;
+	while (n < 2 * static_cast<unsigned int>(entries))
+		n <<= 1;
+	return n;
+}
+
+///// Helpers shared by MRegCmdList and MRegCvarList:
+
+static const char* reg_name(const MRegCmd* icmd) { return icmd->name; }
+static const char* reg_name(const MRegCvar* icvar) { return icvar->data->name; }
+
+// Put entry in hash by name, unless an entry of same name is already
+// there.  Names are compared without case, as the engine does for cmds
+// and cvars.
+template<typename T>
+static void reg_hash_add(T** hash, const unsigned int hash_size, T* ient) {
+	const char* name = reg_name(ient);
+	if (!name)
+		return;
+	const unsigned int mask = hash_size - 1;
+	for (unsigned int i = mm_strcasehash(name) & mask; ; i = (i + 1) & mask) {
+		if (!hash[i]) {
+			hash[i] = ient;
+			return;
+		}
+		if (!strcasecmp(reg_name(hash[i]), name))
+			return;
+	}
+}
+
+template<typename T>
+static T* reg_hash_find(T** hash, const unsigned int hash_size, const char* findname) {
+	if (!findname || !hash_size)
+		RETURN_ERRNO(nullptr, ME_NOTFOUND);
+	const unsigned int mask = hash_size - 1;
+	for (unsigned int i = mm_strcasehash(findname) & mask; hash[i]; i = (i + 1) & mask) {
+		if (!strcasecmp(reg_name(hash[i]), findname))
+			return hash[i];
+	}
+	RETURN_ERRNO(nullptr, ME_NOTFOUND);
+}
+
+// Grow the list of entry pointers by a block of new entries.  Entries are
+// never moved, so callers can hold on to them across add().
+// meta_errno values:
+//  - ME_NOMEM			couldn't allocate block or list
+template<typename T>
+static mBOOL reg_grow(T**& list, int& size, const int growsize) {
+	T* block = static_cast<T*>(calloc(static_cast<size_t>(growsize), sizeof(T)));
+	if (!block)
+		RETURN_ERRNO(mFALSE, ME_NOMEM);
+	T** temp = static_cast<T**>(realloc(list, static_cast<size_t>(size + growsize) * sizeof(T*)));
+	if (!temp) {
+		free(block);
+		RETURN_ERRNO(mFALSE, ME_NOMEM);
+	}
+	list = temp;
+	for (int i = 0; i < growsize; i++) {
+		block[i].init(size + i + 1);		// 1-based
+		list[size + i] = &block[i];
+	}
+	size += growsize;
+	return mTRUE;
+}
+
+// Rebuild hash by name with the given size.
+// meta_errno values:
+//  - ME_NOMEM			couldn't allocate hash
+template<typename T>
+static mBOOL reg_reindex(T**& hash, unsigned int& hash_size, T* const* list, const int endlist, const unsigned int newsize) {
+	T** temp = static_cast<T**>(calloc(newsize, sizeof(T*)));
+	if (!temp)
+		RETURN_ERRNO(mFALSE, ME_NOMEM);
+	free(hash);
+	hash = temp;
+	hash_size = newsize;
+	// in order added, so first entry of a name is found
+	for (int i = 0; i < endlist; i++)
+		reg_hash_add(hash, hash_size, list[i]);
+	return mTRUE;
+}
+
+// Remove entry from its plugin's chain, if it's on one.
+template<typename T>
+static void reg_unlink(T** heads, const int nheads, T* ient) {
+	if (ient->plug_prev)
+		ient->plug_prev->plug_next = ient->plug_next;
+	else if (ient->plugid > 0 && ient->plugid < nheads && heads[ient->plugid] == ient)
+		heads[ient->plugid] = ient->plug_next;
+	else
+		return;
+	if (ient->plug_next)
+		ient->plug_next->plug_prev = ient->plug_prev;
+	ient->plug_prev = nullptr;
+	ient->plug_next = nullptr;
+}
+
+// Put entry at the head of the given plugin's chain, so the plugin's
+// entries can be disabled without walking the whole list.  Unknown
+// plugins (index 0) don't get a chain.
+template<typename T>
+static void reg_link(T**& heads, int& nheads, T* ient, const int plugin_id) {
+	reg_unlink(heads, nheads, ient);
+	ient->plugid = plugin_id;
+	if (plugin_id <= 0)
+		return;
+	if (plugin_id >= nheads) {
+		int newsize = nheads ? nheads : 16;
+		while (newsize <= plugin_id)
+			newsize *= 2;
+		T** temp = static_cast<T**>(realloc(heads, static_cast<size_t>(newsize) * sizeof(T*)));
+		if (!temp) {
+			// still valid; just found by a walk of the whole list
+			META_WARNING("Couldn't grow reg plugin chains to %d: %s", newsize, strerror(errno));
+			return;
+		}
+		memset(temp + nheads, 0, static_cast<size_t>(newsize - nheads) * sizeof(T*));
+		heads = temp;
+		nheads = newsize;
+	}
+	ient->plug_next = heads[plugin_id];
+	if (ient->plug_next)
+		ient->plug_next->plug_prev = ient;
+	heads[plugin_id] = ient;
+}
 
 ///// class MRegCmd:
 
@@ -67,6 +198,9 @@ void DLLINTERNAL MRegCmd::init(const int idx)
 	pfnCmd = nullptr;
 	plugid = 0;
 	status = RG_INVALID;
+	calls = 0;
+	plug_prev = nullptr;
+	plug_next = nullptr;
 }
 
 // Try to call the function.  Relies on OS-specific routine to attempt
@@ -82,6 +216,7 @@ mBOOL DLLINTERNAL MRegCmd::call() {
 	if (!pfnCmd)
 		RETURN_ERRNO(mFALSE, ME_ARGUMENT);
 
+	calls++;
 	// try to call this function
 	const mBOOL ret = os_safe_call(pfnCmd);
 	if (!ret) {
@@ -99,18 +234,13 @@ mBOOL DLLINTERNAL MRegCmd::call() {
 
 // Constructor
 MRegCmdList::MRegCmdList()
-	: mlist(nullptr), size(REG_CMD_GROWSIZE), endlist(0)
+	: mlist(nullptr), size(0), endlist(0), byname(nullptr), byname_size(0), byplugin(nullptr), byplugin_size(0)
 {
-	// Ensure size is unsigned to avoid sign-conversion warnings - [APG]RoboCop[CL]
-	mlist = static_cast<MRegCmd*>(calloc(1, static_cast<std::size_t>(size) * sizeof(MRegCmd)));
-	if (!mlist) {
+	if (!reg_grow(mlist, size, REG_CMD_GROWSIZE)
+		|| !reg_reindex(byname, byname_size, mlist, endlist, reg_hash_size(size)))
+	{
 		META_ERROR("Failed to allocate MRegCmdList");
-		size = 0;
-		return;
 	}
-	// initialize array
-	for (int i = 0; i < size; i++)
-		mlist[i].init(i + 1);		// 1-based index
 }
 
 // Try to find a registered function with the given name.
@@ -120,43 +250,31 @@ MRegCmd* DLLINTERNAL MRegCmdList::find(const char* findname) const
 {
 	if (!findname)
 		RETURN_ERRNO(nullptr, ME_ARGUMENT);
-	
-	for (int i = 0; i < endlist; i++) {
-		if (mlist[i].name && !strcasecmp(mlist[i].name, findname))
-			return &mlist[i];  // Fixed spacing
-	}
-	RETURN_ERRNO(nullptr, ME_NOTFOUND);
+	return reg_hash_find(byname, byname_size, findname);
 }
 
 // Add the given name to the list and return the instance.  This only
-// writes the "name" to the new cmd; other fields are writtin by caller
-// (meta_AddServerCommand).
+// writes the "name" to the new cmd; other fields are written by enable().
 // meta_errno values:
 //  - ME_NOMEM			couldn't realloc or malloc for various parts
 MRegCmd* DLLINTERNAL MRegCmdList::add(const char* addname) {
 	if (endlist == size) {
-		const int newsize = size + REG_CMD_GROWSIZE;
-		META_DEBUG(6, ("Growing reg cmd list from %d to %d", size, newsize));
-		MRegCmd* temp = static_cast<MRegCmd*>(realloc(mlist, static_cast<size_t>(newsize) * sizeof(MRegCmd)));
-		if (!temp) {
-			META_WARNING("Couldn't grow registered command list to %d for '%s': %s", newsize, addname, strerror(errno));
+		META_DEBUG(6, ("Growing reg cmd list from %d to %d", size, size + REG_CMD_GROWSIZE));
+		if (!reg_grow(mlist, size, REG_CMD_GROWSIZE)) {
+			META_WARNING("Couldn't grow registered command list to %d for '%s': %s", size + REG_CMD_GROWSIZE, addname, strerror(errno));
 			RETURN_ERRNO(NULL, ME_NOMEM);
 		}
-		mlist = temp;
-		size = newsize;
-		// initialize new (unused) entries
-		for (int i = endlist; i < size; i++) {
-			memset(&mlist[i], 0, sizeof(mlist[i]));
-			mlist[i].init(i + 1);		// 1-based
-		}
 	}
-	MRegCmd* icmd = &mlist[endlist];
+	if (byname_size < reg_hash_size(endlist + 1)
+		&& !reg_reindex(byname, byname_size, mlist, endlist, reg_hash_size(endlist + 1)))
+	{
+		META_WARNING("Couldn't grow registered command hash for '%s'", addname);
+		RETURN_ERRNO(NULL, ME_NOMEM);
+	}
+	MRegCmd* icmd = mlist[endlist];
 
-	// Malloc space separately for the command name, because:
-	//  - Can't point to memory loc in plugin (another segv waiting to
-	//    happen).
-	//  - Can't point to memory in mlist which might get moved later by
-	//    realloc (again, segv).
+	// Malloc space separately for the command name, because we can't
+	// point to memory loc in plugin (another segv waiting to happen).
 	icmd->name = strdup(addname);
 	if (!icmd->name) {
 		META_WARNING("Couldn't strdup for adding reg cmd name '%s': %s",
@@ -164,16 +282,35 @@ MRegCmd* DLLINTERNAL MRegCmdList::add(const char* addname) {
 		RETURN_ERRNO(NULL, ME_NOMEM);
 	}
 	endlist++;
+	reg_hash_add(byname, byname_size, icmd);
 
 	return icmd;
 }
 
+// Point the given cmd at the function of the given plugin (by index id).
+void DLLINTERNAL MRegCmdList::enable(MRegCmd* icmd, const REG_CMD_FN fn, const int plugin_id) {
+	icmd->pfnCmd = fn;
+	icmd->status = RG_VALID;
+	reg_link(byplugin, byplugin_size, icmd, plugin_id);
+}
+
 // Disable any functions belonging to the given plugin (by index id).
-void DLLINTERNAL MRegCmdList::disable(const int plugin_id) const
-{
-	for (int i = 0; i < size; i++) {
-		if (mlist[i].plugid == plugin_id)
-			mlist[i].status = RG_INVALID;
+void DLLINTERNAL MRegCmdList::disable(const int plugin_id) {
+	if (plugin_id > 0 && plugin_id < byplugin_size) {
+		MRegCmd* inext;
+		for (MRegCmd* icmd = byplugin[plugin_id]; icmd; icmd = inext) {
+			inext = icmd->plug_next;
+			icmd->status = RG_INVALID;
+			icmd->plug_prev = nullptr;
+			icmd->plug_next = nullptr;
+		}
+		byplugin[plugin_id] = nullptr;
+		return;
+	}
+	// not on a chain; happens if the chains couldn't be grown
+	for (int i = 0; i < endlist; i++) {
+		if (mlist[i]->plugid == plugin_id)
+			mlist[i]->status = RG_INVALID;
 	}
 }
 
@@ -184,12 +321,12 @@ void DLLINTERNAL MRegCmdList::show() const
 	char bplug[18 + 1];	// +1 for term null
 
 	META_CONS("Registered plugin commands:");
-	META_CONS("  %*s  %-*s  %-s",
+	META_CONS("  %*s  %-*s  %8s  %-s",
 		WIDTH_MAX_REG, "",
-		sizeof(bplug) - 1, "plugin", "command");
+		sizeof(bplug) - 1, "plugin", "calls", "command");
 
 	for (int i = 0; i < endlist; i++) {
-		const MRegCmd* icmd = &mlist[i];
+		const MRegCmd* icmd = mlist[i];
 
 		if (icmd->status == RG_VALID) {
 			const MPlugin* iplug = Plugins->find(icmd->plugid);
@@ -202,9 +339,10 @@ void DLLINTERNAL MRegCmdList::show() const
 		else
 			STRNCPY(bplug, "(unloaded)", sizeof(bplug));
 
-		META_CONS(" [%*d] %-*s  %-s",
+		META_CONS(" [%*d] %-*s  %8u  %-s",
 			WIDTH_MAX_REG, icmd->index,
 			sizeof(bplug) - 1, bplug,
+			icmd->calls,
 			icmd->name);
 
 		if (icmd->status == RG_VALID)
@@ -220,6 +358,7 @@ void DLLINTERNAL MRegCmdList::show() const
 void DLLINTERNAL MRegCmdList::show(const int plugin_id) const
 {
 	int n = 0;
+	char bname[30 + 1];	// +1 for term null
 
 	/*
 	// If OS doesn't support DLFNAME, then we can't know what the plugin's
@@ -231,12 +370,13 @@ void DLLINTERNAL MRegCmdList::show(const int plugin_id) const
 	}
 	*/
 
-	META_CONS("Registered commands:");
+	META_CONS("%-*s  %8s", sizeof(bname) - 1, "Registered commands:", "calls");
 	for (int i = 0; i < endlist; i++) {
-		const MRegCmd* icmd = &mlist[i];
+		const MRegCmd* icmd = mlist[i];
 		if (icmd->plugid != plugin_id)
 			continue;
-		META_CONS("   %s", icmd->name);
+		STRNCPY(bname, icmd->name, sizeof(bname));
+		META_CONS("   %-*s  %8u", sizeof(bname) - 1, bname, icmd->calls);
 		n++;
 	}
 	META_CONS("%d commands", n);
@@ -252,6 +392,8 @@ void DLLINTERNAL MRegCvar::init(const int idx)
 	data = nullptr;
 	plugid = 0;
 	status = RG_INVALID;
+	plug_prev = nullptr;
+	plug_next = nullptr;
 }
 
 // Set the cvar, copying values from given cvar.
@@ -277,48 +419,39 @@ mBOOL DLLINTERNAL MRegCvar::set(const cvar_t* src) const
 
 // Constructor
 MRegCvarList::MRegCvarList()
-	: vlist(nullptr), size(REG_CVAR_GROWSIZE), endlist(0)
+	: vlist(nullptr), size(0), endlist(0), byname(nullptr), byname_size(0), byplugin(nullptr), byplugin_size(0)
 {
-	// Ensure size is unsigned to avoid sign-conversion warnings - [APG]RoboCop[CL]
-	vlist = static_cast<MRegCvar*>(calloc(1, static_cast<std::size_t>(size) * sizeof(MRegCvar)));
-	// initialize array
-	for (int i = 0; i < size; i++)
-		vlist[i].init(i + 1);		// 1-based
-	endlist = 0;
+	if (!reg_grow(vlist, size, REG_CVAR_GROWSIZE)
+		|| !reg_reindex(byname, byname_size, vlist, endlist, reg_hash_size(size)))
+	{
+		META_ERROR("Failed to allocate MRegCvarList");
+	}
 }
 
 // Add the given cvar name to the list and return the instance.  This only
 // writes the "name" to the new cvar; other fields are written with
-// cvar::set().
+// cvar::set() and enable().
 // meta_errno values:
 //  - ME_NOMEM			couldn't alloc or realloc for various parts
 MRegCvar* DLLINTERNAL MRegCvarList::add(const char* addname) {
 	if (endlist == size) {
-		const int newsize = size + REG_CVAR_GROWSIZE;
-		META_DEBUG(6, ("Growing reg cvar list from %d to %d", size, newsize));
-		MRegCvar* temp = static_cast<MRegCvar*>(
-			realloc(vlist, static_cast<unsigned int>(newsize) * sizeof(MRegCvar))
-			);
-		if (!temp) {
-			META_WARNING("Couldn't grow registered cvar list to %d for '%s'; %s", newsize, addname, strerror(errno));
+		META_DEBUG(6, ("Growing reg cvar list from %d to %d", size, size + REG_CVAR_GROWSIZE));
+		if (!reg_grow(vlist, size, REG_CVAR_GROWSIZE)) {
+			META_WARNING("Couldn't grow registered cvar list to %d for '%s'; %s", size + REG_CVAR_GROWSIZE, addname, strerror(errno));
 			RETURN_ERRNO(NULL, ME_NOMEM);
 		}
-		vlist = temp;
-		size = newsize;
-		// initialize new (unused) entries
-		for (int i = endlist; i < size; i++) {
-			memset(&vlist[i], 0, sizeof(vlist[i]));
-			vlist[i].init(i + 1);        // 1-based
-		}
+	}
+	if (byname_size < reg_hash_size(endlist + 1)
+		&& !reg_reindex(byname, byname_size, vlist, endlist, reg_hash_size(endlist + 1)))
+	{
+		META_WARNING("Couldn't grow registered cvar hash for '%s'", addname);
+		RETURN_ERRNO(NULL, ME_NOMEM);
 	}
 
-	MRegCvar* icvar = &vlist[endlist];
+	MRegCvar* icvar = vlist[endlist];
 
-	// Malloc space for the cvar and cvar name, for two reasons:
-	//  - Can't point to memory loc in plugin (another segv waiting to
-	//    happen).
-	//  - Can't point to memory in vlist which might get moved later by
-	//    realloc (again, segv).
+	// Malloc space for the cvar and cvar name, because we can't point to
+	// memory loc in plugin (another segv waiting to happen).
 	icvar->data = static_cast<cvar_t*>(calloc(1, sizeof(cvar_t)));
 	if (!icvar->data) {
 		META_WARNING("Couldn't malloc cvar for adding reg cvar name '%s': %s",
@@ -334,6 +467,7 @@ MRegCvar* DLLINTERNAL MRegCvarList::add(const char* addname) {
 		RETURN_ERRNO(nullptr, ME_NOMEM);
 	}
 	endlist++;
+	reg_hash_add(byname, byname_size, icvar);
 
 	return icvar;
 }
@@ -343,24 +477,38 @@ MRegCvar* DLLINTERNAL MRegCvarList::add(const char* addname) {
 //  - ME_NOTFOUND	couldn't find a matching cvar
 MRegCvar* DLLINTERNAL MRegCvarList::find(const char* findname) const
 {
-	for (int i = 0; i < endlist; i++) {
-		if (!strcasecmp(vlist[i].data->name, findname))
-			return&vlist[i];
-	}
-	RETURN_ERRNO(NULL, ME_NOTFOUND);
+	return reg_hash_find(byname, byname_size, findname);
+}
+
+// Mark the given cvar as belonging to the given plugin (by index id).
+void DLLINTERNAL MRegCvarList::enable(MRegCvar* icvar, const int plugin_id) {
+	icvar->status = RG_VALID;
+	reg_link(byplugin, byplugin_size, icvar, plugin_id);
 }
 
 // Disable any cvars belonging to the given plugin (by index id).
-void DLLINTERNAL MRegCvarList::disable(const int plugin_id) const
-{
-	for (int i = 0; i < size; i++) {
-		MRegCvar* icvar = &vlist[i];
+void DLLINTERNAL MRegCvarList::disable(const int plugin_id) {
+	// Decided not to reset the cvar values, in order to keep pre-existing
+	// values after a plugin reload.
+	// CVAR_SET_STRING(icvar->data->name, "[metamod: cvar invalid; plugin unloaded]");
+	if (plugin_id > 0 && plugin_id < byplugin_size) {
+		MRegCvar* inext;
+		for (MRegCvar* icvar = byplugin[plugin_id]; icvar; icvar = inext) {
+			inext = icvar->plug_next;
+			icvar->status = RG_INVALID;
+			icvar->plugid = 0;
+			icvar->plug_prev = nullptr;
+			icvar->plug_next = nullptr;
+		}
+		byplugin[plugin_id] = nullptr;
+		return;
+	}
+	// not on a chain; happens if the chains couldn't be grown
+	for (int i = 0; i < endlist; i++) {
+		MRegCvar* icvar = vlist[i];
 		if (icvar->plugid == plugin_id) {
 			icvar->status = RG_INVALID;
 			icvar->plugid = 0;
-			// Decided not to do this, in order to keep pre-existing values
-			// after a plugin reload.
-			// CVAR_SET_STRING(icvar->data->name, "[metamod: cvar invalid; plugin unloaded]");
 		}
 	}
 }
@@ -380,7 +528,7 @@ void DLLINTERNAL MRegCvarList::show() const
 		"string value");
 
 	for (int i = 0; i < endlist; i++) {
-		const MRegCvar* icvar = &vlist[i];
+		const MRegCvar* icvar = vlist[i];
 		if (icvar->status == RG_VALID) {
 			const MPlugin* iplug = Plugins->find(icvar->plugid);
 			if (iplug)
@@ -426,7 +574,7 @@ void DLLINTERNAL MRegCvarList::show(const int plugin_id) const
 		sizeof(bval) - 1, "float value",
 		"string value");
 	for (int i = 0; i < endlist; i++) {
-		const MRegCvar* icvar = &vlist[i];
+		const MRegCvar* icvar = vlist[i];
 		if (icvar->plugid != plugin_id)
 			continue;
 		STRNCPY(bname, icvar->data->name, sizeof(bname));
@@ -443,26 +591,117 @@ void DLLINTERNAL MRegCvarList::show(const int plugin_id) const
 ///// class MRegMsgList:
 
 // Constructor
+// Built-in engine msgs mentioned in the SDK (dlls/util.h); names are
+// guesses.
+static const struct {
+	const char* name;
+	int msgid;
+} builtin_msg_names[] = {
+	{ "tempentity?",	SVC_TEMPENTITY },
+	{ "intermission?",	SVC_INTERMISSION },
+	{ "cdtrack?",		SVC_CDTRACK },
+	{ "weaponanim?",	SVC_WEAPONANIM },
+	{ "roomtype?",		SVC_ROOMTYPE },
+	{ "director?",		SVC_DIRECTOR },
+};
+static MRegMsg builtin_msgs[sizeof(builtin_msg_names) / sizeof(builtin_msg_names[0])];
+
 MRegMsgList::MRegMsgList()
-	: size(MAX_REG_MSGS), endlist(0)
+	: mlist(nullptr), size(REG_MSG_GROWSIZE), endlist(0), byname(nullptr), byname_size(0), generation(0)
 {
-	// initialize array
-	memset(mlist, 0, sizeof(mlist));
-	for (int i = 0; i < size; i++) {
+	memset(byid, 0, sizeof(byid));
+	for (unsigned int i = 0; i < sizeof(builtin_msgs) / sizeof(builtin_msgs[0]); i++) {
+		MRegMsg* imsg = &builtin_msgs[i];
+		imsg->index = 0;
+		imsg->name = builtin_msg_names[i].name;
+		imsg->msgid = builtin_msg_names[i].msgid;
+		imsg->size = -1;
+		byid[imsg->msgid] = imsg;
+	}
+
+	mlist = static_cast<MRegMsg*>(calloc(1, static_cast<size_t>(size) * sizeof(MRegMsg)));
+	if (!mlist || !reindex(reg_hash_size(size))) {
+		META_ERROR("Failed to allocate MRegMsgList");
+		size = 0;
+		return;
+	}
+	for (int i = 0; i < size; i++)
 		mlist[i].index = i + 1;		// 1-based
+}
+
+// Put msg in hash by name, unless a msg of same name is already there.
+void DLLINTERNAL MRegMsgList::hash_add(MRegMsg* imsg) const
+{
+	if (!imsg->name || !imsg->name[0])
+		return;
+	const unsigned int mask = byname_size - 1;
+	for (unsigned int i = mm_strhash(imsg->name) & mask; ; i = (i + 1) & mask) {
+		if (!byname[i]) {
+			byname[i] = imsg;
+			return;
+		}
+		if (!mm_strcmp(byname[i]->name, imsg->name))
+			return;
 	}
-	endlist = 0;
+}
+
+// Rebuild table by msgid and hash by name, with given hash size, after
+// the list is moved or a msg is renamed.
+// meta_errno values:
+//  - ME_NOMEM			couldn't allocate hash
+mBOOL DLLINTERNAL MRegMsgList::reindex(const unsigned int newsize) {
+	if (newsize != byname_size) {
+		MRegMsg** temp = static_cast<MRegMsg**>(calloc(newsize, sizeof(MRegMsg*)));
+		if (!temp)
+			RETURN_ERRNO(mFALSE, ME_NOMEM);
+		free(byname);
+		byname = temp;
+		byname_size = newsize;
+	}
+	else
+		memset(byname, 0, byname_size * sizeof(MRegMsg*));
+
+	for (int i = 0; i < MAX_MSGIDS; i++) {
+		if (byid[i] && !byid[i]->is_builtin())
+			byid[i] = nullptr;
+	}
+	for (MRegMsg& imsg : builtin_msgs)
+		byid[imsg.msgid] = &imsg;
+	// in order added, so first msg of a name or msgid is found
+	for (int i = 0; i < endlist; i++) {
+		MRegMsg* imsg = &mlist[i];
+		const unsigned int id = static_cast<unsigned int>(imsg->msgid);
+		if (id < MAX_MSGIDS && (!byid[id] || byid[id]->is_builtin()))
+			byid[id] = imsg;
+		hash_add(imsg);
+	}
+	return mTRUE;
 }
 
 // Add the given user msg the list and return the instance.
 // meta_errno values:
-//  - ME_MAXREACHED		reached max number of msgs allowed
+//  - ME_NOMEM			couldn't realloc list or hash
 MRegMsg* DLLINTERNAL MRegMsgList::add(const char* addname, const int addmsgid, const int addsize) {
 	if (endlist == size) {
-		// all slots used
-		META_ERROR("Couldn't add registered msg '%s' to list; reached max msgs (%d)",
-			addname, size);
-		RETURN_ERRNO(NULL, ME_MAXREACHED);
+		const int newsize = size + REG_MSG_GROWSIZE;
+		META_DEBUG(6, ("Growing reg msg list from %d to %d", size, newsize));
+		MRegMsg* temp = static_cast<MRegMsg*>(realloc(mlist, static_cast<size_t>(newsize) * sizeof(MRegMsg)));
+		if (!temp) {
+			META_ERROR("Couldn't grow registered msg list to %d for '%s': %s", newsize, addname, strerror(errno));
+			RETURN_ERRNO(NULL, ME_NOMEM);
+		}
+		mlist = temp;
+		size = newsize;
+		// initialize new (unused) entries
+		for (int i = endlist; i < size; i++) {
+			memset(&mlist[i], 0, sizeof(mlist[i]));
+			mlist[i].index = i + 1;		// 1-based
+		}
+		// list moved; keep hash at most half full
+		if (!reindex(reg_hash_size(size))) {
+			META_ERROR("Couldn't grow registered msg hash for '%s'", addname);
+			RETURN_ERRNO(NULL, ME_NOMEM);
+		}
 	}
 
 	MRegMsg* imsg = &mlist[endlist];
@@ -475,29 +714,36 @@ MRegMsg* DLLINTERNAL MRegMsgList::add(const char* addname, const int addmsgid, c
 	imsg->msgid = addmsgid;
 	imsg->size = addsize;
 
+	const unsigned int id = static_cast<unsigned int>(addmsgid);
+	if (id < MAX_MSGIDS && (!byid[id] || byid[id]->is_builtin()))
+		byid[id] = imsg;
+	hash_add(imsg);
+	generation++;
+
 	return imsg;
 }
 
-// Try to find a registered msg with the given name.
-// meta_errno values:
-//  - ME_NOTFOUND	couldn't find a matching cvar
-MRegMsg* DLLINTERNAL MRegMsgList::find(const char* findname) {
-	for (int i = 0; i < endlist; i++) {
-		if (mlist[i].name && !mm_strcmp(mlist[i].name, findname))
-			return&mlist[i];
-	}
-	RETURN_ERRNO(NULL, ME_NOTFOUND);
+// Give a msg, registered with empty or null name, its actual name.
+void DLLINTERNAL MRegMsgList::rename(MRegMsg* imsg, const char* newname, const int newsize) {
+	imsg->name = newname;
+	imsg->size = newsize;
+	reindex(byname_size);
+	generation++;
 }
 
-// Try to find a registered msg with the given msgid.
+// Try to find a registered msg with the given name.
 // meta_errno values:
 //  - ME_NOTFOUND	couldn't find a matching cvar
-MRegMsg* DLLINTERNAL MRegMsgList::find(const int findmsgid) {
-	for (int i = 0; i < endlist; i++) {
-		if (mlist[i].msgid == findmsgid)
-			return&mlist[i];
+MRegMsg* DLLINTERNAL MRegMsgList::find(const char* findname) const
+{
+	if (!findname || !byname_size)
+		RETURN_ERRNO(nullptr, ME_NOTFOUND);
+	const unsigned int mask = byname_size - 1;
+	for (unsigned int i = mm_strhash(findname) & mask; byname[i]; i = (i + 1) & mask) {
+		if (!mm_strcmp(byname[i]->name, findname))
+			return byname[i];
 	}
-	RETURN_ERRNO(NULL, ME_NOTFOUND);
+	RETURN_ERRNO(nullptr, ME_NOTFOUND);
 }
 
 // List the registered usermsgs for the gamedll.
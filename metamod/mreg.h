@@ -45,6 +45,7 @@
  // more cvars than commands, so we grow them at different increments.
 constexpr int REG_CMD_GROWSIZE = 32;
 constexpr int REG_CVAR_GROWSIZE = 64;
+constexpr int REG_MSG_GROWSIZE = 64;
 
 // Width required to printf a Reg*List index number, for show() functions.
 // This used to correspond to the number of digits in MAX_REG, which was a
@@ -55,8 +56,8 @@ constexpr int REG_CVAR_GROWSIZE = 64;
 // lot, if you ask me).
 constexpr int WIDTH_MAX_REG = 4;
 
-// Max number of registered user msgs we can manage.
-constexpr int MAX_REG_MSGS = 256;
+// Number of msgids; msgid is sent as a byte.
+constexpr int MAX_MSGIDS = 256;
 
 // Max number of clients on server
 constexpr int MAX_CLIENTS_CONNECTED = 32;
@@ -81,6 +82,9 @@ public:
 	REG_CMD_FN pfnCmd;		// pointer to the function
 	int plugid;			// index id of corresponding plugin
 	REG_STATUS status;		// whether corresponding plugin is loaded
+	unsigned int calls;		// number of times called
+	MRegCmd* plug_prev;		// chain of this plugin's cmds, kept by list
+	MRegCmd* plug_next;
 // functions:
 	void DLLINTERNAL init(int idx);	// init values, as not using constructors
 	mBOOL DLLINTERNAL call();	// try to call the function
@@ -92,9 +96,14 @@ public:
 	~MRegCmdList() DLLINTERNAL;
 private:
 	// data:
-	MRegCmd* mlist;			// malloc'd array of registered commands
+	MRegCmd** mlist;		// registered commands, malloc'd in blocks
+					// so they never move as the list grows
 	int size;			// current size of list
 	int endlist;			// index of last used entry
+	MRegCmd** byname;		// open addressing hash of cmds by name
+	unsigned int byname_size;	// power of 2
+	MRegCmd** byplugin;		// head of each plugin's chain, by plugin index
+	int byplugin_size;
 	// Private; to satisfy -Weffc++ "has pointer data members but does
 	// not override" copy/assignment constructor.
 	void operator=(const MRegCmdList& src) = delete;
@@ -107,7 +116,8 @@ public:
 	// functions:
 	MRegCmd* DLLINTERNAL find(const char* findname) const;	// find by MRegCmd->name
 	MRegCmd* DLLINTERNAL add(const char* addname);
-	void DLLINTERNAL disable(int plugin_id) const;		// change status to Invalid
+	void DLLINTERNAL enable(MRegCmd* icmd, REG_CMD_FN fn, int plugin_id);	// change status to Valid
+	void DLLINTERNAL disable(int plugin_id);		// change status to Invalid
 	void DLLINTERNAL show() const;			// list all funcs to console
 	void DLLINTERNAL show(int plugin_id) const;		// list given plugin's funcs to console
 };
@@ -122,6 +132,8 @@ public:
 	cvar_t* data;				// actual cvar structure, malloc'd
 	int plugid;				// index id of corresponding plugin
 	REG_STATUS status;			// whether corresponding plugin is loaded
+	MRegCvar* plug_prev;		// chain of this plugin's cvars, kept by list
+	MRegCvar* plug_next;
 // functions:
 	void DLLINTERNAL init(int idx);		// init values, as not using constructors
 	mBOOL DLLINTERNAL set(const cvar_t* src) const;
@@ -133,9 +145,14 @@ public:
 	~MRegCvarList() DLLINTERNAL;
 private:
 	// data:
-	MRegCvar* vlist;		// malloc'd array of registered cvars
+	MRegCvar** vlist;		// registered cvars, malloc'd in blocks so
+					// they never move as the list grows
 	int size;			// size of list, ie MAX_REG_CVARS
 	int endlist;			// index of last used entry
+	MRegCvar** byname;		// open addressing hash of cvars by name
+	unsigned int byname_size;	// power of 2
+	MRegCvar** byplugin;		// head of each plugin's chain, by plugin index
+	int byplugin_size;
 	// Private; to satisfy -Weffc++ "has pointer data members but does
 	// not override" copy/assignment constructor.
 	void operator=(const MRegCvarList& src) = delete;
@@ -148,7 +165,8 @@ public:
 	// functions:
 	MRegCvar* DLLINTERNAL add(const char* addname);
 	MRegCvar* DLLINTERNAL find(const char* findname) const;	// find by MRegCvar->data.name
-	void DLLINTERNAL disable(int plugin_id) const;		// change status to Invalid
+	void DLLINTERNAL enable(MRegCvar* icvar, int plugin_id);	// change status to Valid
+	void DLLINTERNAL disable(int plugin_id);		// change status to Invalid
 	void DLLINTERNAL show() const;			// list all cvars to console
 	void DLLINTERNAL show(int plugin_id) const;		// list given plugin's cvars to console
 };
@@ -158,20 +176,32 @@ class MRegMsg : public class_metamod_new {
 	friend class MRegMsgList;
 private:
 	// data:
-	int index;				// 1-based
+	int index;				// 1-based; 0 for built-in engine msgs
 public:
 	const char* name;		// name, assumed constant string in gamedll
 	int msgid;				// msgid, assigned by engine
 	int size;				// size, if given by gamedll
+
+	mBOOL DLLINTERNAL is_builtin() const { return index ? mFALSE : mTRUE; }
 };
 
-// A list of registered user msgs.
+// A list of registered user msgs, with a table by msgid and a hash by
+// name.  Built-in engine msgs, with guessed names, are only in the table
+// by msgid.
 class MRegMsgList : public class_metamod_new {
 private:
 	// data:
-	MRegMsg mlist[MAX_REG_MSGS];	// array of registered msgs
-	int size;						// size of list, ie MAX_REG_MSGS
+	MRegMsg* mlist;					// array of registered msgs
+	int size;						// size of list, ie allocated entries
 	int endlist;					// index of last used entry
+	MRegMsg* byid[MAX_MSGIDS];		// msgs by msgid
+	MRegMsg** byname;				// open addressing hash of msgs by name
+	unsigned int byname_size;		// power of 2
+	unsigned int generation;		// changed when any msg added or renamed
+
+	// functions:
+	void DLLINTERNAL hash_add(MRegMsg* imsg) const;
+	mBOOL DLLINTERNAL reindex(unsigned int newsize);
 
 public:
 	// constructor:
@@ -179,8 +209,14 @@ public:
 
 	// functions:
 	MRegMsg* DLLINTERNAL add(const char* addname, int addmsgid, int addsize);
-	MRegMsg* DLLINTERNAL find(const char* findname);
-	MRegMsg* DLLINTERNAL find(int findmsgid);
+	void DLLINTERNAL rename(MRegMsg* imsg, const char* newname, int newsize);
+	MRegMsg* DLLINTERNAL find(const char* findname) const;
+	MRegMsg* DLLINTERNAL find(int findmsgid) const {
+		if (likely(static_cast<unsigned int>(findmsgid) < MAX_MSGIDS && byid[findmsgid]))
+			return byid[findmsgid];
+		RETURN_ERRNO(nullptr, ME_NOTFOUND);
+	}
+	unsigned int DLLINTERNAL get_generation() const { return generation; }
 	void DLLINTERNAL show() const;						// list all msgs to console
 };
 
@@ -50,6 +50,12 @@
 #include "types_meta.h"		// mBOOL
 #include "osdep.h"			// win32 vsnprintf, etc
 #include "sdk_util.h"		// ALERT, etc
+#include "usermsg.h"		// umsg_hook, etc
+#include "diag_meta.h"		// diag_warning
+#include "support_meta.h"	// mm_strhash
+#include "cvarwatch.h"		// cvarwatch_add, etc
+#include "cvarquery.h"		// cvarquery_request, etc
+#include "edictslot.h"		// edictslot_alloc, etc
 
 static hudtextparms_t default_csay_tparms = {
 	-1, 0.25,			// x, y
@@ -60,6 +66,12 @@ static hudtextparms_t default_csay_tparms = {
 	1					// channel
 };
 
+// Index of the calling plugin, for diag_warning; 0 if not found.
+static int plugin_index(const plid_t plid) {
+	const MPlugin* plug = Plugins->find(plid);
+	return plug ? plug->index : 0;
+}
+
 // Log to console; newline added.
 static void mutil_LogConsole(plid_t /* plid */, const char* fmt, ...) {
 	va_list ap;
@@ -82,24 +94,28 @@ static void mutil_LogConsole(plid_t /* plid */, const char* fmt, ...) {
 static void mutil_LogMessage(const plid_t plid, const char* fmt, ...) {
 	va_list ap;
 	char buf[MAX_LOGMSG_LEN];
+	char prefix[64];
 
 	const plugin_info_t* plinfo = plid;
+	safevoid_snprintf(prefix, sizeof(prefix), "[%s]", plinfo->logtag);
 	va_start(ap, fmt);
-	safevoid_vsnprintf(buf, sizeof(buf), fmt, ap);
+	log_vformat(buf, sizeof(buf), prefix, fmt, ap);
 	va_end(ap);
-	ALERT(at_logged, "[%s] %s\n", plinfo->logtag, buf);
+	log_write(at_logged, buf, mFALSE);
 }
 
 // Log an error message to logs; newline added.
 static void mutil_LogError(const plid_t plid, const char* fmt, ...) {
 	va_list ap;
 	char buf[MAX_LOGMSG_LEN];
+	char prefix[64];
 
 	const plugin_info_t* plinfo = plid;
+	safevoid_snprintf(prefix, sizeof(prefix), "[%s] ERROR:", plinfo->logtag);
 	va_start(ap, fmt);
-	safevoid_vsnprintf(buf, sizeof(buf), fmt, ap);
+	log_vformat(buf, sizeof(buf), prefix, fmt, ap);
 	va_end(ap);
-	ALERT(at_logged, "[%s] ERROR: %s\n", plinfo->logtag, buf);
+	log_write(at_logged, buf, mTRUE);
 }
 
 // Log a message only if cvar "developer" set; newline added.
@@ -107,14 +123,17 @@ static void mutil_LogDeveloper(const plid_t plid, const char* fmt, ...) {
 	va_list ap;
 	char buf[MAX_LOGMSG_LEN];
 
-	if (static_cast<int>(CVAR_GET_FLOAT("developer")) == 0)
+	const cvar_t* developer = developer_cvar();
+	if (!developer || static_cast<int>(developer->value) == 0)
 		return;
 
+	char prefix[64];
 	const plugin_info_t* plinfo = plid;
+	safevoid_snprintf(prefix, sizeof(prefix), "[%s] dev:", plinfo->logtag);
 	va_start(ap, fmt);
-	safevoid_vsnprintf(buf, sizeof(buf), fmt, ap);
+	log_vformat(buf, sizeof(buf), prefix, fmt, ap);
 	va_end(ap);
-	ALERT(at_logged, "[%s] dev: %s\n", plinfo->logtag, buf);
+	log_write(at_logged, buf, mFALSE);
 }
 
 // Print a center-message, with text parameters and varargs.  Provides
@@ -159,7 +178,8 @@ static qboolean mutil_CallGameEntity(const plid_t plid, const char* entStr, entv
 		plinfo->name));
 	const ENTITY_FN pfnEntity = ENTITY_FN(DLSYM(GameDLL.handle, entStr));
 	if (!pfnEntity) {
-		META_WARNING("Couldn't find game entity '%s' in game DLL '%s' for plugin '%s'", entStr, GameDLL.name, plinfo->name);
+		diag_warning(DIAG_NO_GAME_ENTITY, plugin_index(plid), mm_strhash(entStr),
+			"Couldn't find game entity '%s' in game DLL '%s' for plugin '%s'", entStr, GameDLL.name, plinfo->name);
 		return false;
 	}
 	META_DEBUG(7, ("Calling game entity '%s' for plugin '%s'", entStr,
@@ -193,30 +213,8 @@ static const char* mutil_GetUserMsgName(plid_t plid, const int msgid, int* size)
 #endif
 	META_DEBUG(8, ("Looking up usermsg id '%d' for plugin '%s'", msgid,
 		plinfo->name));
-	// Guess names for any built-in Engine messages mentioned in the SDK;
-	// from dlls/util.h.
-	if (msgid < 64) {
-		switch (msgid) {
-		case SVC_TEMPENTITY:
-			if (size) *size = -1;
-			return"tempentity?";
-		case SVC_INTERMISSION:
-			if (size) *size = -1;
-			return"intermission?";
-		case SVC_CDTRACK:
-			if (size) *size = -1;
-			return"cdtrack?";
-		case SVC_WEAPONANIM:
-			if (size) *size = -1;
-			return"weaponanim?";
-		case SVC_ROOMTYPE:
-			if (size) *size = -1;
-			return"roomtype?";
-		case SVC_DIRECTOR:
-			if (size) *size = -1;
-			return"director?";
-		}
-	}
+	// Includes built-in Engine messages mentioned in the SDK, with
+	// guessed names.
 	const MRegMsg* umsg = RegMsgs->find(msgid);
 	if (umsg) {
 		if (size)
@@ -228,6 +226,13 @@ static const char* mutil_GetUserMsgName(plid_t plid, const int msgid, int* size)
 	return nullptr;
 }
 
+// Return a number that changes whenever a usermsg is registered or
+// renamed, so plugins can tell when usermsg ids and names they looked up
+// might be stale.
+static int mutil_GetUserMsgGeneration(plid_t /*plid*/) {
+	return static_cast<int>(RegMsgs->get_generation());
+}
+
 // Return the full path of the plugin's loaded dll/so file.
 static const char* mutil_GetPluginPath(const plid_t plid) {
 	static char buf[PATH_MAX];
@@ -266,7 +271,7 @@ static const char* mutil_GetGameInfo(const plid_t plid, const ginfo_t type) {
 		cp = GameDLL.real_pathname;
 		break;
 	default:
-		META_WARNING("GetGameInfo: invalid request '%d' from plugin '%s'",
+		diag_warning(DIAG_BAD_GAME_INFO, plugin_index(plid), type, "GetGameInfo: invalid request '%d' from plugin '%s'",
 			type, plid->name);
 		return nullptr;
 	}
@@ -340,7 +345,7 @@ static int mutil_UnloadMetaPluginByHandle(const plid_t plid, void* plugin_handle
 
 // Check if player is being queried for cvar
 static const char* mutil_IsQueryingClientCvar(plid_t /*plid*/, const edict_t* player) {
-	return g_Players.is_querying_cvar(player);
+	return cvarquery_legacy(player);
 }
 
 //
@@ -358,6 +363,75 @@ static void mutil_GetHookTables(plid_t /*plid*/, enginefuncs_t** peng, DLL_FUNCT
 		*pnewdll = g_pHookedNewDllFunctions;
 }
 
+// Hook whole user messages of a type; see usermsg.h.
+static int mutil_HookUserMsg(const plid_t plid, const int msg_type, const USERMSG_FN pfn) {
+	const MPlugin* plug = Plugins->find(plid);
+	if (!plug)
+		return ME_NOTFOUND;
+	return umsg_hook(plug->index, msg_type, pfn);
+}
+
+static int mutil_UnhookUserMsg(const plid_t plid, const int msg_type, const USERMSG_FN pfn) {
+	const MPlugin* plug = Plugins->find(plid);
+	if (!plug)
+		return ME_NOTFOUND;
+	return umsg_unhook(plug->index, msg_type, pfn);
+}
+
+// Resolve a cvar to a pointer the plugin can keep and read directly; see
+// cvarwatch.h.
+static cvar_t* mutil_GetCvarHandle(plid_t /*plid*/, const char* name) {
+	return cvar_handle(name);
+}
+
+// Have a function called when a cvar's value changes.
+static int mutil_WatchCvar(const plid_t plid, cvar_t* cvar, const CVAR_CHANGE_FN pfn) {
+	const MPlugin* plug = Plugins->find(plid);
+	if (!plug)
+		return ME_NOTFOUND;
+	return cvarwatch_add(plug->index, cvar, pfn);
+}
+
+static int mutil_UnwatchCvar(const plid_t plid, cvar_t* cvar, const CVAR_CHANGE_FN pfn) {
+	const MPlugin* plug = Plugins->find(plid);
+	if (!plug)
+		return ME_NOTFOUND;
+	return cvarwatch_remove(plug->index, cvar, pfn);
+}
+
+// Have a function called with a client's value of a cvar, sharing the
+// query with other plugins; see cvarquery.h.
+static int mutil_QueryClientCvar(const plid_t plid, const edict_t* player, const char* cvar_name, const float max_age, const CVAR_QUERY_FN pfn) {
+	const MPlugin* plug = Plugins->find(plid);
+	if (!plug)
+		return ME_NOTFOUND;
+	return cvarquery_request(plug->index, player, cvar_name, max_age, pfn);
+}
+
+static int mutil_CancelClientCvarQuery(const plid_t plid, const edict_t* player, const char* cvar_name, const CVAR_QUERY_FN pfn) {
+	const MPlugin* plug = Plugins->find(plid);
+	if (!plug)
+		return ME_NOTFOUND;
+	return cvarquery_cancel(plug->index, player, cvar_name, pfn);
+}
+
+// Allocate per-edict storage for the plugin; see edictslot.h.  Returns
+// the slot, or 0.
+static int mutil_AllocEdictSlot(const plid_t plid, const size_t size) {
+	const MPlugin* plug = Plugins->find(plid);
+	if (!plug)
+		return 0;
+	return edictslot_alloc(plug->index, size);
+}
+
+static void* mutil_GetEdictSlot(plid_t /*plid*/, const int slot, const edict_t* ed) {
+	return edictslot_get(slot, ed);
+}
+
+static void* mutil_GetIndexSlot(plid_t /*plid*/, const int slot, const int index) {
+	return edictslot_get_index(slot, index);
+}
+
 // Meta Utility Function table.
 mutil_funcs_t MetaUtilFunctions = {
 	mutil_LogConsole,		// pfnLogConsole
@@ -378,4 +452,15 @@ mutil_funcs_t MetaUtilFunctions = {
 	mutil_IsQueryingClientCvar, // pfnIsQueryingClientCvar
 	mutil_MakeRequestID, 	// pfnMakeRequestID
 	mutil_GetHookTables,   // pfnGetHookTables
+	mutil_HookUserMsg,		// pfnHookUserMsg
+	mutil_UnhookUserMsg,	// pfnUnhookUserMsg
+	mutil_GetUserMsgGeneration,	// pfnGetUserMsgGeneration
+	mutil_GetCvarHandle,	// pfnGetCvarHandle
+	mutil_WatchCvar,		// pfnWatchCvar
+	mutil_UnwatchCvar,		// pfnUnwatchCvar
+	mutil_QueryClientCvar,	// pfnQueryClientCvar
+	mutil_CancelClientCvarQuery,	// pfnCancelClientCvarQuery
+	mutil_AllocEdictSlot,	// pfnAllocEdictSlot
+	mutil_GetEdictSlot,		// pfnGetEdictSlot
+	mutil_GetIndexSlot,		// pfnGetIndexSlot
 };
\ No newline at end of file
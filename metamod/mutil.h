@@ -56,6 +56,52 @@ typedef enum : std::uint8_t {
 	GINFO_REALDLL_FULLPATH,
 } ginfo_t;
 
+// For HookUserMsg: type of a value written to a user message.
+typedef enum : std::uint8_t {
+	UMSG_BYTE = 0,
+	UMSG_CHAR,
+	UMSG_SHORT,
+	UMSG_LONG,
+	UMSG_ANGLE,
+	UMSG_COORD,
+	UMSG_STRING,
+	UMSG_ENTITY,
+} umsg_arg_type_t;
+
+// For HookUserMsg: a value written to a user message.
+typedef struct usermsg_arg_s {
+	umsg_arg_type_t type;
+	union {
+		int iValue;				// BYTE, CHAR, SHORT, LONG, ENTITY
+		float flValue;			// ANGLE, COORD
+		const char* szValue;	// STRING
+	};
+} usermsg_arg_t;
+
+// For HookUserMsg: a whole user message, from MessageBegin to MessageEnd.
+// The hook may change any field and arg, or drop trailing args by
+// lowering num_args.  Strings and origin it sets must stay valid until
+// the message is sent, which is just after the last hook returns.
+typedef struct usermsg_s {
+	int msg_dest;
+	int msg_type;
+	const float* origin;	// nullptr if none
+	edict_t* ed;
+	int num_args;
+	usermsg_arg_t* args;
+} usermsg_t;
+
+// Hook for a user message; returning MRES_SUPERCEDE blocks the message.
+typedef int (*USERMSG_FN)(usermsg_t* msg);
+
+// For WatchCvar: called once a frame at most, when the watched cvar's
+// value changed; old_string is its previous string value.
+typedef void (*CVAR_CHANGE_FN)(cvar_t* cvar, const char* old_string);
+
+// For QueryClientCvar: called with the client's value of the cvar, or
+// with value nullptr if the client didn't answer, left or reconnected.
+typedef void (*CVAR_QUERY_FN)(const edict_t* player, const char* cvar_name, const char* value);
+
 // Meta Utility Function table type.
 typedef struct meta_util_funcs_s {
 	void		(*pfnLogConsole)		(plid_t plid, const char* fmt, ...);
@@ -83,6 +129,21 @@ typedef struct meta_util_funcs_s {
 	int (*pfnMakeRequestID)	(plid_t plid);
 
 	void            (*pfnGetHookTables)             (plid_t plid, enginefuncs_t** peng, DLL_FUNCTIONS** pdll, NEW_DLL_FUNCTIONS** pnewdll);
+
+	int (*pfnHookUserMsg)(plid_t plid, int msg_type, USERMSG_FN pfn);
+	int (*pfnUnhookUserMsg)(plid_t plid, int msg_type, USERMSG_FN pfn);
+	int (*pfnGetUserMsgGeneration)(plid_t plid);
+
+	cvar_t* (*pfnGetCvarHandle)(plid_t plid, const char* name);
+	int (*pfnWatchCvar)(plid_t plid, cvar_t* cvar, CVAR_CHANGE_FN pfn);
+	int (*pfnUnwatchCvar)(plid_t plid, cvar_t* cvar, CVAR_CHANGE_FN pfn);
+
+	int (*pfnQueryClientCvar)(plid_t plid, const edict_t* player, const char* cvar_name, float max_age, CVAR_QUERY_FN pfn);
+	int (*pfnCancelClientCvarQuery)(plid_t plid, const edict_t* player, const char* cvar_name, CVAR_QUERY_FN pfn);
+
+	int (*pfnAllocEdictSlot)(plid_t plid, size_t size);
+	void* (*pfnGetEdictSlot)(plid_t plid, int slot, const edict_t* ed);
+	void* (*pfnGetIndexSlot)(plid_t plid, int slot, int index);
 } mutil_funcs_t;
 extern mutil_funcs_t MetaUtilFunctions DLLHIDDEN;
 
@@ -105,5 +166,16 @@ extern mutil_funcs_t MetaUtilFunctions DLLHIDDEN;
 #define IS_QUERYING_CLIENT_CVAR (*gpMetaUtilFuncs->pfnIsQueryingClientCvar)
 #define MAKE_REQUESTID		(*gpMetaUtilFuncs->pfnMakeRequestID)
 #define GET_HOOK_TABLES         (*gpMetaUtilFuncs->pfnGetHookTables)
+#define HOOK_USER_MSG		(*gpMetaUtilFuncs->pfnHookUserMsg)
+#define UNHOOK_USER_MSG		(*gpMetaUtilFuncs->pfnUnhookUserMsg)
+#define GET_USER_MSG_GENERATION	(*gpMetaUtilFuncs->pfnGetUserMsgGeneration)
+#define GET_CVAR_HANDLE		(*gpMetaUtilFuncs->pfnGetCvarHandle)
+#define WATCH_CVAR			(*gpMetaUtilFuncs->pfnWatchCvar)
+#define UNWATCH_CVAR		(*gpMetaUtilFuncs->pfnUnwatchCvar)
+#define QUERY_CLIENT_CVAR	(*gpMetaUtilFuncs->pfnQueryClientCvar)
+#define CANCEL_CLIENT_CVAR_QUERY	(*gpMetaUtilFuncs->pfnCancelClientCvarQuery)
+#define ALLOC_EDICT_SLOT	(*gpMetaUtilFuncs->pfnAllocEdictSlot)
+#define GET_EDICT_SLOT		(*gpMetaUtilFuncs->pfnGetEdictSlot)
+#define GET_INDEX_SLOT		(*gpMetaUtilFuncs->pfnGetIndexSlot)
 
 #endif /* MUTIL_H */
@@ -56,7 +56,7 @@
 #include "support_meta.h"	// MAX_STRBUF_LEN
 #include <climits>		// INT_MAX
 
-mBOOL dlclose_handle_invalid;
+std::atomic<bool> dlclose_handle_invalid(false);
 
 #ifdef _WIN32
 // Since windows doesn't provide a verison of strtok_r(), we include one
@@ -336,26 +336,87 @@ char* DLLINTERNAL realpath(const char* file_name, char* resolved_name) {
 	}
 	return nullptr;
 }
+
+// Monotonic clock in nanoseconds, from the performance counter; its
+// frequency is fixed at boot, so it's only read once.
+unsigned long long DLLINTERNAL get_monotonic_ns() {
+	static LARGE_INTEGER freq = { 0 };
+	LARGE_INTEGER now;
+
+	if (!freq.QuadPart)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	const unsigned long long ticks = static_cast<unsigned long long>(now.QuadPart);
+	const unsigned long long hz = static_cast<unsigned long long>(freq.QuadPart);
+	return ticks / hz * 1000000000ULL + ticks % hz * 1000000000ULL / hz;
+}
 #endif /*_WIN32*/
 
-// Determine whether the given memory location is valid (ie whether we
-// should expect to be able to reference strings or functions at this
-// location without segfaulting).
+// Function and arg for a new thread, passed through the OS's thread
+// start routine.
+typedef struct thread_start_s {
+	THREAD_FN fn;
+	void* arg;
+} thread_start_t;
+
 #ifdef __linux__
-// Simulate this with dladdr.  I'm not convinced this will be as generally
-// applicable as the native windows routine below, but it should do what
-// we need it for in this particular situation.
+static void* thread_main(void* param) {
+#elif defined(_WIN32)
+static DWORD WINAPI thread_main(LPVOID param) {
+#endif /* _WIN32 */
+	const thread_start_t start = *static_cast<thread_start_t*>(param);
+	free(param);
+	start.fn(start.arg);
+	return 0;
+}
+
+// Start a thread running fn(arg).
 // meta_errno values:
-//  - ME_NOTFOUND	couldn't find a matching sharedlib for this ptr
-mBOOL DLLINTERNAL IS_VALID_PTR(const void* memptr) {
-	Dl_info dli;
-	memset(&dli, 0, sizeof(dli));
-	if (dladdr(memptr, &dli))
-		return mTRUE;
-	else
-		RETURN_ERRNO(mFALSE, ME_NOTFOUND);
+//  - ME_NOMEM		couldn't allocate start info
+//  - ME_OSNOTSUP	OS couldn't create thread
+mBOOL DLLINTERNAL os_thread_start(THREAD_T* thread, const THREAD_FN fn, void* arg) {
+	thread_start_t* start = static_cast<thread_start_t*>(malloc(sizeof(thread_start_t)));
+	if (!start)
+		RETURN_ERRNO(mFALSE, ME_NOMEM);
+	start->fn = fn;
+	start->arg = arg;
+#ifdef __linux__
+	if (pthread_create(thread, nullptr, thread_main, start) != 0) {
+#elif defined(_WIN32)
+	if (!((*thread = CreateThread(nullptr, 0, thread_main, start, 0, nullptr)))) {
+#endif /* _WIN32 */
+		free(start);
+		RETURN_ERRNO(mFALSE, ME_OSNOTSUP);
+	}
+	return mTRUE;
 }
+
+// Wait for a thread to return.
+void DLLINTERNAL os_thread_join(THREAD_T thread) {
+#ifdef __linux__
+	pthread_join(thread, nullptr);
 #elif defined(_WIN32)
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#endif /* _WIN32 */
+}
+
+void DLLINTERNAL os_sleep_ms(const int ms) {
+#ifdef __linux__
+	struct timespec ts;
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (ms % 1000) * 1000000L;
+	nanosleep(&ts, nullptr);
+#elif defined(_WIN32)
+	Sleep(static_cast<DWORD>(ms));
+#endif /* _WIN32 */
+}
+
+// Determine whether the given memory location is valid (ie whether we
+// should expect to be able to reference strings or functions at this
+// location without segfaulting).
+// For linux, see osdep_modrange_linux.cpp.
+#ifdef _WIN32
 // Use the native windows routine IsBadCodePtr.
 // meta_errno values:
 //  - ME_BADMEMPTR	not a valid memory pointer
@@ -40,6 +40,7 @@
 #include <cstring>			// strerror()
 #include <cctype>			// isupper, tolower
 #include <cerrno>			// errno
+#include <atomic>			// std::atomic
 
  // Various differences between WIN32 and Linux.
 
@@ -105,13 +106,19 @@ int DLLINTERNAL safe_snprintf(char* s, size_t n, const char* format, ...);
 void DLLINTERNAL safevoid_vsnprintf(char* s, size_t n, const char* format, va_list ap);
 void DLLINTERNAL safevoid_snprintf(char* s, size_t n, const char* format, ...);
 
-// Functions & types for DLL open/close/etc operations.
-extern mBOOL dlclose_handle_invalid DLLHIDDEN;
+// Functions & types for DLL open/close/etc operations.  DLOPEN and
+// DLCLOSE may be called off the main thread, so the state they set is
+// atomic.
+extern std::atomic<bool> dlclose_handle_invalid DLLHIDDEN;
 #ifdef __linux__
 #include <dlfcn.h>
 typedef void* DLHANDLE;
 typedef void* DLFUNC;
+// Table of loaded module segments needs rebuilding; see
+// osdep_modrange_linux.cpp.
+extern std::atomic<bool> modrange_stale DLLHIDDEN;
 inline DLHANDLE DLLINTERNAL DLOPEN(const char* filename) {
+	modrange_stale.store(true, std::memory_order_release);
 	return dlopen(filename, RTLD_NOW);
 }
 inline DLFUNC DLLINTERNAL DLSYM(DLHANDLE handle, const char* string) {
@@ -120,11 +127,12 @@ inline DLFUNC DLLINTERNAL DLSYM(DLHANDLE handle, const char* string) {
 //dlclose crashes if handle is null.
 inline int DLLINTERNAL DLCLOSE(DLHANDLE handle) {
 	if (!handle) {
-		dlclose_handle_invalid = mTRUE;
+		dlclose_handle_invalid = true;
 		return 1;
 	}
 
-	dlclose_handle_invalid = mFALSE;
+	dlclose_handle_invalid = false;
+	modrange_stale.store(true, std::memory_order_release);
 	return dlclose(handle);
 }
 inline const char* DLLINTERNAL DLERROR() {
@@ -143,11 +151,11 @@ inline DLFUNC DLLINTERNAL DLSYM(const DLHANDLE handle, const char* string) {
 }
 inline int DLLINTERNAL DLCLOSE(const DLHANDLE handle) {
 	if (!handle) {
-		dlclose_handle_invalid = mTRUE;
+		dlclose_handle_invalid = true;
 		return 1;
 	}
 
-	dlclose_handle_invalid = mFALSE;
+	dlclose_handle_invalid = false;
 
 	// NOTE: Windows FreeLibrary returns success=nonzero, fail=zero,
 	// which is the opposite of the unix convention, thus the '!'.
@@ -164,6 +172,9 @@ inline const char* DLLINTERNAL DLERROR() {
 #endif /* _WIN32 */
 const char* DLLINTERNAL DLFNAME(const void* memptr);
 mBOOL DLLINTERNAL IS_VALID_PTR(const void* memptr);
+#ifdef __linux__
+int DLLINTERNAL os_memloc_plugin(const void* memptr);
+#endif /* __linux__ */
 
 // Attempt to call the given function pointer, without segfaulting.
 mBOOL DLLINTERNAL os_safe_call(REG_CMD_FN pfn);
@@ -299,4 +310,31 @@ inline const char* DLLINTERNAL str_os_error() {
 #endif /* _WIN32 */
 }
 
+// Monotonic clock in nanoseconds, for timing intervals.  Unlike raw
+// rdtsc, it isn't affected by cpu frequency scaling or by the thread
+// moving between cores.
+#ifdef __linux__
+#include <ctime>			// clock_gettime
+inline unsigned long long DLLINTERNAL get_monotonic_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + static_cast<unsigned long long>(ts.tv_nsec);
+}
+#elif defined(_WIN32)
+unsigned long long DLLINTERNAL get_monotonic_ns();
+#endif /* _WIN32 */
+
+// Background threads, for work that shouldn't run on the server thread.
+#ifdef __linux__
+#include <pthread.h>
+typedef pthread_t THREAD_T;
+#elif defined(_WIN32)
+typedef HANDLE THREAD_T;
+#endif /* _WIN32 */
+typedef void (*THREAD_FN) (void* arg);
+
+mBOOL DLLINTERNAL os_thread_start(THREAD_T* thread, THREAD_FN fn, void* arg);
+void DLLINTERNAL os_thread_join(THREAD_T thread);
+void DLLINTERNAL os_sleep_ms(int ms);
+
 #endif /* OSDEP_H */
@@ -97,7 +97,7 @@ static IMAGE_EXPORT_DIRECTORY* DLLINTERNAL_NOVIS get_export_table(void* mapview,
 	return mem.export_dir;
 }
 
-mBOOL DLLINTERNAL is_gamedll(const char* filename) {
+mBOOL DLLINTERNAL check_gamedll(const char* filename, char* why, size_t why_size, int* loglevel) {
 	int has_GiveFnptrsToDll = 0;
 	int has_GetEntityAPI2 = 0;
 	int has_GetEntityAPI = 0;
@@ -107,14 +107,16 @@ mBOOL DLLINTERNAL is_gamedll(const char* filename) {
 	                                FILE_ATTRIBUTE_NORMAL,
 	                                nullptr);
 	if (is_invalid_handle(hFile)) {
-		META_DEBUG(3, ("is_gamedll(%s): CreateFile() failed.", filename));
+		*loglevel = 3;
+		safevoid_snprintf(why, why_size, "CreateFile() failed.");
 		return mFALSE;
 	}
 
 	//
 	void* const hMap = CreateFileMapping(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
 	if (is_invalid_handle(hMap)) {
-		META_DEBUG(3, ("is_gamedll(%s): CreateFileMapping() failed.", filename));
+		*loglevel = 3;
+		safevoid_snprintf(why, why_size, "CreateFileMapping() failed.");
 		CloseHandle(hFile);
 		return mFALSE;
 	}
@@ -122,7 +124,8 @@ mBOOL DLLINTERNAL is_gamedll(const char* filename) {
 	//
 	void* mapview = MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
 	if (!mapview) {
-		META_DEBUG(3, ("is_gamedll(%s): MapViewOfFile() failed.", filename));
+		*loglevel = 3;
+		safevoid_snprintf(why, why_size, "MapViewOfFile() failed.");
 		CloseHandle(hMap);
 		CloseHandle(hFile);
 		return mFALSE;
@@ -130,7 +133,8 @@ mBOOL DLLINTERNAL is_gamedll(const char* filename) {
 
 	IMAGE_NT_HEADERS* ntheaders = get_ntheaders(mapview);
 	if (!ntheaders) {
-		META_DEBUG(3, ("is_gamedll(%s): get_ntheaders() failed.", filename));
+		*loglevel = 3;
+		safevoid_snprintf(why, why_size, "get_ntheaders() failed.");
 		UnmapViewOfFile(mapview);
 		CloseHandle(hMap);
 		CloseHandle(hFile);
@@ -141,7 +145,8 @@ mBOOL DLLINTERNAL is_gamedll(const char* filename) {
 	_IMAGE_SECTION_HEADER* sections = IMAGE_FIRST_SECTION(ntheaders);
 	const int num_sects = ntheaders->FileHeader.NumberOfSections;
 	if (IsBadReadPtr(sections, num_sects * sizeof(IMAGE_SECTION_HEADER))) {
-		META_DEBUG(3, ("is_gamedll(%s): IMAGE_FIRST_SECTION() failed.", filename));
+		*loglevel = 3;
+		safevoid_snprintf(why, why_size, "IMAGE_FIRST_SECTION() failed.");
 		UnmapViewOfFile(mapview);
 		CloseHandle(hMap);
 		CloseHandle(hFile);
@@ -151,7 +156,8 @@ mBOOL DLLINTERNAL is_gamedll(const char* filename) {
 	//
 	const IMAGE_EXPORT_DIRECTORY* exports = get_export_table(mapview, ntheaders, sections, num_sects);
 	if (!exports) {
-		META_DEBUG(3, ("is_gamedll(%s): get_export_table() failed.", filename));
+		*loglevel = 3;
+		safevoid_snprintf(why, why_size, "get_export_table() failed.");
 		UnmapViewOfFile(mapview);
 		CloseHandle(hMap);
 		CloseHandle(hFile);
@@ -161,7 +167,8 @@ mBOOL DLLINTERNAL is_gamedll(const char* filename) {
 	//
 	const unsigned long* names = (unsigned long*)va_to_mapaddr(mapview, sections, num_sects, exports->AddressOfNames);
 	if (IsBadReadPtr(names, exports->NumberOfNames * sizeof(unsigned long))) {
-		META_DEBUG(3, ("is_gamedll(%s): Pointer to exported function names is invalid.", filename));
+		*loglevel = 3;
+		safevoid_snprintf(why, why_size, "Pointer to exported function names is invalid.");
 		UnmapViewOfFile(mapview);
 		CloseHandle(hMap);
 		CloseHandle(hFile);
@@ -192,7 +199,8 @@ mBOOL DLLINTERNAL is_gamedll(const char* filename) {
 				strmatch(funcname, "Meta_Attach") ||
 				strmatch(funcname, "Meta_Detach")) {
 				// Metamod plugin.. is not gamedll
-				META_DEBUG(5, ("is_gamedll(%s): Detected Metamod plugin, library exports [%s].", filename, funcname));
+				*loglevel = 5;
+				safevoid_snprintf(why, why_size, "Detected Metamod plugin, library exports [%s].", funcname);
 
 				UnmapViewOfFile(mapview);
 				CloseHandle(hMap);
@@ -210,11 +218,13 @@ mBOOL DLLINTERNAL is_gamedll(const char* filename) {
 	// Check if gamedll
 	if (has_GiveFnptrsToDll && (has_GetEntityAPI2 || has_GetEntityAPI)) {
 		// This is gamedll!
-		META_DEBUG(5, ("is_gamedll(%s): Detected GameDLL.", filename));
+		*loglevel = 5;
+		safevoid_snprintf(why, why_size, "Detected GameDLL.");
 
 		return mTRUE;
 	}
-	META_DEBUG(5, ("is_gamedll(%s): Library isn't GameDLL.", filename));
+	*loglevel = 5;
+	safevoid_snprintf(why, why_size, "Library isn't GameDLL.");
 
 	return mFALSE;
 }
@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cerrno>			// errno, EINTR
+#include <cstdlib>			// malloc, free
+#include <cstring>			// strcmp, strncpy
+#include <fcntl.h>			// open
+#include <sys/stat.h>		// fstat
+#include <unistd.h>			// pread, close
+#include <elf.h>
+
+#include "elf_probe.h"		// me
+
+// Types for one ELF class.
+typedef struct elf32_s {
+	typedef Elf32_Addr Addr;
+	typedef Elf32_Ehdr Ehdr;
+	typedef Elf32_Phdr Phdr;
+	typedef Elf32_Shdr Shdr;
+	typedef Elf32_Sym Sym;
+	typedef Elf32_Dyn Dyn;
+} elf32_t;
+
+typedef struct elf64_s {
+	typedef Elf64_Addr Addr;
+	typedef Elf64_Ehdr Ehdr;
+	typedef Elf64_Phdr Phdr;
+	typedef Elf64_Shdr Shdr;
+	typedef Elf64_Sym Sym;
+	typedef Elf64_Dyn Dyn;
+} elf64_t;
+
+typedef struct elf_file_s {
+	int fd;
+	unsigned long long size;
+} elf_file_t;
+
+// Check that [offset, offset+size) is inside the file.
+static bool DLLINTERNAL in_file(const elf_file_t* file, const unsigned long long offset, const unsigned long long size) {
+	return offset <= file->size && size <= file->size - offset;
+}
+
+// Read size bytes at offset, which must be inside the file.
+static elf_probe_err_t DLLINTERNAL read_at(const elf_file_t* file, unsigned long long offset, unsigned long long size, void* buf) {
+	if (!in_file(file, offset, size))
+		return ELF_PROBE_BAD_ELF;
+
+	unsigned char* p = static_cast<unsigned char*>(buf);
+	while (size) {
+		const ssize_t n = pread(file->fd, p, size, static_cast<off_t>(offset));
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return ELF_PROBE_READ;
+		p += n;
+		offset += static_cast<unsigned long long>(n);
+		size -= static_cast<unsigned long long>(n);
+	}
+	return ELF_PROBE_OK;
+}
+
+// Read a table into a new buffer, to be freed by caller.
+static elf_probe_err_t DLLINTERNAL read_table(const elf_file_t* file, const unsigned long long offset, const unsigned long long size, void** buf) {
+	*buf = nullptr;
+	if (!size || !in_file(file, offset, size))
+		return ELF_PROBE_BAD_ELF;
+	*buf = malloc(size);
+	if (!*buf)
+		return ELF_PROBE_NOMEM;
+	const elf_probe_err_t err = read_at(file, offset, size, *buf);
+	if (err != ELF_PROBE_OK) {
+		free(*buf);
+		*buf = nullptr;
+	}
+	return err;
+}
+
+// Where to find the symbol and string tables in the file.
+typedef struct elf_tables_s {
+	unsigned long long sym_offset;
+	unsigned long long nsyms;
+	unsigned long long str_offset;
+	unsigned long long str_size;
+} elf_tables_t;
+
+// Find .dynsym, or .symtab if there is none, and its string table, from
+// the section headers.
+template<typename elf_t>
+static elf_probe_err_t DLLINTERNAL find_tables_by_sections(const elf_file_t* file, const typename elf_t::Ehdr* ehdr, elf_tables_t* tables) {
+	typedef typename elf_t::Shdr Shdr;
+
+	if (!ehdr->e_shnum)
+		return ELF_PROBE_NO_SYMTAB;
+	if (ehdr->e_shentsize != sizeof(Shdr))
+		return ELF_PROBE_BAD_ELF;
+
+	void* buf;
+	elf_probe_err_t err = read_table(file, ehdr->e_shoff, static_cast<unsigned long long>(ehdr->e_shnum) * sizeof(Shdr), &buf);
+	if (err != ELF_PROBE_OK)
+		return err;
+	const Shdr* shdr = static_cast<const Shdr*>(buf);
+
+	const Shdr* symtab = nullptr;
+	for (int i = 0; i < ehdr->e_shnum; i++) {
+		if (shdr[i].sh_type == SHT_DYNSYM) {
+			symtab = &shdr[i];
+			break;
+		}
+		if (shdr[i].sh_type == SHT_SYMTAB && !symtab)
+			symtab = &shdr[i];
+	}
+
+	err = ELF_PROBE_NO_SYMTAB;
+	if (symtab) {
+		err = ELF_PROBE_BAD_ELF;
+		if (symtab->sh_link < ehdr->e_shnum && (!symtab->sh_entsize || symtab->sh_entsize == sizeof(typename elf_t::Sym))) {
+			const Shdr* strtab = &shdr[symtab->sh_link];
+			if (strtab->sh_type == SHT_STRTAB) {
+				tables->sym_offset = symtab->sh_offset;
+				tables->nsyms = symtab->sh_size / sizeof(typename elf_t::Sym);
+				tables->str_offset = strtab->sh_offset;
+				tables->str_size = strtab->sh_size;
+				err = ELF_PROBE_OK;
+			}
+		}
+	}
+
+	free(buf);
+	return err;
+}
+
+// Translate a virtual address to a file offset using PT_LOAD segments.
+template<typename elf_t>
+static bool DLLINTERNAL vaddr_to_offset(const typename elf_t::Phdr* phdr, const int phnum, const unsigned long long vaddr, unsigned long long* offset) {
+	for (int i = 0; i < phnum; i++) {
+		if (phdr[i].p_type == PT_LOAD && vaddr >= phdr[i].p_vaddr && vaddr - phdr[i].p_vaddr < phdr[i].p_filesz) {
+			*offset = phdr[i].p_offset + (vaddr - phdr[i].p_vaddr);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Count symbols from .gnu.hash: one past the end of the chain of the
+// highest bucket.
+template<typename elf_t>
+static elf_probe_err_t DLLINTERNAL count_gnu_hash_symbols(const elf_file_t* file, unsigned long long offset, unsigned long long* nsyms) {
+	Elf32_Word header[4];	// nbuckets, symoffset, bloom_size, bloom_shift
+	elf_probe_err_t err = read_at(file, offset, sizeof(header), header);
+	if (err != ELF_PROBE_OK)
+		return err;
+
+	// bloom filter words are the size of an address
+	offset += sizeof(header) + static_cast<unsigned long long>(header[2]) * sizeof(typename elf_t::Addr);
+
+	void* buf;
+	err = read_table(file, offset, static_cast<unsigned long long>(header[0]) * sizeof(Elf32_Word), &buf);
+	if (err != ELF_PROBE_OK)
+		return err;
+	const Elf32_Word* buckets = static_cast<const Elf32_Word*>(buf);
+	Elf32_Word last = 0;
+	for (Elf32_Word i = 0; i < header[0]; i++) {
+		if (buckets[i] > last)
+			last = buckets[i];
+	}
+	free(buf);
+
+	if (last < header[1]) {
+		*nsyms = header[1];
+		return ELF_PROBE_OK;
+	}
+
+	// walk last chain to its end, marked by low bit
+	const unsigned long long chain = offset + static_cast<unsigned long long>(header[0]) * sizeof(Elf32_Word);
+	for (;; last++) {
+		Elf32_Word value;
+		err = read_at(file, chain + static_cast<unsigned long long>(last - header[1]) * sizeof(Elf32_Word), sizeof(value), &value);
+		if (err != ELF_PROBE_OK)
+			return err;
+		if (value & 1)
+			break;
+	}
+	*nsyms = static_cast<unsigned long long>(last) + 1;
+	return ELF_PROBE_OK;
+}
+
+// Find dynamic symbol and string tables from the dynamic segment, for
+// libraries stripped of section headers.
+template<typename elf_t>
+static elf_probe_err_t DLLINTERNAL find_tables_by_segments(const elf_file_t* file, const typename elf_t::Ehdr* ehdr, elf_tables_t* tables) {
+	typedef typename elf_t::Phdr Phdr;
+	typedef typename elf_t::Dyn Dyn;
+
+	if (!ehdr->e_phnum)
+		return ELF_PROBE_NO_SYMTAB;
+	if (ehdr->e_phentsize != sizeof(Phdr))
+		return ELF_PROBE_BAD_ELF;
+
+	void* buf;
+	elf_probe_err_t err = read_table(file, ehdr->e_phoff, static_cast<unsigned long long>(ehdr->e_phnum) * sizeof(Phdr), &buf);
+	if (err != ELF_PROBE_OK)
+		return err;
+	const Phdr* phdr = static_cast<const Phdr*>(buf);
+
+	const Phdr* dynamic = nullptr;
+	for (int i = 0; i < ehdr->e_phnum; i++) {
+		if (phdr[i].p_type == PT_DYNAMIC) {
+			dynamic = &phdr[i];
+			break;
+		}
+	}
+	void* dynbuf = nullptr;
+	err = dynamic ? read_table(file, dynamic->p_offset, dynamic->p_filesz, &dynbuf) : ELF_PROBE_NO_SYMTAB;
+	if (err != ELF_PROBE_OK) {
+		free(buf);
+		return err;
+	}
+
+	unsigned long long symtab = 0, strtab = 0, strsz = 0, hash = 0, gnu_hash = 0;
+	const Dyn* dyn = static_cast<const Dyn*>(dynbuf);
+	const unsigned long long ndyn = dynamic->p_filesz / sizeof(Dyn);
+	for (unsigned long long i = 0; i < ndyn && dyn[i].d_tag != DT_NULL; i++) {
+		switch (dyn[i].d_tag) {
+		case DT_SYMTAB:		symtab = dyn[i].d_un.d_ptr; break;
+		case DT_STRTAB:		strtab = dyn[i].d_un.d_ptr; break;
+		case DT_STRSZ:		strsz = dyn[i].d_un.d_val; break;
+		case DT_HASH:		hash = dyn[i].d_un.d_ptr; break;
+		case DT_GNU_HASH:	gnu_hash = dyn[i].d_un.d_ptr; break;
+		default: break;
+		}
+	}
+	free(dynbuf);
+
+	err = ELF_PROBE_NO_SYMTAB;
+	if (symtab && strtab && strsz && (hash || gnu_hash)) {
+		err = ELF_PROBE_BAD_ELF;
+		unsigned long long hash_offset;
+		if (vaddr_to_offset<elf_t>(phdr, ehdr->e_phnum, symtab, &tables->sym_offset)
+			&& vaddr_to_offset<elf_t>(phdr, ehdr->e_phnum, strtab, &tables->str_offset)
+			&& vaddr_to_offset<elf_t>(phdr, ehdr->e_phnum, hash ? hash : gnu_hash, &hash_offset)) {
+			tables->str_size = strsz;
+			if (hash) {
+				// nchain, the number of symbols, is the second word
+				Elf32_Word header[2];
+				err = read_at(file, hash_offset, sizeof(header), header);
+				tables->nsyms = header[1];
+			}
+			else
+				err = count_gnu_hash_symbols<elf_t>(file, hash_offset, &tables->nsyms);
+		}
+	}
+
+	free(buf);
+	return err;
+}
+
+// Look for known exports in the symbol table.
+template<typename elf_t>
+static void DLLINTERNAL scan_symbols(const typename elf_t::Sym* syms, const unsigned long long nsyms, const char* strtab, const unsigned long long strsz, elf_probe_t* probe) {
+	for (unsigned long long i = 0; i < nsyms; i++) {
+		const typename elf_t::Sym* sym = &syms[i];
+
+		// Defined function export?
+		if (ELF32_ST_TYPE(sym->st_info) != STT_FUNC || ELF32_ST_BIND(sym->st_info) != STB_GLOBAL || sym->st_shndx == SHN_UNDEF)
+			continue;
+		// string outside strtab?
+		if (!sym->st_name || sym->st_name >= strsz)
+			continue;
+
+		const char* name = &strtab[sym->st_name];
+		if (name[0] == 'G') {
+			if (!strcmp(name, "GiveFnptrsToDll"))
+				probe->exports |= ELF_EXPORT_GIVEFNPTRSTODLL;
+			else if (!strcmp(name, "GetEntityAPI2"))
+				probe->exports |= ELF_EXPORT_GETENTITYAPI2;
+			else if (!strcmp(name, "GetEntityAPI"))
+				probe->exports |= ELF_EXPORT_GETENTITYAPI;
+		}
+		else if (name[0] == 'M') {
+			if (!strcmp(name, "Meta_Init") || !strcmp(name, "Meta_Query")
+				|| !strcmp(name, "Meta_Attach") || !strcmp(name, "Meta_Detach")) {
+				if (!(probe->exports & ELF_EXPORT_META)) {
+					strncpy(probe->meta_export, name, sizeof(probe->meta_export) - 1);
+					probe->meta_export[sizeof(probe->meta_export) - 1] = '\0';
+				}
+				probe->exports |= ELF_EXPORT_META;
+			}
+		}
+	}
+}
+
+template<typename elf_t>
+static elf_probe_err_t DLLINTERNAL probe_file(const elf_file_t* file, const int want_class, const int want_machine, elf_probe_t* probe) {
+	typename elf_t::Ehdr ehdr;
+	elf_probe_err_t err = read_at(file, 0, sizeof(ehdr), &ehdr);
+	if (err != ELF_PROBE_OK)
+		return err == ELF_PROBE_BAD_ELF ? ELF_PROBE_NOT_ELF : err;
+
+	probe->type = ehdr.e_type;
+	probe->machine = ehdr.e_machine;
+	if (probe->elf_class != want_class || ehdr.e_type != ET_DYN || ehdr.e_machine != want_machine)
+		return ELF_PROBE_TARGET;
+
+	elf_tables_t tables;
+	err = find_tables_by_sections<elf_t>(file, &ehdr, &tables);
+	if (err == ELF_PROBE_NO_SYMTAB)
+		err = find_tables_by_segments<elf_t>(file, &ehdr, &tables);
+	if (err != ELF_PROBE_OK)
+		return err;
+
+	void* syms;
+	err = read_table(file, tables.sym_offset, tables.nsyms * sizeof(typename elf_t::Sym), &syms);
+	if (err != ELF_PROBE_OK)
+		return err;
+	void* strtab;
+	err = read_table(file, tables.str_offset, tables.str_size, &strtab);
+	if (err != ELF_PROBE_OK) {
+		free(syms);
+		return err;
+	}
+	// make sure all names end inside the table
+	static_cast<char*>(strtab)[tables.str_size - 1] = '\0';
+
+	scan_symbols<elf_t>(static_cast<const typename elf_t::Sym*>(syms), tables.nsyms, static_cast<const char*>(strtab), tables.str_size, probe);
+
+	free(strtab);
+	free(syms);
+	return ELF_PROBE_OK;
+}
+
+elf_probe_err_t DLLINTERNAL elf_probe(const char* filename, const int want_class, const int want_machine, elf_probe_t* probe) {
+	memset(probe, 0, sizeof(*probe));
+
+	elf_file_t file;
+	file.fd = open(filename, O_RDONLY | O_CLOEXEC);
+	if (file.fd < 0)
+		return ELF_PROBE_OPEN;
+	struct stat st;
+	if (fstat(file.fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		close(file.fd);
+		return ELF_PROBE_OPEN;
+	}
+	file.size = static_cast<unsigned long long>(st.st_size);
+
+	unsigned char ident[EI_NIDENT];
+	elf_probe_err_t err = read_at(&file, 0, sizeof(ident), ident);
+	if (err == ELF_PROBE_OK) {
+		if (memcmp(ident, ELFMAG, SELFMAG) != 0 || ident[EI_VERSION] != EV_CURRENT || ident[EI_DATA] != ELFDATA2LSB)
+			err = ELF_PROBE_NOT_ELF;
+		else if ((probe->elf_class = ident[EI_CLASS]) == ELFCLASS64)
+			err = probe_file<elf64_t>(&file, want_class, want_machine, probe);
+		else if (probe->elf_class == ELFCLASS32)
+			err = probe_file<elf32_t>(&file, want_class, want_machine, probe);
+		else
+			err = ELF_PROBE_NOT_ELF;
+	}
+	else if (err == ELF_PROBE_BAD_ELF)
+		err = ELF_PROBE_NOT_ELF;	// too small
+
+	close(file.fd);
+	return err;
+}
+
+const char* DLLINTERNAL elf_probe_strerror(const elf_probe_err_t err) {
+	switch (err) {
+	case ELF_PROBE_OK:			return "ok";
+	case ELF_PROBE_OPEN:		return "cannot open file";
+	case ELF_PROBE_READ:		return "read error";
+	case ELF_PROBE_NOT_ELF:		return "file isn't ELF";
+	case ELF_PROBE_TARGET:		return "ELF isn't a library for this target";
+	case ELF_PROBE_BAD_ELF:		return "invalid ELF";
+	case ELF_PROBE_NO_SYMTAB:	return "couldn't locate symtab";
+	case ELF_PROBE_NOMEM:		return "out of memory";
+	}
+	return "unknown error";
+}
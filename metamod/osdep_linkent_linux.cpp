@@ -44,6 +44,10 @@
 #define PAGE_ALIGN(addr) (((addr)+PAGE_SIZE-1)&PAGE_MASK)
 #include <pthread.h>
 #include <link.h>
+#include <elf.h>
+#include <cstdint>
+#include <cstdlib>		// calloc
+#include <cstring>		// memcpy
 
 #include "osdep.h"
 #include "osdep_p.h"
@@ -55,8 +59,20 @@
 //  -- by Jussi Kivilinna
 //
 
-//opcode, e9, + sizeof pointer
-#define BYTES_SIZE (1 + sizeof(void*))
+//
+// The engine finds map entities with dlsym() on metamod's handle, so
+// dlsym itself is patched with a jump to our replacement, which looks up
+// names missing from metamod in the game DLL.
+//
+// To call the real dlsym without undoing the patch, its first
+// instructions are copied to a trampoline, followed by a jump back to the
+// rest of dlsym.  Lookups on metamod's handle are answered from a table
+// of metamod's and the game DLL's exports, built once at init.  Neither
+// takes a lock or writes code per call.
+//
+// If dlsym's first instructions can't be relocated, falls back to
+// restoring the original bytes around each call, under a mutex.
+//
 
 typedef void * (*dlsym_func)(void * module, const char * funcname);
 
@@ -66,20 +82,59 @@ static void * metamod_module_handle = nullptr;
 //pointer to original dlsym
 static dlsym_func dlsym_original;
 
+//calls original dlsym without unpatching; NULL if not available
+static dlsym_func dlsym_trampoline;
+
+//max size of jmp forwarder: "jmp qword ptr[rip+0]", pointer
+#define MAX_JMP_SIZE (6 + sizeof(void*))
+
+//bytes of dlsym overwritten by jmp forwarder
+static size_t dlsym_patch_size;
+
 //contains jmp to replacement_dlsym @dlsym_original
-static unsigned char dlsym_new_bytes[BYTES_SIZE];
+static unsigned char dlsym_new_bytes[MAX_JMP_SIZE];
 
 //contains original bytes of dlsym
-static unsigned char dlsym_old_bytes[BYTES_SIZE];
+static unsigned char dlsym_old_bytes[MAX_JMP_SIZE];
 
 //Mutex for our protection
 static pthread_mutex_t mutex_replacement_dlsym = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 
-//constructs new jmp forwarder
-inline void construct_jmp_instruction(void *x, void *place, void* target)
+//checks if rel32 jmp/call at place, insn_len bytes long with prefixes,
+//can reach target
+inline bool is_rel32_reachable(const void *place, const void *target, size_t insn_len = 5)
+{
+	const long long offset = (long long)(uintptr_t)target - (long long)((uintptr_t)place + insn_len);
+	return offset == (long long)(int32_t)offset;
+}
+
+//size of jmp forwarder from place to target
+inline size_t jmp_instruction_size(const void *place, const void *target)
 {
-	((unsigned char *)x)[0] = 0xe9;
-	*(unsigned long *)((char *)x + 1) = (unsigned long)target - ((unsigned long)place + 5);
+	return is_rel32_reachable(place, target) ? 5 : MAX_JMP_SIZE;
+}
+
+//constructs new jmp forwarder; returns its size
+static size_t construct_jmp_instruction(void *x, const void *place, const void *target)
+{
+	unsigned char *code = (unsigned char *)x;
+
+	if(is_rel32_reachable(place, target))
+	{
+		const int32_t rel = (int32_t)((uintptr_t)target - ((uintptr_t)place + 5));
+		code[0] = 0xe9;
+		memcpy(code + 1, &rel, sizeof(rel));
+		return 5;
+	}
+
+	//"jmp qword ptr[rip+0]", followed by absolute address; x86_64 only,
+	//as rel32 always reaches on i386
+	const uintptr_t abs = (uintptr_t)target;
+	code[0] = 0xff;
+	code[1] = 0x25;
+	memset(code + 2, 0, 4);
+	memcpy(code + 6, &abs, sizeof(abs));
+	return MAX_JMP_SIZE;
 }
 
 //checks if pointer x points to jump forwarder
@@ -94,13 +149,372 @@ inline void * extract_function_pointer_from_trampoline_jmp(void *x)
 	return (**(void***)((char *)(x) + 2));
 }
 
+//
+// Returns length of the x86 instruction at code, or 0 if it isn't one
+// we know to be safe to move elsewhere.  Only covers what compilers put
+// in function prologues; anything addressing relative to the instruction
+// pointer is refused, except "call rel32", flagged in is_call.
+//
+static size_t DLLINTERNAL_NOVIS movable_insn_length(const unsigned char *code, bool *is_call)
+{
+	const unsigned char *p = code;
+	bool opsize = false;
+	bool rex_w = false;
+
+	*is_call = false;
+
+	//endbr64, endbr32
+	if(p[0] == 0xf3 && p[1] == 0x0f && p[2] == 0x1e && (p[3] == 0xfa || p[3] == 0xfb))
+		return 4;
+
+	//operand size and segment prefixes
+	for(;; p++)
+	{
+		if(*p == 0x66)
+			opsize = true;
+		else if(*p != 0x64 && *p != 0x65)
+			break;
+	}
+#ifdef __x86_64__
+	//REX prefix
+	if((*p & 0xf0) == 0x40)
+		rex_w = (*p++ & 0x08) != 0;
+#endif
+
+	const unsigned char op = *p++;
+	const size_t op_size = (size_t)(p - code);
+	const size_t imm_full = opsize ? 2 : 4;
+	size_t imm;
+
+	switch(op)
+	{
+	case 0x50: case 0x51: case 0x52: case 0x53:	//push reg
+	case 0x54: case 0x55: case 0x56: case 0x57:
+	case 0x58: case 0x59: case 0x5a: case 0x5b:	//pop reg
+	case 0x5c: case 0x5d: case 0x5e: case 0x5f:
+	case 0x90:									//nop
+		return op_size;
+	case 0x6a:									//push imm8
+		return op_size + 1;
+	case 0x68:									//push imm32
+		return op_size + imm_full;
+	case 0xb8: case 0xb9: case 0xba: case 0xbb:	//mov reg, imm
+	case 0xbc: case 0xbd: case 0xbe: case 0xbf:
+		return op_size + (rex_w ? 8 : imm_full);
+	case 0xe8:									//call rel32
+		*is_call = !opsize;
+		return opsize ? 0 : op_size + 4;
+	case 0x01: case 0x03: case 0x09: case 0x0b:	//add, or, and, sub, xor, cmp,
+	case 0x21: case 0x23: case 0x29: case 0x2b:	//test, mov, lea with modrm
+	case 0x31: case 0x33: case 0x39: case 0x3b:
+	case 0x85: case 0x89: case 0x8b: case 0x8d:
+		imm = 0;
+		break;
+	case 0x83: case 0xc6:						//with modrm and imm8
+		imm = 1;
+		break;
+	case 0x81: case 0xc7:						//with modrm and imm32
+		imm = imm_full;
+		break;
+	default:
+		return 0;
+	}
+
+	//modrm, sib and displacement
+	const unsigned char modrm = *p++;
+	const int mod = modrm >> 6;
+	const int rm = modrm & 7;
+
+	if(mod != 3)
+	{
+		if(rm == 4)
+		{
+			//sib; base 5 without displacement means disp32
+			if(mod == 0 && (*p & 7) == 5)
+				p += 4;
+			p++;
+		}
+		else if(mod == 0 && rm == 5)
+		{
+#ifdef __x86_64__
+			//rip-relative
+			return 0;
+#else
+			p += 4;
+#endif
+		}
+
+		if(mod == 1)
+			p += 1;
+		else if(mod == 2)
+			p += 4;
+	}
+
+	return (size_t)(p - code) + imm;
+}
+
+//
+// Builds trampoline calling dlsym without going through first patch_size
+// bytes of it.  Returns NULL if instructions there can't be moved.
+//
+static dlsym_func DLLINTERNAL_NOVIS build_dlsym_trampoline(size_t patch_size)
+{
+	//copy whole instructions covering patched bytes
+	size_t copy_size = 0;
+	while(copy_size < patch_size)
+	{
+		bool is_call;
+		const size_t len = movable_insn_length((const unsigned char *)dlsym_original + copy_size, &is_call);
+		if(!len)
+			return nullptr;
+		copy_size += len;
+	}
+
+	unsigned char *stub = (unsigned char *)mmap(nullptr, PAGE_SIZE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if(stub == MAP_FAILED)
+		return nullptr;
+
+	memcpy(stub, (void*)dlsym_original, copy_size);
+
+	//relocate calls
+	for(size_t i = 0; i < copy_size;)
+	{
+		bool is_call;
+		const size_t len = movable_insn_length(stub + i, &is_call);
+		if(is_call)
+		{
+			int32_t rel;
+			memcpy(&rel, stub + i + len - 4, sizeof(rel));
+			const uintptr_t target = (uintptr_t)dlsym_original + i + len + (uintptr_t)(intptr_t)rel;
+			if(!is_rel32_reachable(stub + i, (void*)target, len))
+			{
+				munmap(stub, PAGE_SIZE);
+				return nullptr;
+			}
+			rel = (int32_t)(target - ((uintptr_t)stub + i + len));
+			memcpy(stub + i + len - 4, &rel, sizeof(rel));
+		}
+		i += len;
+	}
+
+	//jump to rest of dlsym
+	construct_jmp_instruction(stub + copy_size, stub + copy_size, (unsigned char *)dlsym_original + copy_size);
+
+	if(mprotect(stub, PAGE_SIZE, PROT_READ|PROT_EXEC))
+	{
+		munmap(stub, PAGE_SIZE);
+		return nullptr;
+	}
+
+	return (dlsym_func)stub;
+}
+
+//
+// Exports of metamod and the game DLL, by name.  Built before dlsym is
+// patched and only read afterwards, so lookups need no lock.
+//
+typedef struct linkent_export_s {
+	const char *name;
+	void *addr;
+} linkent_export_t;
+
+static linkent_export_t *export_table = nullptr;
+static unsigned int export_mask = 0;
+
+//dynamic symbol table of a loaded module
+typedef struct module_symbols_s {
+	const ElfW(Sym) *symtab;
+	const char *strtab;
+	const ElfW(Half) *versym;
+	ElfW(Addr) base;
+	unsigned int count;
+} module_symbols_t;
+
+//counts symbols in gnu hash table
+static unsigned int DLLINTERNAL_NOVIS count_gnu_hash_symbols(const uint32_t *gnu_hash)
+{
+	const uint32_t nbuckets = gnu_hash[0];
+	const uint32_t symoffset = gnu_hash[1];
+	const uint32_t bloom_size = gnu_hash[2];
+	const uint32_t *buckets = gnu_hash + 4 + bloom_size * (sizeof(ElfW(Addr)) / 4);
+	const uint32_t *chain = buckets + nbuckets;
+
+	uint32_t last = 0;
+	for(uint32_t i = 0; i < nbuckets; i++)
+	{
+		if(buckets[i] > last)
+			last = buckets[i];
+	}
+	if(last < symoffset)
+		return symoffset;
+
+	//walk last chain to its end
+	while(!(chain[last - symoffset] & 1))
+		last++;
+
+	return last + 1;
+}
+
+//finds dynamic symbol table of module
+static bool DLLINTERNAL_NOVIS get_module_symbols(DLHANDLE handle, module_symbols_t *syms)
+{
+	struct link_map *lm;
+	if(dlinfo(handle, RTLD_DI_LINKMAP, &lm) != 0 || !lm || !lm->l_ld)
+		return false;
+
+	const uint32_t *hash = nullptr;
+	const uint32_t *gnu_hash = nullptr;
+
+	memset(syms, 0, sizeof(*syms));
+	syms->base = lm->l_addr;
+
+	for(const ElfW(Dyn) *dyn = lm->l_ld; dyn->d_tag != DT_NULL; dyn++)
+	{
+		//glibc relocates these in place, but be safe
+		ElfW(Addr) ptr = dyn->d_un.d_ptr;
+		if(ptr < lm->l_addr)
+			ptr += lm->l_addr;
+
+		switch(dyn->d_tag)
+		{
+		case DT_SYMTAB:
+			syms->symtab = (const ElfW(Sym) *)ptr;
+			break;
+		case DT_STRTAB:
+			syms->strtab = (const char *)ptr;
+			break;
+		case DT_VERSYM:
+			syms->versym = (const ElfW(Half) *)ptr;
+			break;
+		case DT_HASH:
+			hash = (const uint32_t *)ptr;
+			break;
+		case DT_GNU_HASH:
+			gnu_hash = (const uint32_t *)ptr;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if(!syms->symtab || !syms->strtab)
+		return false;
+
+	if(hash)
+		syms->count = hash[1];
+	else if(gnu_hash)
+		syms->count = count_gnu_hash_symbols(gnu_hash);
+	else
+		return false;
+
+	return true;
+}
+
+//looks up name in export table
+static void * DLLINTERNAL_NOVIS find_export(const char *name)
+{
+	for(unsigned int i = mm_strhash(name) & export_mask; export_table[i].name; i = (i + 1) & export_mask)
+	{
+		if(!strcmp(export_table[i].name, name))
+			return export_table[i].addr;
+	}
+
+	return nullptr;
+}
+
+//adds module's exported functions and objects to export table, unless
+//already there
+static void DLLINTERNAL_NOVIS add_module_exports(const module_symbols_t *syms)
+{
+	for(unsigned int i = 0; i < syms->count; i++)
+	{
+		const ElfW(Sym) *sym = &syms->symtab[i];
+		const int type = ELF32_ST_TYPE(sym->st_info);
+		const int bind = ELF32_ST_BIND(sym->st_info);
+
+		if(sym->st_shndx == SHN_UNDEF || !sym->st_name)
+			continue;
+		if(type != STT_FUNC && type != STT_OBJECT)
+			continue;
+		if((bind != STB_GLOBAL && bind != STB_WEAK) || ELF32_ST_VISIBILITY(sym->st_other) != STV_DEFAULT)
+			continue;
+		//hidden version
+		if(syms->versym && (syms->versym[i] & 0x8000))
+			continue;
+
+		const char *name = syms->strtab + sym->st_name;
+		unsigned int j = mm_strhash(name) & export_mask;
+		for(; export_table[j].name; j = (j + 1) & export_mask)
+		{
+			if(!strcmp(export_table[j].name, name))
+				break;
+		}
+		if(!export_table[j].name)
+		{
+			export_table[j].name = name;
+			export_table[j].addr = (void *)(syms->base + sym->st_value);
+		}
+	}
+}
+
+//
+// Builds export table from metamod's and game DLL's symbol tables,
+// metamod's taking precedence like in the dlsym lookups it replaces.
+//
+static bool DLLINTERNAL_NOVIS build_export_table()
+{
+	module_symbols_t mm_syms, game_syms;
+
+	if(!get_module_symbols(metamod_module_handle, &mm_syms) || !get_module_symbols(gamedll_module_handle, &game_syms))
+		return false;
+
+	//keep at most half full
+	unsigned int size = 64;
+	while(size < (mm_syms.count + game_syms.count) * 2)
+		size <<= 1;
+
+	export_table = (linkent_export_t *)calloc(size, sizeof(linkent_export_t));
+	if(!export_table)
+		return false;
+	export_mask = size - 1;
+
+	add_module_exports(&mm_syms);
+	add_module_exports(&game_syms);
+
+	return true;
+}
+
+//
+// Lookup on metamod's module; calls original dlsym with given function
+//
+inline void * DLLINTERNAL lookup_linkent(void * module, const char * funcname, dlsym_func real_dlsym)
+{
+	if(export_table)
+	{
+		void * func = find_export(funcname);
+		if(func)
+			return func;
+	}
+
+	//dlsym on metamod module, searching its dependencies too
+	void * func = real_dlsym(module, funcname);
+	
+	if(!func)
+	{
+		//function not in metamod module, try gamedll
+		func = real_dlsym(gamedll_module_handle, funcname);
+	}
+
+	return func;
+}
+
 //
 //restores old dlsym
 //
 inline void DLLINTERNAL restore_original_dlsym()
 {
 	//Copy old dlsym bytes back
-	memcpy((void*)dlsym_original, dlsym_old_bytes, BYTES_SIZE);
+	memcpy((void*)dlsym_original, dlsym_old_bytes, dlsym_patch_size);
 }
 
 //
@@ -109,13 +523,24 @@ inline void DLLINTERNAL restore_original_dlsym()
 inline void DLLINTERNAL reset_dlsym_hook()
 {
 	//Copy new dlsym bytes back
-	memcpy((void*)dlsym_original, dlsym_new_bytes, BYTES_SIZE);
+	memcpy((void*)dlsym_original, dlsym_new_bytes, dlsym_patch_size);
 }
 
 //
-// Replacement dlsym function
+// Replacement dlsym function, calling original through trampoline
 //
 static void * __replacement_dlsym(void * module, const char * funcname)
+{
+	if(module != metamod_module_handle || !metamod_module_handle || !gamedll_module_handle)
+		return dlsym_trampoline(module, funcname);
+
+	return lookup_linkent(module, funcname, dlsym_trampoline);
+}
+
+//
+// Replacement dlsym function, restoring original around each call
+//
+static void * __replacement_dlsym_unpatching(void * module, const char * funcname)
 {
 	//these are needed in case dlsym calls dlsym, default one doesn't do
 	//it but some LD_PRELOADed library that hooks dlsym might actually
@@ -161,14 +586,7 @@ static void * __replacement_dlsym(void * module, const char * funcname)
 		return(retval);
 	}
 	
-	//dlsym on metamod module
-	void * func = dlsym_original(module, funcname);
-	
-	if(!func)
-	{
-		//function not in metamod module, try gamedll
-		func = dlsym_original(gamedll_module_handle, funcname);
-	}
+	void * func = lookup_linkent(module, funcname, dlsym_original);
 	
 	if(!was_original_restored)
 	{
@@ -200,17 +618,33 @@ int DLLINTERNAL init_linkent_replacement(DLHANDLE MetamodHandle, DLHANDLE GameDl
 	
 	dlsym_original = (dlsym_func)sym_ptr;
 	
+	//Table of exports answers engine's entity lookups; without it, they
+	//go to dlsym as before
+	if(!build_export_table())
+		META_DEBUG(2, ("dll: Couldn't read export tables; looking up linkents with dlsym"));
+	
+	//Try to reach original dlsym through trampoline
+	void * replacement = (void*)&__replacement_dlsym;
+	dlsym_patch_size = jmp_instruction_size((void*)dlsym_original, replacement);
+	dlsym_trampoline = build_dlsym_trampoline(dlsym_patch_size);
+	if(!dlsym_trampoline)
+	{
+		META_DEBUG(2, ("dll: Couldn't relocate start of dlsym; unpatching it on each call"));
+		replacement = (void*)&__replacement_dlsym_unpatching;
+		dlsym_patch_size = jmp_instruction_size((void*)dlsym_original, replacement);
+	}
+	
 	//Backup old bytes of "dlsym" function
-	memcpy(dlsym_old_bytes, (void*)dlsym_original, BYTES_SIZE);
+	memcpy(dlsym_old_bytes, (void*)dlsym_original, dlsym_patch_size);
 	
-	//Construct new bytes: "jmp offset[replacement_sendto] @ sendto_original"
-	construct_jmp_instruction(&dlsym_new_bytes[0], (void*)dlsym_original, (void*)&__replacement_dlsym);
+	//Construct new bytes: "jmp offset[replacement_dlsym] @ dlsym_original"
+	construct_jmp_instruction(&dlsym_new_bytes[0], (void*)dlsym_original, replacement);
 	
 	//Check if bytes overlap page border.	
 	const unsigned long start_of_page = PAGE_ALIGN((unsigned long)dlsym_original) - PAGE_SIZE;
 	unsigned long size_of_pages;
 	
-	if((unsigned long)dlsym_original + BYTES_SIZE > PAGE_ALIGN((unsigned long)dlsym_original))
+	if((unsigned long)dlsym_original + dlsym_patch_size > PAGE_ALIGN((unsigned long)dlsym_original))
 	{
 		//bytes are located on two pages
 		size_of_pages = PAGE_SIZE*2;
@@ -230,6 +664,10 @@ int DLLINTERNAL init_linkent_replacement(DLHANDLE MetamodHandle, DLHANDLE GameDl
 	
 	//Write our own jmp-forwarder on "dlsym"
 	reset_dlsym_hook();
+	
+	//With trampoline, dlsym is never written again
+	if(dlsym_trampoline)
+		mprotect((void*)start_of_page, size_of_pages, PROT_READ|PROT_EXEC);
 		
 	//done
 	return(1);
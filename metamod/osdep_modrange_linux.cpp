@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cstdlib>			// realloc, qsort
+#include <cstring>			// memset
+#include <dlfcn.h>			// dladdr, dlinfo
+#include <link.h>			// dl_iterate_phdr
+
+#include <extdll.h>			// always
+
+#include "osdep.h"			// me
+#include "metamod.h"		// Plugins
+#include "mlist.h"			// class MPluginList
+#include "mplugin.h"		// class MPlugin
+#include "log_meta.h"		// META_DEBUG, etc
+
+// Table of loaded modules' segments.
+//
+// Asking dladdr() which module holds an address takes the dynamic
+// loader's lock and walks its list of modules, and finding the plugin
+// then took a compare of the module's filename against each plugin's
+// path.  Instead, the loaded segments of all modules are kept in a table
+// sorted by address, each with the plugin that owns it, so both become a
+// binary search.
+//
+// The table is rebuilt, on the next lookup, after metamod opens or closes
+// a module (see DLOPEN and DLCLOSE, which may run on other threads, so
+// the stale flag is atomic).  A module loaded by someone else is found by
+// a dladdr() on a miss, which has the table rebuilt if the module isn't
+// in it yet; a miss inside a module already in the table (eg between its
+// segments) is just a miss.  Otherwise only used from the main thread.
+
+typedef struct modrange_s {
+	const unsigned char* start;
+	const unsigned char* end;		// just past the segment
+	ElfW(Addr) base;				// module's load address
+	int plugin_index;				// owning plugin; 0 if none
+	mBOOL code;						// executable
+} modrange_t;
+
+std::atomic<bool> modrange_stale(true);
+static modrange_t* modranges = nullptr;
+static int modrange_num = 0;
+static int modrange_size = 0;
+
+static int DLLINTERNAL modrange_add(struct dl_phdr_info* info, size_t /*size*/, void* /*data*/) {
+	for (int i = 0; i < info->dlpi_phnum; i++) {
+		const ElfW(Phdr)* phdr = &info->dlpi_phdr[i];
+		if (phdr->p_type != PT_LOAD || !phdr->p_memsz)
+			continue;
+		if (modrange_num == modrange_size) {
+			const int size = modrange_size ? modrange_size * 2 : 64;
+			modrange_t* temp = static_cast<modrange_t*>(realloc(modranges, static_cast<size_t>(size) * sizeof(modrange_t)));
+			if (!temp)
+				return 1;
+			modranges = temp;
+			modrange_size = size;
+		}
+		modrange_t* range = &modranges[modrange_num++];
+		range->start = reinterpret_cast<const unsigned char*>(info->dlpi_addr + phdr->p_vaddr);
+		range->end = range->start + phdr->p_memsz;
+		range->base = info->dlpi_addr;
+		range->plugin_index = 0;
+		range->code = (phdr->p_flags & PF_X) ? mTRUE : mFALSE;
+	}
+	return 0;
+}
+
+static int modrange_cmp(const void* a, const void* b) {
+	const unsigned char* sa = static_cast<const modrange_t*>(a)->start;
+	const unsigned char* sb = static_cast<const modrange_t*>(b)->start;
+	return (sa > sb) - (sa < sb);
+}
+
+// Rebuild the table from the loader's list of modules, and mark the
+// segments of each opened plugin with its index.
+static void DLLINTERNAL modrange_rebuild() {
+	modrange_num = 0;
+	// cleared first, so a DLOPEN or DLCLOSE during the rebuild isn't lost
+	modrange_stale.store(false, std::memory_order_release);
+	if (dl_iterate_phdr(modrange_add, nullptr)) {
+		META_WARNING("Couldn't grow table of loaded module segments; looking up addresses with dladdr");
+		modrange_num = 0;
+		modrange_stale.store(true, std::memory_order_release);
+		return;
+	}
+	qsort(modranges, static_cast<size_t>(modrange_num), sizeof(modrange_t), modrange_cmp);
+
+	if (!Plugins)
+		return;
+	for (int i = 0; i < Plugins->endlist; i++) {
+		const MPlugin* iplug = Plugins->plist[i];
+		struct link_map* lm;
+		if (!iplug->handle || dlinfo(iplug->handle, RTLD_DI_LINKMAP, &lm) != 0 || !lm)
+			continue;
+		for (int j = 0; j < modrange_num; j++) {
+			if (modranges[j].base == lm->l_addr)
+				modranges[j].plugin_index = iplug->index;
+		}
+	}
+	META_DEBUG(7, ("Rebuilt table of %d loaded module segments", modrange_num));
+}
+
+static const modrange_t* DLLINTERNAL modrange_search(const void* memptr) {
+	const unsigned char* p = static_cast<const unsigned char*>(memptr);
+	int lo = 0, hi = modrange_num;
+	// last range starting at or below p
+	while (lo < hi) {
+		const int mid = (lo + hi) / 2;
+		if (modranges[mid].start <= p)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo && p < modranges[lo - 1].end)
+		return &modranges[lo - 1];
+	return nullptr;
+}
+
+// Find the loaded segment holding the given address.
+static const modrange_t* DLLINTERNAL modrange_find(const void* memptr) {
+	if (!memptr)
+		return nullptr;
+	if (unlikely(modrange_stale.load(std::memory_order_acquire)))
+		modrange_rebuild();
+	const modrange_t* range = modrange_search(memptr);
+	if (likely(range != nullptr))
+		return range;
+	// maybe in a module loaded since the table was built
+	Dl_info dli;
+	memset(&dli, 0, sizeof(dli));
+	if (!dladdr(memptr, &dli))
+		return nullptr;
+	// module already in the table; rebuilding wouldn't find it either
+	if (modrange_num && modrange_search(dli.dli_fbase))
+		return nullptr;
+	modrange_rebuild();
+	if (unlikely(modrange_num == 0)) {
+		// couldn't build table; go by dladdr alone, without owner
+		static modrange_t fallback;
+		fallback.start = static_cast<const unsigned char*>(memptr);
+		fallback.end = fallback.start + 1;
+		fallback.base = reinterpret_cast<ElfW(Addr)>(dli.dli_fbase);
+		fallback.plugin_index = 0;
+		fallback.code = mTRUE;
+		return &fallback;
+	}
+	return modrange_search(memptr);
+}
+
+// Index of the plugin whose module holds the given address.
+// meta_errno values:
+//  - ME_NOTFOUND	address isn't in a plugin
+int DLLINTERNAL os_memloc_plugin(const void* memptr) {
+	const modrange_t* range = modrange_find(memptr);
+	if (!range || !range->plugin_index)
+		RETURN_ERRNO(0, ME_NOTFOUND);
+	return range->plugin_index;
+}
+
+// Determine whether the given pointer is in the code of a loaded module,
+// ie whether we should expect to be able to call a function there without
+// segfaulting.
+// meta_errno values:
+//  - ME_NOTFOUND	couldn't find a matching sharedlib for this ptr
+mBOOL DLLINTERNAL IS_VALID_PTR(const void* memptr) {
+	const modrange_t* range = modrange_find(memptr);
+	if (!range || !range->code)
+		RETURN_ERRNO(mFALSE, ME_NOTFOUND);
+	return mTRUE;
+}
@@ -38,7 +38,9 @@
  // Checks if file is hlsdk api game dll
  //   (osdep_detect_gamedll_linux.cpp and osdep_detect_gamedll_win32.cpp)
  //  --Jussi Kivilinna
-mBOOL DLLINTERNAL is_gamedll(const char* filename);
+ // Doesn't log; writes the reason for the result to why, with the debug
+ // level to log it at, so it can run on worker threads.
+mBOOL DLLINTERNAL check_gamedll(const char* filename, char* why, size_t why_size, int* loglevel);
 
 // MSVC doesn't provide opendir/readdir/closedir, so we write our own.
 //  --Jussi Kivilinna
@@ -50,8 +50,11 @@
 #include "sdk_util.h"		// REG_SVR_COMMAND, etc
 
 #include "reg_support.h"	// me
-#include "metamod.h"            // RegCmds, g_Players, etc
+#include "metamod.h"            // RegCmds, etc
 #include "log_meta.h"		// META_ERROR, etc
+#include "diag_meta.h"		// diag_warning
+#include "cvarquery.h"		// cvarquery_legacy_set
+#include "support_meta.h"	// mm_strhash
 
 // "Register" support.
 //
@@ -103,7 +106,7 @@ void DLLHIDDEN meta_command_handler() {
 
 	MRegCmd* icmd = RegCmds->find(cmd);
 	if (!icmd) {
-		META_WARNING("Couldn't find registered plugin command: %s", cmd);
+		diag_warning(DIAG_NO_REGCMD, 0, mm_strhash(cmd), "Couldn't find registered plugin command: %s", cmd);
 		return;
 	}
 	if (icmd->call() != mTRUE)
@@ -144,11 +147,9 @@ void DLLHIDDEN meta_AddServerCommand(char* cmd_name, void (*function) ()) {
 		REG_SVR_COMMAND(icmd->name, meta_command_handler);
 	}
 
-	icmd->pfnCmd = function;
-	icmd->status = RG_VALID;
 	// Store which plugin this is for, if we know.  We can use '0' for
 	// unknown plugin, since plugin index starts at 1.
-	icmd->plugid = iplug ? iplug->index : 0;
+	RegCmds->enable(icmd, function, iplug ? iplug->index : 0);
 }
 
 // Replacement for engine routine CVarRegister; called by plugins.  Rather
@@ -195,10 +196,9 @@ void DLLHIDDEN meta_CVarRegister(cvar_t* pCvar) {
 	// Note: if not a new cvar, then we don't set the values, and just keep
 	// the pre-existing value.
 
-	icvar->status = RG_VALID;
 	// Store which plugin this is for, if we know.  Use '0' for unknown
 	// plugin, as plugin index starts at 1.
-	icvar->plugid = iplug ? iplug->index : 0;
+	RegCvars->enable(icvar, iplug ? iplug->index : 0);
 }
 
 // Replacement for engine routine RegUserMsg; called by plugins.
@@ -210,7 +210,7 @@ int DLLHIDDEN meta_RegUserMsg(const char* pszName, int iSize) {
 
 // Intercept and record queries
 void DLLHIDDEN meta_QueryClientCvarValue(const edict_t* player, const char* cvarName) {
-	g_Players.set_player_cvar_query(player, cvarName);
+	cvarquery_legacy_set(player, cvarName);
 
 	if (g_engfuncs.pfnQueryClientCvarValue)
 		(*g_engfuncs.pfnQueryClientCvarValue)(player, cvarName);
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cerrno>			// errno, etc
+#include <cstdio>			// snprintf
+#include <cstdlib>			// malloc, realloc, free
+#include <cstring>			// strcmp, etc
+
+#include <extdll.h>			// always
+
+#include "stageload.h"		// me
+#include "filewatch.h"		// filewatch_notify, filewatch_stat_id
+#include "log_meta.h"		// META_DEBUG, etc
+#include "support_meta.h"	// STRNCPY, etc
+
+#ifdef __linux__
+#include <fcntl.h>			// open, O_CREAT, etc
+#include <unistd.h>			// read, write, unlink, close
+
+// A plugin file whose updates are staged.  Entries are never removed
+// while staging runs, as the watcher thread may be copying one.
+typedef struct stage_file_s {
+	char path[PATH_MAX];
+	mBOOL tracked;			// plugin is running
+	mBOOL busy;				// being copied and opened by the watcher thread
+	DLHANDLE handle;		// opened copy, if any
+	filewatch_id_t id;		// version of the file the copy was made of
+} stage_file_t;
+
+static stage_file_t** stage_files = nullptr;
+static int stage_num = 0;
+static int stage_size = 0;
+static unsigned int stage_serial = 0;	// watcher thread only
+static pthread_mutex_t stage_mutex = PTHREAD_MUTEX_INITIALIZER;
+static mBOOL stage_enabled = mFALSE;
+
+// Find a file's entry; mutex must be held.
+static stage_file_t* DLLINTERNAL stage_find(const char* path) {
+	for (int i = 0; i < stage_num; i++) {
+		if (!strcmp(stage_files[i]->path, path))
+			return stage_files[i];
+	}
+	return nullptr;
+}
+
+// Copy a file, failing if the copy exists.
+static mBOOL DLLINTERNAL stage_copy(const char* from, const char* to) {
+	char buf[16384];
+	ssize_t len = 0;
+
+	const int in = open(from, O_RDONLY | O_CLOEXEC);
+	if (in < 0)
+		return mFALSE;
+	const int out = open(to, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0755);
+	if (out < 0) {
+		close(in);
+		return mFALSE;
+	}
+	while ((len = read(in, buf, sizeof(buf))) > 0) {
+		if (write(out, buf, static_cast<size_t>(len)) != len) {
+			len = -1;
+			break;
+		}
+	}
+	close(in);
+	if (close(out) != 0)
+		len = -1;
+	if (len < 0) {
+		unlink(to);
+		return mFALSE;
+	}
+	return mTRUE;
+}
+
+// Close a copy on the watcher thread.  Uses dlclose() directly, as
+// DLCLOSE sets state for DLERROR that the main thread reads; the table of
+// loaded modules may hold the copy, so it's marked stale (that flag is
+// atomic).
+static void DLLINTERNAL stage_dlclose(DLHANDLE handle) {
+	dlclose(handle);
+	modrange_stale.store(true, std::memory_order_release);
+}
+
+// Copy and open a file, if it still is as the watcher saw it and looks
+// like a plugin; nullptr otherwise.  On the watcher thread, so opens
+// with dlopen() directly; stage_take() marks the table of loaded modules
+// stale once the copy is handed to the main thread.
+static DLHANDLE DLLINTERNAL stage_open(const char* path, const filewatch_id_t* id) {
+	char copy[PATH_MAX];
+	filewatch_id_t now;
+
+	if (!filewatch_stat_id(path, &now) || !filewatch_same_id(&now, id))
+		return nullptr;
+	snprintf(copy, sizeof(copy), "%s.%u.staged", path, ++stage_serial);
+	unlink(copy);
+	if (!stage_copy(path, copy))
+		return nullptr;
+	DLHANDLE handle = dlopen(copy, RTLD_NOW);
+	// The mapping outlives the name.
+	unlink(copy);
+	if (!handle)
+		return nullptr;
+	// Changed while being copied; a later change will stage it again.
+	if (!filewatch_stat_id(path, &now) || !filewatch_same_id(&now, id)
+		|| !dlsym(handle, "Meta_Query") || !dlsym(handle, "Meta_Attach")
+		|| (!dlsym(handle, "GiveFnptrsToDll") && !dlsym(handle, "_GiveFnptrsToDll@8")))
+	{
+		stage_dlclose(handle);
+		return nullptr;
+	}
+	return handle;
+}
+
+// A watched file changed; on the watcher thread, so no logging.  The
+// thread handles one change at a time, so a file changing again while
+// copied is staged again on its next event.
+static void DLLINTERNAL stage_changed(const char* path, const filewatch_id_t* id) {
+	pthread_mutex_lock(&stage_mutex);
+	stage_file_t* sf = stage_find(path);
+	if (!stage_enabled || !sf || !sf->tracked) {
+		pthread_mutex_unlock(&stage_mutex);
+		return;
+	}
+	sf->busy = mTRUE;
+	DLHANDLE old = sf->handle;
+	sf->handle = nullptr;
+	pthread_mutex_unlock(&stage_mutex);
+
+	// a copy of an older update
+	if (old)
+		stage_dlclose(old);
+	DLHANDLE handle = stage_open(path, id);
+
+	pthread_mutex_lock(&stage_mutex);
+	sf->busy = mFALSE;
+	if (handle && sf->tracked && stage_enabled) {
+		sf->handle = handle;
+		sf->id = *id;
+		handle = nullptr;
+	}
+	pthread_mutex_unlock(&stage_mutex);
+	if (handle)
+		stage_dlclose(handle);
+}
+
+// Stage updates of tracked plugin files seen by the file watcher.
+void DLLINTERNAL stage_start() {
+	pthread_mutex_lock(&stage_mutex);
+	stage_enabled = mTRUE;
+	pthread_mutex_unlock(&stage_mutex);
+	filewatch_notify(stage_changed);
+	META_DEBUG(2, ("Staging updated plugin files"));
+}
+
+// Stop staging and close copies never used.  The file watcher should be
+// stopped first, so no copy is being made.
+void DLLINTERNAL stage_stop() {
+	filewatch_notify(nullptr);
+	pthread_mutex_lock(&stage_mutex);
+	stage_enabled = mFALSE;
+	for (int i = 0; i < stage_num; i++) {
+		if (stage_files[i]->handle && !stage_files[i]->busy) {
+			DLCLOSE(stage_files[i]->handle);
+			stage_files[i]->handle = nullptr;
+		}
+	}
+	pthread_mutex_unlock(&stage_mutex);
+}
+
+mBOOL DLLINTERNAL stage_running() {
+	return stage_enabled;
+}
+
+// Stage updates of a plugin's file from now on.
+void DLLINTERNAL stage_track(const char* pathname) {
+	pthread_mutex_lock(&stage_mutex);
+	stage_file_t* sf = stage_find(pathname);
+	if (!sf) {
+		if (stage_num == stage_size) {
+			const int nsize = stage_size ? stage_size * 2 : 16;
+			stage_file_t** nfiles = static_cast<stage_file_t**>(realloc(stage_files, static_cast<size_t>(nsize) * sizeof(stage_file_t*)));
+			if (!nfiles) {
+				pthread_mutex_unlock(&stage_mutex);
+				return;
+			}
+			stage_files = nfiles;
+			stage_size = nsize;
+		}
+		if (!((sf = static_cast<stage_file_t*>(calloc(1, sizeof(stage_file_t)))))) {
+			pthread_mutex_unlock(&stage_mutex);
+			return;
+		}
+		STRNCPY(sf->path, pathname, sizeof(sf->path));
+		stage_files[stage_num++] = sf;
+	}
+	sf->tracked = mTRUE;
+	pthread_mutex_unlock(&stage_mutex);
+}
+
+// Stop staging a plugin's file, closing any copy made.
+void DLLINTERNAL stage_untrack(const char* pathname) {
+	DLHANDLE handle = nullptr;
+
+	pthread_mutex_lock(&stage_mutex);
+	stage_file_t* sf = stage_find(pathname);
+	if (sf) {
+		sf->tracked = mFALSE;
+		handle = sf->handle;
+		sf->handle = nullptr;
+	}
+	pthread_mutex_unlock(&stage_mutex);
+	if (handle)
+		DLCLOSE(handle);
+}
+
+mBOOL DLLINTERNAL stage_ready(const char* pathname) {
+	pthread_mutex_lock(&stage_mutex);
+	const stage_file_t* sf = stage_find(pathname);
+	const mBOOL ready = (sf && sf->handle) ? mTRUE : mFALSE;
+	pthread_mutex_unlock(&stage_mutex);
+	return ready;
+}
+
+// Take the opened copy of a file, if made from the version of the file
+// with the given identity.  A copy of another version is closed.
+DLHANDLE DLLINTERNAL stage_take(const char* pathname, const filewatch_id_t* id) {
+	DLHANDLE handle = nullptr, stale = nullptr;
+
+	pthread_mutex_lock(&stage_mutex);
+	stage_file_t* sf = stage_find(pathname);
+	if (sf && sf->handle) {
+		if (filewatch_same_id(&sf->id, id))
+			handle = sf->handle;
+		else
+			stale = sf->handle;
+		sf->handle = nullptr;
+	}
+	pthread_mutex_unlock(&stage_mutex);
+	// opened on the watcher thread, behind DLOPEN's back
+	if (handle)
+		modrange_stale.store(true, std::memory_order_release);
+	if (stale) {
+		META_DEBUG(3, ("dll: Discarding staged copy of '%s'; file changed again", pathname));
+		DLCLOSE(stale);
+	}
+	return handle;
+}
+
+#else /* _WIN32 */
+
+// Staging relies on the file watcher, which is linux only.
+
+void DLLINTERNAL stage_start() {
+}
+
+void DLLINTERNAL stage_stop() {
+}
+
+mBOOL DLLINTERNAL stage_running() {
+	return mFALSE;
+}
+
+void DLLINTERNAL stage_track(const char* /*pathname*/) {
+}
+
+void DLLINTERNAL stage_untrack(const char* /*pathname*/) {
+}
+
+mBOOL DLLINTERNAL stage_ready(const char* /*pathname*/) {
+	return mFALSE;
+}
+
+DLHANDLE DLLINTERNAL stage_take(const char* /*pathname*/, const filewatch_id_t* /*id*/) {
+	return nullptr;
+}
+
+#endif /* _WIN32 */
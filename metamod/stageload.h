@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#ifndef STAGELOAD_H
+#define STAGELOAD_H
+
+#include "types_meta.h"		// mBOOL
+#include "comp_dep.h"		// DLLINTERNAL
+#include "osdep.h"			// DLHANDLE
+#include "filewatch.h"		// filewatch_id_t
+
+// Staged reloads of updated plugins.
+//
+// Reloading a plugin whose file was updated dlopens the new file at
+// changelevel, and relocating a large plugin there can take hundreds of
+// milliseconds.  With stage_reload on (it's off by default), when the
+// file watcher sees a running plugin's file change, it instead copies the
+// file to a unique name (dlopen of the same path would just return the
+// loaded copy) and dlopens the copy then, mid-map.  At changelevel the
+// reload queries and attaches the staged copy, and only then detaches and
+// closes the old one, reattaching the old one if the new one fails to
+// attach.  Nothing of the plugin is called off the server thread, besides
+// its static constructors.
+
+void DLLINTERNAL stage_start();
+void DLLINTERNAL stage_stop();
+mBOOL DLLINTERNAL stage_running();
+
+// Stage updates of a running plugin's file, or stop doing so.
+void DLLINTERNAL stage_track(const char* pathname);
+void DLLINTERNAL stage_untrack(const char* pathname);
+
+// Whether a copy of a file is opened and waiting.
+mBOOL DLLINTERNAL stage_ready(const char* pathname);
+// Handle of the opened copy, if it was made from the version of the file
+// with the given identity (see filewatch_id); the caller owns it from
+// then on.
+DLHANDLE DLLINTERNAL stage_take(const char* pathname, const filewatch_id_t* id);
+
+#endif /* STAGELOAD_H */
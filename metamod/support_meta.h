@@ -39,6 +39,7 @@
 
 #include <cstring>		// strcpy(), strncat()
 #include <cstddef>
+#include <cctype>		// tolower
 #include <sys/types.h>	// stat
 #include <sys/stat.h>	// stat
 
@@ -57,6 +58,22 @@ inline int DLLINTERNAL mm_strcmp(const char* s1, const char* s2) {
 #endif
 }
 
+// Hash of a string, for hash tables of names (FNV-1a).
+inline unsigned int DLLINTERNAL mm_strhash(const char* s) {
+	unsigned int hash = 2166136261u;
+	for (; *s; s++)
+		hash = (hash ^ static_cast<unsigned char>(*s)) * 16777619u;
+	return hash;
+}
+
+// Same, ignoring case, for names compared with strcasecmp.
+inline unsigned int DLLINTERNAL mm_strcasehash(const char* s) {
+	unsigned int hash = 2166136261u;
+	for (; *s; s++)
+		hash = (hash ^ static_cast<unsigned char>(tolower(static_cast<unsigned char>(*s)))) * 16777619u;
+	return hash;
+}
+
 //use pointer to avoid inlining of strncmp
 inline int DLLINTERNAL mm_strncmp(const char* s1, const char* s2, size_t n) {
 #if 0
@@ -0,0 +1,7 @@
+// Source of the gamedll_*.so fixtures:
+//   gcc [-m32] -shared -fPIC -nostdlib -s -Os -Wl,--build-id=none \
+//     -Wl,-z,max-page-size=0x200 -Wl,-z,norelro -Wl,--hash-style=sysv \
+//     gamedll.c -o gamedll_{i386,amd64}.so
+// truncated_amd64.so is the first 512 bytes of gamedll_amd64.so.
+void GiveFnptrsToDll(void *a, void *b) { (void)a; (void)b; }
+int GetEntityAPI2(void *a, int *b) { (void)a; (void)b; return 1; }
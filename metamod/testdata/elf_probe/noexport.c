@@ -0,0 +1,2 @@
+// Source of noexport_amd64.so; built like gamedll.c.
+int not_a_game_dll(void) { return 0; }
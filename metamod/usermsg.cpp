@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+
+#include <cstdlib>			// realloc, free
+#include <cstring>			// memcpy, memmove, strlen
+
+#include <extdll.h>			// always
+
+#include "usermsg.h"		// me
+#include "engine_api.h"		// meta_engfuncs
+#include "meta_api.h"		// MRES_SUPERCEDE
+#include "metamod.h"		// Plugins, RegMsgs
+#include "mlist.h"			// class MPluginList
+#include "mplugin.h"		// class MPlugin
+#include "mreg.h"			// class MRegMsgList
+#include "log_meta.h"		// META_CONS, etc
+#include "api_route.h"		// route_update
+
+// A plugin's hook of a message type.
+typedef struct umsg_hook_s {
+	int plugin_index;
+	USERMSG_FN pfn;
+} umsg_hook_t;
+
+// Hooks of a message type, in plugin order.
+typedef struct umsg_hooks_s {
+	umsg_hook_t* hooks;
+	int num;
+	int size;
+} umsg_hooks_t;
+
+static umsg_hooks_t umsg_hooks[MAX_UMSG_TYPES];
+int umsg_num_hooks = 0;
+
+mBOOL umsg_capturing = mFALSE;
+static mBOOL umsg_sending = mFALSE;		// hooks or engine have the message
+static umsg_hooks_t* umsg_delivering = nullptr;	// list whose hooks are being called
+static mBOOL umsg_changed = mFALSE;		// delivering list changed by its hooks
+
+// Message being captured.
+static usermsg_t umsg;
+static float umsg_origin[3];
+static usermsg_arg_t umsg_args[MAX_UMSG_ARGS];
+static char umsg_strings[MAX_UMSG_STRINGS];
+static int umsg_strings_len;
+
+static void DLLINTERNAL umsg_send_arg(const usermsg_arg_t* arg) {
+	switch (arg->type) {
+	case UMSG_BYTE:		meta_engfuncs.pfnWriteByte(arg->iValue); break;
+	case UMSG_CHAR:		meta_engfuncs.pfnWriteChar(arg->iValue); break;
+	case UMSG_SHORT:	meta_engfuncs.pfnWriteShort(arg->iValue); break;
+	case UMSG_LONG:		meta_engfuncs.pfnWriteLong(arg->iValue); break;
+	case UMSG_ANGLE:	meta_engfuncs.pfnWriteAngle(arg->flValue); break;
+	case UMSG_COORD:	meta_engfuncs.pfnWriteCoord(arg->flValue); break;
+	case UMSG_STRING:	meta_engfuncs.pfnWriteString(arg->szValue); break;
+	case UMSG_ENTITY:	meta_engfuncs.pfnWriteEntity(arg->iValue); break;
+	}
+}
+
+// Pass message, as far as captured, through engine function table.
+static void DLLINTERNAL umsg_send(const mBOOL end) {
+	umsg_sending = mTRUE;
+	meta_engfuncs.pfnMessageBegin(umsg.msg_dest, umsg.msg_type, umsg.origin, umsg.ed);
+	for (int i = 0; i < umsg.num_args; i++)
+		umsg_send_arg(&umsg.args[i]);
+	if (end)
+		meta_engfuncs.pfnMessageEnd();
+	umsg_sending = mFALSE;
+}
+
+// Add a written value to message.  If it doesn't fit, send the message
+// unhooked, and let the rest of it go to the engine as usual.
+static void DLLINTERNAL umsg_add(const usermsg_arg_t* arg, const int len) {
+	if (likely(umsg.num_args < MAX_UMSG_ARGS && umsg_strings_len + len <= MAX_UMSG_STRINGS)) {
+		usermsg_arg_t* dest = &umsg_args[umsg.num_args++];
+		*dest = *arg;
+		if (len) {
+			memcpy(umsg_strings + umsg_strings_len, arg->szValue, static_cast<size_t>(len));
+			dest->szValue = umsg_strings + umsg_strings_len;
+			umsg_strings_len += len;
+		}
+		return;
+	}
+	META_DEBUG(3, ("User message %d too big to hook; sending as is", umsg.msg_type));
+	umsg_capturing = mFALSE;
+	umsg_send(mFALSE);
+	umsg_send_arg(arg);
+}
+
+// Start of a message from gamedll or a plugin; returns true if message
+// is hooked and will be kept until MessageEnd.
+mBOOL DLLINTERNAL umsg_begin(const int msg_dest, const int msg_type, const float* origin, edict_t* ed) {
+	if (likely(!umsg_num_hooks) || umsg_sending || umsg_capturing)
+		return mFALSE;
+	if (msg_type < 0 || msg_type >= MAX_UMSG_TYPES || !umsg_hooks[msg_type].num)
+		return mFALSE;
+
+	umsg.msg_dest = msg_dest;
+	umsg.msg_type = msg_type;
+	umsg.origin = nullptr;
+	if (origin) {
+		umsg_origin[0] = origin[0];
+		umsg_origin[1] = origin[1];
+		umsg_origin[2] = origin[2];
+		umsg.origin = umsg_origin;
+	}
+	umsg.ed = ed;
+	umsg.num_args = 0;
+	umsg.args = umsg_args;
+	umsg_strings_len = 0;
+	umsg_capturing = mTRUE;
+	return mTRUE;
+}
+
+void DLLINTERNAL umsg_write(const umsg_arg_type_t type, const int iValue) {
+	usermsg_arg_t arg;
+	arg.type = type;
+	arg.iValue = iValue;
+	umsg_add(&arg, 0);
+}
+
+void DLLINTERNAL umsg_write(const umsg_arg_type_t type, const float flValue) {
+	usermsg_arg_t arg;
+	arg.type = type;
+	arg.flValue = flValue;
+	umsg_add(&arg, 0);
+}
+
+void DLLINTERNAL umsg_write(const char* szValue) {
+	usermsg_arg_t arg;
+	arg.type = UMSG_STRING;
+	arg.szValue = szValue;
+	umsg_add(&arg, szValue ? static_cast<int>(strlen(szValue)) + 1 : 0);
+}
+
+// Drop hooks removed, and put hooks added in plugin order, after the
+// hooks of a list were called.
+static void DLLINTERNAL umsg_compact(umsg_hooks_t* list) {
+	int n = 0;
+	for (int i = 0; i < list->num; i++) {
+		if (list->hooks[i].pfn)
+			list->hooks[n++] = list->hooks[i];
+	}
+	list->num = n;
+	for (int i = 1; i < n; i++) {
+		const umsg_hook_t hook = list->hooks[i];
+		int j;
+		for (j = i; j > 0 && list->hooks[j - 1].plugin_index > hook.plugin_index; j--)
+			list->hooks[j] = list->hooks[j - 1];
+		list->hooks[j] = hook;
+	}
+}
+
+// End of a hooked message; give it to hooks, then to engine unless
+// blocked.  Messages started by hooks aren't hooked.  Hooks may hook or
+// unhook the type; until they're done, removed hooks are only cleared and
+// added ones go at the end, so each hook is called at most once.
+void DLLINTERNAL umsg_end() {
+	umsg_hooks_t* list = &umsg_hooks[umsg.msg_type];
+	int status = MRES_IGNORED;
+
+	umsg_capturing = mFALSE;
+	umsg_sending = mTRUE;
+	umsg_delivering = list;
+	// hooks added by hooks see the next message
+	const int num = list->num;
+	for (int i = 0; i < num; i++) {
+		const umsg_hook_t hook = list->hooks[i];
+		if (!hook.pfn || Plugins->plist[hook.plugin_index - 1]->status != PL_RUNNING)
+			continue;
+		const int mres = hook.pfn(&umsg);
+		if (mres > status)
+			status = mres;
+		if (umsg.num_args < 0 || umsg.num_args > MAX_UMSG_ARGS)
+			umsg.num_args = 0;
+	}
+	umsg_delivering = nullptr;
+	if (umsg_changed) {
+		umsg_compact(list);
+		umsg_changed = mFALSE;
+	}
+	if (status < MRES_SUPERCEDE)
+		umsg_send(mTRUE);
+	umsg_sending = mFALSE;
+}
+
+// Hook a message type for a plugin; returns 0 or meta_errno value.
+int DLLINTERNAL umsg_hook(const int plugin_index, const int msg_type, const USERMSG_FN pfn) {
+	if (msg_type < 0 || msg_type >= MAX_UMSG_TYPES || !pfn)
+		return ME_ARGUMENT;
+
+	umsg_hooks_t* list = &umsg_hooks[msg_type];
+	int i;
+	for (i = 0; i < list->num; i++) {
+		if (list->hooks[i].plugin_index == plugin_index && list->hooks[i].pfn == pfn)
+			return ME_ALREADY;
+	}
+	if (list->num == list->size) {
+		const int size = list->size ? list->size * 2 : 4;
+		umsg_hook_t* hooks = static_cast<umsg_hook_t*>(realloc(list->hooks, static_cast<size_t>(size) * sizeof(umsg_hook_t)));
+		if (!hooks)
+			return ME_NOMEM;
+		list->hooks = hooks;
+		list->size = size;
+	}
+	// after other hooks of same or lower plugin index; at the end if the
+	// list's hooks are being called (see umsg_end)
+	if (list == umsg_delivering)
+		umsg_changed = mTRUE;
+	else {
+		for (i = list->num; i > 0 && list->hooks[i - 1].plugin_index > plugin_index; i--)
+			list->hooks[i] = list->hooks[i - 1];
+	}
+	list->hooks[i].plugin_index = plugin_index;
+	list->hooks[i].pfn = pfn;
+	list->num++;
+	umsg_num_hooks++;
+	// gamedll's messages have to come through metamod
+	if (umsg_num_hooks == 1)
+		route_update();
+	return 0;
+}
+
+// Remove a plugin's hook of a message type; returns 0 or meta_errno value.
+int DLLINTERNAL umsg_unhook(const int plugin_index, const int msg_type, const USERMSG_FN pfn) {
+	if (msg_type < 0 || msg_type >= MAX_UMSG_TYPES)
+		return ME_ARGUMENT;
+
+	umsg_hooks_t* list = &umsg_hooks[msg_type];
+	for (int i = 0; i < list->num; i++) {
+		if (list->hooks[i].plugin_index == plugin_index && list->hooks[i].pfn == pfn) {
+			if (list == umsg_delivering) {
+				list->hooks[i].pfn = nullptr;
+				umsg_changed = mTRUE;
+			}
+			else {
+				memmove(&list->hooks[i], &list->hooks[i + 1], static_cast<size_t>(list->num - i - 1) * sizeof(umsg_hook_t));
+				list->num--;
+			}
+			umsg_num_hooks--;
+			if (!umsg_num_hooks)
+				route_update();
+			return 0;
+		}
+	}
+	return ME_NOTFOUND;
+}
+
+// Remove all hooks of a plugin being unloaded.
+void DLLINTERNAL umsg_unhook_plugin(const int plugin_index) {
+	if (!umsg_num_hooks)
+		return;
+	for (umsg_hooks_t& list : umsg_hooks) {
+		if (&list == umsg_delivering) {
+			for (int i = 0; i < list.num; i++) {
+				if (list.hooks[i].plugin_index == plugin_index && list.hooks[i].pfn) {
+					list.hooks[i].pfn = nullptr;
+					umsg_num_hooks--;
+					umsg_changed = mTRUE;
+				}
+			}
+			continue;
+		}
+		int n = 0;
+		for (int i = 0; i < list.num; i++) {
+			if (list.hooks[i].plugin_index != plugin_index)
+				list.hooks[n++] = list.hooks[i];
+		}
+		umsg_num_hooks -= list.num - n;
+		list.num = n;
+	}
+	if (!umsg_num_hooks)
+		route_update();
+}
+
+// List hooked message types to console.
+void DLLINTERNAL umsg_show() {
+	if (!umsg_num_hooks)
+		return;
+	META_CONS("User message hooks:");
+	for (int type = 0; type < MAX_UMSG_TYPES; type++) {
+		const umsg_hooks_t* list = &umsg_hooks[type];
+		if (!list->num)
+			continue;
+		const MRegMsg* msg = RegMsgs->find(type);
+		META_CONS("  %3d  %-20s %d hook%s", type, msg ? msg->name : "", list->num, list->num == 1 ? "" : "s");
+	}
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2004-2006 Jussi Kivilinna
+ *
+ *    This file is part of "Metamod All-Mod-Support"-patch for Metamod.
+ *
+ *    Metamod is free software; you can redistribute it and/or modify it
+ *    under the terms of the GNU General Public License as published by the
+ *    Free Software Foundation; either version 2 of the License, or (at
+ *    your option) any later version.
+ *
+ *    Metamod is distributed in the hope that it will be useful, but
+ *    WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with Metamod; if not, write to the Free Software Foundation,
+ *    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *    In addition, as a special exception, the author gives permission to
+ *    link the code of this program with the Half-Life Game Engine ("HL
+ *    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+ *    L.L.C ("Valve").  You must obey the GNU General Public License in all
+ *    respects for all of the code used other than the HL Engine and MODs
+ *    from Valve.  If you modify this file, you may extend this exception
+ *    to your version of the file, but you are not obligated to do so.  If
+ *    you do not wish to do so, delete this exception statement from your
+ *    version.
+ *
+ */
+#ifndef USERMSG_H
+#define USERMSG_H
+
+#include <extdll.h>			// edict_t, etc
+
+#include "types_meta.h"		// mBOOL
+#include "comp_dep.h"		// DLLINTERNAL, unlikely
+#include "mutil.h"			// usermsg_t, USERMSG_FN
+
+// Whole-message user message hooks.
+//
+// A message of a type some plugin hooked with HOOK_USER_MSG is not passed
+// to the engine as it is written.  Its MessageBegin args and written
+// values are kept in a buffer, and at MessageEnd the whole message is
+// given to each hooking plugin, which may change or block it.  Unless
+// blocked, the message is then sent through the engine function table,
+// so plugins hooking MessageBegin, Write* and MessageEnd still see it.
+// Messages of other types go to the engine as usual.  While any type is
+// hooked, the message functions are routed through metamod whether or not
+// a plugin hooks them; see api_route.h.
+
+constexpr int MAX_UMSG_TYPES = 256;
+constexpr int MAX_UMSG_ARGS = 256;
+constexpr int MAX_UMSG_STRINGS = 2048;	// bytes of strings in a message
+
+extern mBOOL umsg_capturing DLLHIDDEN;	// in a hooked message
+extern int umsg_num_hooks DLLHIDDEN;	// hooks of all types
+
+mBOOL DLLINTERNAL umsg_begin(int msg_dest, int msg_type, const float* origin, edict_t* ed);
+void DLLINTERNAL umsg_write(umsg_arg_type_t type, int iValue);
+void DLLINTERNAL umsg_write(umsg_arg_type_t type, float flValue);
+void DLLINTERNAL umsg_write(const char* szValue);
+void DLLINTERNAL umsg_end();
+
+int DLLINTERNAL umsg_hook(int plugin_index, int msg_type, USERMSG_FN pfn);
+int DLLINTERNAL umsg_unhook(int plugin_index, int msg_type, USERMSG_FN pfn);
+void DLLINTERNAL umsg_unhook_plugin(int plugin_index);
+void DLLINTERNAL umsg_show();
+
+#endif /* USERMSG_H */